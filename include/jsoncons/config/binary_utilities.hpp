@@ -198,6 +198,16 @@ double decode_half(uint16_t half)
 #endif
 }
 
+// Returns true if the host stores multibyte values least significant byte first
+inline
+bool is_little_endian()
+{
+    const uint16_t x = 1;
+    uint8_t b;
+    memcpy(&b, &x, sizeof(b));
+    return b == 1;
+}
+
 // to_big_endian
 
 template<typename T>
@@ -0,0 +1,104 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_DETAIL_DEFERREDLENGTHBUFFER_HPP
+#define JSONCONS_DETAIL_DEFERREDLENGTHBUFFER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace jsoncons { namespace detail {
+
+// deferred_length_buffer lets a binary serializer write a length prefixed
+// container whose length is not known when it begins. While any such container
+// is open, output goes to the buffer, with room left for each header. When a
+// container ends its header is written into that room, and the unused bytes
+// are skipped when the outermost container ends and the buffer is written out.
+
+class deferred_length_buffer
+{
+    size_t max_header_length_;
+    std::vector<uint8_t> buffer_;
+    std::vector<std::pair<size_t,size_t>> gaps_;
+    size_t depth_;
+public:
+    explicit deferred_length_buffer(size_t max_header_length)
+        : max_header_length_(max_header_length), depth_(0)
+    {
+    }
+
+    bool active() const
+    {
+        return depth_ > 0;
+    }
+
+    // Reserves room for a header, returns its offset
+    size_t begin()
+    {
+        size_t offset = buffer_.size();
+        ++depth_;
+        buffer_.resize(buffer_.size() + max_header_length_);
+        return offset;
+    }
+
+    template <class Writer>
+    void end(size_t offset, const std::vector<uint8_t>& header, Writer& writer)
+    {
+        std::copy(header.begin(), header.end(), buffer_.begin() + offset);
+        if (header.size() < max_header_length_)
+        {
+            gaps_.push_back(std::make_pair(offset + header.size(), max_header_length_ - header.size()));
+        }
+
+        --depth_;
+        if (depth_ == 0)
+        {
+            // Inner containers end first, so the gaps are not in buffer order
+            std::sort(gaps_.begin(), gaps_.end());
+            size_t pos = 0;
+            for (const auto& gap : gaps_)
+            {
+                writer.write(buffer_.data() + pos, gap.first - pos);
+                pos = gap.first + gap.second;
+            }
+            writer.write(buffer_.data() + pos, buffer_.size() - pos);
+            buffer_.clear();
+            gaps_.clear();
+        }
+    }
+
+    template <class Writer>
+    void put(uint8_t c, Writer& writer)
+    {
+        if (depth_ > 0)
+        {
+            buffer_.push_back(c);
+        }
+        else
+        {
+            writer.put(c);
+        }
+    }
+
+    template <class Writer>
+    void write(const std::vector<uint8_t>& v, Writer& writer)
+    {
+        if (depth_ > 0)
+        {
+            buffer_.insert(buffer_.end(), v.begin(), v.end());
+        }
+        else
+        {
+            writer.write(v.data(), v.size());
+        }
+    }
+};
+
+}}
+
+#endif
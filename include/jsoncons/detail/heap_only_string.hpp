@@ -12,6 +12,7 @@
 #include <cstdlib>
 #include <exception>
 #include <ostream>
+#include <atomic>
 #include <jsoncons/config/jsoncons_config.hpp>
 
 namespace jsoncons { namespace detail {
@@ -70,18 +71,19 @@ public:
     }
 private:
     heap_only_string()
-        : heap_only_string_base<Allocator>(Allocator())
+        : heap_only_string_base<Allocator>(Allocator()), ref_count_(1)
     {
 
     }
     heap_only_string(const Allocator& allocator)
-        : heap_only_string_base<Allocator>(allocator)
+        : heap_only_string_base<Allocator>(allocator), ref_count_(1)
     {
 
     }
 
     pointer p_;
     size_t length_;
+    std::atomic<size_t> ref_count_;
 
     heap_only_string(const heap_only_string&) = delete;
     heap_only_string& operator=(const heap_only_string&) = delete;
@@ -139,6 +141,21 @@ public:
         return std::pointer_traits<string_pointer>::pointer_to(*ps);
     }
 
+    // Shared strings are released rather than destroyed, the last release frees the storage
+    static string_pointer share(string_pointer ptr)
+    {
+        ptr->ref_count_.fetch_add(1, std::memory_order_relaxed);
+        return ptr;
+    }
+
+    static void release(string_pointer ptr)
+    {
+        if (ptr->ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            destroy(ptr);
+        }
+    }
+
     static void destroy(string_pointer ptr)
     {
         raw_string_pointer_type rawp = to_plain_pointer(ptr);
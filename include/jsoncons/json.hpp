@@ -16,6 +16,7 @@
 #include <ostream>
 #include <memory>
 #include <typeinfo>
+#include <atomic>
 #include <cstring>
 #include <jsoncons/json_fwd.hpp>
 #include <jsoncons/config/version.hpp>
@@ -59,6 +60,80 @@ struct preserve_order_policy : public sorted_policy
     static const bool preserve_order = true;
 };
 
+// Decodes homogeneous arrays of int64 or double values into packed storage
+struct typed_array_policy : public sorted_policy
+{
+    static const size_t typed_array_min_length = 8;
+};
+
+// Shares arrays, objects and long strings between copies, a mutation clones 
+// only the containers on the path to the changed value
+struct copy_on_write_policy : public sorted_policy
+{
+    static const bool copy_on_write = true;
+};
+
+namespace detail {
+
+// is_copy_on_write
+
+template <class Policy, class Enable=void>
+struct is_copy_on_write : std::false_type
+{
+};
+
+template <class Policy>
+struct is_copy_on_write<Policy,
+    typename std::enable_if<std::is_same<decltype(Policy::copy_on_write),const bool>::value>::type>
+    : std::integral_constant<bool,Policy::copy_on_write>
+{
+};
+
+// ref_counted
+
+template <class T>
+class ref_counted : public T
+{
+    std::atomic<size_t> count_;
+    bool shareable_;
+public:
+    template <class... Args>
+    explicit ref_counted(Args&&... args)
+        : T(std::forward<Args>(args)...), count_(1), shareable_(true)
+    {
+    }
+
+    void add_ref()
+    {
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Returns true when the last reference is released
+    bool release()
+    {
+        return count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    bool is_shared() const
+    {
+        return count_.load(std::memory_order_acquire) > 1;
+    }
+
+    // A holder that a mutable reference or iterator has escaped from stays 
+    // unshareable, later copies clone it
+    bool is_shareable() const
+    {
+        return shareable_;
+    }
+
+    void mark_unshareable()
+    {
+        shareable_ = false;
+    }
+};
+
+}
+
 template <typename IteratorT>
 class range 
 {
@@ -93,9 +168,33 @@ enum class structure_tag_type : uint8_t
     byte_string_tag = 0x07,
     array_tag = 0x08,
     empty_object_tag = 0x09,
-    object_tag = 0x0a
+    object_tag = 0x0a,
+    typed_array_tag = 0x0b
 };
                       
+// json_memory_usage
+
+struct json_memory_usage
+{
+    size_t nodes;        // values, including those held by arrays and objects
+    size_t containers;   // array and object storage other than the values they hold, including slack
+    size_t slack;        // unused capacity of arrays and objects, included in containers
+    size_t keys;         // object member names that do not fit in short string storage
+    size_t strings;      // long strings
+    size_t byte_strings;
+    size_t bignums;
+
+    json_memory_usage()
+        : nodes(0), containers(0), slack(0), keys(0), strings(0), byte_strings(0), bignums(0)
+    {
+    }
+
+    size_t total() const
+    {
+        return nodes + containers + keys + strings + byte_strings + bignums;
+    }
+};
+
 template <class CharT, class ImplementationPolicy, class Allocator>
 class basic_json
 {
@@ -155,6 +254,8 @@ public:
 
     struct variant
     {
+        static const bool copy_on_write = detail::is_copy_on_write<implementation_policy>::value;
+
         class data_base
         {
             static const uint8_t major_type_shift = 0x04;
@@ -375,7 +476,7 @@ public:
             long_string_data(const long_string_data& val)
                 : data_base(structure_tag_type::long_string_tag, semantic_tag_type::none)
             {
-                ptr_ = detail::heap_only_string_factory<char_type,Allocator>::create(val.data(),val.length(),val.get_allocator());
+                ptr_ = copy(val.ptr_, std::integral_constant<bool,copy_on_write>());
             }
 
             long_string_data(long_string_data&& val)
@@ -394,7 +495,7 @@ public:
             {
                 if (ptr_ != nullptr)
                 {
-                    detail::heap_only_string_factory<char_type,Allocator>::destroy(ptr_);
+                    detail::heap_only_string_factory<char_type,Allocator>::release(ptr_);
                 }
             }
 
@@ -422,6 +523,17 @@ public:
             {
                 return ptr_->get_allocator();
             }
+        private:
+            // Strings are immutable, so copies may share storage
+            static pointer copy(pointer p, std::true_type)
+            {
+                return detail::heap_only_string_factory<char_type,Allocator>::share(p);
+            }
+
+            static pointer copy(pointer p, std::false_type)
+            {
+                return detail::heap_only_string_factory<char_type,Allocator>::create(p->data(),p->length(),p->get_allocator());
+            }
         };
 
         // byte_string_data
@@ -498,6 +610,11 @@ public:
                 return ptr_->size();
             }
 
+            size_t capacity() const
+            {
+                return ptr_->capacity();
+            }
+
             allocator_type get_allocator() const
             {
                 return ptr_->get_allocator();
@@ -507,17 +624,19 @@ public:
         // array_data
         class array_data final : public data_base
         {
-            typedef typename std::allocator_traits<array_allocator>::pointer pointer;
+            typedef typename std::conditional<copy_on_write,detail::ref_counted<array>,array>::type holder_type;
+            typedef typename std::allocator_traits<Allocator>:: template rebind_alloc<holder_type> holder_allocator;
+            typedef typename std::allocator_traits<holder_allocator>::pointer pointer;
             pointer ptr_;
 
             template <typename... Args>
             void create(array_allocator allocator, Args&& ... args)
             {
-                typename std::allocator_traits<Allocator>:: template rebind_alloc<array> alloc(allocator);
+                holder_allocator alloc(allocator);
                 ptr_ = alloc.allocate(1);
                 try
                 {
-                    std::allocator_traits<array_allocator>:: template rebind_traits<array>::construct(alloc, detail::to_plain_pointer(ptr_), std::forward<Args>(args)...);
+                    std::allocator_traits<holder_allocator>::construct(alloc, detail::to_plain_pointer(ptr_), std::forward<Args>(args)...);
                 }
                 catch (...)
                 {
@@ -525,6 +644,105 @@ public:
                     throw;
                 }
             }
+
+            static void destroy(pointer ptr)
+            {
+                holder_allocator alloc(ptr->get_allocator());
+                std::allocator_traits<holder_allocator>::destroy(alloc, detail::to_plain_pointer(ptr));
+                alloc.deallocate(ptr,1);
+            }
+
+            void share(const array_data& val, std::true_type)
+            {
+                if (val.ptr_->is_shareable())
+                {
+                    ptr_ = val.ptr_;
+                    ptr_->add_ref();
+                }
+                else
+                {
+                    copy(static_cast<const array&>(*(val.ptr_)), val.ptr_->get_allocator());
+                }
+            }
+
+            void share(const array_data& val, std::false_type)
+            {
+                copy(static_cast<const array&>(*(val.ptr_)), val.ptr_->get_allocator());
+            }
+
+            // Nested values are copied with an explicit stack, see copy_nested
+            void copy(const array& val, const Allocator& a)
+            {
+                create(array_allocator(a), a);
+                try
+                {
+                    copy_nested(val, *ptr_);
+                }
+                catch (...)
+                {
+                    destroy(ptr_);
+                    throw;
+                }
+            }
+
+            bool is_shared(std::true_type) const
+            {
+                return ptr_->is_shared();
+            }
+
+            bool is_shared(std::false_type) const
+            {
+                return false;
+            }
+
+            void mark_unshareable(std::true_type)
+            {
+                ptr_->mark_unshareable();
+            }
+
+            void mark_unshareable(std::false_type)
+            {
+            }
+
+            void release(std::true_type)
+            {
+                if (ptr_->release())
+                {
+                    destroy(ptr_);
+                }
+            }
+
+            void release(std::false_type)
+            {
+                destroy(ptr_);
+            }
+
+            // Clones a shared array before it is modified, the elements 
+            // themselves are shared with the original
+            void detach(std::true_type)
+            {
+                if (ptr_->is_shared())
+                {
+                    pointer p = ptr_;
+                    try
+                    {
+                        create(p->get_allocator(), static_cast<const array&>(*p));
+                    }
+                    catch (...)
+                    {
+                        ptr_ = p;
+                        throw;
+                    }
+                    if (p->release())
+                    {
+                        destroy(p);
+                    }
+                }
+            }
+
+            void detach(std::false_type)
+            {
+            }
         public:
             array_data(const array& val)
                 : data_base(structure_tag_type::array_tag, semantic_tag_type::none)
@@ -541,7 +759,7 @@ public:
             array_data(const array_data& val)
                 : data_base(val.type())
             {
-                create(val.ptr_->get_allocator(), *(val.ptr_));
+                share(val, std::integral_constant<bool,copy_on_write>());
             }
 
             array_data(array_data&& val)
@@ -553,15 +771,13 @@ public:
             array_data(const array_data& val, const Allocator& a)
                 : data_base(val.type())
             {
-                create(array_allocator(a), *(val.ptr_), a);
+                copy(static_cast<const array&>(*(val.ptr_)), a);
             }
             ~array_data()
             {
                 if (ptr_ != nullptr)
                 {
-                    typename std::allocator_traits<array_allocator>:: template rebind_alloc<array> alloc(ptr_->get_allocator());
-                    std::allocator_traits<array_allocator>:: template rebind_traits<array>::destroy(alloc, detail::to_plain_pointer(ptr_));
-                    alloc.deallocate(ptr_,1);
+                    release(std::integral_constant<bool,copy_on_write>());
                 }
             }
 
@@ -577,29 +793,294 @@ public:
 
             array& value()
             {
+                detach(std::integral_constant<bool,copy_on_write>());
+                return *ptr_;
+            }
+
+            // As value(), for access that lets a mutable reference or iterator 
+            // escape, the array is no longer shared by later copies
+            array& leak()
+            {
+                detach(std::integral_constant<bool,copy_on_write>());
+                mark_unshareable(std::integral_constant<bool,copy_on_write>());
                 return *ptr_;
             }
 
+            // Size of the allocation that holds the array
+            static size_t holder_size()
+            {
+                return sizeof(holder_type);
+            }
+
+            // Returns nullptr if the array has been moved from or is shared with other copies
+            array* unique_value()
+            {
+                return ptr_ != nullptr && !is_shared(std::integral_constant<bool,copy_on_write>()) ? detail::to_plain_pointer(ptr_) : nullptr;
+            }
+
             const array& value() const
             {
                 return *ptr_;
             }
         };
 
+        // typed_array_data
+        class typed_array_data final : public data_base
+        {
+        public:
+            class storage
+            {
+                typedef typename std::allocator_traits<Allocator>:: template rebind_alloc<int64_t> int64_allocator_type;
+                typedef typename std::allocator_traits<Allocator>:: template rebind_alloc<double> double_allocator_type;
+
+                structure_tag_type element_tag_;
+                std::vector<int64_t,int64_allocator_type> int64_values_;
+                std::vector<double,double_allocator_type> double_values_;
+            public:
+                storage(const int64_t* data, size_t length, const Allocator& a)
+                    : element_tag_(structure_tag_type::int64_tag), 
+                      int64_values_(data, data+length, int64_allocator_type(a)), 
+                      double_values_(double_allocator_type(a))
+                {
+                }
+
+                storage(const double* data, size_t length, const Allocator& a)
+                    : element_tag_(structure_tag_type::double_tag), 
+                      int64_values_(int64_allocator_type(a)), 
+                      double_values_(data, data+length, double_allocator_type(a))
+                {
+                }
+
+                storage(const storage& val, const Allocator& a)
+                    : element_tag_(val.element_tag_), 
+                      int64_values_(val.int64_values_, int64_allocator_type(a)), 
+                      double_values_(val.double_values_, double_allocator_type(a))
+                {
+                }
+
+                allocator_type get_allocator() const
+                {
+                    return allocator_type(int64_values_.get_allocator());
+                }
+
+                structure_tag_type element_tag() const
+                {
+                    return element_tag_;
+                }
+
+                size_t size() const
+                {
+                    return element_tag_ == structure_tag_type::double_tag ? double_values_.size() : int64_values_.size();
+                }
+
+                size_t capacity() const
+                {
+                    return element_tag_ == structure_tag_type::double_tag ? double_values_.capacity() : int64_values_.capacity();
+                }
+
+                void shrink_to_fit()
+                {
+                    int64_values_.shrink_to_fit();
+                    double_values_.shrink_to_fit();
+                }
+
+                const int64_t* int64_data() const
+                {
+                    return int64_values_.data();
+                }
+
+                const double* double_data() const
+                {
+                    return double_values_.data();
+                }
+
+                // Appends val if it has the element type
+                bool push_back(const variant& val)
+                {
+                    if (val.semantic_tag() != semantic_tag_type::none)
+                    {
+                        return false;
+                    }
+                    switch (val.structure_tag())
+                    {
+                        case structure_tag_type::double_tag:
+                            if (element_tag_ != structure_tag_type::double_tag)
+                            {
+                                return false;
+                            }
+                            double_values_.push_back(val.double_data_cast()->value());
+                            return true;
+                        case structure_tag_type::int64_tag:
+                            if (element_tag_ != structure_tag_type::int64_tag)
+                            {
+                                return false;
+                            }
+                            int64_values_.push_back(val.int64_data_cast()->value());
+                            return true;
+                        case structure_tag_type::uint64_tag:
+                            if (element_tag_ != structure_tag_type::int64_tag || 
+                                val.uint64_data_cast()->value() > static_cast<uint64_t>((std::numeric_limits<int64_t>::max)()))
+                            {
+                                return false;
+                            }
+                            int64_values_.push_back(static_cast<int64_t>(val.uint64_data_cast()->value()));
+                            return true;
+                        default:
+                            return false;
+                    }
+                }
+
+                array to_array() const
+                {
+                    array result(get_allocator());
+                    result.reserve(size());
+                    if (element_tag_ == structure_tag_type::double_tag)
+                    {
+                        for (double val : double_values_)
+                        {
+                            result.push_back(basic_json(val));
+                        }
+                    }
+                    else
+                    {
+                        for (int64_t val : int64_values_)
+                        {
+                            result.push_back(basic_json(val));
+                        }
+                    }
+                    return result;
+                }
+
+                // Elements are returned by value, a packed array has no basic_json elements to refer to
+                basic_json element(size_t i) const
+                {
+                    return element_tag_ == structure_tag_type::double_tag ? basic_json(double_values_[i]) : basic_json(int64_values_[i]);
+                }
+
+                bool equal_elements(const array& a) const
+                {
+                    if (size() != a.size())
+                    {
+                        return false;
+                    }
+                    for (size_t i = 0; i < a.size(); ++i)
+                    {
+                        if (!(element(i) == a[i]))
+                        {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                bool equal_elements(const storage& rhs) const
+                {
+                    if (size() != rhs.size())
+                    {
+                        return false;
+                    }
+                    for (size_t i = 0; i < size(); ++i)
+                    {
+                        if (!(element(i) == rhs.element(i)))
+                        {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                bool operator==(const storage& rhs) const
+                {
+                    return element_tag_ == rhs.element_tag_ && int64_values_ == rhs.int64_values_ && double_values_ == rhs.double_values_;
+                }
+            };
+        private:
+            typedef typename std::allocator_traits<Allocator>:: template rebind_alloc<storage> storage_allocator_type;
+            typedef typename std::allocator_traits<storage_allocator_type>::pointer pointer;
+            pointer ptr_;
+
+            template <typename... Args>
+            void create(storage_allocator_type alloc, Args&& ... args)
+            {
+                ptr_ = alloc.allocate(1);
+                try
+                {
+                    std::allocator_traits<storage_allocator_type>::construct(alloc, detail::to_plain_pointer(ptr_), std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    alloc.deallocate(ptr_,1);
+                    throw;
+                }
+            }
+        public:
+            template <class T>
+            typed_array_data(const T* data, size_t length, const Allocator& a)
+                : data_base(structure_tag_type::typed_array_tag, semantic_tag_type::none)
+            {
+                create(storage_allocator_type(a), data, length, a);
+            }
+
+            typed_array_data(const typed_array_data& val)
+                : data_base(val.type())
+            {
+                create(storage_allocator_type(val.get_allocator()), *(val.ptr_), val.get_allocator());
+            }
+
+            typed_array_data(typed_array_data&& val)
+                : data_base(val.type()), ptr_(nullptr)
+            {
+                std::swap(val.ptr_, ptr_);
+            }
+
+            typed_array_data(const typed_array_data& val, const Allocator& a)
+                : data_base(val.type())
+            {
+                create(storage_allocator_type(a), *(val.ptr_), a);
+            }
+
+            ~typed_array_data()
+            {
+                if (ptr_ != nullptr)
+                {
+                    storage_allocator_type alloc(ptr_->get_allocator());
+                    std::allocator_traits<storage_allocator_type>::destroy(alloc, detail::to_plain_pointer(ptr_));
+                    alloc.deallocate(ptr_,1);
+                }
+            }
+
+            allocator_type get_allocator() const
+            {
+                return ptr_->get_allocator();
+            }
+
+            storage& value()
+            {
+                return *ptr_;
+            }
+
+            const storage& value() const
+            {
+                return *ptr_;
+            }
+        };
+
         // object_data
         class object_data final : public data_base
         {
-            typedef typename std::allocator_traits<object_allocator>::pointer pointer;
+            typedef typename std::conditional<copy_on_write,detail::ref_counted<object>,object>::type holder_type;
+            typedef typename std::allocator_traits<Allocator>:: template rebind_alloc<holder_type> holder_allocator;
+            typedef typename std::allocator_traits<holder_allocator>::pointer pointer;
             pointer ptr_;
 
             template <typename... Args>
             void create(Allocator allocator, Args&& ... args)
             {
-                typename std::allocator_traits<object_allocator>:: template rebind_alloc<object> alloc(allocator);
+                holder_allocator alloc(allocator);
                 ptr_ = alloc.allocate(1);
                 try
                 {
-                    std::allocator_traits<object_allocator>:: template rebind_traits<object>::construct(alloc, detail::to_plain_pointer(ptr_), std::forward<Args>(args)...);
+                    std::allocator_traits<holder_allocator>::construct(alloc, detail::to_plain_pointer(ptr_), std::forward<Args>(args)...);
                 }
                 catch (...)
                 {
@@ -607,6 +1088,105 @@ public:
                     throw;
                 }
             }
+
+            static void destroy(pointer ptr)
+            {
+                holder_allocator alloc(ptr->get_allocator());
+                std::allocator_traits<holder_allocator>::destroy(alloc, detail::to_plain_pointer(ptr));
+                alloc.deallocate(ptr,1);
+            }
+
+            void share(const object_data& val, std::true_type)
+            {
+                if (val.ptr_->is_shareable())
+                {
+                    ptr_ = val.ptr_;
+                    ptr_->add_ref();
+                }
+                else
+                {
+                    copy(static_cast<const object&>(*(val.ptr_)), val.ptr_->get_allocator());
+                }
+            }
+
+            void share(const object_data& val, std::false_type)
+            {
+                copy(static_cast<const object&>(*(val.ptr_)), val.ptr_->get_allocator());
+            }
+
+            // Nested values are copied with an explicit stack, see copy_nested
+            void copy(const object& val, const Allocator& a)
+            {
+                create(object_allocator(a), a);
+                try
+                {
+                    copy_nested(val, *ptr_);
+                }
+                catch (...)
+                {
+                    destroy(ptr_);
+                    throw;
+                }
+            }
+
+            bool is_shared(std::true_type) const
+            {
+                return ptr_->is_shared();
+            }
+
+            bool is_shared(std::false_type) const
+            {
+                return false;
+            }
+
+            void mark_unshareable(std::true_type)
+            {
+                ptr_->mark_unshareable();
+            }
+
+            void mark_unshareable(std::false_type)
+            {
+            }
+
+            void release(std::true_type)
+            {
+                if (ptr_->release())
+                {
+                    destroy(ptr_);
+                }
+            }
+
+            void release(std::false_type)
+            {
+                destroy(ptr_);
+            }
+
+            // Clones a shared object before it is modified, the member 
+            // values themselves are shared with the original
+            void detach(std::true_type)
+            {
+                if (ptr_->is_shared())
+                {
+                    pointer p = ptr_;
+                    try
+                    {
+                        create(p->get_allocator(), static_cast<const object&>(*p));
+                    }
+                    catch (...)
+                    {
+                        ptr_ = p;
+                        throw;
+                    }
+                    if (p->release())
+                    {
+                        destroy(p);
+                    }
+                }
+            }
+
+            void detach(std::false_type)
+            {
+            }
         public:
             explicit object_data(const Allocator& a)
                 : data_base(structure_tag_type::object_tag, semantic_tag_type::none)
@@ -629,7 +1209,7 @@ public:
             explicit object_data(const object_data& val)
                 : data_base(val.type())
             {
-                create(val.ptr_->get_allocator(), *(val.ptr_));
+                share(val, std::integral_constant<bool,copy_on_write>());
             }
 
             explicit object_data(object_data&& val)
@@ -641,16 +1221,14 @@ public:
             explicit object_data(const object_data& val, const Allocator& a)
                 : data_base(val.type())
             {
-                create(object_allocator(a), *(val.ptr_), a);
+                copy(static_cast<const object&>(*(val.ptr_)), a);
             }
 
             ~object_data()
             {
                 if (ptr_ != nullptr)
                 {
-                    typename std::allocator_traits<Allocator>:: template rebind_alloc<object> alloc(ptr_->get_allocator());
-                    std::allocator_traits<Allocator>:: template rebind_traits<object>::destroy(alloc, detail::to_plain_pointer(ptr_));
-                    alloc.deallocate(ptr_,1);
+                    release(std::integral_constant<bool,copy_on_write>());
                 }
             }
 
@@ -661,9 +1239,31 @@ public:
 
             object& value()
             {
+                detach(std::integral_constant<bool,copy_on_write>());
+                return *ptr_;
+            }
+
+            // As value(), for access that lets a mutable reference or iterator 
+            // escape, the object is no longer shared by later copies
+            object& leak()
+            {
+                detach(std::integral_constant<bool,copy_on_write>());
+                mark_unshareable(std::integral_constant<bool,copy_on_write>());
                 return *ptr_;
             }
 
+            // Size of the allocation that holds the object
+            static size_t holder_size()
+            {
+                return sizeof(holder_type);
+            }
+
+            // Returns nullptr if the object has been moved from or is shared with other copies
+            object* unique_value()
+            {
+                return ptr_ != nullptr && !is_shared(std::integral_constant<bool,copy_on_write>()) ? detail::to_plain_pointer(ptr_) : nullptr;
+            }
+
             const object& value() const
             {
                 return *ptr_;
@@ -676,8 +1276,8 @@ public:
         };
 
     private:
-        static const size_t data_size = static_max<sizeof(uint64_data),sizeof(double_data),sizeof(short_string_data), sizeof(long_string_data), sizeof(array_data), sizeof(object_data)>::value;
-        static const size_t data_align = static_max<JSONCONS_ALIGNOF(uint64_data),JSONCONS_ALIGNOF(double_data),JSONCONS_ALIGNOF(short_string_data),JSONCONS_ALIGNOF(long_string_data),JSONCONS_ALIGNOF(array_data),JSONCONS_ALIGNOF(object_data)>::value;
+        static const size_t data_size = static_max<sizeof(uint64_data),sizeof(double_data),sizeof(short_string_data), sizeof(long_string_data), sizeof(array_data), sizeof(typed_array_data), sizeof(object_data)>::value;
+        static const size_t data_align = static_max<JSONCONS_ALIGNOF(uint64_data),JSONCONS_ALIGNOF(double_data),JSONCONS_ALIGNOF(short_string_data),JSONCONS_ALIGNOF(long_string_data),JSONCONS_ALIGNOF(array_data),JSONCONS_ALIGNOF(typed_array_data),JSONCONS_ALIGNOF(object_data)>::value;
 
         typedef typename std::aligned_storage<data_size,data_align>::type data_t;
 
@@ -867,31 +1467,315 @@ public:
         {
             new(reinterpret_cast<void*>(&data_))array_data(val,alloc);
         }
+        variant(const int64_t* data, size_t length, const Allocator& alloc)
+        {
+            new(reinterpret_cast<void*>(&data_))typed_array_data(data,length,alloc);
+        }
+        variant(const double* data, size_t length, const Allocator& alloc)
+        {
+            new(reinterpret_cast<void*>(&data_))typed_array_data(data,length,alloc);
+        }
+
+        ~variant()
+        {
+            Destroy_();
+        }
+
+        void Destroy_()
+        {
+            switch (structure_tag())
+            {
+                case structure_tag_type::long_string_tag:
+                    reinterpret_cast<long_string_data*>(&data_)->~long_string_data();
+                    break;
+                case structure_tag_type::byte_string_tag:
+                    reinterpret_cast<byte_string_data*>(&data_)->~byte_string_data();
+                    break;
+                case structure_tag_type::array_tag:
+                    destroy_nested(*this);
+                    reinterpret_cast<array_data*>(&data_)->~array_data();
+                    break;
+                case structure_tag_type::typed_array_tag:
+                    reinterpret_cast<typed_array_data*>(&data_)->~typed_array_data();
+                    break;
+                case structure_tag_type::object_tag:
+                    destroy_nested(*this);
+                    reinterpret_cast<object_data*>(&data_)->~object_data();
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // Nested arrays and objects are destroyed, copied and compared with an 
+        // explicit stack rather than by recursion, so that the depth of a document 
+        // is not limited by the size of the call stack
+
+        static bool is_container(const variant& val)
+        {
+            return val.structure_tag() == structure_tag_type::array_tag || 
+                   val.structure_tag() == structure_tag_type::object_tag;
+        }
+
+        static bool has_elements(const basic_json& val)
+        {
+            switch (val.var_.structure_tag())
+            {
+                case structure_tag_type::array_tag:
+                    return val.var_.array_data_cast()->value().size() != 0;
+                case structure_tag_type::object_tag:
+                    return val.var_.object_data_cast()->value().size() != 0;
+                default:
+                    return false;
+            }
+        }
+
+        // Moves the nested values of an array or object that is not shared to the stack
+        static void move_nested(variant& val, std::vector<basic_json>& stack)
+        {
+            switch (val.structure_tag())
+            {
+                case structure_tag_type::array_tag:
+                {
+                    array* p = val.array_data_cast()->unique_value();
+                    if (p != nullptr)
+                    {
+                        for (auto it = p->begin(); it != p->end(); ++it)
+                        {
+                            if (is_container(it->var_) && has_unique_elements(it->var_))
+                            {
+                                stack.emplace_back();
+                                stack.back().swap(*it);
+                            }
+                        }
+                    }
+                    break;
+                }
+                case structure_tag_type::object_tag:
+                {
+                    object* p = val.object_data_cast()->unique_value();
+                    if (p != nullptr)
+                    {
+                        for (auto it = p->begin(); it != p->end(); ++it)
+                        {
+                            if (is_container(it->value().var_) && has_unique_elements(it->value().var_))
+                            {
+                                stack.emplace_back();
+                                stack.back().swap(it->value());
+                            }
+                        }
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        static bool has_unique_elements(variant& val)
+        {
+            if (val.structure_tag() == structure_tag_type::array_tag)
+            {
+                array* p = val.array_data_cast()->unique_value();
+                return p != nullptr && p->size() != 0;
+            }
+            else
+            {
+                object* p = val.object_data_cast()->unique_value();
+                return p != nullptr && p->size() != 0;
+            }
+        }
+
+        // Called from the destructor, so must not throw. If the stack cannot grow, 
+        // the nested values not yet moved to it are destroyed by recursion.
+        static void destroy_nested(variant& val) JSONCONS_NOEXCEPT
+        {
+            try
+            {
+                std::vector<basic_json> stack;
+                move_nested(val, stack);
+                while (!stack.empty())
+                {
+                    basic_json current;
+                    current.swap(stack.back());
+                    stack.pop_back();
+                    move_nested(current.var_, stack);
+                }
+            }
+            catch (const std::bad_alloc&)
+            {
+            }
+        }
+
+        struct copy_frame
+        {
+            const basic_json* source;
+            basic_json* target;
+        };
+
+        static basic_json empty_like(const basic_json& val)
+        {
+            if (val.var_.structure_tag() == structure_tag_type::array_tag)
+            {
+                return basic_json(variant(array(val.var_.array_data_cast()->get_allocator())));
+            }
+            else
+            {
+                return basic_json(variant(object(val.var_.object_data_cast()->get_allocator())));
+            }
+        }
+
+        static void copy_elements(const array& source, array& target, std::vector<copy_frame>& stack)
+        {
+            target.reserve(source.size());
+            for (auto it = source.begin(); it != source.end(); ++it)
+            {
+                if (has_elements(*it))
+                {
+                    target.push_back(empty_like(*it));
+                    copy_frame frame = {std::addressof(*it), std::addressof(target[target.size()-1])};
+                    stack.push_back(frame);
+                }
+                else
+                {
+                    target.push_back(*it);
+                }
+            }
+        }
+
+        static void copy_members(const object& source, object& target, std::vector<copy_frame>& stack)
+        {
+            target.reserve(source.size());
+            for (auto it = source.begin(); it != source.end(); ++it)
+            {
+                if (has_elements(it->value()))
+                {
+                    basic_json& val = target.append(it->key(), empty_like(it->value()));
+                    copy_frame frame = {std::addressof(it->value()), std::addressof(val)};
+                    stack.push_back(frame);
+                }
+                else
+                {
+                    target.append(it->key(), it->value());
+                }
+            }
+        }
+
+        static void copy_nested(std::vector<copy_frame>& stack)
+        {
+            while (!stack.empty())
+            {
+                copy_frame frame = stack.back();
+                stack.pop_back();
+                if (frame.source->var_.structure_tag() == structure_tag_type::array_tag)
+                {
+                    copy_elements(frame.source->var_.array_data_cast()->value(), 
+                                  frame.target->var_.array_data_cast()->value(), stack);
+                }
+                else
+                {
+                    copy_members(frame.source->var_.object_data_cast()->value(), 
+                                 frame.target->var_.object_data_cast()->value(), stack);
+                }
+            }
+        }
+
+        static void copy_nested(const array& source, array& target)
+        {
+            std::vector<copy_frame> stack;
+            copy_elements(source, target, stack);
+            copy_nested(stack);
+        }
+
+        static void copy_nested(const object& source, object& target)
+        {
+            std::vector<copy_frame> stack;
+            copy_members(source, target, stack);
+            copy_nested(stack);
+        }
+
+        typedef std::pair<const variant*,const variant*> compare_frame;
+
+        // Compares the elements of two arrays or two objects, pushing pairs of nested 
+        // arrays and objects to the stack
+        static bool compare_elements(const variant& lhs, const variant& rhs, std::vector<compare_frame>& stack)
+        {
+            if (lhs.structure_tag() == structure_tag_type::array_tag && rhs.structure_tag() == structure_tag_type::array_tag)
+            {
+                const array& a = lhs.array_data_cast()->value();
+                const array& b = rhs.array_data_cast()->value();
+                if (std::addressof(a) == std::addressof(b))
+                {
+                    return true;
+                }
+                if (a.size() != b.size())
+                {
+                    return false;
+                }
+                for (size_t i = 0; i < a.size(); ++i)
+                {
+                    if (!compare_element(a[i].var_, b[i].var_, stack))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            else if (lhs.structure_tag() == structure_tag_type::object_tag && rhs.structure_tag() == structure_tag_type::object_tag)
+            {
+                const object& a = lhs.object_data_cast()->value();
+                const object& b = rhs.object_data_cast()->value();
+                if (std::addressof(a) == std::addressof(b))
+                {
+                    return true;
+                }
+                if (a.size() != b.size())
+                {
+                    return false;
+                }
+                for (auto it = a.begin(); it != a.end(); ++it)
+                {
+                    auto rhs_it = b.find(it->key());
+                    if (rhs_it == b.end() || !compare_element(it->value().var_, rhs_it->value().var_, stack))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            else
+            {
+                return lhs == rhs;
+            }
+        }
 
-        ~variant()
+        static bool compare_element(const variant& lhs, const variant& rhs, std::vector<compare_frame>& stack)
         {
-            Destroy_();
+            if (is_container(lhs) && is_container(rhs))
+            {
+                stack.emplace_back(std::addressof(lhs), std::addressof(rhs));
+                return true;
+            }
+            return lhs == rhs;
         }
 
-        void Destroy_()
+        bool equal_nested(const variant& rhs) const
         {
-            switch (structure_tag())
+            std::vector<compare_frame> stack;
+            if (!compare_elements(*this, rhs, stack))
             {
-                case structure_tag_type::long_string_tag:
-                    reinterpret_cast<long_string_data*>(&data_)->~long_string_data();
-                    break;
-                case structure_tag_type::byte_string_tag:
-                    reinterpret_cast<byte_string_data*>(&data_)->~byte_string_data();
-                    break;
-                case structure_tag_type::array_tag:
-                    reinterpret_cast<array_data*>(&data_)->~array_data();
-                    break;
-                case structure_tag_type::object_tag:
-                    reinterpret_cast<object_data*>(&data_)->~object_data();
-                    break;
-                default:
-                    break;
+                return false;
+            }
+            while (!stack.empty())
+            {
+                compare_frame frame = stack.back();
+                stack.pop_back();
+                if (!compare_elements(*frame.first, *frame.second, stack))
+                {
+                    return false;
+                }
             }
+            return true;
         }
 
         variant& operator=(const variant& val)
@@ -931,6 +1815,9 @@ public:
                 case structure_tag_type::array_tag:
                     new(reinterpret_cast<void*>(&data_))array_data(*(val.array_data_cast()));
                     break;
+                case structure_tag_type::typed_array_tag:
+                    new(reinterpret_cast<void*>(&data_))typed_array_data(*(val.typed_array_data_cast()));
+                    break;
                 case structure_tag_type::object_tag:
                     new(reinterpret_cast<void*>(&data_))object_data(*(val.object_data_cast()));
                     break;
@@ -1036,12 +1923,24 @@ public:
             return reinterpret_cast<const array_data*>(&data_);
         }
 
+        typed_array_data* typed_array_data_cast()
+        {
+            return reinterpret_cast<typed_array_data*>(&data_);
+        }
+
+        const typed_array_data* typed_array_data_cast() const
+        {
+            return reinterpret_cast<const typed_array_data*>(&data_);
+        }
+
         size_t size() const
         {
             switch (structure_tag())
             {
             case structure_tag_type::array_tag:
                 return array_data_cast()->value().size();
+            case structure_tag_type::typed_array_tag:
+                return typed_array_data_cast()->value().size();
             case structure_tag_type::object_tag:
                 return object_data_cast()->value().size();
             default:
@@ -1223,7 +2122,24 @@ public:
                 switch (rhs.structure_tag())
                 {
                 case structure_tag_type::array_tag:
-                    return array_data_cast()->value() == rhs.array_data_cast()->value();
+                    return equal_nested(rhs);
+                case structure_tag_type::typed_array_tag:
+                    return rhs.typed_array_data_cast()->value().equal_elements(array_data_cast()->value());
+                default:
+                    return false;
+                }
+                break;
+            case structure_tag_type::typed_array_tag:
+                switch (rhs.structure_tag())
+                {
+                case structure_tag_type::array_tag:
+                    return typed_array_data_cast()->value().equal_elements(rhs.array_data_cast()->value());
+                case structure_tag_type::typed_array_tag:
+                    if (typed_array_data_cast()->value().element_tag() == rhs.typed_array_data_cast()->value().element_tag())
+                    {
+                        return typed_array_data_cast()->value() == rhs.typed_array_data_cast()->value();
+                    }
+                    return typed_array_data_cast()->value().equal_elements(rhs.typed_array_data_cast()->value());
                 default:
                     return false;
                 }
@@ -1234,7 +2150,7 @@ public:
                 case structure_tag_type::empty_object_tag:
                     return size() == 0;
                 case structure_tag_type::object_tag:
-                    return object_data_cast()->value() == rhs.object_data_cast()->value();
+                    return equal_nested(rhs);
                 default:
                     return false;
                 }
@@ -1304,6 +2220,9 @@ public:
             case structure_tag_type::array_tag:
                 new(reinterpret_cast<void*>(&(other.data_)))array_data(std::move(*array_data_cast()));
                 break;
+            case structure_tag_type::typed_array_tag:
+                new(reinterpret_cast<void*>(&(other.data_)))typed_array_data(std::move(*typed_array_data_cast()));
+                break;
             case structure_tag_type::object_tag:
                 new(reinterpret_cast<void*>(&(other.data_)))object_data(std::move(*object_data_cast()));
                 break;
@@ -1322,6 +2241,9 @@ public:
             case structure_tag_type::array_tag:
                 new(reinterpret_cast<void*>(&(data_)))array_data(std::move(*temp.array_data_cast()));
                 break;
+            case structure_tag_type::typed_array_tag:
+                new(reinterpret_cast<void*>(&(data_)))typed_array_data(std::move(*temp.typed_array_data_cast()));
+                break;
             case structure_tag_type::object_tag:
                 new(reinterpret_cast<void*>(&(data_)))object_data(std::move(*temp.object_data_cast()));
                 break;
@@ -1369,6 +2291,9 @@ public:
             case structure_tag_type::array_tag:
                 new(reinterpret_cast<void*>(&data_))array_data(*(val.array_data_cast()));
                 break;
+            case structure_tag_type::typed_array_tag:
+                new(reinterpret_cast<void*>(&data_))typed_array_data(*(val.typed_array_data_cast()));
+                break;
             default:
                 break;
             }
@@ -1396,6 +2321,9 @@ public:
             case structure_tag_type::array_tag:
                 new(reinterpret_cast<void*>(&data_))array_data(*(val.array_data_cast()),a);
                 break;
+            case structure_tag_type::typed_array_tag:
+                new(reinterpret_cast<void*>(&data_))typed_array_data(*(val.typed_array_data_cast()),a);
+                break;
             case structure_tag_type::object_tag:
                 new(reinterpret_cast<void*>(&data_))object_data(*(val.object_data_cast()),a);
                 break;
@@ -1435,6 +2363,12 @@ public:
                     new(reinterpret_cast<void*>(&val.data_))null_data();
                 }
                 break;
+            case structure_tag_type::typed_array_tag:
+                {
+                    new(reinterpret_cast<void*>(&data_))typed_array_data(std::move(*val.typed_array_data_cast()));
+                    new(reinterpret_cast<void*>(&val.data_))null_data();
+                }
+                break;
             case structure_tag_type::object_tag:
                 {
                     new(reinterpret_cast<void*>(&data_))object_data(std::move(*val.object_data_cast()));
@@ -1513,6 +2447,18 @@ public:
                     }
                 }
                 break;
+            case structure_tag_type::typed_array_tag:
+                {
+                    if (a == val.typed_array_data_cast()->get_allocator())
+                    {
+                        Init_rv_(std::forward<variant>(val), a, std::true_type());
+                    }
+                    else
+                    {
+                        Init_(val,a);
+                    }
+                }
+                break;
             default:
                 break;
             }
@@ -1641,6 +2587,11 @@ public:
             return evaluate().capacity();
         }
 
+        json_memory_usage memory_usage() const
+        {
+            return evaluate().memory_usage();
+        }
+
         void reserve(size_t n)
         {
             evaluate().reserve(n);
@@ -1707,6 +2658,25 @@ public:
             return evaluate().is_array();
         }
 
+        bool is_typed_array() const JSONCONS_NOEXCEPT
+        {
+            return evaluate().is_typed_array();
+        }
+
+        template <class T>
+        typename std::enable_if<std::is_same<T,int64_t>::value || std::is_same<T,double>::value,bool>::type
+        is_typed_array() const JSONCONS_NOEXCEPT
+        {
+            return evaluate().template is_typed_array<T>();
+        }
+
+        template <class T>
+        typename std::enable_if<std::is_same<T,int64_t>::value || std::is_same<T,double>::value,range<const T*>>::type
+        typed_array_range() const
+        {
+            return evaluate().template typed_array_range<T>();
+        }
+
         bool is_int64() const JSONCONS_NOEXCEPT
         {
             return evaluate().is_int64();
@@ -2470,6 +3440,16 @@ public:
         return decoder.get_result();
     }
 
+    static basic_json make_typed_array(const int64_t* data, size_t length, const Allocator& allocator = Allocator())
+    {
+        return basic_json(variant(data, length, allocator));
+    }
+
+    static basic_json make_typed_array(const double* data, size_t length, const Allocator& allocator = Allocator())
+    {
+        return basic_json(variant(data, length, allocator));
+    }
+
     static basic_json make_array()
     {
         return basic_json(variant(array()));
@@ -2765,6 +3745,8 @@ public:
             return object_value().size();
         case structure_tag_type::array_tag:
             return array_value().size();
+        case structure_tag_type::typed_array_tag:
+            return var_.typed_array_data_cast()->value().size();
         default:
             return 0;
         }
@@ -2838,61 +3820,39 @@ public:
 
     void dump(basic_json_content_handler<char_type>& handler) const
     {
-        switch (var_.structure_tag())
+        // Nested arrays and objects are written with an explicit stack rather than by recursion
+        std::vector<dump_frame> stack;
+        dump_value(*this, handler, stack);
+        while (!stack.empty())
         {
-            case structure_tag_type::short_string_tag:
-            case structure_tag_type::long_string_tag:
-                handler.string_value(as_string_view(), var_.semantic_tag());
-                break;
-            case structure_tag_type::byte_string_tag:
-                handler.byte_string_value(var_.byte_string_data_cast()->data(), var_.byte_string_data_cast()->length(), var_.semantic_tag());
-                break;
-            case structure_tag_type::double_tag:
-                handler.double_value(var_.double_data_cast()->value(), 
-                                     var_.double_data_cast()->options(), 
-                                     var_.semantic_tag());
-                break;
-            case structure_tag_type::int64_tag:
-                handler.int64_value(var_.int64_data_cast()->value(), var_.semantic_tag());
-                break;
-            case structure_tag_type::uint64_tag:
-                handler.uint64_value(var_.uint64_data_cast()->value(), var_.semantic_tag());
-                break;
-            case structure_tag_type::bool_tag:
-                handler.bool_value(var_.bool_data_cast()->value());
-                break;
-            case structure_tag_type::null_tag:
-                handler.null_value();
-                break;
-            case structure_tag_type::empty_object_tag:
-                handler.begin_object(0);
-                handler.end_object();
-                break;
-            case structure_tag_type::object_tag:
+            dump_frame& frame = stack.back();
+            if (frame.is_object)
+            {
+                if (frame.object_it == frame.object_end)
                 {
-                    handler.begin_object(size());
-                    const object& o = object_value();
-                    for (const_object_iterator it = o.begin(); it != o.end(); ++it)
-                    {
-                        handler.name(string_view_type((it->key()).data(),it->key().length()));
-                        it->value().dump(handler);
-                    }
                     handler.end_object();
+                    stack.pop_back();
                 }
-                break;
-            case structure_tag_type::array_tag:
+                else
+                {
+                    const_object_iterator it = frame.object_it++;
+                    handler.name(string_view_type((it->key()).data(),it->key().length()));
+                    dump_value(it->value(), handler, stack);
+                }
+            }
+            else
+            {
+                if (frame.array_it == frame.array_end)
                 {
-                    handler.begin_array(size());
-                    const array& o = array_value();
-                    for (const_array_iterator it = o.begin(); it != o.end(); ++it)
-                    {
-                        it->dump(handler);
-                    }
                     handler.end_array();
+                    stack.pop_back();
                 }
-                break;
-            default:
-                break;
+                else
+                {
+                    const_array_iterator it = frame.array_it++;
+                    dump_value(*it, handler, stack);
+                }
+            }
         }
         handler.flush();
     }
@@ -3106,7 +4066,21 @@ public:
 
     bool is_array() const JSONCONS_NOEXCEPT
     {
-        return var_.structure_tag() == structure_tag_type::array_tag;
+        return var_.structure_tag() == structure_tag_type::array_tag || var_.structure_tag() == structure_tag_type::typed_array_tag;
+    }
+
+    bool is_typed_array() const JSONCONS_NOEXCEPT
+    {
+        return var_.structure_tag() == structure_tag_type::typed_array_tag;
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_same<T,int64_t>::value || std::is_same<T,double>::value,bool>::type
+    is_typed_array() const JSONCONS_NOEXCEPT
+    {
+        const structure_tag_type element_tag = std::is_same<T,double>::value ? structure_tag_type::double_tag : structure_tag_type::int64_tag;
+        return var_.structure_tag() == structure_tag_type::typed_array_tag && 
+               var_.typed_array_data_cast()->value().element_tag() == element_tag;
     }
 
     bool is_int64() const JSONCONS_NOEXCEPT
@@ -3139,6 +4113,8 @@ public:
             return var_.string_data_cast()->length() == 0;
         case structure_tag_type::array_tag:
             return array_value().size() == 0;
+        case structure_tag_type::typed_array_tag:
+            return var_.typed_array_data_cast()->value().size() == 0;
         case structure_tag_type::empty_object_tag:
             return true;
         case structure_tag_type::object_tag:
@@ -3154,6 +4130,8 @@ public:
         {
         case structure_tag_type::array_tag:
             return array_value().capacity();
+        case structure_tag_type::typed_array_tag:
+            return var_.typed_array_data_cast()->value().capacity();
         case structure_tag_type::object_tag:
             return object_value().capacity();
         default:
@@ -3161,6 +4139,24 @@ public:
         }
     }
 
+    // Reports the bytes requested from the allocator for this value and 
+    // everything it holds. Storage shared between copies is counted in full.
+    json_memory_usage memory_usage() const
+    {
+        json_memory_usage usage;
+        usage.nodes += sizeof(basic_json);
+
+        std::vector<const basic_json*> stack;
+        stack.push_back(this);
+        while (!stack.empty())
+        {
+            const basic_json* val = stack.back();
+            stack.pop_back();
+            add_memory_usage(*val, usage, stack);
+        }
+        return usage;
+    }
+
     template<class U=Allocator>
     void create_object_implicitly()
     {
@@ -3172,6 +4168,7 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
             array_value().reserve(n);
             break;
@@ -3195,6 +4192,7 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
             array_value().resize(n);
             break;
@@ -3208,6 +4206,7 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
             array_value().resize(n, val);
             break;
@@ -3476,7 +4475,7 @@ public:
             JSONCONS_THROW(key_not_found(name.data(),name.length()));
         case structure_tag_type::object_tag:
             {
-                auto it = object_value().find(name);
+                auto it = leaked_object_value().find(name);
                 if (it == object_range().end())
                 {
                     JSONCONS_THROW(key_not_found(name.data(),name.length()));
@@ -3542,14 +4541,15 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
-            if (i >= array_value().size())
+            if (i >= leaked_array_value().size())
             {
                 JSONCONS_THROW(json_exception_impl<std::out_of_range>("Invalid array subscript"));
             }
-            return array_value().operator[](i);
+            return leaked_array_value().operator[](i);
         case structure_tag_type::object_tag:
-            return object_value().at(i);
+            return leaked_object_value().at(i);
         default:
             JSONCONS_THROW(json_exception_impl<std::runtime_error>("Index on non-array value not supported"));
         }
@@ -3559,6 +4559,7 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
             if (i >= array_value().size())
             {
@@ -3579,7 +4580,7 @@ public:
         case structure_tag_type::empty_object_tag:
             return object_range().end();
         case structure_tag_type::object_tag:
-            return object_value().find(name);
+            return leaked_object_value().find(name);
         default:
             {
                 JSONCONS_THROW(not_an_object(name.data(),name.length()));
@@ -3667,6 +4668,9 @@ public:
         case structure_tag_type::array_tag:
             array_value().shrink_to_fit();
             break;
+        case structure_tag_type::typed_array_tag:
+            var_.typed_array_data_cast()->value().shrink_to_fit();
+            break;
         case structure_tag_type::object_tag:
             object_value().shrink_to_fit();
             break;
@@ -3679,6 +4683,7 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
             array_value().clear();
             break;
@@ -3724,6 +4729,7 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
             array_value().erase(pos);
             break;
@@ -3737,6 +4743,7 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
             array_value().erase(first, last);
             break;
@@ -3772,7 +4779,7 @@ public:
             create_object_implicitly();
             JSONCONS_FALLTHROUGH;
         case structure_tag_type::object_tag:
-            return object_value().insert_or_assign(name, std::forward<T>(val));
+            return leaked_object_value().insert_or_assign(name, std::forward<T>(val));
         default:
             {
                 JSONCONS_THROW(not_an_object(name.data(),name.length()));
@@ -3789,7 +4796,7 @@ public:
             create_object_implicitly();
             JSONCONS_FALLTHROUGH;
         case structure_tag_type::object_tag:
-            return object_value().try_emplace(name, std::forward<Args>(args)...);
+            return leaked_object_value().try_emplace(name, std::forward<Args>(args)...);
         default:
             {
                 JSONCONS_THROW(not_an_object(name.data(),name.length()));
@@ -3938,7 +4945,7 @@ public:
             create_object_implicitly();
             JSONCONS_FALLTHROUGH;
         case structure_tag_type::object_tag:
-            return object_value().insert_or_assign(hint, name, std::forward<T>(val));
+            return leaked_object_value().insert_or_assign(hint, name, std::forward<T>(val));
         default:
             {
                 JSONCONS_THROW(not_an_object(name.data(),name.length()));
@@ -3955,7 +4962,7 @@ public:
             create_object_implicitly();
             JSONCONS_FALLTHROUGH;
         case structure_tag_type::object_tag:
-            return object_value().try_emplace(hint, name, std::forward<Args>(args)...);
+            return leaked_object_value().try_emplace(hint, name, std::forward<Args>(args)...);
         default:
             {
                 JSONCONS_THROW(not_an_object(name.data(),name.length()));
@@ -3968,8 +4975,9 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
-            return array_value().insert(pos, std::forward<T>(val));
+            return leaked_array_value().insert(pos, std::forward<T>(val));
             break;
         default:
             {
@@ -3983,8 +4991,9 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
-            return array_value().insert(pos, first, last);
+            return leaked_array_value().insert(pos, first, last);
             break;
         default:
             {
@@ -3998,8 +5007,9 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
-            return array_value().emplace(pos, std::forward<Args>(args)...);
+            return leaked_array_value().emplace(pos, std::forward<Args>(args)...);
             break;
         default:
             {
@@ -4013,8 +5023,9 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
-            return array_value().emplace_back(std::forward<Args>(args)...);
+            return leaked_array_value().emplace_back(std::forward<Args>(args)...);
         default:
             {
                 JSONCONS_THROW(json_exception_impl<std::runtime_error>("Attempting to insert into a value that is not an array"));
@@ -4050,6 +5061,15 @@ public:
         case structure_tag_type::array_tag:
             array_value().push_back(std::forward<T>(val));
             break;
+        case structure_tag_type::typed_array_tag:
+            {
+                basic_json v(std::forward<T>(val));
+                if (!var_.typed_array_data_cast()->value().push_back(v.var_))
+                {
+                    array_value().push_back(std::move(v));
+                }
+            }
+            break;
         default:
             {
                 JSONCONS_THROW(json_exception_impl<std::runtime_error>("Attempting to insert into a value that is not an array"));
@@ -4323,6 +5343,7 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
             array_value().remove_range(from_index, to_index);
             break;
@@ -4415,7 +5436,7 @@ public:
         case structure_tag_type::empty_object_tag:
             return range<object_iterator>(empty_object.object_range().begin(), empty_object.object_range().end());
         case structure_tag_type::object_tag:
-            return range<object_iterator>(object_value().begin(),object_value().end());
+            return range<object_iterator>(leaked_object_value().begin(),leaked_object_value().end());
         default:
             JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not an object"));
         }
@@ -4439,8 +5460,9 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
-            return range<array_iterator>(array_value().begin(),array_value().end());
+            return range<array_iterator>(leaked_array_value().begin(),leaked_array_value().end());
         default:
             JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not an array"));
         }
@@ -4450,6 +5472,7 @@ public:
     {
         switch (var_.structure_tag())
         {
+        case structure_tag_type::typed_array_tag:
         case structure_tag_type::array_tag:
             return range<const_array_iterator>(array_value().begin(),array_value().end());
         default:
@@ -4457,24 +5480,57 @@ public:
         }
     }
 
+    template <class T>
+    typename std::enable_if<std::is_same<T,int64_t>::value || std::is_same<T,double>::value,range<const T*>>::type
+    typed_array_range() const
+    {
+        const structure_tag_type element_tag = std::is_same<T,double>::value ? structure_tag_type::double_tag : structure_tag_type::int64_tag;
+        if (!is_typed_array<T>())
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a typed array of the requested element type"));
+        }
+        const auto& storage = var_.typed_array_data_cast()->value();
+        const T* p = reinterpret_cast<const T*>(element_tag == structure_tag_type::double_tag ? 
+                                                static_cast<const void*>(storage.double_data()) : 
+                                                static_cast<const void*>(storage.int64_data()));
+        return range<const T*>(p, p + storage.size());
+    }
+
     array& array_value() 
     {
         switch (var_.structure_tag())
         {
         case structure_tag_type::array_tag:
             return var_.array_data_cast()->value();
+        case structure_tag_type::typed_array_tag:
+            {
+                // Element references may be modified, so unpack into a regular array
+                const auto& storage = var_.typed_array_data_cast()->value();
+                variant temp(storage.to_array(), storage.get_allocator());
+                var_.swap(temp);
+                return var_.array_data_cast()->value();
+            }
         default:
             JSONCONS_THROW(json_exception_impl<std::runtime_error>("Bad array cast"));
             break;
         }
     }
 
+    // As array_value(), for access that returns references or iterators to the elements
+    array& leaked_array_value()
+    {
+        array_value();
+        return var_.array_data_cast()->leak();
+    }
+
     const array& array_value() const
     {
         switch (var_.structure_tag())
         {
         case structure_tag_type::array_tag:
             return var_.array_data_cast()->value();
+        case structure_tag_type::typed_array_tag:
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Packed typed array has no element references, use typed_array_range or non-const access"));
         default:
             JSONCONS_THROW(json_exception_impl<std::runtime_error>("Bad array cast"));
             break;
@@ -4496,6 +5552,13 @@ public:
         }
     }
 
+    // As object_value(), for access that returns references or iterators to the members
+    object& leaked_object_value()
+    {
+        object_value();
+        return var_.object_data_cast()->leak();
+    }
+
     const object& object_value() const
     {
         switch (var_.structure_tag())
@@ -4513,6 +5576,173 @@ public:
 
 private:
 
+    // Keys are built from their exact length, so a key longer than the capacity of 
+    // an empty key is taken to occupy length plus terminator on the heap
+    static size_t key_heap_size(const string_view_type& key)
+    {
+        static const size_t short_key_capacity = key_storage_type().capacity();
+        return key.length() > short_key_capacity ? (key.length() + 1)*sizeof(char_type) : 0;
+    }
+
+    static void add_memory_usage(const basic_json& val, 
+                                 json_memory_usage& usage, 
+                                 std::vector<const basic_json*>& stack)
+    {
+        const variant& var = val.var_;
+        switch (var.structure_tag())
+        {
+            case structure_tag_type::long_string_tag:
+            {
+                size_t n = detail::heap_only_string_factory<char_type,Allocator>::aligned_size(var.string_data_cast()->length()*sizeof(char_type));
+                if (var.semantic_tag() == semantic_tag_type::bignum)
+                {
+                    usage.bignums += n;
+                }
+                else
+                {
+                    usage.strings += n;
+                }
+                break;
+            }
+            case structure_tag_type::byte_string_tag:
+                usage.byte_strings += sizeof(byte_string_storage_type) + var.byte_string_data_cast()->capacity();
+                break;
+            case structure_tag_type::typed_array_tag:
+            {
+                const auto& o = var.typed_array_data_cast()->value();
+                size_t element_size = o.element_tag() == structure_tag_type::double_tag ? sizeof(double) : sizeof(int64_t);
+                usage.containers += sizeof(o) + o.capacity()*element_size;
+                usage.slack += (o.capacity() - o.size())*element_size;
+                break;
+            }
+            case structure_tag_type::array_tag:
+            {
+                const array& a = var.array_data_cast()->value();
+                size_t slack = (a.capacity() - a.size())*sizeof(basic_json);
+                usage.nodes += a.size()*sizeof(basic_json);
+                usage.containers += variant::array_data::holder_size() + slack;
+                usage.slack += slack;
+                for (auto it = a.begin(); it != a.end(); ++it)
+                {
+                    stack.push_back(std::addressof(*it));
+                }
+                break;
+            }
+            case structure_tag_type::object_tag:
+            {
+                const object& o = var.object_data_cast()->value();
+                size_t slack = (o.capacity() - o.size())*sizeof(key_value_pair_type);
+                usage.nodes += o.size()*sizeof(basic_json);
+                usage.containers += variant::object_data::holder_size() + 
+                                    o.size()*(sizeof(key_value_pair_type) - sizeof(basic_json)) + slack;
+                usage.slack += slack;
+                for (auto it = o.begin(); it != o.end(); ++it)
+                {
+                    usage.keys += key_heap_size(it->key());
+                    stack.push_back(std::addressof(it->value()));
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    struct dump_frame
+    {
+        bool is_object;
+        const_array_iterator array_it;
+        const_array_iterator array_end;
+        const_object_iterator object_it;
+        const_object_iterator object_end;
+
+        dump_frame(const array& a)
+            : is_object(false), array_it(a.begin()), array_end(a.end())
+        {
+        }
+
+        dump_frame(const object& o)
+            : is_object(true), object_it(o.begin()), object_end(o.end())
+        {
+        }
+    };
+
+    // Writes a scalar value, or begins an array or object and pushes it to the stack
+    static void dump_value(const basic_json& val, 
+                           basic_json_content_handler<char_type>& handler, 
+                           std::vector<dump_frame>& stack)
+    {
+        const variant& var = val.var_;
+        switch (var.structure_tag())
+        {
+            case structure_tag_type::short_string_tag:
+            case structure_tag_type::long_string_tag:
+                handler.string_value(val.as_string_view(), var.semantic_tag());
+                break;
+            case structure_tag_type::byte_string_tag:
+                handler.byte_string_value(var.byte_string_data_cast()->data(), var.byte_string_data_cast()->length(), var.semantic_tag());
+                break;
+            case structure_tag_type::double_tag:
+                handler.double_value(var.double_data_cast()->value(), 
+                                     var.double_data_cast()->options(), 
+                                     var.semantic_tag());
+                break;
+            case structure_tag_type::int64_tag:
+                handler.int64_value(var.int64_data_cast()->value(), var.semantic_tag());
+                break;
+            case structure_tag_type::uint64_tag:
+                handler.uint64_value(var.uint64_data_cast()->value(), var.semantic_tag());
+                break;
+            case structure_tag_type::bool_tag:
+                handler.bool_value(var.bool_data_cast()->value());
+                break;
+            case structure_tag_type::null_tag:
+                handler.null_value();
+                break;
+            case structure_tag_type::empty_object_tag:
+                handler.begin_object(0);
+                handler.end_object();
+                break;
+            case structure_tag_type::object_tag:
+                {
+                    const object& o = var.object_data_cast()->value();
+                    handler.begin_object(o.size());
+                    stack.emplace_back(o);
+                }
+                break;
+            case structure_tag_type::typed_array_tag:
+                {
+                    const auto& o = var.typed_array_data_cast()->value();
+                    handler.begin_array(o.size());
+                    if (o.element_tag() == structure_tag_type::double_tag)
+                    {
+                        for (const double* p = o.double_data(); p != o.double_data() + o.size(); ++p)
+                        {
+                            handler.double_value(*p);
+                        }
+                    }
+                    else
+                    {
+                        for (const int64_t* p = o.int64_data(); p != o.int64_data() + o.size(); ++p)
+                        {
+                            handler.int64_value(*p);
+                        }
+                    }
+                    handler.end_array();
+                }
+                break;
+            case structure_tag_type::array_tag:
+                {
+                    const array& o = var.array_data_cast()->value();
+                    handler.begin_array(o.size());
+                    stack.emplace_back(o);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
     friend std::basic_ostream<char_type>& operator<<(std::basic_ostream<char_type>& os, const basic_json& o)
     {
         o.dump(os);
@@ -4601,5 +5831,6 @@ jsoncons::wojson operator "" _ojson(const wchar_t* s, std::size_t n)
 }
 
 #include <jsoncons/json_convert_traits.hpp>
+#include <jsoncons/json_type_traits_macros.hpp>
 
 #endif
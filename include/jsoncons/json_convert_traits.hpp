@@ -18,9 +18,216 @@
 #include <jsoncons/json_serializer.hpp>
 #include <jsoncons/jsoncons_utilities.hpp>
 #include <jsoncons/json_type_traits.hpp>
+#include <jsoncons/json_decoder.hpp>
+#include <jsoncons/stream_reader.hpp>
+#include <jsoncons/json_stream_reader.hpp>
 
 namespace jsoncons {
 
+namespace detail {
+
+// skip_stream_value
+
+// Advances the reader past the value starting at the current event
+
+template <class CharT>
+void skip_stream_value(basic_stream_reader<CharT>& reader)
+{
+    size_t depth = 0;
+    do
+    {
+        switch (reader.current().event_type())
+        {
+            case stream_event_type::begin_array:
+            case stream_event_type::begin_object:
+                ++depth;
+                break;
+            case stream_event_type::end_array:
+            case stream_event_type::end_object:
+                --depth;
+                break;
+            default:
+                break;
+        }
+        reader.next();
+    } while (depth > 0 && !reader.done());
+}
+
+// replay_stream_value
+
+// Sends the events of the value starting at the current event to a content
+// handler, and advances the reader past it
+
+template <class CharT>
+void replay_stream_value(basic_stream_reader<CharT>& reader, basic_json_content_handler<CharT>& handler)
+{
+    typedef basic_string_view<CharT> string_view_type;
+
+    size_t depth = 0;
+    do
+    {
+        const basic_stream_event<CharT>& event = reader.current();
+        switch (event.event_type())
+        {
+            case stream_event_type::begin_array:
+                handler.begin_array(reader.context());
+                ++depth;
+                break;
+            case stream_event_type::end_array:
+                handler.end_array(reader.context());
+                --depth;
+                break;
+            case stream_event_type::begin_object:
+                handler.begin_object(reader.context());
+                ++depth;
+                break;
+            case stream_event_type::end_object:
+                handler.end_object(reader.context());
+                --depth;
+                break;
+            case stream_event_type::name:
+                handler.name(event.template as<string_view_type>(), reader.context());
+                break;
+            case stream_event_type::string_value:
+                handler.string_value(event.template as<string_view_type>(), event.semantic_tag(), reader.context());
+                break;
+            case stream_event_type::byte_string_value:
+            {
+                byte_string v = event.template as<byte_string>();
+                handler.byte_string_value(v.data(), v.length(), event.semantic_tag(), reader.context());
+                break;
+            }
+            case stream_event_type::null_value:
+                handler.null_value(reader.context());
+                break;
+            case stream_event_type::bool_value:
+                handler.bool_value(event.template as<bool>(), reader.context());
+                break;
+            case stream_event_type::int64_value:
+                handler.int64_value(event.template as<int64_t>(), event.semantic_tag(), reader.context());
+                break;
+            case stream_event_type::uint64_value:
+                handler.uint64_value(event.template as<uint64_t>(), event.semantic_tag(), reader.context());
+                break;
+            case stream_event_type::double_value:
+                handler.double_value(event.template as<double>(), event.semantic_tag(), reader.context());
+                break;
+            default:
+                JSONCONS_THROW(json_exception_impl<std::runtime_error>("Unsupported stream event"));
+        }
+        reader.next();
+    } while (depth > 0 && !reader.done());
+}
+
+// stream_decode_traits
+
+// Decodes a value of type T from the events of a stream reader, leaving the 
+// reader positioned after the value. Types without a specialization are 
+// decoded through a basic_json built from the value's events only.
+
+template <class T, class Enable = void>
+struct stream_decode_traits
+{
+    template <class CharT>
+    static T decode(basic_stream_reader<CharT>& reader)
+    {
+        json_decoder<basic_json<CharT>> decoder;
+        replay_stream_value(reader, decoder);
+        return decoder.get_result().template as<T>();
+    }
+};
+
+template <class T>
+struct stream_decode_traits<T,
+    typename std::enable_if<is_integer_like<T>::value || 
+                            is_uinteger_like<T>::value ||
+                            is_floating_point_like<T>::value ||
+                            std::is_same<T,bool>::value
+>::type>
+{
+    template <class CharT>
+    static T decode(basic_stream_reader<CharT>& reader)
+    {
+        T val = reader.current().template as<T>();
+        reader.next();
+        return val;
+    }
+};
+
+template <class T>
+struct stream_decode_traits<T,
+    typename std::enable_if<is_string_like<T>::value
+>::type>
+{
+    template <class CharT>
+    static T decode(basic_stream_reader<CharT>& reader)
+    {
+        if (reader.current().event_type() != stream_event_type::string_value)
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a string"));
+        }
+        T val = reader.current().template as<T>();
+        reader.next();
+        return val;
+    }
+};
+
+template <class T>
+struct stream_decode_traits<T,
+    typename std::enable_if<is_vector_like<T>::value
+>::type>
+{
+    typedef typename std::iterator_traits<typename T::iterator>::value_type value_type;
+
+    template <class CharT>
+    static T decode(basic_stream_reader<CharT>& reader)
+    {
+        if (reader.current().event_type() != stream_event_type::begin_array)
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not an array"));
+        }
+        T val;
+        reader.next();
+        while (!reader.done() && reader.current().event_type() != stream_event_type::end_array)
+        {
+            val.insert(val.end(), stream_decode_traits<value_type>::decode(reader));
+        }
+        reader.next();
+        return val;
+    }
+};
+
+template <class T>
+struct stream_decode_traits<T,
+    typename std::enable_if<is_map_like<T>::value && 
+                            is_string_like<typename T::key_type>::value
+>::type>
+{
+    typedef typename T::key_type key_type;
+    typedef typename T::mapped_type mapped_type;
+
+    template <class CharT>
+    static T decode(basic_stream_reader<CharT>& reader)
+    {
+        if (reader.current().event_type() != stream_event_type::begin_object)
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not an object"));
+        }
+        T val;
+        reader.next();
+        while (!reader.done() && reader.current().event_type() != stream_event_type::end_object)
+        {
+            key_type key = reader.current().template as<key_type>();
+            reader.next();
+            val.emplace(std::move(key), stream_decode_traits<mapped_type>::decode(reader));
+        }
+        reader.next();
+        return val;
+    }
+};
+
+}
+
 // json_convert_traits
 
 template <class T, class Enable = void>
@@ -44,6 +251,81 @@ struct json_convert_traits
 
 // json_convert_traits specializations
 
+// integer, floating point and bool
+
+template <class T>
+struct json_convert_traits<T,
+    typename std::enable_if<detail::is_integer_like<T>::value ||
+                            detail::is_uinteger_like<T>::value ||
+                            detail::is_floating_point_like<T>::value ||
+                            std::is_same<T,bool>::value
+>::type>
+{
+    template <class CharT>
+    static T decode(std::basic_istringstream<CharT>& is,
+                    const basic_json_serializing_options<CharT>& options)
+    {
+        basic_json<CharT> j = basic_json<CharT>::parse(is, options);
+        return j.template as<T>();
+    }
+
+    template <class CharT>
+    static void encode(T val, basic_json_content_handler<CharT>& serializer)
+    {
+        encode_scalar(val, serializer);
+    }
+private:
+    template <class U, class CharT>
+    static typename std::enable_if<detail::is_integer_like<U>::value>::type
+    encode_scalar(U val, basic_json_content_handler<CharT>& serializer)
+    {
+        serializer.int64_value(val);
+    }
+
+    template <class U, class CharT>
+    static typename std::enable_if<detail::is_uinteger_like<U>::value>::type
+    encode_scalar(U val, basic_json_content_handler<CharT>& serializer)
+    {
+        serializer.uint64_value(val);
+    }
+
+    template <class U, class CharT>
+    static typename std::enable_if<detail::is_floating_point_like<U>::value>::type
+    encode_scalar(U val, basic_json_content_handler<CharT>& serializer)
+    {
+        serializer.double_value(val);
+    }
+
+    template <class U, class CharT>
+    static typename std::enable_if<std::is_same<U,bool>::value>::type
+    encode_scalar(U val, basic_json_content_handler<CharT>& serializer)
+    {
+        serializer.bool_value(val);
+    }
+};
+
+// string like
+
+template <class T>
+struct json_convert_traits<T,
+    typename std::enable_if<detail::is_string_like<T>::value
+>::type>
+{
+    template <class CharT>
+    static T decode(std::basic_istringstream<CharT>& is,
+                    const basic_json_serializing_options<CharT>& options)
+    {
+        basic_json<CharT> j = basic_json<CharT>::parse(is, options);
+        return j.template as<T>();
+    }
+
+    template <class CharT>
+    static void encode(const T& val, basic_json_content_handler<CharT>& serializer)
+    {
+        serializer.string_value(basic_string_view<CharT>(val.data(), val.length()));
+    }
+};
+
 // vector like
 
 template <class T>
@@ -57,8 +339,8 @@ struct json_convert_traits<T,
     static T decode(std::basic_istringstream<CharT>& is,
                     const basic_json_serializing_options<CharT>& options)
     {
-        basic_json<CharT> j = basic_json<CharT>::parse(is, options);
-        return j.template as<T>();
+        basic_json_stream_reader<CharT,std::allocator<CharT>> reader(is, options);
+        return detail::stream_decode_traits<T>::decode(reader);
     }
 
     template <class CharT>
@@ -123,8 +405,8 @@ struct json_convert_traits<T,
     static T decode(std::basic_istringstream<CharT>& is,
                     const basic_json_serializing_options<CharT>& options)
     {
-        basic_json<CharT> j = basic_json<CharT>::parse(is, options);
-        return j.template as<T>();
+        basic_json_stream_reader<CharT,std::allocator<CharT>> reader(is, options);
+        return detail::stream_decode_traits<T>::decode(reader);
     }
 
     template <class CharT>
@@ -13,11 +13,35 @@
 #include <istream>
 #include <cstdlib>
 #include <memory>
+#include <type_traits>
+#include <limits>
 #include <jsoncons/json_exception.hpp>
 #include <jsoncons/json_content_handler.hpp>
 
 namespace jsoncons {
 
+namespace detail {
+
+// typed_array_min_length
+
+// An implementation policy may define typed_array_min_length to have arrays 
+// of at least that many int64 or double values decoded into packed storage
+
+template <class Policy, class Enable=void>
+struct typed_array_min_length
+{
+    static const size_t value = 0;
+};
+
+template <class Policy>
+struct typed_array_min_length<Policy,
+    typename std::enable_if<std::is_integral<decltype(Policy::typed_array_min_length)>::value>::type>
+{
+    static const size_t value = Policy::typed_array_min_length;
+};
+
+}
+
 template <class Json,class Allocator=std::allocator<typename Json::char_type>>
 class json_decoder final : public basic_json_content_handler<typename Json::char_type>
 {
@@ -81,6 +105,8 @@ private:
 
     std::vector<stack_item,stack_item_allocator_type> stack_;
     std::vector<structure_offset,size_t_allocator_type> stack_offsets_;
+    std::vector<double> double_buffer_;
+    std::vector<int64_t> int64_buffer_;
     bool is_valid_;
 
 public:
@@ -194,11 +220,15 @@ private:
         auto first = stack_.begin() + (structure_index+1);
         auto last = first + count;
         auto& j = stack_[structure_index].value_;
-        j.reserve(count);
-        while (first != last)
+        const size_t min_length = detail::typed_array_min_length<typename Json::implementation_policy>::value;
+        if (min_length == 0 || count < min_length || !pack_array(first, last, j))
         {
-            j.push_back(std::move(first->value_));
-            ++first;
+            j.reserve(count);
+            while (first != last)
+            {
+                j.push_back(std::move(first->value_));
+                ++first;
+            }
         }
         stack_.erase(stack_.begin()+structure_index+1, stack_.end());
         stack_offsets_.pop_back();
@@ -211,6 +241,65 @@ private:
         return true;
     }
 
+    template <class Iterator>
+    bool pack_array(Iterator first, Iterator last, Json& j)
+    {
+        typedef decltype(first->value_.structure_tag()) structure_tag_type;
+
+        // Non-negative integers are parsed as uint64, so those are packed with int64 
+        // values when in range
+        bool is_double = true;
+        bool is_int64 = true;
+        for (Iterator it = first; it != last && (is_double || is_int64); ++it)
+        {
+            if (it->value_.semantic_tag() != semantic_tag_type::none)
+            {
+                return false;
+            }
+            switch (it->value_.structure_tag())
+            {
+                case structure_tag_type::double_tag:
+                    is_int64 = false;
+                    break;
+                case structure_tag_type::int64_tag:
+                    is_double = false;
+                    break;
+                case structure_tag_type::uint64_tag:
+                    is_double = false;
+                    is_int64 = is_int64 && it->value_.template as<uint64_t>() <= static_cast<uint64_t>((std::numeric_limits<int64_t>::max)());
+                    break;
+                default:
+                    return false;
+            }
+        }
+        if (!is_double && !is_int64)
+        {
+            return false;
+        }
+        const size_t count = static_cast<size_t>(last - first);
+        if (is_double)
+        {
+            double_buffer_.clear();
+            double_buffer_.reserve(count);
+            for (Iterator it = first; it != last; ++it)
+            {
+                double_buffer_.push_back(it->value_.template as<double>());
+            }
+            j = Json::make_typed_array(double_buffer_.data(), count, array_allocator_);
+        }
+        else
+        {
+            int64_buffer_.clear();
+            int64_buffer_.reserve(count);
+            for (Iterator it = first; it != last; ++it)
+            {
+                int64_buffer_.push_back(it->value_.template as<int64_t>());
+            }
+            j = Json::make_typed_array(int64_buffer_.data(), count, array_allocator_);
+        }
+        return true;
+    }
+
     bool do_name(const string_view_type& name, const serializing_context&) override
     {
         stack_.emplace_back(std::true_type(), name.data(), name.length(), string_allocator_);
@@ -0,0 +1,123 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_JSONRECLAIMER_HPP
+#define JSONCONS_JSONRECLAIMER_HPP
+
+#include <memory>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <jsoncons/json.hpp>
+
+namespace jsoncons {
+
+// json_reclaimer destroys the values handed to it on a background thread,
+// so releasing a large document does not block the calling thread
+
+class json_reclaimer
+{
+    struct reclaimable
+    {
+        virtual ~reclaimable() {}
+    };
+
+    template <class Json>
+    struct reclaimable_value : public reclaimable
+    {
+        Json value_;
+
+        reclaimable_value(Json&& val)
+            : value_(std::move(val))
+        {
+        }
+    };
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::condition_variable idle_;
+    std::deque<std::unique_ptr<reclaimable>> queue_;
+    bool busy_;
+    bool done_;
+    std::thread thread_;
+public:
+    json_reclaimer()
+        : busy_(false), done_(false)
+    {
+        thread_ = std::thread([this](){run();});
+    }
+
+    json_reclaimer(const json_reclaimer&) = delete;
+    json_reclaimer& operator=(const json_reclaimer&) = delete;
+
+    // Destroys any values still pending before returning
+    ~json_reclaimer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_ = true;
+        }
+        ready_.notify_one();
+        thread_.join();
+    }
+
+    // Takes ownership of val, leaving it null
+    template <class CharT, class ImplementationPolicy, class Allocator>
+    void reclaim(basic_json<CharT,ImplementationPolicy,Allocator>&& val)
+    {
+        typedef basic_json<CharT,ImplementationPolicy,Allocator> json_type;
+
+        std::unique_ptr<reclaimable> p(new reclaimable_value<json_type>(std::move(val)));
+        val = json_type::null();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(p));
+        }
+        ready_.notify_one();
+    }
+
+    // Blocks until every value handed over so far has been destroyed
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this](){return queue_.empty() && !busy_;});
+    }
+
+    size_t pending()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size() + (busy_ ? 1 : 0);
+    }
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            ready_.wait(lock, [this](){return done_ || !queue_.empty();});
+            if (queue_.empty())
+            {
+                break;
+            }
+            std::unique_ptr<reclaimable> p = std::move(queue_.front());
+            queue_.pop_front();
+            busy_ = true;
+            lock.unlock();
+            p.reset();
+            lock.lock();
+            busy_ = false;
+            if (queue_.empty())
+            {
+                idle_.notify_all();
+            }
+        }
+    }
+};
+
+}
+
+#endif
@@ -97,11 +97,12 @@ private:
         return false;
     }
 
-    bool do_byte_string_value(const uint8_t*, size_t, 
-                              semantic_tag_type,
+    bool do_byte_string_value(const uint8_t* data, size_t length, 
+                              semantic_tag_type tag,
                               const serializing_context&) override
     {
-        JSONCONS_UNREACHABLE();
+        event_ = basic_stream_event<CharT>(data, length, tag);
+        return false;
     }
 
     bool do_int64_value(int64_t value, 
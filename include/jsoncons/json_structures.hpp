@@ -548,6 +548,27 @@ public:
     {
         return this->self_allocator_;
     }
+
+    // Appends a member without searching for its position, for copying 
+    // the members of another object that are already in order
+
+    template <class T, class A=allocator_type>
+    typename std::enable_if<is_stateless<A>::value,Json&>::type
+    append(const string_view_type& name, T&& value)
+    {
+        members_.emplace_back(key_storage_type(name.begin(),name.end()), 
+                              std::forward<T>(value));
+        return members_.back().value();
+    }
+
+    template <class T, class A=allocator_type>
+    typename std::enable_if<!is_stateless<A>::value,Json&>::type
+    append(const string_view_type& name, T&& value)
+    {
+        members_.emplace_back(key_storage_type(name.begin(),name.end(),get_allocator()), 
+                              std::forward<T>(value),get_allocator());
+        return members_.back().value();
+    }
 };
 
 // json_object
@@ -559,7 +580,7 @@ class json_object
 
 // Do not preserve order
 template <class KeyT,class Json>
-class json_object<KeyT,Json,false> final : public Json_object_<KeyT,Json>
+class json_object<KeyT,Json,false> : public Json_object_<KeyT,Json>
 {
 public:
     using typename Json_object_<KeyT,Json>::allocator_type;
@@ -573,6 +594,7 @@ public:
     using typename Json_object_<KeyT,Json>::iterator;
     using typename Json_object_<KeyT,Json>::const_iterator;
     using Json_object_<KeyT,Json>::get_allocator;
+    using Json_object_<KeyT,Json>::append;
 
     json_object()
         : Json_object_<KeyT,Json>()
@@ -1165,7 +1187,7 @@ private:
 
 // Preserve order
 template <class KeyT,class Json>
-class json_object<KeyT,Json,true> final : public Json_object_<KeyT,Json>
+class json_object<KeyT,Json,true> : public Json_object_<KeyT,Json>
 {
 public:
     using typename Json_object_<KeyT,Json>::allocator_type;
@@ -1179,6 +1201,7 @@ public:
     using typename Json_object_<KeyT,Json>::iterator;
     using typename Json_object_<KeyT,Json>::const_iterator;
     using Json_object_<KeyT,Json>::get_allocator;
+    using Json_object_<KeyT,Json>::append;
 
     json_object()
         : Json_object_<KeyT,Json>()
@@ -533,6 +533,10 @@ struct json_type_traits<Json, T,
 
     static bool is(const Json& j) JSONCONS_NOEXCEPT
     {
+        if (j.is_typed_array())
+        {
+            return is_typed_array(j);
+        }
         bool result = j.is_array();
         if (result)
         {
@@ -552,7 +556,11 @@ struct json_type_traits<Json, T,
     static typename std::enable_if<!(std::is_integral<Ty>::value && !std::is_same<Ty,bool>::value),T>::type
     as(const Json& j)
     {
-        if (j.is_array())
+        if (j.is_typed_array())
+        {
+            return as_typed_array(j);
+        }
+        else if (j.is_array())
         {
             T v(detail::json_array_input_iterator<Json, element_type>(j.array_range().begin()),
                 detail::json_array_input_iterator<Json, element_type>(j.array_range().end()));
@@ -568,7 +576,11 @@ struct json_type_traits<Json, T,
     static typename std::enable_if<std::is_integral<Ty>::value && !std::is_same<Ty,bool>::value,T>::type
     as(const Json& j)
     {
-        if (j.is_array())
+        if (j.is_typed_array())
+        {
+            return as_typed_array(j);
+        }
+        else if (j.is_array())
         {
             T v(detail::json_array_input_iterator<Json, element_type>(j.array_range().begin()),
                 detail::json_array_input_iterator<Json, element_type>(j.array_range().end()));
@@ -591,6 +603,77 @@ struct json_type_traits<Json, T,
         }
     }
 
+private:
+    // Packed arrays are read in place, without building their elements
+
+    static bool is_typed_array(const Json& j)
+    {
+        bool result = true;
+        if (j.template is_typed_array<double>())
+        {
+            for (double e : j.template typed_array_range<double>())
+            {
+                if (!Json(e).template is<element_type>())
+                {
+                    result = false;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            for (int64_t e : j.template typed_array_range<int64_t>())
+            {
+                if (!Json(e).template is<element_type>())
+                {
+                    result = false;
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+    static T as_typed_array(const Json& j)
+    {
+        return as_typed_array(j, std::integral_constant<bool,std::is_arithmetic<element_type>::value>());
+    }
+
+    static T as_typed_array(const Json& j, std::false_type)
+    {
+        T v;
+        if (j.template is_typed_array<double>())
+        {
+            for (double e : j.template typed_array_range<double>())
+            {
+                v.insert(v.end(), Json(e).template as<element_type>());
+            }
+        }
+        else
+        {
+            for (int64_t e : j.template typed_array_range<int64_t>())
+            {
+                v.insert(v.end(), Json(e).template as<element_type>());
+            }
+        }
+        return v;
+    }
+
+    static T as_typed_array(const Json& j, std::true_type)
+    {
+        if (j.template is_typed_array<double>())
+        {
+            auto r = j.template typed_array_range<double>();
+            return T(r.begin(), r.end());
+        }
+        else
+        {
+            auto r = j.template typed_array_range<int64_t>();
+            return T(r.begin(), r.end());
+        }
+    }
+public:
+
     static Json to_json(const T& val)
     {
         Json j = typename Json::array();
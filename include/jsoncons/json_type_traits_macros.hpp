@@ -0,0 +1,281 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_JSON_TYPE_TRAITS_MACROS_HPP
+#define JSONCONS_JSON_TYPE_TRAITS_MACROS_HPP
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <type_traits>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons/json_decoder.hpp>
+#include <jsoncons/json_type_traits.hpp>
+#include <jsoncons/json_convert_traits.hpp>
+#include <jsoncons/stream_reader.hpp>
+#include <jsoncons/json_stream_reader.hpp>
+
+// Preprocessor helpers for iterating over a member list
+
+#define JSONCONS_PP_EXPAND(X) X
+#define JSONCONS_PP_CONCAT_RAW(a, b) a ## b
+#define JSONCONS_PP_CONCAT(a, b) JSONCONS_PP_CONCAT_RAW(a, b)
+
+#define JSONCONS_PP_NARG(...) JSONCONS_PP_EXPAND(JSONCONS_PP_NARG_(__VA_ARGS__, JSONCONS_PP_RSEQ_N()))
+#define JSONCONS_PP_NARG_(...) JSONCONS_PP_EXPAND(JSONCONS_PP_ARG_N(__VA_ARGS__))
+#define JSONCONS_PP_ARG_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, N, ...) N
+#define JSONCONS_PP_RSEQ_N() 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+
+#define JSONCONS_PP_REP_N(Count, Macro, Type, ...) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_OF_N(Count)(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_OF_N(Count) JSONCONS_PP_CONCAT(JSONCONS_PP_REP_, Count)
+
+#define JSONCONS_PP_REP_1(Macro, Type, P1) Macro(Type, P1)
+#define JSONCONS_PP_REP_2(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_1(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_3(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_2(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_4(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_3(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_5(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_4(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_6(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_5(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_7(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_6(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_8(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_7(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_9(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_8(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_10(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_9(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_11(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_10(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_12(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_11(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_13(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_12(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_14(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_13(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_15(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_14(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_16(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_15(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_17(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_16(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_18(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_17(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_19(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_18(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_20(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_19(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_21(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_20(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_22(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_21(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_23(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_22(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_24(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_23(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_25(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_24(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_26(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_25(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_27(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_26(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_28(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_27(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_29(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_28(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_30(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_29(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_31(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_30(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_32(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_31(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_33(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_32(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_34(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_33(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_35(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_34(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_36(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_35(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_37(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_36(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_38(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_37(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_39(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_38(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_40(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_39(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_41(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_40(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_42(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_41(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_43(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_42(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_44(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_43(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_45(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_44(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_46(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_45(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_47(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_46(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_48(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_47(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_49(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_48(Macro, Type, __VA_ARGS__))
+#define JSONCONS_PP_REP_50(Macro, Type, P1, ...) Macro(Type, P1) JSONCONS_PP_EXPAND(JSONCONS_PP_REP_49(Macro, Type, __VA_ARGS__))
+
+namespace jsoncons {
+
+namespace detail {
+
+// member_name_hash
+
+// FNV-1a over the code units of a member name. The constexpr overload is 
+// evaluated at compile time for the names in a member list, and the values 
+// are used as case labels, so a collision between two members of the same 
+// struct is reported by the compiler as a duplicate case value.
+
+constexpr
+uint32_t member_name_hash(const char* s, uint32_t h = 2166136261u)
+{
+    return *s ? member_name_hash(s+1, (h ^ static_cast<uint32_t>(static_cast<unsigned char>(*s))) * 16777619u) : h;
+}
+
+template <class CharT>
+uint32_t member_name_hash(const CharT* s, size_t length)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        h = (h ^ static_cast<uint32_t>(static_cast<typename std::make_unsigned<CharT>::type>(s[i]))) * 16777619u;
+    }
+    return h;
+}
+
+template <class CharT>
+bool member_name_equals(const basic_string_view<CharT>& name, const char* s)
+{
+    size_t i = 0;
+    for (; i < name.length() && s[i] != 0; ++i)
+    {
+        if (name[i] != static_cast<CharT>(s[i]))
+        {
+            return false;
+        }
+    }
+    return i == name.length() && s[i] == 0;
+}
+
+// member_name_traits
+
+template <class CharT>
+struct member_name_traits
+{
+    typedef std::basic_string<CharT> name_type;
+
+    static name_type name(const char* s)
+    {
+        name_type result;
+        for (; *s != 0; ++s)
+        {
+            result.push_back(static_cast<CharT>(*s));
+        }
+        return result;
+    }
+};
+
+template <>
+struct member_name_traits<char>
+{
+    typedef basic_string_view<char> name_type;
+
+    static name_type name(const char* s)
+    {
+        return name_type(s);
+    }
+};
+
+}
+
+}
+
+// JSONCONS_MEMBER_TRAITS_DECL(ValueType, Member1, Member2, ...)
+// 
+// Generates json_type_traits, json_convert_traits and streaming decode 
+// specializations for a struct or class with public, default constructible
+// data members. Must be used in the global namespace. encode_json writes the 
+// members directly to the content handler, and decode_json assigns them 
+// directly from parser events, so neither builds a basic_json. The value is 
+// value-initialized, members absent from the input keep their initial values, 
+// unknown names are skipped.
+
+#define JSONCONS_MEMBER_IS(ValueType, Member) \
+    if (!j.contains(jsoncons::detail::member_name_traits<typename Json::char_type>::name(#Member))) return false;
+
+#define JSONCONS_MEMBER_AS(ValueType, Member) \
+    { \
+        auto it = j.find(jsoncons::detail::member_name_traits<typename Json::char_type>::name(#Member)); \
+        if (it != j.object_range().end()) \
+        { \
+            val.Member = it->value().template as<decltype(val.Member)>(); \
+        } \
+    }
+
+#define JSONCONS_MEMBER_TO_JSON(ValueType, Member) \
+    j.insert_or_assign(jsoncons::detail::member_name_traits<typename Json::char_type>::name(#Member), val.Member);
+
+#define JSONCONS_MEMBER_ENCODE(ValueType, Member) \
+    handler.name(jsoncons::detail::member_name_traits<CharT>::name(#Member)); \
+    jsoncons::json_convert_traits<decltype(val.Member)>::encode(val.Member, handler);
+
+#define JSONCONS_MEMBER_DECODE(ValueType, Member) \
+    case jsoncons::detail::member_name_hash(#Member): \
+        if (jsoncons::detail::member_name_equals(name, #Member)) \
+        { \
+            reader.next(); \
+            val.Member = jsoncons::detail::stream_decode_traits<decltype(val.Member)>::decode(reader); \
+            continue; \
+        } \
+        break;
+
+#define JSONCONS_MEMBER_TRAITS_DECL(ValueType, ...) \
+namespace jsoncons \
+{ \
+    template<class Json> \
+    struct json_type_traits<Json, ValueType> \
+    { \
+        typedef typename Json::allocator_type allocator_type; \
+        static bool is(const Json& j) JSONCONS_NOEXCEPT \
+        { \
+            if (!j.is_object()) return false; \
+            JSONCONS_PP_REP_N(JSONCONS_PP_NARG(__VA_ARGS__), JSONCONS_MEMBER_IS, ValueType, __VA_ARGS__) \
+            return true; \
+        } \
+        static ValueType as(const Json& j) \
+        { \
+            if (!j.is_object()) \
+            { \
+                JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not an object")); \
+            } \
+            ValueType val{}; \
+            JSONCONS_PP_REP_N(JSONCONS_PP_NARG(__VA_ARGS__), JSONCONS_MEMBER_AS, ValueType, __VA_ARGS__) \
+            return val; \
+        } \
+        static Json to_json(const ValueType& val, allocator_type allocator=allocator_type()) \
+        { \
+            Json j((typename Json::object(allocator))); \
+            JSONCONS_PP_REP_N(JSONCONS_PP_NARG(__VA_ARGS__), JSONCONS_MEMBER_TO_JSON, ValueType, __VA_ARGS__) \
+            return j; \
+        } \
+    }; \
+    namespace detail \
+    { \
+        template<> \
+        struct stream_decode_traits<ValueType> \
+        { \
+            template <class CharT> \
+            static ValueType decode(basic_stream_reader<CharT>& reader) \
+            { \
+                if (reader.current().event_type() != stream_event_type::begin_object) \
+                { \
+                    JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not an object")); \
+                } \
+                ValueType val{}; \
+                reader.next(); \
+                while (!reader.done() && reader.current().event_type() != stream_event_type::end_object) \
+                { \
+                    basic_string_view<CharT> name = reader.current().template as<basic_string_view<CharT>>(); \
+                    switch (jsoncons::detail::member_name_hash(name.data(), name.length())) \
+                    { \
+                        JSONCONS_PP_REP_N(JSONCONS_PP_NARG(__VA_ARGS__), JSONCONS_MEMBER_DECODE, ValueType, __VA_ARGS__) \
+                        default: \
+                            break; \
+                    } \
+                    reader.next(); \
+                    skip_stream_value(reader); \
+                } \
+                reader.next(); \
+                return val; \
+            } \
+        }; \
+    } \
+    template<> \
+    struct json_convert_traits<ValueType> \
+    { \
+        template <class CharT> \
+        static ValueType decode(std::basic_istringstream<CharT>& is, \
+                                const basic_json_serializing_options<CharT>& options) \
+        { \
+            basic_json_stream_reader<CharT,std::allocator<CharT>> reader(is, options); \
+            return jsoncons::detail::stream_decode_traits<ValueType>::decode(reader); \
+        } \
+        template <class CharT> \
+        static void encode(const ValueType& val, basic_json_content_handler<CharT>& handler) \
+        { \
+            handler.begin_object(); \
+            JSONCONS_PP_REP_N(JSONCONS_PP_NARG(__VA_ARGS__), JSONCONS_MEMBER_ENCODE, ValueType, __VA_ARGS__) \
+            handler.end_object(); \
+        } \
+    }; \
+}
+
+#endif
@@ -20,6 +20,8 @@
 #include <jsoncons/json_exception.hpp>
 #include <jsoncons/json_content_handler.hpp>
 #include <jsoncons/bignum.hpp>
+#include <jsoncons/byte_string.hpp>
+#include <jsoncons/jsoncons_utilities.hpp>
 #include <jsoncons/parse_error_handler.hpp>
 #include <jsoncons/serializing_context.hpp>
 #include <jsoncons/detail/writer.hpp>
@@ -102,6 +104,13 @@ public:
         value_.string_data_ = data;
     }
 
+    basic_stream_event(const uint8_t* data, size_t length, 
+                       semantic_tag_type semantic_tag = semantic_tag_type::none)
+        : event_type_(stream_event_type::byte_string_value), semantic_tag_(semantic_tag), length_(length)
+    {
+        value_.byte_string_data_ = data;
+    }
+
     template<class T, class CharT_ = CharT>
     typename std::enable_if<detail::is_string_like<T>::value && std::is_same<typename T::value_type,CharT_>::value,T>::type
     as() const
@@ -113,6 +122,13 @@ public:
             case stream_event_type::string_value:
                 s = T(value_.string_data_,length_);
                 break;
+            case stream_event_type::byte_string_value:
+            {
+                std::basic_string<CharT> encoded;
+                encode_base64url(value_.byte_string_data_, length_, encoded);
+                s = T(encoded.data(),encoded.length());
+                break;
+            }
             case stream_event_type::int64_value:
             {
                 detail::string_writer<T> writer(s);
@@ -177,6 +193,17 @@ public:
         return s;
     }
 
+    template<class T>
+    typename std::enable_if<std::is_same<T,byte_string>::value,T>::type
+    as() const
+    {
+        if (event_type_ != stream_event_type::byte_string_value)
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a byte string"));
+        }
+        return T(value_.byte_string_data_, length_);
+    }
+
     template<class T>
     typename std::enable_if<detail::is_integer_like<T>::value,T>::type
     as() const
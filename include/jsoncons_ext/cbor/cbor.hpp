@@ -20,7 +20,10 @@
 #include <jsoncons/json_filter.hpp>
 #include <jsoncons/config/binary_utilities.hpp>
 #include <jsoncons_ext/cbor/cbor_parser.hpp>
+#include <jsoncons_ext/cbor/cbor_reader.hpp>
 #include <jsoncons_ext/cbor/cbor_serializer.hpp>
 #include <jsoncons_ext/cbor/cbor_view.hpp>
+#include <jsoncons_ext/cbor/cbor_index.hpp>
+#include <jsoncons_ext/cbor/cbor_stream_reader.hpp>
 
 #endif
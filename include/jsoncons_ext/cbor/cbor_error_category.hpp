@@ -16,7 +16,8 @@ namespace jsoncons { namespace cbor {
     {
         ok = 0,
         unexpected_eof = 1,
-        source_error
+        source_error,
+        extra_data
     };
 
 #if !defined(JSONCONS_NO_DEPRECATED)
@@ -39,6 +40,8 @@ public:
             return "Unexpected end of file";
         case cbor_parse_errc::source_error:
             return "Source error";
+        case cbor_parse_errc::extra_data:
+            return "Unexpected data after the end of the data item";
        default:
             return "Unknown CBOR parser error";
         }
@@ -0,0 +1,389 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_CBOR_CBORINDEX_HPP
+#define JSONCONS_CBOR_CBORINDEX_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+#include <jsoncons/json_exception.hpp>
+#include <jsoncons/jsoncons_utilities.hpp>
+#include <jsoncons_ext/cbor/cbor_parser.hpp>
+
+namespace jsoncons { namespace cbor {
+
+// cbor_index records, in one pass over a CBOR buffer, the offsets of the
+// elements of every array and a hash table of the keys of every map, so that
+// views over the buffer can look up elements and members in constant time.
+// The payload is not copied, the buffer must outlive the index.
+
+class cbor_index
+{
+public:
+    typedef basic_string_view<char> string_view_type;
+
+    struct container_entry
+    {
+        bool is_map;
+        bool has_key_table;
+        size_t count;
+        size_t first;        // first element offset or member
+        size_t end;          // offset of the end of the last element
+        size_t first_bucket;
+        size_t bucket_count;
+    };
+private:
+    struct member_entry
+    {
+        size_t key_data;
+        size_t key_length;
+        size_t value_start;
+        size_t value_end;
+        uint32_t hash;
+    };
+
+    struct frame
+    {
+        size_t entry;
+        size_t remaining;     // members or elements left, if not indefinite length
+        bool indefinite_length;
+        bool is_map;
+        bool has_key_table;
+        bool expect_key;
+        size_t scratch_start;
+    };
+
+    const uint8_t* first_;
+    const uint8_t* last_;
+    std::vector<container_entry> containers_;
+    std::unordered_map<size_t,size_t> container_offsets_;
+    std::vector<size_t> element_offsets_;
+    std::vector<member_entry> members_;
+    std::vector<size_t> buckets_;
+public:
+    cbor_index(const uint8_t* data, size_t length)
+        : first_(data), last_(data+length)
+    {
+        build();
+    }
+
+    cbor_index(const std::vector<uint8_t>& v)
+        : first_(v.data()), last_(v.data()+v.size())
+    {
+        build();
+    }
+
+    cbor_index(const cbor_index&) = delete;
+    cbor_index& operator=(const cbor_index&) = delete;
+
+    const uint8_t* buffer() const
+    {
+        return first_;
+    }
+
+    size_t buflen() const
+    {
+        return last_ - first_;
+    }
+
+    // Returns the entry for the array or map that begins at p, or nullptr if there is none
+    const container_entry* find(const uint8_t* p) const
+    {
+        if (p < first_ || p >= last_)
+        {
+            return nullptr;
+        }
+        auto it = container_offsets_.find(static_cast<size_t>(p - first_));
+        return it != container_offsets_.end() ? std::addressof(containers_[it->second]) : nullptr;
+    }
+
+    void element(const container_entry& entry, size_t index,
+                 const uint8_t** first, const uint8_t** last) const
+    {
+        if (index >= entry.count)
+        {
+            JSONCONS_THROW(json_exception_impl<std::out_of_range>("Invalid array subscript"));
+        }
+        if (entry.is_map)
+        {
+            const member_entry& member = members_[entry.first + index];
+            *first = first_ + member.value_start;
+            *last = first_ + member.value_end;
+        }
+        else
+        {
+            *first = first_ + element_offsets_[entry.first + index];
+            *last = first_ + (index + 1 < entry.count ? element_offsets_[entry.first + index + 1] : entry.end);
+        }
+    }
+
+    // Returns false if the map has no member with the given key
+    bool member(const container_entry& entry, const string_view_type& key,
+                const uint8_t** first, const uint8_t** last) const
+    {
+        JSONCONS_ASSERT(entry.is_map && entry.has_key_table);
+        if (entry.bucket_count == 0)
+        {
+            return false;
+        }
+        const uint32_t h = hash(reinterpret_cast<const uint8_t*>(key.data()), key.length());
+        const size_t mask = entry.bucket_count - 1;
+        for (size_t i = h & mask; ; i = (i + 1) & mask)
+        {
+            size_t slot = buckets_[entry.first_bucket + i];
+            if (slot == 0)
+            {
+                return false;
+            }
+            const member_entry& m = members_[entry.first + slot - 1];
+            if (m.hash == h && m.key_length == key.length() &&
+                std::memcmp(first_ + m.key_data, key.data(), key.length()) == 0)
+            {
+                *first = first_ + m.value_start;
+                *last = first_ + m.value_end;
+                return true;
+            }
+        }
+    }
+
+private:
+    static uint32_t hash(const uint8_t* p, size_t length)
+    {
+        uint32_t h = 2166136261u;
+        for (const uint8_t* q = p; q != p + length; ++q)
+        {
+            h ^= *q;
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    // Skips any semantic tags in front of an item
+    const uint8_t* skip_tags(const uint8_t* p) const
+    {
+        while (p < last_ && get_major_type(*p) == cbor_major_type::semantic_tag)
+        {
+            switch (get_additional_information_value(*p))
+            {
+                case 0x18:
+                    p += 2;
+                    break;
+                case 0x19:
+                    p += 3;
+                    break;
+                case 0x1a:
+                    p += 5;
+                    break;
+                case 0x1b:
+                    p += 9;
+                    break;
+                default:
+                    p += 1;
+                    break;
+            }
+        }
+        if (p >= last_)
+        {
+            JSONCONS_THROW(cbor_decode_error(last_-first_));
+        }
+        return p;
+    }
+
+    const uint8_t* skip(const uint8_t* p) const
+    {
+        const uint8_t* endp;
+        detail::walk(p, last_, &endp);
+        if (endp == p)
+        {
+            JSONCONS_THROW(cbor_decode_error(p-first_));
+        }
+        return endp;
+    }
+
+    // Begins the array or map at p, or skips any other item; returns the position that follows
+    const uint8_t* visit(const uint8_t* start, std::vector<frame>& stack, std::vector<size_t>& scratch)
+    {
+        const uint8_t* p = skip_tags(start);
+        cbor_major_type major_type = get_major_type(*p);
+        if (major_type != cbor_major_type::array && major_type != cbor_major_type::map)
+        {
+            return skip(p);
+        }
+
+        frame f;
+        f.is_map = major_type == cbor_major_type::map;
+        f.has_key_table = f.is_map;
+        f.expect_key = f.is_map;
+        f.scratch_start = scratch.size();
+        f.indefinite_length = get_additional_information_value(*p) == additional_information::indefinite_length;
+
+        const uint8_t* endp;
+        if (f.indefinite_length)
+        {
+            f.remaining = 0;
+            endp = p + 1;
+        }
+        else
+        {
+            f.remaining = f.is_map ? detail::get_map_size(p, last_, &endp) : detail::get_array_size(p, last_, &endp);
+            if (endp == p)
+            {
+                JSONCONS_THROW(cbor_decode_error(p-first_));
+            }
+        }
+
+        container_entry entry = {f.is_map, f.has_key_table, 0, 0, 0, 0, 0};
+        f.entry = containers_.size();
+        containers_.push_back(entry);
+        container_offsets_.emplace(static_cast<size_t>(start - first_), f.entry);
+        stack.push_back(f);
+        return endp;
+    }
+
+    bool at_end(frame& f, const uint8_t* p) const
+    {
+        if (f.indefinite_length)
+        {
+            if (p >= last_)
+            {
+                JSONCONS_THROW(cbor_decode_error(last_-first_));
+            }
+            return *p == 0xff;
+        }
+        return f.remaining == 0;
+    }
+
+    void finish(const frame& f, size_t end, std::vector<size_t>& scratch)
+    {
+        container_entry& entry = containers_[f.entry];
+        entry.end = end;
+        entry.has_key_table = f.has_key_table;
+        if (f.is_map)
+        {
+            // scratch holds key start, key data, key length and value start for each member
+            entry.count = (scratch.size() - f.scratch_start)/4;
+            entry.first = members_.size();
+            for (size_t i = f.scratch_start; i < scratch.size(); i += 4)
+            {
+                member_entry m;
+                m.key_data = scratch[i+1];
+                m.key_length = scratch[i+2];
+                m.value_start = scratch[i+3];
+                m.value_end = i + 4 < scratch.size() ? scratch[i+4] : end;
+                m.hash = f.has_key_table ? hash(first_ + m.key_data, m.key_length) : 0;
+                members_.push_back(m);
+            }
+            if (f.has_key_table && entry.count > 0)
+            {
+                size_t bucket_count = 2;
+                while (bucket_count < 2*entry.count)
+                {
+                    bucket_count *= 2;
+                }
+                entry.first_bucket = buckets_.size();
+                entry.bucket_count = bucket_count;
+                buckets_.resize(buckets_.size() + bucket_count, 0);
+                const size_t mask = bucket_count - 1;
+                for (size_t i = 0; i < entry.count; ++i)
+                {
+                    const member_entry& m = members_[entry.first + i];
+                    size_t j = m.hash & mask;
+                    bool duplicate = false;
+                    while (buckets_[entry.first_bucket + j] != 0 && !duplicate)
+                    {
+                        // The first of duplicate keys wins, as when walking the map
+                        const member_entry& other = members_[entry.first + buckets_[entry.first_bucket + j] - 1];
+                        duplicate = other.hash == m.hash && other.key_length == m.key_length &&
+                                    std::memcmp(first_ + other.key_data, first_ + m.key_data, m.key_length) == 0;
+                        j = (j + 1) & mask;
+                    }
+                    if (!duplicate)
+                    {
+                        buckets_[entry.first_bucket + j] = i + 1;
+                    }
+                }
+            }
+        }
+        else
+        {
+            entry.count = scratch.size() - f.scratch_start;
+            entry.first = element_offsets_.size();
+            element_offsets_.insert(element_offsets_.end(), scratch.begin() + f.scratch_start, scratch.end());
+        }
+        scratch.resize(f.scratch_start);
+    }
+
+    void build()
+    {
+        if (first_ == last_)
+        {
+            return;
+        }
+        std::vector<frame> stack;
+        std::vector<size_t> scratch;
+
+        const uint8_t* p = visit(first_, stack, scratch);
+        while (!stack.empty())
+        {
+            frame& f = stack.back();
+            if (at_end(f, p))
+            {
+                frame done = f;
+                stack.pop_back();
+                finish(done, static_cast<size_t>(p - first_), scratch);
+                if (done.indefinite_length)
+                {
+                    ++p;
+                }
+            }
+            else if (f.expect_key)
+            {
+                if (p >= last_)
+                {
+                    JSONCONS_THROW(cbor_decode_error(last_-first_));
+                }
+                const uint8_t* endp;
+                scratch.push_back(static_cast<size_t>(p - first_));
+                if (get_major_type(*p) == cbor_major_type::text_string &&
+                    get_additional_information_value(*p) != additional_information::indefinite_length)
+                {
+                    size_t length = detail::get_text_string_length(p, last_, &endp);
+                    if (endp == p || length > static_cast<size_t>(last_ - endp))
+                    {
+                        JSONCONS_THROW(cbor_decode_error(p-first_));
+                    }
+                    scratch.push_back(static_cast<size_t>(endp - first_));
+                    scratch.push_back(length);
+                    p = endp + length;
+                }
+                else
+                {
+                    // Maps with keys other than definite length text strings are walked
+                    f.has_key_table = false;
+                    scratch.push_back(0);
+                    scratch.push_back(0);
+                    p = skip(p);
+                }
+                f.expect_key = false;
+            }
+            else
+            {
+                scratch.push_back(static_cast<size_t>(p - first_));
+                if (!f.indefinite_length)
+                {
+                    --f.remaining;
+                }
+                f.expect_key = f.is_map;
+                p = visit(p, stack, scratch); // may invalidate f
+            }
+        }
+    }
+};
+
+}}
+
+#endif
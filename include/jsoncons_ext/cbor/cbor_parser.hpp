@@ -16,6 +16,7 @@
 #include <limits>
 #include <cassert>
 #include <iterator>
+#include <algorithm>
 #include <jsoncons/json.hpp>
 #include <jsoncons/json_content_handler.hpp>
 #include <jsoncons/config/binary_utilities.hpp>
@@ -84,6 +85,7 @@ private:
 namespace detail {
 
 void walk(const uint8_t* first, const uint8_t* last, const uint8_t** endp);
+inline bool read_head(const uint8_t* first, const uint8_t* last, uint64_t& val, const uint8_t** endp);
 
 inline 
 size_t get_byte_string_length(const uint8_t* first, const uint8_t* last, 
@@ -905,6 +907,12 @@ void walk(const uint8_t *first, const uint8_t *last, const uint8_t **endp)
         }
         case cbor_major_type::semantic_tag:
         {
+            uint64_t tag;
+            if (!read_head(first, last, tag, &p))
+            {
+                *endp = first;
+                break;
+            }
             walk(p, last, endp);
             break;
         }
@@ -1158,137 +1166,696 @@ size_t get_array_size(const uint8_t* first, const uint8_t* last, const uint8_t**
     }
 }
 
-template <class T>
-class const_array_iterator
+// Reads the head of the data item at first, its initial byte and the argument
+// that follows, returning false if it is malformed or does not end by last. 
+// The argument of an indefinite length item is zero.
+inline
+bool read_head(const uint8_t* first, const uint8_t* last, uint64_t& val, const uint8_t** endp)
 {
-    const uint8_t* p_;
-    const uint8_t* last_;
-    const uint8_t* base_relative_;
-    T current_;
-public:
-    typedef typename T::difference_type difference_type;
-    typedef typename T::value_type value_type;
-    typedef typename T::const_reference reference;
-    typedef typename T::const_pointer pointer;
-    typedef std::forward_iterator_tag iterator_catagory;
-
-    const_array_iterator()
-        : p_(nullptr), last_(nullptr), base_relative_(nullptr)
+    if (first >= last)
     {
+        return false;
     }
-
-    const_array_iterator(const uint8_t* p, const uint8_t* last, const uint8_t* base_relative)
-        : p_(p), last_(last), base_relative_(base_relative)
+    const uint8_t* p = first + 1;
+    uint8_t info = get_additional_information_value(*first);
+    size_t length = 0;
+    switch (info)
+    {
+        case JSONCONS_CBOR_0x00_0x17: // 0x00..0x17 (0..23)
+            val = info;
+            *endp = p;
+            return true;
+        case 0x18:
+            length = 1;
+            break;
+        case 0x19:
+            length = 2;
+            break;
+        case 0x1a:
+            length = 4;
+            break;
+        case 0x1b:
+            length = 8;
+            break;
+        case additional_information::indefinite_length:
+            val = 0;
+            *endp = p;
+            return true;
+        default:
+            return false;
+    }
+    if (static_cast<size_t>(last - p) < length)
     {
+        return false;
     }
-
-    const_array_iterator(const const_array_iterator& other) = default;
-
-    friend bool operator==(const const_array_iterator& lhs, const const_array_iterator& rhs) 
+    val = 0;
+    for (size_t i = 0; i < length; ++i)
     {
-        return lhs.p_ == rhs.p_; 
+        val = (val << 8) | p[i];
     }
+    *endp = p + length;
+    return true;
+}
 
-    friend bool operator!=(const const_array_iterator& lhs, const const_array_iterator& rhs) 
+// Finds the end of the data item at first, returning false if it is malformed 
+// or does not end by last
+inline
+bool skip_item(const uint8_t* first, const uint8_t* last, const uint8_t** endp)
+{
+    uint64_t val;
+    const uint8_t* p;
+    if (!read_head(first, last, val, &p))
     {
-        return lhs.p_ != rhs.p_; 
+        return false;
     }
-
-    friend bool operator<(const const_array_iterator& lhs, const const_array_iterator& rhs) 
+    bool is_indefinite_length = get_additional_information_value(*first) == additional_information::indefinite_length;
+    switch (get_major_type(*first))
     {
-        return lhs.p_ == rhs.p_; 
+        case cbor_major_type::unsigned_integer:
+        case cbor_major_type::negative_integer:
+        case cbor_major_type::semantic_tag:
+            if (is_indefinite_length)
+            {
+                return false;
+            }
+            if (get_major_type(*first) == cbor_major_type::semantic_tag)
+            {
+                return skip_item(p, last, endp);
+            }
+            *endp = p;
+            return true;
+        case cbor_major_type::byte_string:
+        case cbor_major_type::text_string:
+            if (is_indefinite_length)
+            {
+                while (p < last && *p != 0xff)
+                {
+                    if (get_major_type(*p) != get_major_type(*first) || 
+                        get_additional_information_value(*p) == additional_information::indefinite_length ||
+                        !skip_item(p, last, &p))
+                    {
+                        return false;
+                    }
+                }
+                if (p >= last)
+                {
+                    return false;
+                }
+                *endp = p + 1;
+                return true;
+            }
+            if (static_cast<uint64_t>(last - p) < val)
+            {
+                return false;
+            }
+            *endp = p + static_cast<size_t>(val);
+            return true;
+        case cbor_major_type::array:
+        case cbor_major_type::map:
+        {
+            size_t items_per_entry = get_major_type(*first) == cbor_major_type::map ? 2 : 1;
+            if (is_indefinite_length)
+            {
+                while (p < last && *p != 0xff)
+                {
+                    for (size_t i = 0; i < items_per_entry; ++i)
+                    {
+                        if (!skip_item(p, last, &p))
+                        {
+                            return false;
+                        }
+                    }
+                }
+                if (p >= last)
+                {
+                    return false;
+                }
+                *endp = p + 1;
+                return true;
+            }
+            for (uint64_t n = 0; n < val; ++n)
+            {
+                for (size_t i = 0; i < items_per_entry; ++i)
+                {
+                    if (!skip_item(p, last, &p))
+                    {
+                        return false;
+                    }
+                }
+            }
+            *endp = p;
+            return true;
+        }
+        case cbor_major_type::simple:
+            if (is_indefinite_length)
+            {
+                return false;
+            }
+            *endp = p;
+            return true;
+        default:
+            return false;
     }
+}
 
-    const_array_iterator& operator++()
+// Walks the data item at first, counting the strings that are assigned 
+// stringrefs in the enclosing namespace, until the string with the given 
+// index is found. Strings inside nested namespaces are passed over.
+inline
+bool find_nth_stringref(const uint8_t* first, const uint8_t* last, uint64_t index, uint64_t& count, 
+                        const uint8_t** str_first, const uint8_t** endp)
+{
+    uint64_t val;
+    const uint8_t* p;
+    if (!read_head(first, last, val, &p))
     {
-        detail::walk(p_, last_, &p_);
-        return *this;
+        return false;
+    }
+    bool is_indefinite_length = get_additional_information_value(*first) == additional_information::indefinite_length;
+    switch (get_major_type(*first))
+    {
+        case cbor_major_type::byte_string:
+        case cbor_major_type::text_string:
+            if (is_indefinite_length || static_cast<uint64_t>(last - p) < val)
+            {
+                return skip_item(first, last, endp);
+            }
+            *endp = p + static_cast<size_t>(val);
+            if (val >= min_stringref_length(count))
+            {
+                if (count == index)
+                {
+                    *str_first = first;
+                    return true;
+                }
+                ++count;
+            }
+            return true;
+        case cbor_major_type::semantic_tag:
+            if (val == 25 || val == 256)
+            {
+                return skip_item(first, last, endp);
+            }
+            return find_nth_stringref(p, last, index, count, str_first, endp);
+        case cbor_major_type::array:
+        case cbor_major_type::map:
+        {
+            size_t items_per_entry = get_major_type(*first) == cbor_major_type::map ? 2 : 1;
+            for (uint64_t n = 0; is_indefinite_length || n < val; ++n)
+            {
+                if (is_indefinite_length && p < last && *p == 0xff)
+                {
+                    *endp = p + 1;
+                    return true;
+                }
+                for (size_t i = 0; i < items_per_entry; ++i)
+                {
+                    if (!find_nth_stringref(p, last, index, count, str_first, &p))
+                    {
+                        return false;
+                    }
+                    if (*str_first != nullptr)
+                    {
+                        return true;
+                    }
+                }
+            }
+            *endp = p;
+            return true;
+        }
+        default:
+            return skip_item(first, last, endp);
     }
+}
 
-    const_array_iterator operator++(int) // postfix increment
+// Finds the string that the stringref (tag 25) between p and last refers to, 
+// in the data that begins at first. The innermost namespace (tag 256) 
+// enclosing p is found by passing over the items that end before p, and 
+// descending into the one that contains it, and is then walked up to p.
+inline
+bool find_stringref(const uint8_t* first, const uint8_t* p, const uint8_t* last, 
+                    const uint8_t** str_first, const uint8_t** str_last)
+{
+    uint64_t tag;
+    const uint8_t* q;
+    if (!read_head(p, last, tag, &q) || get_major_type(*p) != cbor_major_type::semantic_tag || tag != 25 ||
+        q >= last || get_major_type(*q) != cbor_major_type::unsigned_integer)
     {
-        const_array_iterator temp(*this);
-        detail::walk(p_, last_, &p_);
-        return temp;
+        return false;
+    }
+    uint64_t index;
+    if (!read_head(q, last, index, &q))
+    {
+        return false;
     }
 
-    reference operator*() const
+    const uint8_t* ns = nullptr;
+    q = first;
+    while (true)
     {
         const uint8_t* endp;
-        detail::walk(p_, last_, &endp);
-        const_cast<T*>(&current_)->first_ = p_;
-        const_cast<T*>(&current_)->last_ = endp;
-        const_cast<T*>(&current_)->base_relative_ = base_relative_;
-        return current_;
+        while (q < p && skip_item(q, p, &endp))
+        {
+            q = endp;
+        }
+        if (q >= p)
+        {
+            break;
+        }
+        uint64_t val;
+        if (!read_head(q, p, val, &endp))
+        {
+            return false;
+        }
+        switch (get_major_type(*q))
+        {
+            case cbor_major_type::semantic_tag:
+                if (val == 256)
+                {
+                    ns = endp;
+                }
+                break;
+            case cbor_major_type::array:
+            case cbor_major_type::map:
+                break;
+            default:
+                return false;
+        }
+        q = endp;
+    }
+    if (q != p || ns == nullptr)
+    {
+        return false;
     }
 
-    pointer operator->() const
+    uint64_t count = 0;
+    *str_first = nullptr;
+    const uint8_t* endp;
+    find_nth_stringref(ns, p, index, count, str_first, &endp);
+    if (*str_first == nullptr)
     {
-        const uint8_t* endp;
-        detail::walk(p_, last_, &endp);
-        const_cast<T*>(&current_)->first_ = p_;
-        const_cast<T*>(&current_)->last_ = endp;
-        const_cast<T*>(&current_)->base_relative_ = base_relative_;
-        return &current_;
+        return false;
     }
-};
+    return skip_item(*str_first, p, str_last);
+}
 
-template <class T>
-class const_object_iterator;
+// Typed arrays (RFC 8746) are byte strings tagged 64 to 87. The tag bits 
+// are 010fsell: f for floating point, s for signed, e for little endian, and 
+// ll for the element size. Tag 76 is reserved, and 128-bit floats, tags 83 
+// and 87, are not supported.
+inline
+bool is_typed_array_tag(uint64_t tag)
+{
+    return tag >= 64 && tag <= 87 && tag != 76 && tag != 83 && tag != 87;
+}
 
-template <class T>
-class key_value_pair_view
+inline
+bool is_float_typed_array_tag(uint64_t tag)
 {
-    const uint8_t* key_begin_;
-    const uint8_t* key_end_;
-    const uint8_t* val_begin_;
-    const uint8_t* val_end_;
-    const uint8_t* base_relative_;
+    return (tag & 0x10) != 0;
+}
 
-public:
-    friend class const_object_iterator<T>;
+inline
+bool is_signed_typed_array_tag(uint64_t tag)
+{
+    return (tag & 0x08) != 0;
+}
 
-    key_value_pair_view()
-        : key_begin_(nullptr), key_end_(nullptr), val_begin_(nullptr), val_end_(nullptr)
+inline
+bool is_little_endian_typed_array_tag(uint64_t tag)
+{
+    // Tag 68 is uint8 with clamped arithmetic, its e bit is not an endianness
+    return (tag & 0x04) != 0 && tag != 68;
+}
+
+inline
+size_t typed_array_element_size(uint64_t tag)
+{
+    size_t ll = static_cast<size_t>(tag & 0x03);
+    return is_float_typed_array_tag(tag) ? (size_t(2) << ll) : (size_t(1) << ll);
+}
+
+// Returns true if the elements are stored as T in the host's byte order
+template <class T>
+bool is_native_typed_array_tag(uint64_t tag)
+{
+    return typed_array_element_size(tag) == sizeof(T) &&
+           is_float_typed_array_tag(tag) == std::is_floating_point<T>::value &&
+           (std::is_floating_point<T>::value || is_signed_typed_array_tag(tag) == std::is_signed<T>::value) &&
+           (sizeof(T) == 1 || is_little_endian_typed_array_tag(tag) == binary::is_little_endian());
+}
+
+// Reads the bits of the typed array element at p
+inline
+uint64_t get_typed_array_bits(const uint8_t* p, uint64_t tag)
+{
+    size_t size = typed_array_element_size(tag);
+    uint64_t bits = 0;
+    if (is_little_endian_typed_array_tag(tag))
     {
+        for (size_t i = size; i-- > 0;)
+        {
+            bits = (bits << 8) | p[i];
+        }
     }
-    key_value_pair_view(const uint8_t* key_begin, const uint8_t* key_end, 
-                        const uint8_t* val_begin, const uint8_t* val_end, 
-                        const uint8_t* base_relative)
-        : key_begin_(key_begin), key_end_(key_end), val_begin_(val_begin), val_end_(val_end), 
-          base_relative_(base_relative)
+    else
     {
+        for (size_t i = 0; i < size; ++i)
+        {
+            bits = (bits << 8) | p[i];
+        }
     }
-    key_value_pair_view(const key_value_pair_view& other) = default;
+    return bits;
+}
 
-    std::string key() const
+inline
+uint64_t get_typed_array_uint64(const uint8_t* p, uint64_t tag)
+{
+    return get_typed_array_bits(p, tag);
+}
+
+inline
+int64_t get_typed_array_int64(const uint8_t* p, uint64_t tag)
+{
+    uint64_t bits = get_typed_array_bits(p, tag);
+    size_t shift = 64 - 8*typed_array_element_size(tag);
+    if (is_signed_typed_array_tag(tag) && shift > 0)
     {
-        const uint8_t* endp;
-        return get_text_string(key_begin_, key_end_, &endp);
+        // Sign extend
+        return static_cast<int64_t>(bits << shift) >> shift;
     }
+    return static_cast<int64_t>(bits);
+}
 
-    T value() const
+inline
+double get_typed_array_double(const uint8_t* p, uint64_t tag)
+{
+    if (!is_float_typed_array_tag(tag))
     {
-        return T(val_begin_, val_end_ - val_begin_, base_relative_);
+        return is_signed_typed_array_tag(tag) ? static_cast<double>(get_typed_array_int64(p, tag)) 
+                                              : static_cast<double>(get_typed_array_uint64(p, tag));
     }
-};
+    uint64_t bits = get_typed_array_bits(p, tag);
+    switch (typed_array_element_size(tag))
+    {
+        case 2:
+            return binary::decode_half(static_cast<uint16_t>(bits));
+        case 4:
+        {
+            uint32_t x = static_cast<uint32_t>(bits);
+            float val;
+            memcpy(&val, &x, sizeof(val));
+            return val;
+        }
+        default:
+        {
+            double val;
+            memcpy(&val, &bits, sizeof(val));
+            return val;
+        }
+    }
+}
 
+// An iterator over the elements of a typed array, converted to T
 template <class T>
-class const_object_iterator
+class typed_array_iterator
 {
     const uint8_t* p_;
-    const uint8_t* last_;
-    const uint8_t* base_relative_;
-    key_value_pair_view<T> kvpair_;
+    uint64_t tag_;
+    size_t element_size_;
 public:
-    typedef typename T::difference_type difference_type;
-    typedef key_value_pair_view<T> value_type;
-    typedef const key_value_pair_view<T>& reference;
-    typedef const key_value_pair_view<T>* pointer;
-    typedef std::forward_iterator_tag iterator_catagory;
+    typedef std::ptrdiff_t difference_type;
+    typedef T value_type;
+    typedef T reference;
+    typedef const T* pointer;
+    typedef std::random_access_iterator_tag iterator_category;
 
-    const_object_iterator()
-        : p_(nullptr), last_(nullptr), base_relative_(nullptr)
+    typed_array_iterator()
+        : p_(nullptr), tag_(0), element_size_(1)
+    {
+    }
+
+    typed_array_iterator(const uint8_t* p, uint64_t tag)
+        : p_(p), tag_(tag), element_size_(typed_array_element_size(tag))
+    {
+    }
+
+    // The element bytes and their tag
+    const uint8_t* data() const
+    {
+        return p_;
+    }
+
+    uint64_t tag() const
+    {
+        return tag_;
+    }
+
+    T operator*() const
+    {
+        return get(std::integral_constant<bool,std::is_floating_point<T>::value>());
+    }
+
+    T operator[](difference_type n) const
+    {
+        return *(*this + n);
+    }
+
+    typed_array_iterator& operator++()
+    {
+        p_ += element_size_;
+        return *this;
+    }
+
+    typed_array_iterator operator++(int)
+    {
+        typed_array_iterator temp(*this);
+        p_ += element_size_;
+        return temp;
+    }
+
+    typed_array_iterator& operator--()
+    {
+        p_ -= element_size_;
+        return *this;
+    }
+
+    typed_array_iterator operator--(int)
+    {
+        typed_array_iterator temp(*this);
+        p_ -= element_size_;
+        return temp;
+    }
+
+    typed_array_iterator& operator+=(difference_type n)
+    {
+        p_ += n*static_cast<difference_type>(element_size_);
+        return *this;
+    }
+
+    typed_array_iterator& operator-=(difference_type n)
+    {
+        p_ -= n*static_cast<difference_type>(element_size_);
+        return *this;
+    }
+
+    friend typed_array_iterator operator+(typed_array_iterator it, difference_type n)
+    {
+        return it += n;
+    }
+
+    friend typed_array_iterator operator-(typed_array_iterator it, difference_type n)
+    {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const typed_array_iterator& lhs, const typed_array_iterator& rhs)
+    {
+        return (lhs.p_ - rhs.p_)/static_cast<difference_type>(lhs.element_size_);
+    }
+
+    friend bool operator==(const typed_array_iterator& lhs, const typed_array_iterator& rhs) 
+    {
+        return lhs.p_ == rhs.p_; 
+    }
+
+    friend bool operator!=(const typed_array_iterator& lhs, const typed_array_iterator& rhs) 
+    {
+        return lhs.p_ != rhs.p_; 
+    }
+
+    friend bool operator<(const typed_array_iterator& lhs, const typed_array_iterator& rhs) 
+    {
+        return lhs.p_ < rhs.p_; 
+    }
+private:
+    T get(std::true_type) const
+    {
+        return static_cast<T>(get_typed_array_double(p_, tag_));
+    }
+
+    T get(std::false_type) const
+    {
+        return is_signed_typed_array_tag(tag_) ? static_cast<T>(get_typed_array_int64(p_, tag_)) 
+                                               : static_cast<T>(get_typed_array_uint64(p_, tag_));
+    }
+};
+
+// Copies the elements of a typed array to v, with a single memcpy if they 
+// are stored as T in the host's byte order
+template <class T>
+void copy_typed_array(typed_array_iterator<T> first, typed_array_iterator<T> last, std::vector<T>& v)
+{
+    size_t count = static_cast<size_t>(last - first);
+    if (is_native_typed_array_tag<T>(first.tag()))
+    {
+        v.resize(count);
+        if (count > 0)
+        {
+            memcpy(v.data(), first.data(), count*sizeof(T));
+        }
+    }
+    else
+    {
+        v.assign(first, last);
+    }
+}
+
+template <class T>
+class const_array_iterator
+{
+    const uint8_t* p_;
+    const uint8_t* last_;
+    const uint8_t* base_relative_;
+    T current_;
+public:
+    typedef typename T::difference_type difference_type;
+    typedef typename T::value_type value_type;
+    typedef typename T::const_reference reference;
+    typedef typename T::const_pointer pointer;
+    typedef std::forward_iterator_tag iterator_catagory;
+
+    const_array_iterator()
+        : p_(nullptr), last_(nullptr), base_relative_(nullptr)
+    {
+    }
+
+    const_array_iterator(const uint8_t* p, const uint8_t* last, const uint8_t* base_relative)
+        : p_(p), last_(last), base_relative_(base_relative)
+    {
+    }
+
+    const_array_iterator(const const_array_iterator& other) = default;
+
+    friend bool operator==(const const_array_iterator& lhs, const const_array_iterator& rhs) 
+    {
+        return lhs.p_ == rhs.p_; 
+    }
+
+    friend bool operator!=(const const_array_iterator& lhs, const const_array_iterator& rhs) 
+    {
+        return lhs.p_ != rhs.p_; 
+    }
+
+    friend bool operator<(const const_array_iterator& lhs, const const_array_iterator& rhs) 
+    {
+        return lhs.p_ == rhs.p_; 
+    }
+
+    const_array_iterator& operator++()
+    {
+        detail::walk(p_, last_, &p_);
+        return *this;
+    }
+
+    const_array_iterator operator++(int) // postfix increment
+    {
+        const_array_iterator temp(*this);
+        detail::walk(p_, last_, &p_);
+        return temp;
+    }
+
+    reference operator*() const
+    {
+        const uint8_t* endp;
+        detail::walk(p_, last_, &endp);
+        const_cast<T*>(&current_)->first_ = p_;
+        const_cast<T*>(&current_)->last_ = endp;
+        const_cast<T*>(&current_)->base_relative_ = base_relative_;
+        return current_;
+    }
+
+    pointer operator->() const
+    {
+        const uint8_t* endp;
+        detail::walk(p_, last_, &endp);
+        const_cast<T*>(&current_)->first_ = p_;
+        const_cast<T*>(&current_)->last_ = endp;
+        const_cast<T*>(&current_)->base_relative_ = base_relative_;
+        return &current_;
+    }
+};
+
+template <class T>
+class const_object_iterator;
+
+template <class T>
+class key_value_pair_view
+{
+    const uint8_t* key_begin_;
+    const uint8_t* key_end_;
+    const uint8_t* val_begin_;
+    const uint8_t* val_end_;
+    const uint8_t* base_relative_;
+
+public:
+    friend class const_object_iterator<T>;
+
+    key_value_pair_view()
+        : key_begin_(nullptr), key_end_(nullptr), val_begin_(nullptr), val_end_(nullptr)
+    {
+    }
+    key_value_pair_view(const uint8_t* key_begin, const uint8_t* key_end, 
+                        const uint8_t* val_begin, const uint8_t* val_end, 
+                        const uint8_t* base_relative)
+        : key_begin_(key_begin), key_end_(key_end), val_begin_(val_begin), val_end_(val_end), 
+          base_relative_(base_relative)
+    {
+    }
+    key_value_pair_view(const key_value_pair_view& other) = default;
+
+    std::string key() const
+    {
+        if (key_begin_ < key_end_ && get_major_type(*key_begin_) == cbor_major_type::semantic_tag)
+        {
+            return T(key_begin_, key_end_ - key_begin_, base_relative_).as_string();
+        }
+        const uint8_t* endp;
+        return get_text_string(key_begin_, key_end_, &endp);
+    }
+
+    T value() const
+    {
+        return T(val_begin_, val_end_ - val_begin_, base_relative_);
+    }
+};
+
+template <class T>
+class const_object_iterator
+{
+    const uint8_t* p_;
+    const uint8_t* last_;
+    const uint8_t* base_relative_;
+    key_value_pair_view<T> kvpair_;
+public:
+    typedef typename T::difference_type difference_type;
+    typedef key_value_pair_view<T> value_type;
+    typedef const key_value_pair_view<T>& reference;
+    typedef const key_value_pair_view<T>* pointer;
+    typedef std::forward_iterator_tag iterator_catagory;
+
+    const_object_iterator()
+        : p_(nullptr), last_(nullptr), base_relative_(nullptr)
     {
     }
 
@@ -1509,24 +2076,98 @@ std::string get_decimal_as_string(const uint8_t* first, const uint8_t* last,
 
 } // namespace detail
 
+// cbor_parser reports the data items in its input to a json_content_handler.
+// Each call to parse_some reports the next complete top level data item, or 
+// stops early if the handler returns false. If the input ends first, 
+// parse_some fails with cbor_parse_errc::unexpected_eof, having consumed only
+// the data items it reported. The parser keeps its place in any open arrays 
+// and maps, so after update is called with the rest of the input, beginning 
+// with the remaining() unconsumed bytes, parse_some carries on from where it 
+// stopped. Strings are passed to the handler as views into the input where 
+// they are contiguous, and are valid until the next call to the parser.
+//
+// Stringrefs (tag 25) are resolved against the strings of the enclosing 
+// namespace (tag 256), which are kept in one buffer that is reused from one
+// namespace to the next.
+
 class cbor_parser : public serializing_context
 {
+    struct parse_state 
+    {
+        bool is_object;
+        bool is_indefinite_length;
+        bool expect_name;
+        size_t remaining;
+        uint8_t typed_array_tag;
+
+        parse_state(bool object, bool indefinite_length, size_t length)
+            : is_object(object), is_indefinite_length(indefinite_length),
+              expect_name(object), remaining(length), typed_array_tag(0)
+        {
+        }
+    };
+
+    struct stringref_entry
+    {
+        bool is_text;
+        size_t offset;
+        size_t length;
+
+        stringref_entry(bool text, size_t data_offset, size_t data_length)
+            : is_text(text), offset(data_offset), length(data_length)
+        {
+        }
+    };
+
+    struct stringref_namespace
+    {
+        size_t depth;
+        size_t first_entry;
+        size_t first_data;
+
+        stringref_namespace(size_t state_depth, size_t entry_count, size_t data_length)
+            : depth(state_depth), first_entry(entry_count), first_data(data_length)
+        {
+        }
+    };
+
     const uint8_t* begin_input_;
     const uint8_t* end_input_;
     const uint8_t* input_ptr_;
     json_content_handler& handler_;
+    size_t offset_;
     size_t column_;
-    size_t nesting_depth_;
+    bool continue_;
+    std::vector<parse_state> state_stack_;
+    size_t skip_depth_;
+    uint64_t skip_length_;
+    bool skip_stringref_;
+    std::string text_buffer_;
+    std::vector<uint8_t> bytes_buffer_;
+    std::vector<stringref_namespace> namespaces_;
+    std::vector<stringref_entry> stringrefs_;
+    std::vector<uint8_t> stringref_data_;
+    std::vector<uint8_t> typed_array_data_;
+    size_t typed_array_index_;
 public:
     cbor_parser(json_content_handler& handler)
-       : handler_(handler), 
+       : begin_input_(nullptr),
+         end_input_(nullptr),
+         input_ptr_(nullptr),
+         handler_(handler), 
+         offset_(0),
          column_(1),
-         nesting_depth_(0)
+         continue_(true),
+         skip_depth_(0),
+         skip_length_(0),
+         skip_stringref_(false),
+         typed_array_index_(0)
     {
     }
 
     void update(const uint8_t* input, size_t length)
     {
+        offset_ += input_ptr_ - begin_input_;
         begin_input_ = input;
         end_input_ = input + length;
         input_ptr_ = begin_input_;
@@ -1535,458 +2176,879 @@ public:
     void reset()
     {
         column_ = 1;
-        nesting_depth_ = 0;
+        continue_ = true;
+        state_stack_.clear();
+        skip_depth_ = 0;
+        skip_length_ = 0;
+        skip_stringref_ = false;
+        namespaces_.clear();
+        stringrefs_.clear();
+        stringref_data_.clear();
     }
 
-    void parse_some(std::error_code& ec)
+    void restart()
     {
-        bool has_semantic_tag = false;
-        uint8_t semantic_tag = 0;
+        continue_ = true;
+    }
 
-        if (get_major_type(*input_ptr_) == cbor_major_type::semantic_tag)
-        {
-            has_semantic_tag = true;
-            semantic_tag = get_additional_information_value(*input_ptr_);
-            if (semantic_tag == 4)
-            {
-                const uint8_t* endp;
-                std::string s = cbor::detail::get_decimal_as_string(input_ptr_,end_input_,&endp);
-                if (endp == input_ptr_)
-                {
-                    ec = cbor_parse_errc::unexpected_eof;
-                    return;
-                }
-                handler_.string_value(s, semantic_tag_type::decimal);
-                input_ptr_ = endp;
-                return;
-            }
-            else
-            {
-                input_ptr_++;
-            }
-        }
+    bool stopped() const
+    {
+        return !continue_;
+    }
+
+    // Returns true if no data item is partly parsed
+    bool done() const
+    {
+        return state_stack_.empty();
+    }
 
-        const uint8_t* pos = input_ptr_++;
+    // Returns the number of bytes of the current input not yet consumed
+    size_t remaining() const
+    {
+        return end_input_ - input_ptr_;
+    }
 
-        switch (get_major_type(*pos))
+    void parse_some(std::error_code& ec)
+    {
+        do
         {
-            case cbor_major_type::unsigned_integer:
+            if (!state_stack_.empty())
             {
-                const uint8_t* endp;
-                uint64_t val = detail::get_uint64_value(pos,end_input_,&endp);
-                if (endp == pos)
+                parse_state& state = state_stack_.back();
+                if (state.typed_array_tag != 0)
                 {
-                    ec = cbor_parse_errc::unexpected_eof;
-                    return;
+                    if (state.remaining == 0)
+                    {
+                        end_container();
+                    }
+                    else
+                    {
+                        parse_typed_array_element(state);
+                    }
+                    continue;
                 }
-                input_ptr_ = endp;
-
-                if (has_semantic_tag && semantic_tag == 1)
+                if (state.is_indefinite_length)
                 {
-                    handler_.uint64_value(val, semantic_tag_type::epoch_time, *this);
+                    if (input_ptr_ >= end_input_)
+                    {
+                        ec = cbor_parse_errc::unexpected_eof;
+                        return;
+                    }
+                    if (*input_ptr_ == 0xff)
+                    {
+                        if (state.is_object && !state.expect_name)
+                        {
+                            ec = cbor_parse_errc::source_error;
+                            return;
+                        }
+                        ++input_ptr_;
+                        end_container();
+                        continue;
+                    }
                 }
-                else
+                else if (state.remaining == 0)
                 {
-                    handler_.uint64_value(val, semantic_tag_type::none, *this);
+                    end_container();
+                    continue;
+                }
+                if (state.expect_name)
+                {
+                    parse_name(ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    state_stack_.back().expect_name = false;
+                    continue;
                 }
-                break;
             }
-            case cbor_major_type::negative_integer:
+
+            size_t parent = state_stack_.size();
+            parse_item(ec);
+            if (ec)
+            {
+                return;
+            }
+            if (parent > 0)
             {
-                const uint8_t* endp;
-                int64_t val = detail::get_int64_value(pos,end_input_,&endp);
-                if (endp == pos)
+                parse_state& state = state_stack_[parent-1];
+                if (!state.is_indefinite_length)
                 {
-                    ec = cbor_parse_errc::unexpected_eof;
-                    return;
+                    --state.remaining;
                 }
-                input_ptr_ = endp;
-                if (has_semantic_tag && semantic_tag == 1)
+                state.expect_name = state.is_object;
+            }
+        }
+        while (!state_stack_.empty() && continue_);
+
+        if (state_stack_.empty())
+        {
+            handler_.flush();
+        }
+    }
+
+    // Skips the rest of the innermost open array or map, including its end,
+    // without reporting its contents. Strings are skipped over using their 
+    // lengths, and need not be in the input all at once. If the input ends 
+    // first, fails with cbor_parse_errc::unexpected_eof, and carries on from 
+    // where it stopped when called again after update.
+    void skip_container(std::error_code& ec)
+    {
+        if (skip_depth_ == 0)
+        {
+            if (state_stack_.empty())
+            {
+                return;
+            }
+            skip_depth_ = state_stack_.size();
+        }
+        while (state_stack_.size() >= skip_depth_)
+        {
+            if (skip_length_ > 0)
+            {
+                size_t n = static_cast<size_t>((std::min)(skip_length_, static_cast<uint64_t>(end_input_ - input_ptr_)));
+                if (skip_stringref_)
                 {
-                    handler_.int64_value(val, semantic_tag_type::epoch_time, *this);
+                    stringref_data_.insert(stringref_data_.end(), input_ptr_, input_ptr_ + n);
                 }
-                else 
+                input_ptr_ += n;
+                skip_length_ -= n;
+                if (skip_length_ > 0)
                 {
-                    handler_.int64_value(val, semantic_tag_type::none, *this);
+                    ec = cbor_parse_errc::unexpected_eof;
+                    return;
                 }
-                break;
+                skip_stringref_ = false;
+                continue;
             }
-            case cbor_major_type::byte_string:
+
+            parse_state& state = state_stack_.back();
+            if (state.typed_array_tag != 0)
             {
-                const uint8_t* endp;
-                std::vector<uint8_t> v = detail::get_byte_string(pos,end_input_,&endp);
-                if (endp == pos)
+                // The elements are already consumed
+                pop_state();
+                continue;
+            }
+            if (state.is_indefinite_length)
+            {
+                if (input_ptr_ >= end_input_)
                 {
                     ec = cbor_parse_errc::unexpected_eof;
                     return;
                 }
-                input_ptr_ = endp;
-
-                if (has_semantic_tag)
+                if (*input_ptr_ == 0xff)
                 {
-                    if (semantic_tag == 2)
-                    {
-                        handler_.bignum_value(1, v.data(), v.size(), *this);
-                    }
-                    else if (semantic_tag == 3)
-                    {
-                        handler_.bignum_value(-1, v.data(), v.size(), *this);
-                    }
-                    else
+                    if (state.is_object && !state.expect_name)
                     {
-                        handler_.byte_string_value(v.data(), v.size(), semantic_tag_type::none, *this);
+                        ec = cbor_parse_errc::source_error;
+                        return;
                     }
+                    ++input_ptr_;
+                    pop_state();
+                    continue;
                 }
-                else
-                {
-                    handler_.byte_string_value(v.data(), v.size(), semantic_tag_type::none, *this);
-                }
-                break;
             }
-            case cbor_major_type::text_string:
+            else if (state.remaining == 0)
+            {
+                pop_state();
+                continue;
+            }
+
+            // Find the header of the next item, past any tags
+            const uint8_t* pos = input_ptr_;
+            uint64_t val;
+            bool is_namespace = false;
+            while (pos < end_input_ && get_major_type(*pos) == cbor_major_type::semantic_tag)
             {
-                const uint8_t* endp;
-                std::string s = detail::get_text_string(pos,end_input_,&endp);
-                if (endp == pos)
+                if (!read_argument(pos, val, &pos, ec))
                 {
-                    ec = cbor_parse_errc::unexpected_eof;
                     return;
                 }
-                input_ptr_ = endp;
-                if (has_semantic_tag && semantic_tag == 0)
+                if (val == 256)
                 {
-                    handler_.string_value(basic_string_view<char>(s.data(),s.length()), semantic_tag_type::date_time, *this);
+                    is_namespace = true;
                 }
-                else
+            }
+            if (pos >= end_input_)
+            {
+                ec = cbor_parse_errc::unexpected_eof;
+                return;
+            }
+            const uint8_t* endp;
+            cbor_major_type major_type = get_major_type(*pos);
+            bool is_indefinite_length = get_additional_information_value(*pos) == additional_information::indefinite_length;
+            if (!is_indefinite_length && 
+                (major_type == cbor_major_type::byte_string || major_type == cbor_major_type::text_string ||
+                 major_type == cbor_major_type::array || major_type == cbor_major_type::map))
+            {
+                if (!read_argument(pos, val, &endp, ec))
                 {
-                    handler_.string_value(basic_string_view<char>(s.data(),s.length()), semantic_tag_type::none, *this);
+                    return;
                 }
-                break;
             }
-            case cbor_major_type::array:
+            else if (!find_item_end(pos, &endp, ec))
             {
-                size_t info = get_additional_information_value(*pos);
-                switch (info)
+                return;
+            }
+            input_ptr_ = endp;
+
+            if (state.expect_name)
+            {
+                state.expect_name = false;
+            }
+            else
+            {
+                if (!state.is_indefinite_length)
                 {
-                    case JSONCONS_CBOR_0x00_0x17: // Integer 0x00..0x17 (0..23)
+                    --state.remaining;
+                }
+                state.expect_name = state.is_object;
+            }
+
+            switch (major_type)
+            {
+                case cbor_major_type::byte_string:
+                case cbor_major_type::text_string:
+                    if (!is_indefinite_length)
                     {
-                        parse_array(info, ec);
-                        if (ec)
+                        skip_length_ = val;
+                        if (!is_namespace && is_stringref_candidate(static_cast<size_t>(val)))
                         {
-                            return;
+                            // The string is copied as it is skipped
+                            stringrefs_.push_back(stringref_entry(major_type == cbor_major_type::text_string, 
+                                                                  stringref_data_.size(), static_cast<size_t>(val)));
+                            skip_stringref_ = val > 0;
                         }
-                        break;
                     }
-                    case 0x18:
+                    break;
+                case cbor_major_type::array:
+                    state_stack_.push_back(parse_state(false, is_indefinite_length, static_cast<size_t>(val)));
+                    if (is_namespace)
                     {
-                        const uint8_t* endp;
-                        const auto len = binary::from_big_endian<uint8_t>(input_ptr_,end_input_,&endp);
-                        if (endp == input_ptr_)
-                        {
-                            ec = cbor_parse_errc::unexpected_eof;
-                            return;
-                        }
-                        input_ptr_ = endp;
-                        parse_array(len, ec);
-                        if (ec)
-                        {
-                            return;
-                        }
-                        break;
+                        begin_namespace();
                     }
-                    case 0x19:
+                    break;
+                case cbor_major_type::map:
+                    state_stack_.push_back(parse_state(true, is_indefinite_length, static_cast<size_t>(val)));
+                    if (is_namespace)
                     {
-                        const uint8_t* endp;
-                        const auto len = binary::from_big_endian<uint16_t>(input_ptr_,end_input_,&endp);
-                        if (endp == input_ptr_)
-                        {
-                            ec = cbor_parse_errc::unexpected_eof;
-                            return;
-                        }
-                        input_ptr_ = endp;
-                        parse_array(len, ec);
-                        if (ec)
-                        {
-                            return;
-                        }
-                        break;
+                        begin_namespace();
                     }
-                    case 0x20:
+                    break;
+                default:
+                    break;
+            }
+        }
+        skip_depth_ = 0;
+    }
+
+    size_t line_number() const override
+    {
+        return 1;
+    }
+
+    size_t column_number() const override
+    {
+        return column_;
+    }
+private:
+    void end_container()
+    {
+        if (state_stack_.back().is_object)
+        {
+            continue_ = handler_.end_object(*this);
+        }
+        else
+        {
+            continue_ = handler_.end_array(*this);
+        }
+        pop_state();
+    }
+
+    // Reports the next element of the typed array on top of the stack
+    void parse_typed_array_element(parse_state& state)
+    {
+        uint64_t tag = state.typed_array_tag;
+        const uint8_t* p = typed_array_data_.data() + typed_array_index_*detail::typed_array_element_size(tag);
+        ++typed_array_index_;
+        --state.remaining;
+        if (detail::is_float_typed_array_tag(tag))
+        {
+            continue_ = handler_.double_value(detail::get_typed_array_double(p, tag), floating_point_options(), semantic_tag_type::none, *this);
+        }
+        else if (detail::is_signed_typed_array_tag(tag))
+        {
+            continue_ = handler_.int64_value(detail::get_typed_array_int64(p, tag), semantic_tag_type::none, *this);
+        }
+        else
+        {
+            continue_ = handler_.uint64_value(detail::get_typed_array_uint64(p, tag), semantic_tag_type::none, *this);
+        }
+    }
+
+    void pop_state()
+    {
+        state_stack_.pop_back();
+        if (!namespaces_.empty() && namespaces_.back().depth > state_stack_.size())
+        {
+            const stringref_namespace& ns = namespaces_.back();
+            stringrefs_.erase(stringrefs_.begin() + ns.first_entry, stringrefs_.end());
+            stringref_data_.erase(stringref_data_.begin() + ns.first_data, stringref_data_.end());
+            namespaces_.pop_back();
+        }
+    }
+
+    // Begins a namespace for the array or map on top of the stack
+    void begin_namespace()
+    {
+        namespaces_.push_back(stringref_namespace(state_stack_.size(), stringrefs_.size(), stringref_data_.size()));
+    }
+
+    // Returns true if a string of this length is assigned the next stringref 
+    // in the current namespace
+    bool is_stringref_candidate(size_t length) const
+    {
+        return !namespaces_.empty() && 
+               length >= detail::min_stringref_length(stringrefs_.size() - namespaces_.back().first_entry);
+    }
+
+    void add_stringref(bool is_text, const uint8_t* data, size_t length)
+    {
+        if (is_stringref_candidate(length))
+        {
+            stringrefs_.push_back(stringref_entry(is_text, stringref_data_.size(), length));
+            stringref_data_.insert(stringref_data_.end(), data, data + length);
+        }
+    }
+
+    // Finds the string that the stringref at pos, an unsigned integer, refers to
+    bool get_stringref(const uint8_t* pos, bool& is_text, const uint8_t** data, size_t& length, std::error_code& ec) const
+    {
+        uint64_t index;
+        const uint8_t* q;
+        if (get_major_type(*pos) != cbor_major_type::unsigned_integer || !read_argument(pos, index, &q, ec) ||
+            namespaces_.empty() || index >= stringrefs_.size() - namespaces_.back().first_entry)
+        {
+            ec = cbor_parse_errc::source_error;
+            return false;
+        }
+        const stringref_entry& entry = stringrefs_[namespaces_.back().first_entry + static_cast<size_t>(index)];
+        is_text = entry.is_text;
+        *data = stringref_data_.data() + entry.offset;
+        length = entry.length;
+        return true;
+    }
+
+    // Reads the argument that follows the initial byte at p
+    bool read_argument(const uint8_t* p, uint64_t& val, const uint8_t** endp, std::error_code& ec) const
+    {
+        const uint8_t* q = p + 1;
+        uint8_t info = get_additional_information_value(*p);
+        size_t length = 0;
+        switch (info)
+        {
+            case JSONCONS_CBOR_0x00_0x17: // 0x00..0x17 (0..23)
+                val = info;
+                *endp = q;
+                return true;
+            case 0x18:
+                length = 1;
+                break;
+            case 0x19:
+                length = 2;
+                break;
+            case 0x1a:
+                length = 4;
+                break;
+            case 0x1b:
+                length = 8;
+                break;
+            case additional_information::indefinite_length:
+                val = 0;
+                *endp = q;
+                return true;
+            default:
+                ec = cbor_parse_errc::source_error;
+                return false;
+        }
+        if (static_cast<size_t>(end_input_ - q) < length)
+        {
+            ec = cbor_parse_errc::unexpected_eof;
+            return false;
+        }
+        val = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            val = (val << 8) | q[i];
+        }
+        *endp = q + length;
+        return true;
+    }
+
+    // Finds the end of the data item at p, or of its header if it is an array or map 
+    bool find_item_end(const uint8_t* p, const uint8_t** endp, std::error_code& ec) const
+    {
+        if (p >= end_input_)
+        {
+            ec = cbor_parse_errc::unexpected_eof;
+            return false;
+        }
+        uint8_t info = get_additional_information_value(*p);
+        uint64_t val;
+        const uint8_t* q;
+        switch (get_major_type(*p))
+        {
+            case cbor_major_type::unsigned_integer:
+            case cbor_major_type::negative_integer:
+                if (info == additional_information::indefinite_length)
+                {
+                    ec = cbor_parse_errc::source_error;
+                    return false;
+                }
+                return read_argument(p, val, endp, ec);
+            case cbor_major_type::array:
+            case cbor_major_type::map:
+                return read_argument(p, val, endp, ec);
+            case cbor_major_type::byte_string:
+            case cbor_major_type::text_string:
+                if (info == additional_information::indefinite_length)
+                {
+                    q = p + 1;
+                    while (true)
                     {
-                        const uint8_t* endp;
-                        const auto len = binary::from_big_endian<uint32_t>(input_ptr_,end_input_,&endp);
-                        if (endp == input_ptr_)
+                        if (q >= end_input_)
                         {
                             ec = cbor_parse_errc::unexpected_eof;
-                            return;
+                            return false;
                         }
-                        input_ptr_ = endp;
-                        parse_array(len, ec);
-                        if (ec)
+                        if (*q == 0xff)
                         {
-                            return;
+                            break;
                         }
-                        break;
-                    }
-                    case 0x21:
-                    {
-                        const uint8_t* endp;
-                        size_t len = (size_t)binary::from_big_endian<uint64_t>(input_ptr_,end_input_,&endp);
-                        if (endp == input_ptr_)
+                        if (get_major_type(*q) != get_major_type(*p) || 
+                            get_additional_information_value(*q) == additional_information::indefinite_length)
                         {
-                            ec = cbor_parse_errc::unexpected_eof;
-                            return;
-                        }
-                        input_ptr_ = endp;
-                        parse_array(len, ec);
-                        if (ec)
-                        {
-                            return;
+                            ec = cbor_parse_errc::source_error;
+                            return false;
                         }
-                        break;
-                    }
-                    case 31:
-                    {
-                        ++nesting_depth_;
-                        handler_.begin_array(*this);
-                        while (*input_ptr_ != 0xff)
+                        if (!find_item_end(q, &q, ec))
                         {
-                            parse_some(ec);
-                            if (ec)
-                            {
-                                return;
-                            }
-                            pos = input_ptr_;
+                            return false;
                         }
-                        handler_.end_array(*this);
-                        --nesting_depth_;
-                        break;
                     }
+                    *endp = q + 1;
+                    return true;
                 }
-                break;
-            }
-            case cbor_major_type::map:
+                if (!read_argument(p, val, &q, ec))
+                {
+                    return false;
+                }
+                if (static_cast<uint64_t>(end_input_ - q) < val)
+                {
+                    ec = cbor_parse_errc::unexpected_eof;
+                    return false;
+                }
+                *endp = q + static_cast<size_t>(val);
+                return true;
+            case cbor_major_type::semantic_tag:
+                if (info == additional_information::indefinite_length)
+                {
+                    ec = cbor_parse_errc::source_error;
+                    return false;
+                }
+                if (!read_argument(p, val, &q, ec))
+                {
+                    return false;
+                }
+                return find_item_end(q, endp, ec);
+            case cbor_major_type::simple:
             {
-                size_t info = get_additional_information_value(*pos);
+                size_t length;
                 switch (info)
                 {
-                    case JSONCONS_CBOR_0x00_0x17: // Integer 0x00..0x17 (0..23)
-                    {
-                        parse_object(info, ec);
-                        if (ec)
-                        {
-                            return;
-                        }
-                        break;
-                    }
                     case 0x18:
-                    {
-                        const uint8_t* endp;
-                        const auto len = binary::from_big_endian<uint8_t>(input_ptr_,end_input_,&endp);
-                        if (endp == input_ptr_)
-                        {
-                            ec = cbor_parse_errc::unexpected_eof;
-                            return;
-                        }
-                        input_ptr_ = endp;
-                        parse_object(len, ec);
-                        if (ec)
-                        {
-                            return;
-                        }
+                        length = 1;
                         break;
-                    }
                     case 0x19:
-                    {
-                        const uint8_t* endp;
-                        const auto len = binary::from_big_endian<uint16_t>(input_ptr_,end_input_,&endp);
-                        if (endp == input_ptr_)
-                        {
-                            ec = cbor_parse_errc::unexpected_eof;
-                            return;
-                        }
-                        input_ptr_ = endp;
-                        parse_object(len, ec);
-                        if (ec)
-                        {
-                            return;
-                        }
+                        length = 2;
                         break;
-                    }
-                    case 0x20:
-                    {
-                        const uint8_t* endp;
-                        const auto len = binary::from_big_endian<uint32_t>(input_ptr_,end_input_,&endp);
-                        if (endp == input_ptr_)
-                        {
-                            ec = cbor_parse_errc::unexpected_eof;
-                            return;
-                        }
-                        input_ptr_ = endp;
-                        parse_object(len, ec);
-                        if (ec)
-                        {
-                            return;
-                        }
+                    case 0x1a:
+                        length = 4;
                         break;
-                    }
-                    case 0x21:
-                    {
-                        const uint8_t* endp;
-                        size_t len = (size_t)binary::from_big_endian<uint64_t>(input_ptr_,end_input_,&endp);
-                        if (endp == input_ptr_)
-                        {
-                            ec = cbor_parse_errc::unexpected_eof;
-                            return;
-                        }
-                        input_ptr_ = endp;
-                        parse_object(len, ec);
-                        if (ec)
-                        {
-                            return;
-                        }
+                    case 0x1b:
+                        length = 8;
                         break;
-                    }
-                    case 31:
-                    {
-                        ++nesting_depth_;
-                        handler_.begin_object(*this);
-                        while (*input_ptr_ != 0xff)
+                    default:
+                        if (info > 0x1b)
                         {
-                            parse_name(ec);
-                            if (ec)
-                            {
-                                return;
-                            }
-                            parse_some(ec);
-                            if (ec)
-                            {
-                                return;
-                            }
-                            pos = input_ptr_;
+                            ec = cbor_parse_errc::source_error;
+                            return false;
                         }
-                        handler_.end_object(*this);
-                        --nesting_depth_;
+                        length = 0;
                         break;
-                    }
                 }
-                break;
+                if (static_cast<size_t>(end_input_ - (p + 1)) < length)
+                {
+                    ec = cbor_parse_errc::unexpected_eof;
+                    return false;
+                }
+                *endp = p + 1 + length;
+                return true;
             }
-            case cbor_major_type::semantic_tag:
+            default:
+                ec = cbor_parse_errc::source_error;
+                return false;
+        }
+    }
+
+    void parse_name(std::error_code& ec)
+    {
+        const uint8_t* endp;
+        if (!find_item_end(input_ptr_, &endp, ec))
+        {
+            return;
+        }
+        column_ = offset_ + (input_ptr_ - begin_input_) + 1;
+        const uint8_t* pos = input_ptr_;
+        if (*pos == 0xd8 && pos + 1 < endp && pos[1] == 25)
+        {
+            bool is_text;
+            const uint8_t* data;
+            size_t length;
+            if (!get_stringref(pos + 2, is_text, &data, length, ec))
             {
-                break;
+                return;
             }
-            case cbor_major_type::simple:
+            if (!is_text)
             {
-                size_t info = get_additional_information_value(*pos);
-                switch (info)
-                {
-                    case 20:
-                        handler_.bool_value(false, *this);
-                        break;
-                    case 21:
-                        handler_.bool_value(true, *this);
-                        break;
-                    case 22:
-                        handler_.null_value(*this);
-                        break;
-                    case 25: // Half-Precision Float (two-byte IEEE 754)
-                    case 26: // Single-Precision Float (four-byte IEEE 754)
-                    case 27: // Double-Precision Float (eight-byte IEEE 754)
-                        const uint8_t* endp;
-                        double val = detail::get_double(pos,end_input_,&endp);
-                        if (endp == pos)
-                        {
-                            ec = cbor_parse_errc::unexpected_eof;
-                            return;
-                        }
-                        input_ptr_ = endp;
-                        if (has_semantic_tag && semantic_tag == 1)
-                        {
-                            handler_.double_value(val, floating_point_options(), semantic_tag_type::epoch_time, *this);
-                        }
-                        else
-                        {
-                            handler_.double_value(val, floating_point_options(), semantic_tag_type::none, *this);
-                        }
-                        break;
-                }
-                break;
+                ec = cbor_parse_errc::source_error;
+                return;
             }
+            input_ptr_ = endp;
+            continue_ = handler_.name(basic_string_view<char>(reinterpret_cast<const char*>(data),length), *this);
+            return;
         }
-        if (nesting_depth_ == 0)
+        if (get_major_type(*pos) != cbor_major_type::text_string)
         {
-            handler_.flush();
+            ec = cbor_parse_errc::source_error;
+            return;
         }
+        basic_string_view<char> s = get_text_string(pos, endp);
+        if (get_additional_information_value(*pos) != additional_information::indefinite_length)
+        {
+            add_stringref(true, reinterpret_cast<const uint8_t*>(s.data()), s.length());
+        }
+        input_ptr_ = endp;
+        continue_ = handler_.name(s, *this);
     }
 
-    size_t line_number() const override
+    // Returns a view of the text string at pos, in the input if it is contiguous
+    basic_string_view<char> get_text_string(const uint8_t* pos, const uint8_t* endp)
     {
-        return 1;
+        const uint8_t* q;
+        if (get_additional_information_value(*pos) == additional_information::indefinite_length)
+        {
+            text_buffer_ = detail::get_text_string(pos,endp,&q);
+            return basic_string_view<char>(text_buffer_.data(),text_buffer_.length());
+        }
+        uint64_t length = 0;
+        std::error_code ec;
+        read_argument(pos, length, &q, ec);
+        return basic_string_view<char>(reinterpret_cast<const char*>(q),static_cast<size_t>(length));
     }
 
-    size_t column_number() const override
+    const uint8_t* get_byte_string(const uint8_t* pos, const uint8_t* endp, size_t* length)
     {
-        return column_;
+        const uint8_t* q;
+        if (get_additional_information_value(*pos) == additional_information::indefinite_length)
+        {
+            bytes_buffer_ = detail::get_byte_string(pos,endp,&q);
+            *length = bytes_buffer_.size();
+            return bytes_buffer_.data();
+        }
+        uint64_t len = 0;
+        std::error_code ec;
+        read_argument(pos, len, &q, ec);
+        *length = static_cast<size_t>(len);
+        return q;
     }
-private:
-    void parse_name(std::error_code& ec)
+
+    // Reports the data item at the input position, or begins the array or map there
+    void parse_item(std::error_code& ec)
     {
-        const uint8_t* pos = input_ptr_++;
-        if (get_major_type(*pos) == cbor_major_type::text_string)
+        const uint8_t* endp;
+        if (!find_item_end(input_ptr_, &endp, ec))
         {
-            const uint8_t* endp;
-            std::string s = detail::get_text_string(pos,end_input_,&endp);
-            if (endp == pos)
+            return;
+        }
+        column_ = offset_ + (input_ptr_ - begin_input_) + 1;
+
+        bool has_semantic_tag = false;
+        uint64_t semantic_tag = 0;
+        bool is_stringref = false;
+        bool is_namespace = false;
+        const uint8_t* tag_ptr = input_ptr_;
+        const uint8_t* pos = input_ptr_;
+        while (get_major_type(*pos) == cbor_major_type::semantic_tag)
+        {
+            const uint8_t* q = pos;
+            uint64_t tag = 0;
+            read_argument(pos, tag, &pos, ec);
+            switch (tag)
+            {
+                case 25:
+                    is_stringref = true;
+                    break;
+                case 256:
+                    is_namespace = true;
+                    break;
+                default:
+                    has_semantic_tag = true;
+                    semantic_tag = tag;
+                    tag_ptr = q;
+                    break;
+            }
+        }
+
+        if (is_stringref)
+        {
+            bool is_text;
+            const uint8_t* data;
+            size_t length;
+            if (!get_stringref(pos, is_text, &data, length, ec))
             {
-                ec = cbor_parse_errc::unexpected_eof;
                 return;
             }
             input_ptr_ = endp;
-            handler_.name(basic_string_view<char>(s.data(),s.length()), *this);
-        }
-        else
-        {
-            ec = cbor_parse_errc::source_error;
+            if (is_text)
+            {
+                basic_string_view<char> s(reinterpret_cast<const char*>(data),length);
+                continue_ = handler_.string_value(s, has_semantic_tag && semantic_tag == 0 ? semantic_tag_type::date_time : semantic_tag_type::none, *this);
+            }
+            else if (has_semantic_tag && (semantic_tag == 2 || semantic_tag == 3))
+            {
+                continue_ = handler_.bignum_value(semantic_tag == 2 ? 1 : -1, data, length, *this);
+            }
+            else
+            {
+                continue_ = handler_.byte_string_value(data, length, semantic_tag_type::none, *this);
+            }
             return;
         }
-    }
 
-    void parse_array(size_t len, std::error_code& ec)
-    {
-        ++nesting_depth_;
-        handler_.begin_array(len, *this);
-        for (size_t i = 0; i < len; ++i)
+        if (has_semantic_tag && semantic_tag == 4)
         {
-            parse_some(ec);
-            if (ec)
+            // A decimal fraction is an array of exponent and mantissa
+            if (*pos != 0x82 || !find_item_end(pos + 1, &endp, ec) || !find_item_end(endp, &endp, ec))
             {
+                if (!ec)
+                {
+                    ec = cbor_parse_errc::source_error;
+                }
                 return;
             }
+            const uint8_t* q;
+            text_buffer_ = detail::get_decimal_as_string(tag_ptr,endp,&q);
+            if (!namespaces_.empty())
+            {
+                // A bignum mantissa is counted among the strings of the namespace
+                const uint8_t* mantissa;
+                find_item_end(pos + 1, &mantissa, ec);
+                while (get_major_type(*mantissa) == cbor_major_type::semantic_tag)
+                {
+                    uint64_t tag;
+                    read_argument(mantissa, tag, &mantissa, ec);
+                }
+                if (get_major_type(*mantissa) == cbor_major_type::byte_string && 
+                    get_additional_information_value(*mantissa) != additional_information::indefinite_length)
+                {
+                    size_t length;
+                    const uint8_t* data = get_byte_string(mantissa, endp, &length);
+                    add_stringref(false, data, length);
+                }
+            }
+            input_ptr_ = endp;
+            continue_ = handler_.string_value(text_buffer_, semantic_tag_type::decimal, *this);
+            return;
         }
-        handler_.end_array(*this);
-        --nesting_depth_;
-    }
 
-    void parse_object(size_t len, std::error_code& ec)
-    {
-        ++nesting_depth_;
-        handler_.begin_object(len, *this);
-        for (size_t i = 0; i < len; ++i)
+        const uint8_t* q;
+        switch (get_major_type(*pos))
         {
-            parse_name(ec);
-            if (ec)
+            case cbor_major_type::unsigned_integer:
             {
-                return;
+                uint64_t val = detail::get_uint64_value(pos,endp,&q);
+                input_ptr_ = endp;
+                if (has_semantic_tag && semantic_tag == 1)
+                {
+                    continue_ = handler_.uint64_value(val, semantic_tag_type::epoch_time, *this);
+                }
+                else
+                {
+                    continue_ = handler_.uint64_value(val, semantic_tag_type::none, *this);
+                }
+                break;
             }
-            parse_some(ec);
-            if (ec)
+            case cbor_major_type::negative_integer:
             {
-                return;
+                int64_t val = detail::get_int64_value(pos,endp,&q);
+                input_ptr_ = endp;
+                if (has_semantic_tag && semantic_tag == 1)
+                {
+                    continue_ = handler_.int64_value(val, semantic_tag_type::epoch_time, *this);
+                }
+                else 
+                {
+                    continue_ = handler_.int64_value(val, semantic_tag_type::none, *this);
+                }
+                break;
+            }
+            case cbor_major_type::byte_string:
+            {
+                size_t length;
+                const uint8_t* data = get_byte_string(pos, endp, &length);
+                if (!is_namespace && get_additional_information_value(*pos) != additional_information::indefinite_length)
+                {
+                    add_stringref(false, data, length);
+                }
+                input_ptr_ = endp;
+                if (has_semantic_tag && detail::is_typed_array_tag(semantic_tag))
+                {
+                    // Reported as an array, one element at a time, from a copy of the elements
+                    size_t element_size = detail::typed_array_element_size(semantic_tag);
+                    if (length % element_size != 0)
+                    {
+                        ec = cbor_parse_errc::source_error;
+                        return;
+                    }
+                    typed_array_data_.assign(data, data + length);
+                    typed_array_index_ = 0;
+                    state_stack_.push_back(parse_state(false, false, length/element_size));
+                    state_stack_.back().typed_array_tag = static_cast<uint8_t>(semantic_tag);
+                    continue_ = handler_.begin_array(length/element_size, *this);
+                }
+                else if (has_semantic_tag && semantic_tag == 2)
+                {
+                    continue_ = handler_.bignum_value(1, data, length, *this);
+                }
+                else if (has_semantic_tag && semantic_tag == 3)
+                {
+                    continue_ = handler_.bignum_value(-1, data, length, *this);
+                }
+                else
+                {
+                    continue_ = handler_.byte_string_value(data, length, semantic_tag_type::none, *this);
+                }
+                break;
             }
+            case cbor_major_type::text_string:
+            {
+                basic_string_view<char> s = get_text_string(pos, endp);
+                if (!is_namespace && get_additional_information_value(*pos) != additional_information::indefinite_length)
+                {
+                    add_stringref(true, reinterpret_cast<const uint8_t*>(s.data()), s.length());
+                }
+                input_ptr_ = endp;
+                if (has_semantic_tag && semantic_tag == 0)
+                {
+                    continue_ = handler_.string_value(s, semantic_tag_type::date_time, *this);
+                }
+                else
+                {
+                    continue_ = handler_.string_value(s, semantic_tag_type::none, *this);
+                }
+                break;
+            }
+            case cbor_major_type::array:
+            {
+                uint64_t len;
+                read_argument(pos, len, &q, ec);
+                input_ptr_ = endp;
+                if (get_additional_information_value(*pos) == additional_information::indefinite_length)
+                {
+                    state_stack_.push_back(parse_state(false, true, 0));
+                    if (is_namespace)
+                    {
+                        begin_namespace();
+                    }
+                    continue_ = handler_.begin_array(*this);
+                }
+                else
+                {
+                    state_stack_.push_back(parse_state(false, false, static_cast<size_t>(len)));
+                    if (is_namespace)
+                    {
+                        begin_namespace();
+                    }
+                    continue_ = handler_.begin_array(static_cast<size_t>(len), *this);
+                }
+                break;
+            }
+            case cbor_major_type::map:
+            {
+                uint64_t len;
+                read_argument(pos, len, &q, ec);
+                input_ptr_ = endp;
+                if (get_additional_information_value(*pos) == additional_information::indefinite_length)
+                {
+                    state_stack_.push_back(parse_state(true, true, 0));
+                    if (is_namespace)
+                    {
+                        begin_namespace();
+                    }
+                    continue_ = handler_.begin_object(*this);
+                }
+                else
+                {
+                    state_stack_.push_back(parse_state(true, false, static_cast<size_t>(len)));
+                    if (is_namespace)
+                    {
+                        begin_namespace();
+                    }
+                    continue_ = handler_.begin_object(static_cast<size_t>(len), *this);
+                }
+                break;
+            }
+            case cbor_major_type::simple:
+            {
+                switch (get_additional_information_value(*pos))
+                {
+                    case 20:
+                        continue_ = handler_.bool_value(false, *this);
+                        break;
+                    case 21:
+                        continue_ = handler_.bool_value(true, *this);
+                        break;
+                    case 22:
+                    case 23: // undefined
+                        continue_ = handler_.null_value(*this);
+                        break;
+                    case 25: // Half-Precision Float (two-byte IEEE 754)
+                    case 26: // Single-Precision Float (four-byte IEEE 754)
+                    case 27: // Double-Precision Float (eight-byte IEEE 754)
+                    {
+                        double val = detail::get_double(pos,endp,&q);
+                        if (has_semantic_tag && semantic_tag == 1)
+                        {
+                            continue_ = handler_.double_value(val, floating_point_options(), semantic_tag_type::epoch_time, *this);
+                        }
+                        else
+                        {
+                            continue_ = handler_.double_value(val, floating_point_options(), semantic_tag_type::none, *this);
+                        }
+                        break;
+                    }
+                    default:
+                        ec = cbor_parse_errc::source_error;
+                        return;
+                }
+                input_ptr_ = endp;
+                break;
+            }
+            default:
+                ec = cbor_parse_errc::source_error;
+                return;
         }
-        handler_.end_object(*this);
-        --nesting_depth_;
     }
 };
 
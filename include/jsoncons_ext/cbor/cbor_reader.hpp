@@ -0,0 +1,174 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_CBOR_CBORREADER_HPP
+#define JSONCONS_CBOR_CBORREADER_HPP
+
+#include <vector>
+#include <istream>
+#include <algorithm>
+#include <system_error>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons_ext/cbor/cbor_error_category.hpp>
+#include <jsoncons_ext/cbor/cbor_parser.hpp>
+
+namespace jsoncons { namespace cbor {
+
+// cbor_reader reads CBOR data items from a stream in chunks of buffer_length()
+// bytes. A data item that does not fit in a chunk is carried over to the next
+// one, so the buffer only grows to hold a single string larger than a chunk.
+// Successive data items in the stream, a CBOR sequence (RFC 8742), are read
+// with read_next until eof().
+
+class cbor_reader
+{
+    static const size_t default_max_buffer_length = 16384;
+
+    basic_null_json_content_handler<char> default_content_handler_;
+
+    cbor_parser parser_;
+    std::istream& is_;
+    bool eof_;
+    std::vector<uint8_t> buffer_;
+    size_t buffer_length_;
+
+    // Noncopyable and nonmoveable
+    cbor_reader(const cbor_reader&) = delete;
+    cbor_reader& operator=(const cbor_reader&) = delete;
+
+public:
+    cbor_reader(std::istream& is)
+        : cbor_reader(is,default_content_handler_)
+    {
+    }
+
+    cbor_reader(std::istream& is,
+                json_content_handler& handler)
+       : parser_(handler),
+         is_(is),
+         eof_(false),
+         buffer_length_(default_max_buffer_length)
+    {
+        buffer_.reserve(buffer_length_);
+    }
+
+    size_t buffer_length() const
+    {
+        return buffer_length_;
+    }
+
+    void buffer_length(size_t length)
+    {
+        buffer_length_ = length;
+        buffer_.reserve(buffer_length_);
+    }
+
+    void read_next()
+    {
+        std::error_code ec;
+        read_next(ec);
+        if (ec)
+        {
+            throw parse_error(ec,parser_.line_number(),parser_.column_number());
+        }
+    }
+
+    void read_buffer(std::error_code& ec)
+    {
+        if (is_.fail() && !is_.eof())
+        {
+            ec = cbor_parse_errc::source_error;
+            return;
+        }
+
+        // Keep the unconsumed bytes, the start of an incomplete data item
+        size_t remaining = parser_.remaining();
+        if (remaining > 0)
+        {
+            std::copy(buffer_.end() - remaining, buffer_.end(), buffer_.begin());
+        }
+        size_t length = (std::max)(buffer_length_, remaining);
+        buffer_.resize(remaining + length);
+        is_.read(reinterpret_cast<char*>(buffer_.data() + remaining), length);
+        size_t count = static_cast<size_t>(is_.gcount());
+        buffer_.resize(remaining + count);
+        if (count == 0)
+        {
+            eof_ = true;
+        }
+        parser_.update(buffer_.data(),buffer_.size());
+    }
+
+    void read_next(std::error_code& ec)
+    {
+        parser_.parse_some(ec);
+        while (ec == cbor_parse_errc::unexpected_eof && !eof_)
+        {
+            ec = std::error_code();
+            read_buffer(ec);
+            if (ec) return;
+            parser_.parse_some(ec);
+        }
+        if (ec) return;
+
+        if (parser_.remaining() == 0)
+        {
+            read_buffer(ec);
+        }
+    }
+
+    void check_done()
+    {
+        std::error_code ec;
+        check_done(ec);
+        if (ec)
+        {
+            throw parse_error(ec,parser_.line_number(),parser_.column_number());
+        }
+    }
+
+    void check_done(std::error_code& ec)
+    {
+        if (!eof_)
+        {
+            ec = cbor_parse_errc::extra_data;
+        }
+    }
+
+    size_t line_number() const
+    {
+        return parser_.line_number();
+    }
+
+    size_t column_number() const
+    {
+        return parser_.column_number();
+    }
+
+    bool eof() const
+    {
+        return eof_;
+    }
+
+    void read()
+    {
+        read_next();
+        check_done();
+    }
+
+    void read(std::error_code& ec)
+    {
+        read_next(ec);
+        if (!ec)
+        {
+            check_done(ec);
+        }
+    }
+};
+
+}}
+
+#endif
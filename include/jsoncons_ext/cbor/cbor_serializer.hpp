@@ -16,17 +16,52 @@
 #include <limits> // std::numeric_limits
 #include <fstream>
 #include <memory>
+#include <unordered_map>
 #include <jsoncons/json_exception.hpp>
 #include <jsoncons/jsoncons_utilities.hpp>
 #include <jsoncons/json_content_handler.hpp>
 #include <jsoncons/config/binary_utilities.hpp>
 #include <jsoncons/detail/writer.hpp>
 #include <jsoncons/detail/parse_number.hpp>
+#include <jsoncons/detail/deferred_length_buffer.hpp>
+#include <jsoncons_ext/cbor/cbor_serializing_options.hpp>
 
 namespace jsoncons { namespace cbor {
 
 enum class cbor_structure_type {object, indefinite_length_object, array, indefinite_length_array};
 
+namespace detail {
+
+// The length a string must have to be assigned the next stringref in a 
+// namespace that already has count of them, so that a reference to it 
+// is shorter than the string
+inline
+size_t min_stringref_length(uint64_t count)
+{
+    if (count < 24)
+    {
+        return 3;
+    }
+    else if (count < 256)
+    {
+        return 4;
+    }
+    else if (count < 65536)
+    {
+        return 5;
+    }
+    else if (count < 4294967296ull)
+    {
+        return 7;
+    }
+    else
+    {
+        return 11;
+    }
+}
+
+}
+
 template<class CharT,class Writer=jsoncons::detail::stream_byte_writer>
 class basic_cbor_serializer final : public basic_json_content_handler<CharT>
 {
@@ -38,13 +73,18 @@ public:
     typedef typename Writer::output_type output_type;
 
 private:
+    // Room for a header with an eight-byte length
+    static const size_t max_header_length = 9;
+
     struct stack_item
     {
         cbor_structure_type type_;
         size_t count_;
+        size_t offset_;
+        bool buffered_;
 
-        stack_item(cbor_structure_type type)
-           : type_(type), count_(0)
+        stack_item(cbor_structure_type type, size_t offset = 0, bool buffered = false)
+           : type_(type), count_(0), offset_(offset), buffered_(buffered)
         {
         }
 
@@ -65,14 +105,38 @@ private:
 
     };
     std::vector<stack_item> stack_;
+    cbor_serializing_options options_;
+    jsoncons::detail::deferred_length_buffer deferred_;
     Writer writer_;
+    // With pack_strings, the stringrefs assigned in the namespace of the 
+    // current top level array or map, text and byte strings numbered together
+    bool in_stringref_namespace_;
+    std::unordered_map<std::string,size_t> text_stringrefs_;
+    std::unordered_map<std::string,size_t> byte_stringrefs_;
+    size_t next_stringref_;
+    // With use_typed_arrays, the elements of the innermost array are held 
+    // back while they are all integers or all floating point numbers
+    bool typed_array_pending_;
+    bool typed_array_has_length_;
+    size_t typed_array_length_;
+    std::vector<int64_t> typed_array_int64s_;
+    std::vector<double> typed_array_doubles_;
 
     // Noncopyable and nonmoveable
     basic_cbor_serializer(const basic_cbor_serializer&) = delete;
     basic_cbor_serializer& operator=(const basic_cbor_serializer&) = delete;
 public:
     basic_cbor_serializer(output_type& os)
-       : writer_(os)
+       : deferred_(max_header_length), writer_(os), 
+         in_stringref_namespace_(false), next_stringref_(0),
+         typed_array_pending_(false), typed_array_has_length_(false), typed_array_length_(0)
+    {
+    }
+
+    basic_cbor_serializer(output_type& os, const cbor_serializing_options& options)
+       : options_(options), deferred_(max_header_length), writer_(os), 
+         in_stringref_namespace_(false), next_stringref_(0),
+         typed_array_pending_(false), typed_array_has_length_(false), typed_array_length_(0)
     {
     }
 
@@ -97,17 +161,33 @@ private:
 
     bool do_begin_object(const serializing_context&) override
     {
+        end_typed_array_candidate();
+        begin_container();
+        if (options_.use_definite_length())
+        {
+            begin_buffered(cbor_structure_type::object);
+            return true;
+        }
         stack_.push_back(stack_item(cbor_structure_type::indefinite_length_object));
         
-        writer_.put(0xbf);
+        put(0xbf);
         return true;
     }
 
     bool do_begin_object(size_t length, const serializing_context&) override
     {
+        end_typed_array_candidate();
+        begin_container();
         stack_.push_back(stack_item(cbor_structure_type::object));
 
         std::vector<uint8_t> v;
+        write_map_header(length, v);
+        put(v);
+        return true;
+    }
+
+    static void write_map_header(size_t length, std::vector<uint8_t>& v)
+    {
         if (length <= 0x17)
         {
             binary::to_big_endian(static_cast<uint8_t>(0xa0 + length), v);
@@ -128,20 +208,18 @@ private:
             binary::to_big_endian(static_cast<uint8_t>(0xbb), v);
             binary::to_big_endian(static_cast<uint64_t>(length),v);
         }
-
-        for (auto c : v)
-        {
-            writer_.put(c);
-        }
-        return true;
     }
 
     bool do_end_object(const serializing_context&) override
     {
         JSONCONS_ASSERT(!stack_.empty());
-        if (stack_.back().is_indefinite_length())
+        if (stack_.back().buffered_)
+        {
+            end_buffered();
+        }
+        else if (stack_.back().is_indefinite_length())
         {
-            writer_.put(0xff);
+            put(0xff);
         }
         stack_.pop_back();
 
@@ -151,15 +229,52 @@ private:
 
     bool do_begin_array(const serializing_context&) override
     {
-        stack_.push_back(stack_item(cbor_structure_type::indefinite_length_array));
-        writer_.put(0x9f);
+        end_typed_array_candidate();
+        if (options_.use_typed_arrays())
+        {
+            begin_typed_array_candidate(false, 0);
+            return true;
+        }
+        write_begin_array();
         return true;
     }
 
     bool do_begin_array(size_t length, const serializing_context&) override
     {
-        std::vector<uint8_t> v;
+        end_typed_array_candidate();
+        if (options_.use_typed_arrays() && length > 0)
+        {
+            begin_typed_array_candidate(true, length);
+            return true;
+        }
+        write_begin_array(length);
+        return true;
+    }
+
+    void write_begin_array()
+    {
+        begin_container();
+        if (options_.use_definite_length())
+        {
+            begin_buffered(cbor_structure_type::array);
+            return;
+        }
+        stack_.push_back(stack_item(cbor_structure_type::indefinite_length_array));
+        put(0x9f);
+    }
+
+    void write_begin_array(size_t length)
+    {
+        begin_container();
         stack_.push_back(stack_item(cbor_structure_type::array));
+
+        std::vector<uint8_t> v;
+        write_array_header(length, v);
+        put(v);
+    }
+
+    static void write_array_header(size_t length, std::vector<uint8_t>& v)
+    {
         if (length <= 0x17)
         {
             binary::to_big_endian(static_cast<uint8_t>(0x80 + length), v);
@@ -184,19 +299,31 @@ private:
             binary::to_big_endian(static_cast<uint8_t>(0x9b), v);
             binary::to_big_endian(static_cast<uint64_t>(length),v);
         }
-        for (auto c : v)
-        {
-            writer_.put(c);
-        }
-        return true;
     }
 
     bool do_end_array(const serializing_context&) override
     {
+        if (typed_array_pending_)
+        {
+            if (typed_array_int64s_.empty() && typed_array_doubles_.empty())
+            {
+                end_typed_array_candidate();
+            }
+            else
+            {
+                write_typed_array();
+                end_value();
+                return true;
+            }
+        }
         JSONCONS_ASSERT(!stack_.empty());
-        if (stack_.back().is_indefinite_length())
+        if (stack_.back().buffered_)
+        {
+            end_buffered();
+        }
+        else if (stack_.back().is_indefinite_length())
         {
-            writer_.put(0xff);
+            put(0xff);
         }
         stack_.pop_back();
         end_value();
@@ -211,7 +338,8 @@ private:
 
     bool do_null_value(const serializing_context&) override
     {
-        writer_.put(0xf6);
+        end_typed_array_candidate();
+        put(0xf6);
 
         end_value();
         return true;
@@ -230,6 +358,11 @@ private:
         }
 
         const size_t length = target.length();
+        if (in_stringref_namespace_ && 
+            write_stringref(text_stringrefs_, target.data(), length))
+        {
+            return;
+        }
         if (length <= 0x17)
         {
             // fixstr stores a byte array whose length is upto 31 bytes
@@ -260,10 +393,7 @@ private:
         {
             binary::to_big_endian(static_cast<uint8_t>(target.data()[i]), v);
         }
-        for (auto c : v)
-        {
-            writer_.put(c);
-        }
+        put(v);
     }
 
     void write_bignum_value(const string_view_type& sv)
@@ -273,6 +403,11 @@ private:
         std::vector<uint8_t> data;
         n.dump(signum, data);
         size_t length = data.size();
+        if (in_stringref_namespace_)
+        {
+            // Counted, but not replaced, so that a decimal fraction's mantissa stays inline
+            add_stringref(byte_stringrefs_, data.data(), length);
+        }
 
         std::vector<uint8_t> v;
         if (signum == -1)
@@ -316,10 +451,7 @@ private:
             //binary::to_big_endian(static_cast<uint8_t>(data[i]), v);
         }
 
-        for (auto c : v)
-        {
-            writer_.put(c);
-        }
+        put(v);
     }
 
     void write_decimal_value(const string_view_type& sv, const serializing_context& context)
@@ -416,8 +548,9 @@ private:
             }
         }
 
-        writer_.put(0xc4);
-        do_begin_array((size_t)2, context);
+        put(0xc4);
+        stack_.push_back(stack_item(cbor_structure_type::array));
+        put(0x82);
         if (exponent.length() > 0)
         {
             auto result = jsoncons::detail::to_integer<int64_t>(exponent.data(), exponent.length());
@@ -443,6 +576,7 @@ private:
 
     bool do_string_value(const string_view_type& sv, semantic_tag_type tag, const serializing_context& context) override
     {
+        end_typed_array_candidate();
         switch (tag)
         {
             case semantic_tag_type::bignum:
@@ -457,7 +591,7 @@ private:
             }
             case semantic_tag_type::date_time:
             {
-                writer_.put(0xc0);
+                put(0xc0);
                 write_string_value(sv);
                 break;
             }
@@ -474,8 +608,28 @@ private:
 
     bool do_byte_string_value(const uint8_t* data, size_t length, semantic_tag_type, const serializing_context&) override
     {
+        end_typed_array_candidate();
+        if (in_stringref_namespace_ && 
+            write_stringref(byte_stringrefs_, data, length))
+        {
+            end_value();
+            return true;
+        }
+
         std::vector<uint8_t> v;
+        write_byte_string_header(length, v);
+        for (size_t i = 0; i < length; ++i)
+        {
+            binary::to_big_endian(static_cast<uint8_t>(data[i]), v);
+        }
+        put(v);
+
+        end_value();
+        return true;
+    }
 
+    static void write_byte_string_header(size_t length, std::vector<uint8_t>& v)
+    {
         if (length <= 0x17)
         {
             // fixstr stores a byte array whose length is upto 31 bytes
@@ -501,18 +655,6 @@ private:
             binary::to_big_endian(static_cast<uint8_t>(0x5b), v);
             binary::to_big_endian(static_cast<uint64_t>(length),v);
         }
-
-        for (size_t i = 0; i < length; ++i)
-        {
-            binary::to_big_endian(static_cast<uint8_t>(data[i]), v);
-        }
-        for (auto c : v)
-        {
-            writer_.put(c);
-        }
-
-        end_value();
-        return true;
     }
 
     bool do_double_value(double val, 
@@ -520,9 +662,15 @@ private:
                          semantic_tag_type tag,
                          const serializing_context&) override
     {
+        if (typed_array_pending_ && tag == semantic_tag_type::none && typed_array_int64s_.empty())
+        {
+            typed_array_doubles_.push_back(val);
+            return true;
+        }
+        end_typed_array_candidate();
         if (tag == semantic_tag_type::epoch_time)
         {
-            writer_.put(0xc1);
+            put(0xc1);
         }
 
         std::vector<uint8_t> v;
@@ -538,10 +686,7 @@ private:
             binary::to_big_endian(static_cast<uint8_t>(0xfb), v);
             binary::to_big_endian(val,v);
         }
-        for (auto c : v)
-        {
-            writer_.put(c);
-        }
+        put(v);
 
         // write double
 
@@ -553,9 +698,15 @@ private:
                         semantic_tag_type tag, 
                         const serializing_context&) override
     {
+        if (typed_array_pending_ && tag == semantic_tag_type::none && typed_array_doubles_.empty())
+        {
+            typed_array_int64s_.push_back(value);
+            return true;
+        }
+        end_typed_array_candidate();
         if (tag == semantic_tag_type::epoch_time)
         {
-            writer_.put(0xc1);
+            put(0xc1);
         }
         std::vector<uint8_t> v;
         if (value >= 0)
@@ -612,10 +763,7 @@ private:
                 binary::to_big_endian(static_cast<int64_t>(posnum), v);
             }
         }
-        for (auto c : v)
-        {
-            writer_.put(c);
-        }
+        put(v);
         end_value();
         return true;
     }
@@ -624,9 +772,16 @@ private:
                          semantic_tag_type tag, 
                          const serializing_context&) override
     {
+        if (typed_array_pending_ && tag == semantic_tag_type::none && typed_array_doubles_.empty() &&
+            value <= static_cast<uint64_t>((std::numeric_limits<int64_t>::max)()))
+        {
+            typed_array_int64s_.push_back(static_cast<int64_t>(value));
+            return true;
+        }
+        end_typed_array_candidate();
         if (tag == semantic_tag_type::epoch_time)
         {
-            writer_.put(0xc1);
+            put(0xc1);
         }
 
         std::vector<uint8_t> v;
@@ -650,35 +805,297 @@ private:
             binary::to_big_endian(static_cast<uint8_t>(0x1b), v);
             binary::to_big_endian(static_cast<uint64_t>(value),v);
         }
-        for (auto c : v)
-        {
-            writer_.put(c);
-        }
+        put(v);
         end_value();
         return true;
     }
 
     bool do_bool(bool value, const serializing_context&) override
     {
+        end_typed_array_candidate();
         if (value)
         {
-            writer_.put(0xf5);
+            put(0xf5);
         }
         else
         {
-            writer_.put(0xf4);
+            put(0xf4);
         }
 
         end_value();
         return true;
     }
 
+    // With use_typed_arrays, an array is held back until it ends, and written 
+    // as a typed array if its elements are all integers or all floating point
+    // numbers. Any other element ends the candidate, and the elements held 
+    // back are written as an ordinary array.
+
+    void begin_typed_array_candidate(bool has_length, size_t length)
+    {
+        typed_array_pending_ = true;
+        typed_array_has_length_ = has_length;
+        typed_array_length_ = length;
+        typed_array_int64s_.clear();
+        typed_array_doubles_.clear();
+    }
+
+    void end_typed_array_candidate()
+    {
+        if (!typed_array_pending_)
+        {
+            return;
+        }
+        typed_array_pending_ = false;
+        if (typed_array_has_length_)
+        {
+            write_begin_array(typed_array_length_);
+        }
+        else
+        {
+            write_begin_array();
+        }
+        for (int64_t value : typed_array_int64s_)
+        {
+            do_int64_value(value, semantic_tag_type::none, null_serializing_context());
+        }
+        for (double value : typed_array_doubles_)
+        {
+            do_double_value(value, floating_point_options(), semantic_tag_type::none, null_serializing_context());
+        }
+    }
+
+    template <class T>
+    static void append_elements(const std::vector<T>& values, std::vector<uint8_t>& v)
+    {
+        size_t offset = v.size();
+        v.resize(offset + values.size()*sizeof(T));
+        if (!values.empty())
+        {
+            memcpy(v.data() + offset, values.data(), values.size()*sizeof(T));
+        }
+    }
+
+    template <class T, class U>
+    static void append_elements(const std::vector<U>& values, std::vector<uint8_t>& v)
+    {
+        std::vector<T> elements(values.begin(), values.end());
+        append_elements(elements, v);
+    }
+
+    // Writes the elements held back as a typed array with the smallest 
+    // element type that holds them all
+    void write_typed_array()
+    {
+        typed_array_pending_ = false;
+
+        std::vector<uint8_t> elements;
+        uint8_t tag;
+        if (!typed_array_doubles_.empty())
+        {
+            bool is_float32 = true;
+            for (double value : typed_array_doubles_)
+            {
+                if (static_cast<double>(static_cast<float>(value)) != value)
+                {
+                    is_float32 = false;
+                    break;
+                }
+            }
+            if (is_float32)
+            {
+                tag = 81;
+                append_elements<float>(typed_array_doubles_, elements);
+            }
+            else
+            {
+                tag = 82;
+                append_elements(typed_array_doubles_, elements);
+            }
+        }
+        else
+        {
+            int64_t min_value = 0;
+            int64_t max_value = 0;
+            for (int64_t value : typed_array_int64s_)
+            {
+                min_value = (std::min)(min_value, value);
+                max_value = (std::max)(max_value, value);
+            }
+            if (min_value >= 0 && max_value <= (std::numeric_limits<uint8_t>::max)())
+            {
+                tag = 64;
+                append_elements<uint8_t>(typed_array_int64s_, elements);
+            }
+            else if (min_value >= 0 && max_value <= (std::numeric_limits<uint16_t>::max)())
+            {
+                tag = 65;
+                append_elements<uint16_t>(typed_array_int64s_, elements);
+            }
+            else if (min_value >= 0 && max_value <= (std::numeric_limits<uint32_t>::max)())
+            {
+                tag = 66;
+                append_elements<uint32_t>(typed_array_int64s_, elements);
+            }
+            else if (min_value >= (std::numeric_limits<int8_t>::min)() && max_value <= (std::numeric_limits<int8_t>::max)())
+            {
+                tag = 72;
+                append_elements<int8_t>(typed_array_int64s_, elements);
+            }
+            else if (min_value >= (std::numeric_limits<int16_t>::min)() && max_value <= (std::numeric_limits<int16_t>::max)())
+            {
+                tag = 73;
+                append_elements<int16_t>(typed_array_int64s_, elements);
+            }
+            else if (min_value >= (std::numeric_limits<int32_t>::min)() && max_value <= (std::numeric_limits<int32_t>::max)())
+            {
+                tag = 74;
+                append_elements<int32_t>(typed_array_int64s_, elements);
+            }
+            else
+            {
+                tag = 75;
+                append_elements(typed_array_int64s_, elements);
+            }
+        }
+        // The e bit marks little endian elements, single bytes have no byte order
+        if (tag != 64 && tag != 72 && binary::is_little_endian())
+        {
+            tag += 4;
+        }
+
+        if (in_stringref_namespace_)
+        {
+            add_stringref(byte_stringrefs_, elements.data(), elements.size());
+        }
+        std::vector<uint8_t> v;
+        binary::to_big_endian(static_cast<uint8_t>(0xd8), v);
+        binary::to_big_endian(tag, v);
+        write_byte_string_header(elements.size(), v);
+        v.insert(v.end(), elements.begin(), elements.end());
+        put(v);
+    }
+
+    // With use_definite_length, a map or array begun without a length is 
+    // buffered until it ends, when its length is known
+
+    void begin_buffered(cbor_structure_type type)
+    {
+        stack_.push_back(stack_item(type, deferred_.begin(), true));
+    }
+
+    void end_buffered()
+    {
+        const stack_item& item = stack_.back();
+
+        std::vector<uint8_t> v;
+        if (item.is_object())
+        {
+            // names are counted as values
+            write_map_header(item.count()/2, v);
+        }
+        else
+        {
+            write_array_header(item.count(), v);
+        }
+        deferred_.end(item.offset_, v, writer_);
+    }
+
+    // With pack_strings, each top level array or map is tagged as a 
+    // stringref namespace (tag 256)
+    void begin_container()
+    {
+        if (options_.pack_strings() && stack_.empty())
+        {
+            in_stringref_namespace_ = true;
+            text_stringrefs_.clear();
+            byte_stringrefs_.clear();
+            next_stringref_ = 0;
+            put(0xd9);
+            put(0x01);
+            put(0x00);
+        }
+    }
+
+    void add_stringref(std::unordered_map<std::string,size_t>& stringrefs, const uint8_t* data, size_t length)
+    {
+        if (length >= detail::min_stringref_length(next_stringref_))
+        {
+            stringrefs.emplace(std::string(reinterpret_cast<const char*>(data), length), next_stringref_++);
+        }
+    }
+
+    // Writes a stringref (tag 25) if the string has been assigned one, 
+    // otherwise assigns it the next one if it is long enough
+    bool write_stringref(std::unordered_map<std::string,size_t>& stringrefs, const uint8_t* data, size_t length)
+    {
+        if (length < 3)
+        {
+            return false;
+        }
+        std::string key(reinterpret_cast<const char*>(data), length);
+        auto it = stringrefs.find(key);
+        if (it == stringrefs.end())
+        {
+            if (length >= detail::min_stringref_length(next_stringref_))
+            {
+                stringrefs.emplace(std::move(key), next_stringref_++);
+            }
+            return false;
+        }
+
+        const size_t index = it->second;
+        std::vector<uint8_t> v;
+        binary::to_big_endian(static_cast<uint8_t>(0xd8), v);
+        binary::to_big_endian(static_cast<uint8_t>(0x19), v);
+        if (index <= 0x17)
+        {
+            binary::to_big_endian(static_cast<uint8_t>(index), v);
+        }
+        else if (index <= 0xff)
+        {
+            binary::to_big_endian(static_cast<uint8_t>(0x18), v);
+            binary::to_big_endian(static_cast<uint8_t>(index), v);
+        }
+        else if (index <= 0xffff)
+        {
+            binary::to_big_endian(static_cast<uint8_t>(0x19), v);
+            binary::to_big_endian(static_cast<uint16_t>(index), v);
+        }
+        else if (index <= 0xffffffff)
+        {
+            binary::to_big_endian(static_cast<uint8_t>(0x1a), v);
+            binary::to_big_endian(static_cast<uint32_t>(index), v);
+        }
+        else
+        {
+            binary::to_big_endian(static_cast<uint8_t>(0x1b), v);
+            binary::to_big_endian(static_cast<uint64_t>(index), v);
+        }
+        put(v);
+        return true;
+    }
+
+    void put(uint8_t c)
+    {
+        deferred_.put(c, writer_);
+    }
+
+    void put(const std::vector<uint8_t>& v)
+    {
+        deferred_.write(v, writer_);
+    }
+
     void end_value()
     {
         if (!stack_.empty())
         {
             ++stack_.back().count_;
         }
+        else
+        {
+            in_stringref_namespace_ = false;
+        }
     }
 };
 
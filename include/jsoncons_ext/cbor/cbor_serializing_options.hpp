@@ -0,0 +1,41 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_CBOR_CBORSERIALIZINGOPTIONS_HPP
+#define JSONCONS_CBOR_CBORSERIALIZINGOPTIONS_HPP
+
+namespace jsoncons { namespace cbor {
+
+class cbor_serializing_options
+{
+    bool use_definite_length_;
+    bool pack_strings_;
+    bool use_typed_arrays_;
+public:
+    cbor_serializing_options()
+        : use_definite_length_(false), pack_strings_(false), use_typed_arrays_(false)
+    {
+    }
+
+//  Properties
+
+    // Write maps and arrays begun without a length with definite length headers
+    bool use_definite_length() const {return use_definite_length_;}
+    cbor_serializing_options& use_definite_length(bool value) {use_definite_length_ = value; return *this;}
+
+    // Replace repeated strings in an array or map with references to their 
+    // first occurrence, using the stringref extension (tags 25 and 256)
+    bool pack_strings() const {return pack_strings_;}
+    cbor_serializing_options& pack_strings(bool value) {pack_strings_ = value; return *this;}
+
+    // Write arrays of integers only, or of floating point numbers only, as 
+    // typed arrays (RFC 8746) in the host's byte order
+    bool use_typed_arrays() const {return use_typed_arrays_;}
+    cbor_serializing_options& use_typed_arrays(bool value) {use_typed_arrays_ = value; return *this;}
+};
+
+}}
+#endif
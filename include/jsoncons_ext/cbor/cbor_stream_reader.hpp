@@ -0,0 +1,214 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_CBOR_CBORSTREAMREADER_HPP
+#define JSONCONS_CBOR_CBORSTREAMREADER_HPP
+
+#include <vector>
+#include <istream>
+#include <algorithm>
+#include <system_error>
+#include <jsoncons/stream_reader.hpp>
+#include <jsoncons/json_stream_reader.hpp>
+#include <jsoncons_ext/cbor/cbor_error_category.hpp>
+#include <jsoncons_ext/cbor/cbor_parser.hpp>
+#include <jsoncons_ext/cbor/cbor_view.hpp>
+
+namespace jsoncons { namespace cbor {
+
+// cbor_stream_reader reports the data items in a buffer or stream of CBOR
+// data one event at a time. Successive data items in the input, a CBOR
+// sequence (RFC 8742), are reported one after another. Events that a filter
+// does not accept are passed over. String events are views into the reader's
+// buffer, and are valid until the next call to next() or skip().
+
+class cbor_stream_reader : public basic_stream_reader<char>, private virtual serializing_context
+{
+    static const size_t default_max_buffer_length = 16384;
+
+    basic_stream_event_handler<char> event_handler_;
+    default_basic_stream_filter<char> default_filter_;
+
+    cbor_parser parser_;
+    std::istream* is_;
+    basic_stream_filter<char>& filter_;
+    bool eof_;
+    bool done_;
+    std::vector<uint8_t> buffer_;
+    size_t buffer_length_;
+
+    // Noncopyable and nonmoveable
+    cbor_stream_reader(const cbor_stream_reader&) = delete;
+    cbor_stream_reader& operator=(const cbor_stream_reader&) = delete;
+
+public:
+    cbor_stream_reader(std::istream& is)
+        : cbor_stream_reader(is,default_filter_)
+    {
+    }
+
+    cbor_stream_reader(std::istream& is,
+                       basic_stream_filter<char>& filter)
+       : parser_(event_handler_),
+         is_(std::addressof(is)),
+         filter_(filter),
+         eof_(false),
+         done_(false),
+         buffer_length_(default_max_buffer_length)
+    {
+        buffer_.reserve(buffer_length_);
+        next();
+    }
+
+    cbor_stream_reader(const cbor_view& v)
+        : cbor_stream_reader(v,default_filter_)
+    {
+    }
+
+    cbor_stream_reader(const cbor_view& v,
+                       basic_stream_filter<char>& filter)
+       : parser_(event_handler_),
+         is_(nullptr),
+         filter_(filter),
+         eof_(true),
+         done_(false),
+         buffer_length_(default_max_buffer_length)
+    {
+        parser_.update(v.buffer(),v.buflen());
+        next();
+    }
+
+    size_t buffer_length() const
+    {
+        return buffer_length_;
+    }
+
+    void buffer_length(size_t length)
+    {
+        buffer_length_ = length;
+        buffer_.reserve(buffer_length_);
+    }
+
+    bool done() const override
+    {
+        return done_;
+    }
+
+    const basic_stream_event<char>& current() const override
+    {
+        return event_handler_.event();
+    }
+
+    void next() override
+    {
+        std::error_code ec;
+        do
+        {
+            read_next(ec);
+            if (ec)
+            {
+                throw parse_error(ec,parser_.line_number(),parser_.column_number());
+            }
+        } while (!done_ && !filter_.accept(event_handler_.event(), *this));
+    }
+
+    // Advances past the data item that begins with the current event. The
+    // contents of an array or map are passed over without being decoded or
+    // filtered, jumping over strings using their lengths.
+    void skip()
+    {
+        stream_event_type event_type = event_handler_.event().event_type();
+        if (!done_ && (event_type == stream_event_type::begin_array || event_type == stream_event_type::begin_object))
+        {
+            std::error_code ec;
+            parser_.skip_container(ec);
+            while (ec == cbor_parse_errc::unexpected_eof && !eof_)
+            {
+                ec = std::error_code();
+                read_buffer(ec);
+                if (ec) break;
+                parser_.skip_container(ec);
+            }
+            if (ec)
+            {
+                throw parse_error(ec,parser_.line_number(),parser_.column_number());
+            }
+        }
+        next();
+    }
+
+    const serializing_context& context() const override
+    {
+        return *this;
+    }
+
+    size_t line_number() const override
+    {
+        return parser_.line_number();
+    }
+
+    size_t column_number() const override
+    {
+        return parser_.column_number();
+    }
+private:
+    void read_buffer(std::error_code& ec)
+    {
+        if (is_->fail() && !is_->eof())
+        {
+            ec = cbor_parse_errc::source_error;
+            return;
+        }
+
+        // Keep the unconsumed bytes, the start of an incomplete data item
+        size_t remaining = parser_.remaining();
+        if (remaining > 0)
+        {
+            std::copy(buffer_.end() - remaining, buffer_.end(), buffer_.begin());
+        }
+        size_t length = (std::max)(buffer_length_, remaining);
+        buffer_.resize(remaining + length);
+        is_->read(reinterpret_cast<char*>(buffer_.data() + remaining), length);
+        size_t count = static_cast<size_t>(is_->gcount());
+        buffer_.resize(remaining + count);
+        if (count == 0)
+        {
+            eof_ = true;
+        }
+        parser_.update(buffer_.data(),buffer_.size());
+    }
+
+    void read_next(std::error_code& ec)
+    {
+        if (parser_.done())
+        {
+            if (parser_.remaining() == 0 && !eof_)
+            {
+                read_buffer(ec);
+                if (ec) return;
+            }
+            if (parser_.remaining() == 0 && eof_)
+            {
+                done_ = true;
+                return;
+            }
+        }
+
+        parser_.restart();
+        parser_.parse_some(ec);
+        while (ec == cbor_parse_errc::unexpected_eof && !eof_)
+        {
+            ec = std::error_code();
+            read_buffer(ec);
+            if (ec) return;
+            parser_.parse_some(ec);
+        }
+    }
+};
+
+}}
+
+#endif
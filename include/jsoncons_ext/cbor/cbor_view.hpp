@@ -20,7 +20,9 @@
 #include <jsoncons/pretty_print.hpp>
 #include <jsoncons/config/binary_utilities.hpp>
 #include <jsoncons_ext/cbor/cbor_parser.hpp>
+#include <jsoncons_ext/cbor/cbor_reader.hpp>
 #include <jsoncons_ext/cbor/cbor_serializer.hpp>
+#include <jsoncons_ext/cbor/cbor_index.hpp>
 
 namespace jsoncons { namespace cbor {
 
@@ -31,6 +33,7 @@ class cbor_view
     const uint8_t* first_;
     const uint8_t* last_; 
     const uint8_t* base_relative_; 
+    const cbor_index* index_;
 public:
     typedef cbor_view array;
     typedef std::allocator<char> allocator_type;
@@ -58,7 +61,11 @@ public:
         const uint8_t* endp;
         const uint8_t* begin;
 
-        if (major_type() == cbor_major_type::map)
+        if (major_type() == cbor_major_type::semantic_tag)
+        {
+            return tagged_item().object_range();
+        }
+        else if (major_type() == cbor_major_type::map)
         {
             detail::get_map_size(first_,last_,&begin);
             if (begin == first_)
@@ -80,6 +87,15 @@ public:
         const uint8_t* endp;
         const uint8_t* begin;
 
+        if (major_type() == cbor_major_type::semantic_tag)
+        {
+            if (is_typed_array())
+            {
+                JSONCONS_THROW(json_exception_impl<std::runtime_error>("Typed array has no element views, use typed_array_range"));
+            }
+            return tagged_item().array_range();
+        }
+
         detail::get_array_size(first_, last_, &begin);
         if (begin == first_)
         {
@@ -94,27 +110,39 @@ public:
     }
 
     cbor_view()
-        : first_(nullptr), last_(nullptr), base_relative_(nullptr)
+        : first_(nullptr), last_(nullptr), base_relative_(nullptr), index_(nullptr)
     {
     }
 
     cbor_view(const uint8_t* data, size_t length)
-        : first_(data), last_(data+length), base_relative_(data)
+        : first_(data), last_(data+length), base_relative_(data), index_(nullptr)
     {
     }
 
     cbor_view(const uint8_t* data, size_t length, const uint8_t* base_relative)
-        : first_(data), last_(data+length), base_relative_(base_relative)
+        : first_(data), last_(data+length), base_relative_(base_relative), index_(nullptr)
     {
     }
 
     cbor_view(const std::vector<uint8_t>& v)
-        : first_(v.data()), last_(v.data()+v.size()), base_relative_(v.data())
+        : first_(v.data()), last_(v.data()+v.size()), base_relative_(v.data()), index_(nullptr)
+    {
+    }
+
+    // A view over the indexed buffer, size(), at() and contains() on this view 
+    // and the views it returns are constant time
+    explicit cbor_view(const cbor_index& index)
+        : first_(index.buffer()), last_(index.buffer()+index.buflen()), base_relative_(index.buffer()), index_(std::addressof(index))
+    {
+    }
+
+    cbor_view(const uint8_t* data, size_t length, const uint8_t* base_relative, const cbor_index* index)
+        : first_(data), last_(data+length), base_relative_(base_relative), index_(index)
     {
     }
 
     cbor_view(const cbor_view& other)
-        : first_(other.first_), last_(other.last_), base_relative_(other.base_relative_)
+        : first_(other.first_), last_(other.last_), base_relative_(other.base_relative_), index_(other.index_)
     {
     }
 
@@ -163,7 +191,11 @@ public:
     bool empty() const
     {
         bool is_empty;
-        if (is_array() || is_object())
+        if (major_type() == cbor_major_type::semantic_tag)
+        {
+            is_empty = tagged_item().empty();
+        }
+        else if (is_array() || is_object())
         {
             is_empty = (size() == 0);
         }
@@ -201,7 +233,7 @@ public:
                 }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.is_null();
             }
             default:
@@ -217,7 +249,11 @@ public:
                 return true;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                if (is_typed_array())
+                {
+                    return true;
+                }
+                cbor_view v = tagged_item();
                 return v.is_array();
             }
             default:
@@ -225,6 +261,44 @@ public:
         }
     }
 
+    // Typed arrays (RFC 8746) of integers or floating point numbers, other 
+    // than uint64 arrays, whose elements may not fit an int64_t
+    bool is_typed_array() const
+    {
+        uint64_t tag;
+        const uint8_t* data;
+        size_t length;
+        return get_typed_array(tag, &data, &length) && tag != 67 && tag != 71;
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_same<T,int64_t>::value || std::is_same<T,double>::value,bool>::type
+    is_typed_array() const
+    {
+        uint64_t tag;
+        const uint8_t* data;
+        size_t length;
+        return get_typed_array(tag, &data, &length) && tag != 67 && tag != 71 &&
+               detail::is_float_typed_array_tag(tag) == std::is_same<T,double>::value;
+    }
+
+    // The elements of a typed array, read in place
+    template <class T>
+    typename std::enable_if<std::is_same<T,int64_t>::value || std::is_same<T,double>::value,range<detail::typed_array_iterator<T>>>::type
+    typed_array_range() const
+    {
+        if (!is_typed_array<T>())
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a typed array of the requested element type"));
+        }
+        uint64_t tag;
+        const uint8_t* data;
+        size_t length;
+        get_typed_array(tag, &data, &length);
+        return range<detail::typed_array_iterator<T>>(detail::typed_array_iterator<T>(data, tag), 
+                                                      detail::typed_array_iterator<T>(data + length, tag));
+    }
+
     bool is_object() const
     {
         switch (major_type())
@@ -233,7 +307,7 @@ public:
                 return true;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.is_object();
             }
             default:
@@ -249,7 +323,7 @@ public:
                 return true;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.is_string();
             }
             default:
@@ -265,7 +339,7 @@ public:
                 return additional_information_value() != 0x1f;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.is_string_view();
             }
             default:
@@ -281,7 +355,7 @@ public:
                 return true;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.is_byte_string();
             }
             default:
@@ -297,7 +371,7 @@ public:
                 return additional_information_value() != 0x1f;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.is_byte_string();
             }
             default:
@@ -326,7 +400,7 @@ public:
                 }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.is_bool();
             }
             default:
@@ -350,7 +424,7 @@ public:
                 }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.is_double();
             }
             default:
@@ -384,7 +458,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.is_int64();
             }
             default:
@@ -400,7 +474,7 @@ public:
                 return true;
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.is_uint64();
             }
             default:
@@ -410,6 +484,12 @@ public:
 
     size_t size() const
     {
+        const cbor_index::container_entry* entry = find_entry();
+        if (entry != nullptr)
+        {
+            return entry->count;
+        }
+
         size_t len = 0;
         switch (major_type())
         {
@@ -427,7 +507,13 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                uint64_t tag;
+                const uint8_t* data;
+                if (get_typed_array(tag, &data, &len))
+                {
+                    return len / detail::typed_array_element_size(tag);
+                }
+                cbor_view v = tagged_item();
                 return v.size();
             }
             default:
@@ -451,6 +537,24 @@ public:
     cbor_view at(size_t index) const
     {
         JSONCONS_ASSERT(is_array());
+        if (major_type() == cbor_major_type::semantic_tag)
+        {
+            if (is_typed_array())
+            {
+                JSONCONS_THROW(json_exception_impl<std::runtime_error>("Typed array has no element views, use typed_array_range"));
+            }
+            return tagged_item().at(index);
+        }
+
+        const cbor_index::container_entry* entry = find_entry();
+        if (entry != nullptr)
+        {
+            const uint8_t* first;
+            const uint8_t* last;
+            index_->element(*entry, index, &first, &last);
+            return cbor_view(first, last-first, base_relative_, index_);
+        }
+
         const uint8_t* it = first_;
 
         detail::get_array_size(it, last_, &it);
@@ -473,12 +577,29 @@ public:
             JSONCONS_THROW(cbor_decode_error(0));
         }
 
-        return cbor_view(it, endp-it, base_relative_);
+        return cbor_view(it, endp-it, base_relative_, index_);
     }
 
     cbor_view at(const string_view_type& key) const
     {
         JSONCONS_ASSERT(is_object());
+        if (major_type() == cbor_major_type::semantic_tag)
+        {
+            return tagged_item().at(key);
+        }
+
+        const cbor_index::container_entry* entry = find_entry();
+        if (entry != nullptr && entry->has_key_table)
+        {
+            const uint8_t* first;
+            const uint8_t* last;
+            if (!index_->member(*entry, key, &first, &last))
+            {
+                JSONCONS_THROW(json_exception_impl<std::runtime_error>("Key not found"));
+            }
+            return cbor_view(first, last-first, base_relative_, index_);
+        }
+
         const uint8_t* it = first_;
 
         size_t len = detail::get_map_size(first_, last_, &it);
@@ -486,21 +607,14 @@ public:
         for (size_t i = 0; i < len; ++i)
         {
             const uint8_t* endp;
-            string_type a_key = detail::get_text_string(it, last_, &endp);
-            if (endp == it)
-            {
-                JSONCONS_THROW(cbor_decode_error(last_-it));
-            }
-            else
-            {
-                it = endp;
-            }
+            string_type a_key = key_at(it, &endp);
+            it = endp;
             if (a_key == key)
             {
                 const uint8_t* last;
                 detail::walk(it, last_, &last);
                 JSONCONS_ASSERT(last >= it);
-                return cbor_view(it, last-it, base_relative_);
+                return cbor_view(it, last-it, base_relative_, index_);
             }
             const uint8_t* last;
             detail::walk(it, last_, &last);
@@ -515,6 +629,19 @@ public:
         {
             return false;
         }
+        if (major_type() == cbor_major_type::semantic_tag)
+        {
+            return tagged_item().contains(key);
+        }
+
+        const cbor_index::container_entry* entry = find_entry();
+        if (entry != nullptr && entry->has_key_table)
+        {
+            const uint8_t* first;
+            const uint8_t* last;
+            return index_->member(*entry, key, &first, &last);
+        }
+
         const uint8_t* it = first_;
 
         size_t len = detail::get_map_size(it, last_, &it);
@@ -522,15 +649,8 @@ public:
         for (size_t i = 0; i < len; ++i)
         {
             const uint8_t* endp;
-            string_type a_key = detail::get_text_string(it, last_,&endp);
-            if (endp == it)
-            {
-                JSONCONS_THROW(cbor_decode_error(last_-it));
-            }
-            else
-            {
-                it = endp;
-            }
+            string_type a_key = key_at(it, &endp);
+            it = endp;
             if (a_key == key)
             {
                 return true;
@@ -575,7 +695,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_-(first_+1));
+                cbor_view v = tagged_item();
                 return v.as_integer<T>();
             }
             default:
@@ -602,7 +722,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_-(first_+1));
+                cbor_view v = tagged_item();
                 return v.as_integer<T>();
             }
             default:
@@ -626,7 +746,7 @@ public:
                 }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_ - (first_ + 1));
+                cbor_view v = tagged_item();
                 return v.as_bool();
             }
             default:
@@ -681,7 +801,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_-(first_+1));
+                cbor_view v = tagged_item();
                 return v.as_double();
             }
             default:
@@ -721,26 +841,16 @@ public:
                 {
                     case 2:
                     {
-                        const uint8_t* endp;
-                        std::vector<uint8_t> v = detail::get_byte_string(first_+1,last_,&endp);
-                        if (endp == first_+1)
-                        {
-                            JSONCONS_THROW(cbor_decode_error(0));
-                        }
-                        bignum n = bignum(1, v.data(), v.size());
+                        byte_string v = tagged_item().as_byte_string();
+                        bignum n = bignum(1, v.data(), v.length());
                         std::string s;
                         n.dump(s);
                         return s;
                     }
                     case 3:
                     {
-                        const uint8_t* endp;
-                        std::vector<uint8_t> v = detail::get_byte_string(first_+1,last_,&endp);
-                        if (endp == first_+1)
-                        {
-                            JSONCONS_THROW(cbor_decode_error(0));
-                        }
-                        bignum n = bignum(-1, v.data(), v.size());
+                        byte_string v = tagged_item().as_byte_string();
+                        bignum n = bignum(-1, v.data(), v.length());
                         std::string s;
                         n.dump(s);
                         return s;
@@ -756,7 +866,7 @@ public:
                         return s;
                     }
                     default:
-                        cbor_view v(first_ + 1, last_ - (first_ + 1));
+                        cbor_view v = tagged_item();
                         return v.as_string();
                 }
                 break;
@@ -787,7 +897,7 @@ public:
             }
             case cbor_major_type::semantic_tag:
             {
-                cbor_view v(first_ + 1, last_-(first_+1));
+                cbor_view v = tagged_item();
                 return v.as_byte_string<BAllocator>();
             }
             default:
@@ -809,24 +919,14 @@ public:
                 {
                     case 2:
                     {
-                        const uint8_t* endp;
-                        std::vector<uint8_t> v = detail::get_byte_string(first_+1,last_,&endp);
-                        if (endp == first_+1)
-                        {
-                            JSONCONS_THROW(cbor_decode_error(0));
-                        }
-                        bignum n = bignum(1, v.data(), v.size());
+                        byte_string v = tagged_item().as_byte_string();
+                        bignum n = bignum(1, v.data(), v.length());
                         return n;
                     }
                     case 3:
                     {
-                        const uint8_t* endp;
-                        std::vector<uint8_t> v = detail::get_byte_string(first_+1,last_,&endp);
-                        if (endp == first_+1)
-                        {
-                            JSONCONS_THROW(cbor_decode_error(0));
-                        }
-                        bignum n = bignum(-1, v.data(), v.size());
+                        byte_string v = tagged_item().as_byte_string();
+                        bignum n = bignum(-1, v.data(), v.length());
                         return n;
                     }
                     default:
@@ -956,7 +1056,7 @@ public:
                         JSONCONS_THROW(cbor_decode_error(0));
                     }
 
-                    cbor_view(it,endp-it).dump(handler);
+                    cbor_view(it,endp-it,base_relative_,index_).dump(handler);
                     it = endp;
                 }
                 handler.end_array();
@@ -970,11 +1070,7 @@ public:
                 for (size_t i = 0; i < len; ++i)
                 {
                     const uint8_t* endp;
-                    std::string key = detail::get_text_string(it, last_, &endp);
-                    if (endp == it)
-                    {
-                        JSONCONS_THROW(cbor_decode_error(last_-it));
-                    }
+                    std::string key = key_at(it, &endp);
                     handler.name(key);
                     it = endp;
                     detail::walk(it, last_, &endp);
@@ -983,7 +1079,7 @@ public:
                         JSONCONS_THROW(cbor_decode_error(0));
                     }
 
-                    cbor_view(it,endp-it).dump(handler);
+                    cbor_view(it,endp-it,base_relative_,index_).dump(handler);
                     it = endp;
                 }
                 handler.end_object();
@@ -994,23 +1090,13 @@ public:
                 uint8_t tag = additional_information_value();
                 if (tag == 2)
                 {
-                    const uint8_t* endp;
-                    std::vector<uint8_t> v = detail::get_byte_string(first_+1,last_,&endp);
-                    if (endp == first_+1)
-                    {
-                        JSONCONS_THROW(cbor_decode_error(0));
-                    }
-                    handler.bignum_value(1, v.data(), v.size());
+                    byte_string v = tagged_item().as_byte_string();
+                    handler.bignum_value(1, v.data(), v.length());
                 }
                 else if (tag == 3)
                 {
-                    const uint8_t* endp;
-                    std::vector<uint8_t> v = detail::get_byte_string(first_+1,last_,&endp);
-                    if (endp == first_+1)
-                    {
-                        JSONCONS_THROW(cbor_decode_error(0));
-                    }
-                    handler.bignum_value(-1, v.data(), v.size());
+                    byte_string v = tagged_item().as_byte_string();
+                    handler.bignum_value(-1, v.data(), v.length());
                 }
                 else if (tag == 4)
                 {
@@ -1022,6 +1108,28 @@ public:
                     }
                     handler.string_value(s, semantic_tag_type::decimal);
                 }
+                else if (is_typed_array<double>())
+                {
+                    handler.begin_array(size());
+                    for (double value : typed_array_range<double>())
+                    {
+                        handler.double_value(value);
+                    }
+                    handler.end_array();
+                }
+                else if (is_typed_array<int64_t>())
+                {
+                    handler.begin_array(size());
+                    for (int64_t value : typed_array_range<int64_t>())
+                    {
+                        handler.int64_value(value);
+                    }
+                    handler.end_array();
+                }
+                else
+                {
+                    tagged_item().dump(handler);
+                }
                 break;
             }
             case cbor_major_type::simple:
@@ -1083,7 +1191,155 @@ public:
         dump(handler);
     }
 #endif
+private:
+    const cbor_index::container_entry* find_entry() const
+    {
+        return index_ != nullptr ? index_->find(first_) : nullptr;
+    }
+
+    // Returns a view of the data item that the semantic tag at first_ 
+    // applies to, or for a stringref (tag 25), of the string it refers to,
+    // found by walking the namespace that encloses it
+    cbor_view tagged_item() const
+    {
+        uint64_t tag;
+        const uint8_t* p;
+        if (!detail::read_head(first_, last_, tag, &p))
+        {
+            JSONCONS_THROW(cbor_decode_error(0));
+        }
+        if (tag == 25)
+        {
+            const uint8_t* str_first;
+            const uint8_t* str_last;
+            if (!detail::find_stringref(base_relative_, first_, last_, &str_first, &str_last))
+            {
+                JSONCONS_THROW(cbor_decode_error(first_ - base_relative_));
+            }
+            return cbor_view(str_first, str_last - str_first, base_relative_, index_);
+        }
+        return cbor_view(p, last_ - p, base_relative_, index_);
+    }
+
+    // Gets the tag and element bytes of a typed array with a supported tag
+    bool get_typed_array(uint64_t& tag, const uint8_t** data, size_t* length) const
+    {
+        const uint8_t* p;
+        if (major_type() != cbor_major_type::semantic_tag || !detail::read_head(first_, last_, tag, &p) ||
+            !detail::is_typed_array_tag(tag))
+        {
+            return false;
+        }
+        const uint8_t* endp;
+        *length = detail::get_byte_string_length(p, last_, &endp);
+        if (endp == p || get_additional_information_value(*p) == additional_information::indefinite_length ||
+            *length % detail::typed_array_element_size(tag) != 0)
+        {
+            return false;
+        }
+        *data = endp;
+        return true;
+    }
+
+    string_type key_at(const uint8_t* it, const uint8_t** endp) const
+    {
+        if (it < last_ && get_major_type(*it) == cbor_major_type::semantic_tag)
+        {
+            detail::walk(it, last_, endp);
+            if (*endp == it)
+            {
+                JSONCONS_THROW(cbor_decode_error(last_-it));
+            }
+            return cbor_view(it, *endp - it, base_relative_, index_).as_string();
+        }
+        string_type key = detail::get_text_string(it, last_, endp);
+        if (*endp == it)
+        {
+            JSONCONS_THROW(cbor_decode_error(last_-it));
+        }
+        return key;
+    }
 };
+// Typed arrays are copied with a single memcpy when their elements are 
+// stored as T in the host's byte order
+
+template <class T>
+struct cbor_view_typed_array_traits
+{
+    static bool is(const cbor_view& v) JSONCONS_NOEXCEPT
+    {
+        if (v.is_typed_array())
+        {
+            return v.template is_typed_array<T>() || std::is_same<T,double>::value;
+        }
+        if (!v.is_array())
+        {
+            return false;
+        }
+        for (auto e : v.array_range())
+        {
+            if (!e.template is<T>())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static std::vector<T> as(const cbor_view& v)
+    {
+        std::vector<T> result;
+        if (v.template is_typed_array<T>())
+        {
+            auto r = v.template typed_array_range<T>();
+            detail::copy_typed_array(r.begin(), r.end(), result);
+        }
+        else if (v.is_typed_array())
+        {
+            typedef typename std::conditional<std::is_same<T,double>::value,int64_t,double>::type other_type;
+            auto r = v.template typed_array_range<other_type>();
+            result.reserve(v.size());
+            for (other_type e : r)
+            {
+                result.push_back(static_cast<T>(e));
+            }
+        }
+        else if (v.is_array())
+        {
+            result.reserve(v.size());
+            for (auto e : v.array_range())
+            {
+                result.push_back(e.template as<T>());
+            }
+        }
+        else
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Attempt to cast json non-array to array"));
+        }
+        return result;
+    }
+};
+
+}}
+
+namespace jsoncons {
+
+template<>
+struct json_type_traits<cbor::cbor_view, std::vector<double>> 
+    : public cbor::cbor_view_typed_array_traits<double>
+{
+};
+
+template<>
+struct json_type_traits<cbor::cbor_view, std::vector<int64_t>> 
+    : public cbor::cbor_view_typed_array_traits<int64_t>
+{
+};
+
+}
+
+namespace jsoncons { namespace cbor {
+
 // decode_cbor
 
 template<class Json>
@@ -1102,6 +1358,22 @@ void encode_cbor(const Json& j, std::vector<uint8_t>& v)
     j.dump(serializer);
 }
 
+template<class Json>
+void encode_cbor(const Json& j, std::basic_ostream<typename Json::char_type>& os, const cbor_serializing_options& options)
+{
+    typedef typename Json::char_type char_type;
+    basic_cbor_serializer<char_type> serializer(os, options);
+    j.dump(serializer);
+}
+
+template<class Json>
+void encode_cbor(const Json& j, std::vector<uint8_t>& v, const cbor_serializing_options& options)
+{
+    typedef typename Json::char_type char_type;
+    basic_cbor_serializer<char_type,jsoncons::detail::bytes_writer> serializer(v, options);
+    j.dump(serializer);
+}
+
 template<class Json>
 typename std::enable_if<std::is_same<typename Json::char_type,char>::value,Json>::type 
 decode_cbor(const cbor_view& v)
@@ -1139,23 +1411,9 @@ template<class Json>
 typename std::enable_if<std::is_same<typename Json::char_type,char>::value,Json>::type 
 decode_cbor(std::basic_istream<typename Json::char_type>& is)
 {
-    typedef typename Json::char_type char_type;
-
-    std::vector<uint8_t> v;
-    is.seekg(0, std::ios::end);   
-    v.resize((size_t)is.tellg());
-    is.seekg(0, std::ios::beg);    
-    is.read((char_type*)&v[0],v.size());
-
     jsoncons::json_decoder<Json> decoder;
-    cbor_parser parser(decoder);
-    parser.update(v.data(),v.size());
-    std::error_code ec;
-    parser.parse_some(ec);
-    if (ec)
-    {
-        throw parse_error(ec,parser.line_number(),parser.column_number());
-    }
+    cbor_reader reader(is, decoder);
+    reader.read_next();
     return decoder.get_result();
 }
 
@@ -0,0 +1,552 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_CSV_CSV_PARALLEL_READER_HPP
+#define JSONCONS_CSV_CSV_PARALLEL_READER_HPP
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include <exception>
+#include <system_error>
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_filter.hpp>
+#include <jsoncons/json_decoder.hpp>
+#include <jsoncons_ext/csv/csv_error_category.hpp>
+#include <jsoncons_ext/csv/csv_parser.hpp>
+#include <jsoncons_ext/csv/csv_serializing_options.hpp>
+
+namespace jsoncons { namespace csv {
+
+namespace detail {
+
+// Scans CSV text one record at a time, tracking whether it is inside a quoted
+// value and passing over comment lines, without decoding any values. It finds
+// where records begin, so that the text can be split into chunks that are
+// parsed independently.
+template<class CharT,class Allocator>
+class csv_record_scanner
+{
+    const CharT* p_;
+    const CharT* last_;
+    CharT quote_char_;
+    CharT quote_escape_char_;
+    CharT comment_starter_;
+    CharT specials_[4];
+    size_t specials_length_;
+    bool in_quotes_;
+    size_t lines_;
+public:
+    csv_record_scanner(const CharT* first, const CharT* last,
+                       const basic_csv_serializing_options<CharT,Allocator>& options)
+        : p_(first), last_(last),
+          quote_char_(options.quote_char()),
+          quote_escape_char_(options.quote_escape_char()),
+          comment_starter_(options.comment_starter()),
+          specials_length_(0),
+          in_quotes_(false),
+          lines_(0)
+    {
+        specials_[specials_length_++] = '\r';
+        specials_[specials_length_++] = '\n';
+        specials_[specials_length_++] = quote_char_;
+        if (quote_escape_char_ != quote_char_)
+        {
+            specials_[specials_length_++] = quote_escape_char_;
+        }
+    }
+
+    const CharT* position() const
+    {
+        return p_;
+    }
+
+    // The number of line ends passed, including those inside quoted values,
+    // as the parser counts them
+    size_t lines() const
+    {
+        return lines_;
+    }
+
+    // Advances past the end of the next record, returns false if there is none
+    bool next_record()
+    {
+        if (p_ == last_)
+        {
+            return false;
+        }
+        if (*p_ == comment_starter_ && !in_quotes_)
+        {
+            p_ = detail::find_special_char(p_, last_, specials_, 2);
+            return end_line();
+        }
+        while (p_ != last_)
+        {
+            p_ = detail::find_special_char(p_, last_, specials_, specials_length_);
+            if (p_ == last_)
+            {
+                break;
+            }
+            CharT c = *p_;
+            if (c == '\r' || c == '\n')
+            {
+                if (!in_quotes_)
+                {
+                    return end_line();
+                }
+                end_line();
+            }
+            else if (in_quotes_ && c == quote_escape_char_ && quote_escape_char_ != quote_char_)
+            {
+                p_ = (last_ - p_ > 1) ? p_ + 2 : last_;
+            }
+            else
+            {
+                in_quotes_ = !in_quotes_;
+                ++p_;
+            }
+        }
+        return true;
+    }
+private:
+    // Passes over the line end at p_, a \r\n pair counting as one
+    bool end_line()
+    {
+        if (p_ != last_)
+        {
+            if (*p_ == '\r' && last_ - p_ > 1 && p_[1] == '\n')
+            {
+                ++p_;
+            }
+            ++p_;
+            ++lines_;
+        }
+        return true;
+    }
+};
+
+// A range of whole records, and the result of parsing it
+template<class CharT,class Json>
+struct csv_chunk
+{
+    const CharT* first;
+    const CharT* last;
+    size_t line_offset;
+    Json result;
+    std::error_code ec;
+    size_t line;
+    size_t column;
+    std::exception_ptr exception;
+
+    csv_chunk(const CharT* first, const CharT* last, size_t line_offset)
+        : first(first), last(last), line_offset(line_offset), line(0), column(0)
+    {
+    }
+};
+
+// Splits CSV text into its header and chunks of whole records, and parses the
+// chunks on separate threads, each with its own basic_csv_parser given the
+// column names read from the header
+template<class CharT,class Json,class Allocator>
+class csv_chunked_parser
+{
+    basic_csv_serializing_options<CharT,Allocator> options_;
+    size_t num_threads_;
+    size_t min_chunk_length_;
+    std::vector<std::basic_string<CharT>> column_names_;
+    Json header_result_;
+    std::vector<csv_chunk<CharT,Json>> chunks_;
+    size_t line_;
+    size_t column_;
+public:
+    csv_chunked_parser(const basic_csv_serializing_options<CharT,Allocator>& options,
+                       size_t num_threads, size_t min_chunk_length)
+        : options_(options), num_threads_(num_threads), min_chunk_length_(min_chunk_length),
+          line_(0), column_(0)
+    {
+        if (num_threads_ == 0)
+        {
+            num_threads_ = (std::max)(std::thread::hardware_concurrency(), 1u);
+        }
+    }
+
+    // The header's rows for n_rows, or empty columns for m_columns
+    Json& header_result()
+    {
+        return header_result_;
+    }
+
+    std::vector<csv_chunk<CharT,Json>>& chunks()
+    {
+        return chunks_;
+    }
+
+    size_t line_number() const
+    {
+        return line_;
+    }
+
+    size_t column_number() const
+    {
+        return column_;
+    }
+
+    void parse(const CharT* first, const CharT* last, std::error_code& ec)
+    {
+        csv_record_scanner<CharT,Allocator> scanner(first, last, options_);
+
+        // The header is parsed by itself, with the options as given
+        const size_t header_lines = options_.header_lines();
+        while (scanner.lines() < header_lines && scanner.next_record())
+        {
+        }
+        const CharT* data_first = scanner.position();
+        size_t header_line_count = scanner.lines();
+        {
+            json_decoder<Json> decoder;
+            basic_csv_parser<CharT,Allocator> parser(decoder, options_);
+            parser.reset();
+            parser.update(first, data_first - first);
+            parser.parse_some(ec);
+            if (!ec)
+            {
+                parser.end_parse(ec);
+            }
+            if (ec)
+            {
+                line_ = parser.line_number();
+                column_ = parser.column_number();
+                return;
+            }
+            for (const auto& name : parser.column_labels())
+            {
+                column_names_.push_back(name);
+            }
+            header_result_ = decoder.get_result();
+        }
+
+        // The data records are split at record boundaries into chunks of at
+        // least min_chunk_length characters. A max_lines limit is counted
+        // from the start, so the data is then parsed as one chunk.
+        size_t data_length = static_cast<size_t>(last - data_first);
+        size_t num_chunks = (std::min)(num_threads_, data_length / (std::max)(min_chunk_length_, size_t(1)) + 1);
+        if (options_.max_lines() != (std::numeric_limits<unsigned long>::max)())
+        {
+            num_chunks = 1;
+        }
+        const CharT* chunk_first = data_first;
+        size_t chunk_line_offset = header_line_count;
+        for (size_t i = 1; i < num_chunks; ++i)
+        {
+            const CharT* target = data_first + i*(data_length/num_chunks);
+            while (scanner.position() < target && scanner.next_record())
+            {
+            }
+            if (scanner.position() > chunk_first && scanner.position() < last)
+            {
+                chunks_.emplace_back(chunk_first, scanner.position(), chunk_line_offset);
+                chunk_first = scanner.position();
+                chunk_line_offset = scanner.lines();
+            }
+        }
+        chunks_.emplace_back(chunk_first, last, chunk_line_offset);
+
+        // Each chunk is parsed without header lines, with the column names
+        // read from the header
+        basic_csv_serializing_options<CharT,Allocator> chunk_options(options_);
+        std::vector<std::basic_string<CharT,std::char_traits<CharT>,typename std::allocator_traits<Allocator>:: template rebind_alloc<CharT>>,
+                    typename std::allocator_traits<Allocator>:: template rebind_alloc<std::basic_string<CharT,std::char_traits<CharT>,typename std::allocator_traits<Allocator>:: template rebind_alloc<CharT>>>> names;
+        for (const auto& name : column_names_)
+        {
+            names.emplace_back(name.data(), name.size());
+        }
+        chunk_options.mapping(options_.mapping())
+                     .assume_header(false)
+                     .header_lines(0)
+                     .column_names(names);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < chunks_.size(); ++i)
+        {
+            csv_chunk<CharT,Json>* chunk = &chunks_[i];
+            threads.emplace_back([chunk,&chunk_options](){parse_chunk(*chunk, chunk_options);});
+        }
+        parse_chunk(chunks_[0], chunk_options);
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        // Errors are reported for the first chunk that has one, at its line
+        // in the whole text
+        for (auto& chunk : chunks_)
+        {
+            if (chunk.exception)
+            {
+                std::rethrow_exception(chunk.exception);
+            }
+            if (chunk.ec)
+            {
+                ec = chunk.ec;
+                line_ = chunk.line_offset + chunk.line;
+                column_ = chunk.column;
+                return;
+            }
+        }
+    }
+private:
+    static void parse_chunk(csv_chunk<CharT,Json>& chunk,
+                            const basic_csv_serializing_options<CharT,Allocator>& options)
+    {
+        try
+        {
+            json_decoder<Json> decoder;
+            basic_csv_parser<CharT,Allocator> parser(decoder, options);
+            parser.reset();
+            parser.update(chunk.first, chunk.last - chunk.first);
+            parser.parse_some(chunk.ec);
+            if (!chunk.ec)
+            {
+                parser.end_parse(chunk.ec);
+            }
+            if (chunk.ec)
+            {
+                chunk.line = parser.line_number();
+                chunk.column = parser.column_number();
+                return;
+            }
+            chunk.result = decoder.get_result();
+        }
+        catch (...)
+        {
+            chunk.exception = std::current_exception();
+        }
+    }
+};
+
+}
+
+// basic_csv_parallel_reader reads the whole of its input, splits the records
+// into chunks, and parses the chunks on separate threads. The results are
+// reported to the content handler in order, as basic_csv_reader reports them.
+
+template<class CharT,class Allocator=std::allocator<char>>
+class basic_csv_parallel_reader
+{
+    typedef basic_json<CharT,preserve_order_policy,Allocator> json_type;
+
+    basic_csv_parallel_reader(const basic_csv_parallel_reader&) = delete;
+    basic_csv_parallel_reader& operator = (const basic_csv_parallel_reader&) = delete;
+
+    std::basic_istream<CharT>& is_;
+    basic_json_content_handler<CharT>& handler_;
+    basic_csv_serializing_options<CharT,Allocator> options_;
+    size_t num_threads_;
+    size_t min_chunk_length_;
+    size_t line_;
+    size_t column_;
+public:
+    static const size_t default_min_chunk_length = 1048576;
+
+    basic_csv_parallel_reader(std::basic_istream<CharT>& is,
+                              basic_json_content_handler<CharT>& handler)
+        : basic_csv_parallel_reader(is, handler, basic_csv_serializing_options<CharT,Allocator>())
+    {
+    }
+
+    basic_csv_parallel_reader(std::basic_istream<CharT>& is,
+                              basic_json_content_handler<CharT>& handler,
+                              const basic_csv_serializing_options<CharT,Allocator>& options)
+        : is_(is),
+          handler_(handler),
+          options_(options),
+          num_threads_(0),
+          min_chunk_length_(default_min_chunk_length),
+          line_(0),
+          column_(0)
+    {
+    }
+
+    // The number of chunks to parse at once, by default the number of hardware threads
+    size_t num_threads() const
+    {
+        return num_threads_;
+    }
+
+    void num_threads(size_t value)
+    {
+        num_threads_ = value;
+    }
+
+    // Input shorter than this is not split
+    size_t min_chunk_length() const
+    {
+        return min_chunk_length_;
+    }
+
+    void min_chunk_length(size_t value)
+    {
+        min_chunk_length_ = value;
+    }
+
+    size_t line_number() const
+    {
+        return line_;
+    }
+
+    size_t column_number() const
+    {
+        return column_;
+    }
+
+    void read()
+    {
+        std::error_code ec;
+        read(ec);
+        if (ec)
+        {
+            throw parse_error(ec,line_,column_);
+        }
+    }
+
+    void read(std::error_code& ec)
+    {
+        std::basic_string<CharT> text = read_all(is_);
+
+        detail::csv_chunked_parser<CharT,json_type,Allocator> parser(options_, num_threads_, min_chunk_length_);
+        parser.parse(text.data(), text.data() + text.length(), ec);
+        if (ec)
+        {
+            line_ = parser.line_number();
+            column_ = parser.column_number();
+            return;
+        }
+
+        basic_json_fragment_filter<CharT> filter(handler_);
+        json_type& header = parser.header_result();
+        if (options_.mapping() == mapping_type::m_columns)
+        {
+            handler_.begin_object();
+            for (const auto& column : header.object_range())
+            {
+                handler_.name(column.key());
+                handler_.begin_array();
+                for (auto& chunk : parser.chunks())
+                {
+                    auto it = chunk.result.find(column.key());
+                    if (it != chunk.result.object_range().end())
+                    {
+                        for (const auto& item : it->value().array_range())
+                        {
+                            item.dump(filter);
+                        }
+                    }
+                }
+                handler_.end_array();
+            }
+            handler_.end_object();
+        }
+        else
+        {
+            handler_.begin_array();
+            for (const auto& item : header.array_range())
+            {
+                item.dump(filter);
+            }
+            for (auto& chunk : parser.chunks())
+            {
+                for (const auto& item : chunk.result.array_range())
+                {
+                    item.dump(filter);
+                }
+            }
+            handler_.end_array();
+        }
+        handler_.flush();
+    }
+
+    static std::basic_string<CharT> read_all(std::basic_istream<CharT>& is)
+    {
+        std::basic_string<CharT> text;
+        std::vector<CharT> buffer(default_min_chunk_length);
+        while (is)
+        {
+            is.read(buffer.data(), buffer.size());
+            text.append(buffer.data(), static_cast<size_t>(is.gcount()));
+        }
+        return text;
+    }
+};
+
+// Parses CSV text into one Json value on separate threads, moving each
+// chunk's rows or column values into the result rather than replaying them
+
+template <class Json,class Allocator>
+Json decode_csv_parallel(typename Json::string_view_type s,
+                         const basic_csv_serializing_options<typename Json::char_type,Allocator>& options,
+                         size_t num_threads = 0,
+                         size_t min_chunk_length = basic_csv_parallel_reader<typename Json::char_type,Allocator>::default_min_chunk_length)
+{
+    typedef typename Json::char_type char_type;
+
+    detail::csv_chunked_parser<char_type,Json,Allocator> parser(options, num_threads, min_chunk_length);
+    std::error_code ec;
+    parser.parse(s.data(), s.data() + s.length(), ec);
+    if (ec)
+    {
+        throw parse_error(ec,parser.line_number(),parser.column_number());
+    }
+
+    Json result = std::move(parser.header_result());
+    if (options.mapping() == mapping_type::m_columns)
+    {
+        for (auto& column : result.object_range())
+        {
+            for (auto& chunk : parser.chunks())
+            {
+                auto it = chunk.result.find(column.key());
+                if (it != chunk.result.object_range().end())
+                {
+                    for (auto& item : it->value().array_range())
+                    {
+                        column.value().push_back(std::move(item));
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        for (auto& chunk : parser.chunks())
+        {
+            for (auto& item : chunk.result.array_range())
+            {
+                result.push_back(std::move(item));
+            }
+        }
+    }
+    return result;
+}
+
+template <class Json,class Allocator>
+Json decode_csv_parallel(std::basic_istream<typename Json::char_type>& is,
+                         const basic_csv_serializing_options<typename Json::char_type,Allocator>& options,
+                         size_t num_threads = 0,
+                         size_t min_chunk_length = basic_csv_parallel_reader<typename Json::char_type,Allocator>::default_min_chunk_length)
+{
+    std::basic_string<typename Json::char_type> text = basic_csv_parallel_reader<typename Json::char_type,Allocator>::read_all(is);
+    return decode_csv_parallel<Json>(typename Json::string_view_type(text.data(), text.length()), options, num_threads, min_chunk_length);
+}
+
+typedef basic_csv_parallel_reader<char> csv_parallel_reader;
+typedef basic_csv_parallel_reader<wchar_t> wcsv_parallel_reader;
+
+}}
+
+#endif
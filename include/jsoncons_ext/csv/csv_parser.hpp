@@ -16,6 +16,8 @@
 #include <stdexcept>
 #include <system_error>
 #include <cctype>
+#include <cstring>
+#include <algorithm>
 #include <jsoncons/json_exception.hpp>
 #include <jsoncons/json_content_handler.hpp>
 #include <jsoncons/parse_error_handler.hpp>
@@ -55,6 +57,109 @@ enum class csv_state_type
     done
 };
 
+namespace detail {
+
+// Returns the first character in [first,last) that is one of the length 
+// characters in specials, or last if there is none
+template <class CharT>
+const CharT* find_special_char(const CharT* first, const CharT* last, const CharT* specials, size_t length)
+{
+    for (; first != last; ++first)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (*first == specials[i])
+            {
+                return first;
+            }
+        }
+    }
+    return last;
+}
+
+// Narrow characters are tested eight at a time. For each special character, 
+// a word is xor'ed with the character repeated in every byte, and a byte that
+// becomes zero is detected with (x - 0x01..01) & ~x & 0x80..80. Words without
+// any of the specials are skipped; the word with the first one is searched 
+// one character at a time.
+inline
+const char* find_special_char(const char* first, const char* last, const char* specials, size_t length)
+{
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+
+    uint64_t patterns[8];
+    JSONCONS_ASSERT(length <= 8);
+    for (size_t i = 0; i < length; ++i)
+    {
+        patterns[i] = ones * static_cast<uint8_t>(specials[i]);
+    }
+    while (last - first >= static_cast<std::ptrdiff_t>(sizeof(uint64_t)))
+    {
+        uint64_t word;
+        std::memcpy(&word, first, sizeof(uint64_t));
+        uint64_t found = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            uint64_t x = word ^ patterns[i];
+            found |= (x - ones) & ~x & highs;
+        }
+        if (found != 0)
+        {
+            break;
+        }
+        first += sizeof(uint64_t);
+    }
+    return find_special_char<char>(first, last, specials, length);
+}
+
+// Resolves selected columns, names against the column names and otherwise as 
+// zero-based indexes, to whether each column is selected
+template <class String1,class Allocator1,class String2,class Allocator2>
+std::vector<bool> resolve_selected_columns(const std::vector<String1,Allocator1>& selected,
+                                           const std::vector<String2,Allocator2>& column_names)
+{
+    std::vector<bool> column_selected;
+    for (const auto& item : selected)
+    {
+        size_t index = column_names.size();
+        for (size_t i = 0; i < column_names.size(); ++i)
+        {
+            if (item.size() == column_names[i].size() && std::equal(item.begin(), item.end(), column_names[i].begin()))
+            {
+                index = i;
+                break;
+            }
+        }
+        if (index == column_names.size())
+        {
+            bool is_index = !item.empty();
+            for (auto c : item)
+            {
+                is_index = is_index && c >= '0' && c <= '9';
+            }
+            if (!is_index)
+            {
+                continue;
+            }
+            auto result = jsoncons::detail::to_integer<size_t>(item.data(), item.size());
+            if (result.overflow)
+            {
+                continue;
+            }
+            index = result.value;
+        }
+        if (index >= column_selected.size())
+        {
+            column_selected.resize(index + 1, false);
+        }
+        column_selected[index] = true;
+    }
+    return column_selected;
+}
+
+}
+
 template<class CharT,class Allocator=std::allocator<CharT>>
 class basic_csv_parser : private serializing_context
 {
@@ -71,6 +176,9 @@ class basic_csv_parser : private serializing_context
 
     static const int default_depth = 3;
 
+    // The values seen in a column while sampling for type inference
+    enum class sampled_type {none, integer, fraction, other};
+
     default_parse_error_handler default_err_handler_;
     csv_state_type state_;
     int top_;
@@ -97,6 +205,23 @@ class basic_csv_parser : private serializing_context
     const CharT* input_end_;
     const CharT* input_ptr_;
     bool continue_;
+    // The characters that end a run of ordinary characters in an unquoted
+    // value, a quoted value and a comment
+    CharT unquoted_specials_[5];
+    size_t unquoted_specials_length_;
+    CharT quoted_specials_[4];
+    CharT line_end_specials_[2];
+    // Whether each column is read, when the options select columns. The
+    // characters of other columns are passed over without being buffered.
+    bool has_selected_columns_;
+    std::vector<bool> column_selected_;
+    bool value_skipped_;
+    // With infer_types_sample_rows, the values in each column are sampled 
+    // until that many rows have been read, and a column of integers or of 
+    // fixed point numbers is then locked to that type
+    size_t sampled_rows_;
+    std::vector<sampled_type> sampled_types_;
+    std::vector<csv_column_type> locked_types_;
 
 public:
     basic_csv_parser(basic_json_content_handler<CharT>& handler)
@@ -130,7 +255,10 @@ public:
          begin_input_(nullptr),
          input_end_(nullptr),
          input_ptr_(nullptr),
-         continue_(true)
+         continue_(true),
+         has_selected_columns_(false),
+         value_skipped_(false),
+         sampled_rows_(0)
     {
         depth_ = default_depth;
         state_ = csv_state_type::start;
@@ -138,6 +266,22 @@ public:
         line_ = 1;
         column_ = 0;
         column_index_ = 0;
+
+        unquoted_specials_length_ = 0;
+        unquoted_specials_[unquoted_specials_length_++] = parameters_.field_delimiter();
+        unquoted_specials_[unquoted_specials_length_++] = parameters_.quote_char();
+        unquoted_specials_[unquoted_specials_length_++] = '\r';
+        unquoted_specials_[unquoted_specials_length_++] = '\n';
+        if (parameters_.subfield_delimiter().second)
+        {
+            unquoted_specials_[unquoted_specials_length_++] = parameters_.subfield_delimiter().first;
+        }
+        quoted_specials_[0] = parameters_.quote_char();
+        quoted_specials_[1] = parameters_.quote_escape_char();
+        quoted_specials_[2] = '\r';
+        quoted_specials_[3] = '\n';
+        line_end_specials_[0] = '\r';
+        line_end_specials_[1] = '\n';
     }
 
     ~basic_csv_parser()
@@ -154,6 +298,12 @@ public:
         return !continue_;
     }
 
+    // Continues parsing after the content handler has stopped it
+    void restart()
+    {
+        continue_ = true;
+    }
+
     bool source_exhausted() const
     {
         return input_ptr_ == input_end_;
@@ -179,7 +329,7 @@ public:
             switch (parameters_.mapping())
             {
             case mapping_type::n_objects:
-                if (!(parameters_.ignore_empty_values() && value_buffer_.size() == 0))
+                if (!(parameters_.ignore_empty_values() && value_buffer_.size() == 0) && is_selected(column_index_))
                 {
                     if (column_index_ < column_names_.size() + offset_)
                     {
@@ -199,6 +349,10 @@ public:
     void before_multi_valued_field()
     {
         push_mode(csv_mode_type::subfields);
+        if (!is_selected(column_index_))
+        {
+            return;
+        }
         switch (parameters_.mapping())
         {
         case mapping_type::n_rows:
@@ -218,17 +372,20 @@ public:
         if (stack_[top_] == csv_mode_type::subfields)
         {
             pop_mode(csv_mode_type::subfields);
-            switch (parameters_.mapping())
+            if (is_selected(column_index_))
             {
-            case mapping_type::n_rows:
-            case mapping_type::n_objects:
-                continue_ = handler_.end_array(*this);
-                break;
-            case mapping_type::m_columns:
-                decoders_[column_index_].end_array(*this);
-                break;
-            default:
-                break;
+                switch (parameters_.mapping())
+                {
+                case mapping_type::n_rows:
+                case mapping_type::n_objects:
+                    continue_ = handler_.end_array(*this);
+                    break;
+                case mapping_type::m_columns:
+                    decoders_[column_index_].end_array(*this);
+                    break;
+                default:
+                    break;
+                }
             }
         }
         ++column_index_;
@@ -272,15 +429,19 @@ public:
                 flip(csv_mode_type::header, csv_mode_type::data);
             }
             column_values_.resize(column_names_.size());
+            select_columns();
             switch (parameters_.mapping())
             {
             case mapping_type::n_rows:
                 if (column_names_.size() > 0)
                 {
                     continue_ = handler_.begin_array(*this);
-                    for (const auto& name : column_names_)
+                    for (size_t i = 0; i < column_names_.size(); ++i)
                     {
-                        continue_ = handler_.string_value(name, semantic_tag_type::none, *this);
+                        if (is_selected(i))
+                        {
+                            continue_ = handler_.string_value(column_names_[i], semantic_tag_type::none, *this);
+                        }
                     }
                     continue_ = handler_.end_array(*this);
                 }
@@ -309,6 +470,10 @@ public:
             default:
                 break;
             }
+            if (sampled_rows_ < parameters_.infer_types_sample_rows() && ++sampled_rows_ == parameters_.infer_types_sample_rows())
+            {
+                lock_types();
+            }
         }
         column_index_ = 0;
     }
@@ -329,6 +494,7 @@ public:
         {
             column_defaults_.emplace_back(name.data(), name.size());
         }
+        select_columns();
         if (parameters_.header_lines() > 0)
         {
             push_mode(csv_mode_type::header);
@@ -336,6 +502,15 @@ public:
         else
         {
             push_mode(csv_mode_type::data);
+            // Without header lines, the columns are those named in the options
+            if (parameters_.mapping() == mapping_type::m_columns)
+            {
+                for (size_t i = 0; i < column_names_.size(); ++i)
+                {
+                    decoders_.push_back(json_decoder<json_type>());
+                    decoders_.back().begin_array(*this);
+                }
+            }
         }
         if (parameters_.mapping() != mapping_type::m_columns)
         {
@@ -371,7 +546,7 @@ public:
                 {
                     trim_string_buffer(parameters_.trim_leading(),parameters_.trim_trailing());
                 }
-                if (!parameters_.ignore_empty_lines() || (column_index_ > 0 || value_buffer_.length() > 0))
+                if (!parameters_.ignore_empty_lines() || (column_index_ > 0 || value_buffer_.length() > 0 || value_skipped_))
                 {
                     if (column_index_ == 0)
                     {
@@ -425,10 +600,13 @@ public:
                 continue_ = handler_.begin_object(*this);
                 for (size_t i = 0; i < column_names_.size(); ++i)
                 {
-                    continue_ = handler_.name(column_names_[i],*this);
-                    decoders_[i].end_array(*this);
-                    decoders_[i].flush();
-                    decoders_[i].get_result().dump(fragment_filter);
+                    if (is_selected(i))
+                    {
+                        continue_ = handler_.name(column_names_[i],*this);
+                        decoders_[i].end_array(*this);
+                        decoders_[i].flush();
+                        decoders_[i].get_result().dump(fragment_filter);
+                    }
                 }
                 continue_ = handler_.end_object(*this);
             }
@@ -444,6 +622,7 @@ public:
                 return;
             }
             handler_.flush();
+            state_ = csv_state_type::done;
             continue_ = false;
         }
 
@@ -463,6 +642,10 @@ all_csv_states:
                     state_ = csv_state_type::expect_value;
                     goto all_csv_states;
                 }
+                else if (curr_char != '\r')
+                {
+                    curr_char = skip_ordinary_chars(local_input_end, line_end_specials_, 2);
+                }
                 break;
             case csv_state_type::expect_value:
                 if (column_ == 1 && curr_char == parameters_.comment_starter())
@@ -479,7 +662,14 @@ all_csv_states:
                 {
                     if (curr_char == parameters_.quote_char())
                     {
-                        value_buffer_.push_back(static_cast<CharT>(curr_char));
+                        if (skip_value())
+                        {
+                            value_skipped_ = true;
+                        }
+                        else
+                        {
+                            value_buffer_.push_back(static_cast<CharT>(curr_char));
+                        }
                         state_ = csv_state_type::quoted_string;
                     }
                     else if (parameters_.quote_escape_char() == parameters_.quote_char())
@@ -499,10 +689,21 @@ all_csv_states:
                     {
                         state_ = csv_state_type::between_fields;
                     }
-                    else
+                    else if (skip_value())
+                    {
+                        if (curr_char != '\r' && curr_char != '\n')
+                        {
+                            curr_char = skip_value_chars(local_input_end, quoted_specials_, 4);
+                        }
+                    }
+                    else if (curr_char == '\r' || curr_char == '\n')
                     {
                         value_buffer_.push_back(static_cast<CharT>(curr_char));
                     }
+                    else
+                    {
+                        curr_char = append_ordinary_chars(local_input_end, quoted_specials_, 4);
+                    }
                 }
                 break;
             case csv_state_type::between_fields:
@@ -515,7 +716,7 @@ all_csv_states:
                     {
                         trim_string_buffer(parameters_.trim_leading(),parameters_.trim_trailing());
                     }
-                    if (!parameters_.ignore_empty_lines() || (column_index_ > 0 || value_buffer_.length() > 0))
+                    if (!parameters_.ignore_empty_lines() || (column_index_ > 0 || value_buffer_.length() > 0 || value_skipped_))
                     {
                         if (column_index_ == 0)
                         {
@@ -570,7 +771,7 @@ all_csv_states:
                         {
                             trim_string_buffer(parameters_.trim_leading(),parameters_.trim_trailing());
                         }
-                        if (!parameters_.ignore_empty_lines() || (column_index_ > 0 || value_buffer_.length() > 0))
+                        if (!parameters_.ignore_empty_lines() || (column_index_ > 0 || value_buffer_.length() > 0 || value_skipped_))
                         {
                             if (column_index_ == 0)
                             {
@@ -616,9 +817,13 @@ all_csv_states:
                         value_buffer_.clear();
                         state_ = csv_state_type::quoted_string;
                     }
+                    else if (skip_value())
+                    {
+                        curr_char = skip_value_chars(local_input_end, unquoted_specials_, unquoted_specials_length_);
+                    }
                     else
                     {
-                        value_buffer_.push_back(static_cast<CharT>(curr_char));
+                        curr_char = append_ordinary_chars(local_input_end, unquoted_specials_, unquoted_specials_length_);
                     }
                 }
                 break;
@@ -700,6 +905,69 @@ all_csv_states:
     }
 private:
 
+    // Advances past the ordinary characters that follow the one at input_ptr_,
+    // up to the next special character, leaving input_ptr_ at the last one,
+    // and returns it. None of them is a line end, so only the column changes.
+    CharT skip_ordinary_chars(const CharT* local_input_end, const CharT* specials, size_t length)
+    {
+        const CharT* run_end = detail::find_special_char(input_ptr_ + 1, local_input_end, specials, length);
+        column_ += static_cast<unsigned long>(run_end - input_ptr_ - 1);
+        input_ptr_ = run_end - 1;
+        return *input_ptr_;
+    }
+
+    // As skip_ordinary_chars, and appends the characters to the value buffer 
+    // together
+    CharT append_ordinary_chars(const CharT* local_input_end, const CharT* specials, size_t length)
+    {
+        const CharT* first = input_ptr_;
+        CharT last_char = skip_ordinary_chars(local_input_end, specials, length);
+        value_buffer_.append(first, input_ptr_ + 1);
+        return last_char;
+    }
+
+    // As skip_ordinary_chars, for a value in a column that is not selected. 
+    // Whether the first value in a line had any characters (other than
+    // whitespace, when trimming) is kept, as it decides if the line is empty.
+    CharT skip_value_chars(const CharT* local_input_end, const CharT* specials, size_t length)
+    {
+        const CharT* first = input_ptr_;
+        CharT last_char = skip_ordinary_chars(local_input_end, specials, length);
+        if (column_index_ == 0 && !value_skipped_)
+        {
+            if (parameters_.trim_leading() || parameters_.trim_trailing())
+            {
+                for (const CharT* p = first; !value_skipped_ && p <= input_ptr_; ++p)
+                {
+                    value_skipped_ = !((*p < 256) && std::isspace(*p));
+                }
+            }
+            else
+            {
+                value_skipped_ = true;
+            }
+        }
+        return last_char;
+    }
+
+    void select_columns()
+    {
+        has_selected_columns_ = !parameters_.selected_columns().empty();
+        column_selected_ = detail::resolve_selected_columns(parameters_.selected_columns(), column_names_);
+    }
+
+    bool is_selected(size_t column_index) const
+    {
+        return !has_selected_columns_ || (column_index < column_selected_.size() && column_selected_[column_index]);
+    }
+
+    // Values in columns that are not selected are passed over, except in the 
+    // header, which gives the column names
+    bool skip_value() const
+    {
+        return has_selected_columns_ && stack_[top_] != csv_mode_type::header && !is_selected(column_index_);
+    }
+
     void trim_string_buffer(bool trim_leading, bool trim_trailing)
     {
         size_t start = 0;
@@ -746,6 +1014,10 @@ private:
         {
         case csv_mode_type::data:
         case csv_mode_type::subfields:
+            if (!is_selected(column_index_))
+            {
+                break;
+            }
             switch (parameters_.mapping())
             {
             case mapping_type::n_rows:
@@ -801,6 +1073,7 @@ private:
         }
         state_ = csv_state_type::expect_value;
         value_buffer_.clear();
+        value_skipped_ = false;
     }
 
     void end_quoted_string_value(std::error_code& ec) 
@@ -815,6 +1088,10 @@ private:
             break;
         case csv_mode_type::data:
         case csv_mode_type::subfields:
+            if (!is_selected(column_index_))
+            {
+                break;
+            }
             switch (parameters_.mapping())
             {
             case mapping_type::n_rows:
@@ -863,6 +1140,7 @@ private:
         }
         state_ = csv_state_type::expect_value;
         value_buffer_.clear();
+        value_skipped_ = false;
     }
 
     void end_value(const string_view_type& value, size_t column_index, bool infer_types, basic_json_content_handler<CharT>& handler)
@@ -1003,7 +1281,7 @@ private:
         {
             if (infer_types)
             {
-                end_value_with_numeric_check(value, handler);
+                end_inferred_value(value, column_index, handler);
             }
             else
             {
@@ -1028,7 +1306,7 @@ private:
         done
     };
 
-    void end_value_with_numeric_check(const string_view_type& value, basic_json_content_handler<CharT>& handler)
+    numeric_check_state end_value_with_numeric_check(const string_view_type& value, basic_json_content_handler<CharT>& handler)
     {
         numeric_check_state state = numeric_check_state::initial;
         bool is_negative = false;
@@ -1288,6 +1566,179 @@ private:
         default:
             handler.string_value(value, semantic_tag_type::none, *this);
         }
+        return state;
+    }
+
+    // Converts a value in a column locked to a type with the routine for 
+    // that type, and otherwise, or if the value is not of that type, as 
+    // end_value_with_numeric_check does
+    void end_inferred_value(const string_view_type& value, size_t column_index, basic_json_content_handler<CharT>& handler)
+    {
+        if (column_index < locked_types_.size())
+        {
+            switch (locked_types_[column_index])
+            {
+            case csv_column_type::integer_t:
+                if (end_integer_value(value, handler))
+                {
+                    return;
+                }
+                break;
+            case csv_column_type::float_t:
+                if (end_fixed_value(value, handler))
+                {
+                    return;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        numeric_check_state state = end_value_with_numeric_check(value, handler);
+        if (sampled_rows_ < parameters_.infer_types_sample_rows() && value.length() > 0)
+        {
+            if (column_index >= sampled_types_.size())
+            {
+                sampled_types_.resize(column_index + 1, sampled_type::none);
+            }
+            sampled_type& sampled = sampled_types_[column_index];
+            switch (state)
+            {
+            case numeric_check_state::zero:
+            case numeric_check_state::integer:
+                if (sampled == sampled_type::none)
+                {
+                    sampled = sampled_type::integer;
+                }
+                break;
+            case numeric_check_state::fraction:
+                if (sampled == sampled_type::none || sampled == sampled_type::integer)
+                {
+                    sampled = sampled_type::fraction;
+                }
+                break;
+            default:
+                sampled = sampled_type::other;
+                break;
+            }
+        }
+    }
+
+    void lock_types()
+    {
+        locked_types_.assign(sampled_types_.size(), csv_column_type::string_t);
+        for (size_t i = 0; i < sampled_types_.size(); ++i)
+        {
+            switch (sampled_types_[i])
+            {
+            case sampled_type::integer:
+                locked_types_[i] = csv_column_type::integer_t;
+                break;
+            case sampled_type::fraction:
+                locked_types_[i] = csv_column_type::float_t;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // Reports an integer as end_value_with_numeric_check would, returns false
+    // if the value is not one: an optional minus, and digits without a 
+    // leading zero, that do not overflow
+    bool end_integer_value(const string_view_type& value, basic_json_content_handler<CharT>& handler)
+    {
+        const CharT* p = value.data();
+        const CharT* last = p + value.length();
+        bool is_negative = p != last && *p == '-';
+        if (is_negative)
+        {
+            ++p;
+        }
+        if (p == last || (*p == '0' && last - p > 1))
+        {
+            return false;
+        }
+        for (const CharT* q = p; q != last; ++q)
+        {
+            if (*q < '0' || *q > '9')
+            {
+                return false;
+            }
+        }
+        if (is_negative)
+        {
+            auto result = jsoncons::detail::to_integer<int64_t>(value.data(), value.length());
+            if (result.overflow)
+            {
+                return false;
+            }
+            handler.int64_value(result.value, semantic_tag_type::none, *this);
+        }
+        else
+        {
+            auto result = jsoncons::detail::to_integer<uint64_t>(value.data(), value.length());
+            if (result.overflow)
+            {
+                return false;
+            }
+            handler.uint64_value(result.value, semantic_tag_type::none, *this);
+        }
+        return true;
+    }
+
+    // Reports a fixed point number as end_value_with_numeric_check would,
+    // returns false if the value is not one: an optional minus, an integer
+    // part without a leading zero, a decimal point, and one or more digits
+    bool end_fixed_value(const string_view_type& value, basic_json_content_handler<CharT>& handler)
+    {
+        const size_t max_length = 63;
+        if (value.length() > max_length)
+        {
+            return false;
+        }
+        char buffer[max_length+1];
+        size_t length = 0;
+        uint8_t precision = 0;
+        uint8_t decimal_places = 0;
+
+        const CharT* p = value.data();
+        const CharT* last = p + value.length();
+        if (p != last && *p == '-')
+        {
+            buffer[length++] = '-';
+            ++p;
+        }
+        const CharT* integer_first = p;
+        for (; p != last && *p >= '0' && *p <= '9'; ++p)
+        {
+            buffer[length++] = static_cast<char>(*p);
+            ++precision;
+        }
+        if (p == integer_first || (*integer_first == '0' && p - integer_first > 1) || p == last || *p != '.')
+        {
+            return false;
+        }
+        buffer[length++] = to_double_.get_decimal_point();
+        ++p;
+        if (p == last)
+        {
+            return false;
+        }
+        for (; p != last; ++p)
+        {
+            if (*p < '0' || *p > '9')
+            {
+                return false;
+            }
+            buffer[length++] = static_cast<char>(*p);
+            ++precision;
+            ++decimal_places;
+        }
+        buffer[length] = 0;
+        double d = to_double_(buffer, length);
+        handler.double_value(d, floating_point_options(chars_format::fixed, precision, decimal_places), semantic_tag_type::none, *this);
+        return true;
     }
 
     void push_mode(csv_mode_type mode)
@@ -97,10 +97,12 @@ class basic_csv_serializing_options
     size_t header_lines_;
     string_type line_delimiter_;
     bool infer_types_;
+    size_t infer_types_sample_rows_;
 
     std::vector<string_type,string_allocator_type> column_names_;
     std::vector<csv_type_info,csv_type_info_allocator_type> column_types_;
     std::vector<string_type,string_allocator_type> column_defaults_;
+    std::vector<string_type,string_allocator_type> selected_columns_;
 public:
     static const size_t default_indent = 4;
 
@@ -128,7 +130,8 @@ public:
         mapping_({mapping_type::n_rows,false}),
         max_lines_((std::numeric_limits<unsigned long>::max)()),
         header_lines_(0),
-        infer_types_(true)
+        infer_types_(true),
+        infer_types_sample_rows_(0)
     {
         line_delimiter_.push_back('\n');
     }
@@ -354,6 +357,19 @@ public:
         return *this;
     }
 
+    std::vector<string_type,string_allocator_type> selected_columns() const
+    {
+        return selected_columns_;
+    }
+
+    // A comma separated list of the columns to read, each a column name or a
+    // zero-based column index
+    basic_csv_serializing_options& selected_columns(const string_type& columns)
+    {
+        selected_columns_ = parse_column_names(columns);
+        return *this;
+    }
+
     CharT field_delimiter() const
     {
         return field_delimiter_;
@@ -410,6 +426,19 @@ public:
         return *this;
     }
 
+    size_t infer_types_sample_rows() const
+    {
+        return infer_types_sample_rows_;
+    }
+
+    // The number of data rows from which the type of each column is inferred,
+    // after which a column is converted as that type, 0 for no limit
+    basic_csv_serializing_options& infer_types_sample_rows(size_t value)
+    {
+        infer_types_sample_rows_ = value;
+        return *this;
+    }
+
     CharT quote_escape_char() const
     {
         return quote_escape_char_;
@@ -0,0 +1,364 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_CSV_CSV_STREAM_READER_HPP
+#define JSONCONS_CSV_CSV_STREAM_READER_HPP
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <system_error>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons/parse_error_handler.hpp>
+#include <jsoncons/stream_reader.hpp>
+#include <jsoncons_ext/csv/csv_error_category.hpp>
+#include <jsoncons_ext/csv/csv_parser.hpp>
+#include <jsoncons_ext/csv/csv_serializing_options.hpp>
+
+namespace jsoncons { namespace csv {
+
+namespace detail {
+
+// Queues the events that basic_csv_parser reports, and stops the parser at
+// the end of each record. The parser may report several events for one
+// character, so they cannot be taken one at a time. Names and strings are
+// copied into one buffer, which is reused once the queue has been read.
+
+template <class CharT>
+class csv_stream_event_queue final : public basic_json_content_handler<CharT>
+{
+public:
+    using typename basic_json_content_handler<CharT>::string_view_type;
+private:
+    struct queued_event
+    {
+        basic_stream_event<CharT> event;
+        size_t offset;
+        size_t length;
+
+        queued_event(const basic_stream_event<CharT>& event, size_t offset, size_t length)
+            : event(event), offset(offset), length(length)
+        {
+        }
+    };
+
+    std::vector<queued_event> events_;
+    std::basic_string<CharT> strings_;
+    size_t position_;
+    basic_stream_event<CharT> current_;
+    int level_;
+public:
+    csv_stream_event_queue()
+        : position_(0), current_(stream_event_type::null_value), level_(0)
+    {
+    }
+
+    bool empty() const
+    {
+        return position_ == events_.size();
+    }
+
+    const basic_stream_event<CharT>& current() const
+    {
+        return current_;
+    }
+
+    // Makes the next queued event current
+    void pop()
+    {
+        const queued_event& item = events_[position_++];
+        switch (item.event.event_type())
+        {
+        case stream_event_type::name:
+        case stream_event_type::string_value:
+            current_ = basic_stream_event<CharT>(strings_.data() + item.offset, item.length,
+                                                 item.event.event_type(), item.event.semantic_tag());
+            break;
+        default:
+            current_ = item.event;
+            break;
+        }
+        if (position_ == events_.size())
+        {
+            events_.clear();
+            position_ = 0;
+        }
+    }
+
+    // Releases the strings of the events that have been read
+    void clear_strings()
+    {
+        if (events_.empty())
+        {
+            strings_.clear();
+        }
+    }
+private:
+    void push(const basic_stream_event<CharT>& event)
+    {
+        events_.emplace_back(event, 0, 0);
+    }
+
+    void push(const string_view_type& s, stream_event_type event_type, semantic_tag_type tag)
+    {
+        size_t offset = strings_.size();
+        strings_.append(s.data(), s.length());
+        events_.emplace_back(basic_stream_event<CharT>(event_type, tag), offset, s.length());
+    }
+
+    void do_flush() override
+    {
+    }
+
+    bool do_begin_object(const serializing_context&) override
+    {
+        ++level_;
+        push(basic_stream_event<CharT>(stream_event_type::begin_object));
+        return true;
+    }
+
+    bool do_end_object(const serializing_context&) override
+    {
+        push(basic_stream_event<CharT>(stream_event_type::end_object));
+        return --level_ != 1;
+    }
+
+    bool do_begin_array(const serializing_context&) override
+    {
+        ++level_;
+        push(basic_stream_event<CharT>(stream_event_type::begin_array));
+        return true;
+    }
+
+    bool do_end_array(const serializing_context&) override
+    {
+        push(basic_stream_event<CharT>(stream_event_type::end_array));
+        return --level_ != 1;
+    }
+
+    bool do_name(const string_view_type& name, const serializing_context&) override
+    {
+        push(name, stream_event_type::name, semantic_tag_type::none);
+        return true;
+    }
+
+    bool do_null_value(const serializing_context&) override
+    {
+        push(basic_stream_event<CharT>(stream_event_type::null_value));
+        return true;
+    }
+
+    bool do_bool(bool value, const serializing_context&) override
+    {
+        push(basic_stream_event<CharT>(value));
+        return true;
+    }
+
+    bool do_string_value(const string_view_type& s, semantic_tag_type tag, const serializing_context&) override
+    {
+        push(s, stream_event_type::string_value, tag);
+        return true;
+    }
+
+    bool do_byte_string_value(const uint8_t*, size_t, semantic_tag_type, const serializing_context&) override
+    {
+        push(basic_stream_event<CharT>(stream_event_type::null_value));
+        return true;
+    }
+
+    bool do_int64_value(int64_t value, semantic_tag_type tag, const serializing_context&) override
+    {
+        push(basic_stream_event<CharT>(value, tag));
+        return true;
+    }
+
+    bool do_uint64_value(uint64_t value, semantic_tag_type tag, const serializing_context&) override
+    {
+        push(basic_stream_event<CharT>(value, tag));
+        return true;
+    }
+
+    bool do_double_value(double value, const floating_point_options& fmt, semantic_tag_type tag, const serializing_context&) override
+    {
+        push(basic_stream_event<CharT>(value, fmt, tag));
+        return true;
+    }
+};
+
+}
+
+// basic_csv_stream_reader reports CSV text one event at a time, as
+// basic_csv_reader would report it to a content handler. The text is parsed
+// a record at a time when the events of the last record have been read, so
+// only one buffer of input and one record's events are held. Events that a
+// filter does not accept are passed over. String events are valid until the
+// next call to next().
+
+template<class CharT,class Allocator=std::allocator<char>>
+class basic_csv_stream_reader : public basic_stream_reader<CharT>, private virtual serializing_context
+{
+    static const size_t default_max_buffer_length = 16384;
+
+    typedef CharT char_type;
+    typedef Allocator allocator_type;
+    typedef typename std::allocator_traits<allocator_type>:: template rebind_alloc<CharT> char_allocator_type;
+
+    detail::csv_stream_event_queue<CharT> queue_;
+    default_parse_error_handler default_err_handler_;
+    default_basic_stream_filter<CharT> default_filter_;
+
+    basic_csv_parser<CharT,Allocator> parser_;
+    std::basic_istream<CharT>& is_;
+    basic_stream_filter<CharT>& filter_;
+    std::vector<CharT,char_allocator_type> buffer_;
+    size_t buffer_length_;
+    bool eof_;
+    bool done_;
+
+    // Noncopyable and nonmoveable
+    basic_csv_stream_reader(const basic_csv_stream_reader&) = delete;
+    basic_csv_stream_reader& operator=(const basic_csv_stream_reader&) = delete;
+
+public:
+    basic_csv_stream_reader(std::basic_istream<CharT>& is)
+        : basic_csv_stream_reader(is,default_filter_,basic_csv_serializing_options<CharT,Allocator>(),default_err_handler_)
+    {
+    }
+
+    basic_csv_stream_reader(std::basic_istream<CharT>& is,
+                            basic_stream_filter<CharT>& filter)
+        : basic_csv_stream_reader(is,filter,basic_csv_serializing_options<CharT,Allocator>(),default_err_handler_)
+    {
+    }
+
+    basic_csv_stream_reader(std::basic_istream<CharT>& is,
+                            const basic_csv_serializing_options<CharT,Allocator>& options)
+        : basic_csv_stream_reader(is,default_filter_,options,default_err_handler_)
+    {
+    }
+
+    basic_csv_stream_reader(std::basic_istream<CharT>& is,
+                            basic_stream_filter<CharT>& filter,
+                            const basic_csv_serializing_options<CharT,Allocator>& options)
+        : basic_csv_stream_reader(is,filter,options,default_err_handler_)
+    {
+    }
+
+    basic_csv_stream_reader(std::basic_istream<CharT>& is,
+                            basic_stream_filter<CharT>& filter,
+                            const basic_csv_serializing_options<CharT,Allocator>& options,
+                            parse_error_handler& err_handler)
+       : parser_(queue_,options,err_handler),
+         is_(is),
+         filter_(filter),
+         buffer_length_(default_max_buffer_length),
+         eof_(false),
+         done_(false)
+    {
+        buffer_.reserve(buffer_length_);
+        parser_.reset();
+        next();
+    }
+
+    size_t buffer_length() const
+    {
+        return buffer_length_;
+    }
+
+    void buffer_length(size_t length)
+    {
+        buffer_length_ = length;
+        buffer_.reserve(buffer_length_);
+    }
+
+    bool done() const override
+    {
+        return done_;
+    }
+
+    const basic_stream_event<CharT>& current() const override
+    {
+        return queue_.current();
+    }
+
+    void next() override
+    {
+        std::error_code ec;
+        do
+        {
+            read_next(ec);
+            if (ec)
+            {
+                throw parse_error(ec,parser_.line_number(),parser_.column_number());
+            }
+        } while (!done_ && !filter_.accept(queue_.current(), *this));
+    }
+
+    const serializing_context& context() const override
+    {
+        return *this;
+    }
+
+    bool eof() const
+    {
+        return eof_;
+    }
+
+    size_t line_number() const override
+    {
+        return parser_.line_number();
+    }
+
+    size_t column_number() const override
+    {
+        return parser_.column_number();
+    }
+private:
+    void read_next(std::error_code& ec)
+    {
+        if (queue_.empty())
+        {
+            queue_.clear_strings();
+            while (queue_.empty() && !parser_.done())
+            {
+                parser_.restart();
+                if (parser_.source_exhausted())
+                {
+                    if (!is_.eof())
+                    {
+                        buffer_.clear();
+                        buffer_.resize(buffer_length_);
+                        is_.read(buffer_.data(), buffer_length_);
+                        buffer_.resize(static_cast<size_t>(is_.gcount()));
+                        parser_.update(buffer_.data(),buffer_.size());
+                    }
+                    else
+                    {
+                        parser_.update(buffer_.data(),0);
+                        eof_ = true;
+                    }
+                }
+                parser_.parse_some(ec);
+                if (ec) return;
+            }
+        }
+        if (queue_.empty())
+        {
+            done_ = true;
+        }
+        else
+        {
+            queue_.pop();
+        }
+    }
+};
+
+typedef basic_csv_stream_reader<char> csv_stream_reader;
+typedef basic_csv_stream_reader<wchar_t> wcsv_stream_reader;
+
+}}
+
+#endif
@@ -0,0 +1,563 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_CSV_CSV_TABLE_HPP
+#define JSONCONS_CSV_CSV_TABLE_HPP
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+#include <jsoncons/json_exception.hpp>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons_ext/csv/csv_parser.hpp>
+#include <jsoncons_ext/csv/csv_reader.hpp>
+#include <jsoncons_ext/csv/csv_serializing_options.hpp>
+
+namespace jsoncons { namespace csv {
+
+// basic_csv_column holds the values of one column packed by type: integers
+// in a vector of int64_t, floating point values in a vector of double,
+// booleans in a vector of bool, and strings as one character array with
+// offsets. Which values are null is kept in a validity bitmap.
+
+template <class CharT,class Allocator=std::allocator<char>>
+class basic_csv_column
+{
+public:
+    typedef CharT char_type;
+    typedef Allocator allocator_type;
+    typedef typename std::allocator_traits<allocator_type>:: template rebind_alloc<CharT> char_allocator_type;
+    typedef std::basic_string<CharT,std::char_traits<CharT>,char_allocator_type> string_type;
+    typedef basic_string_view<CharT> string_view_type;
+    typedef typename std::allocator_traits<allocator_type>:: template rebind_alloc<bool> bool_allocator_type;
+    typedef typename std::allocator_traits<allocator_type>:: template rebind_alloc<int64_t> int64_allocator_type;
+    typedef typename std::allocator_traits<allocator_type>:: template rebind_alloc<double> double_allocator_type;
+    typedef typename std::allocator_traits<allocator_type>:: template rebind_alloc<size_t> size_allocator_type;
+private:
+    string_type name_;
+    csv_column_type type_;
+    bool has_type_;
+    size_t size_;
+    std::vector<bool,bool_allocator_type> validity_;
+    std::vector<int64_t,int64_allocator_type> int64_values_;
+    std::vector<double,double_allocator_type> double_values_;
+    std::vector<bool,bool_allocator_type> bool_values_;
+    string_type chars_;
+    std::vector<size_t,size_allocator_type> offsets_;
+public:
+    basic_csv_column(const string_view_type& name)
+        : name_(name.data(), name.length()),
+          type_(csv_column_type::string_t),
+          has_type_(false),
+          size_(0)
+    {
+        offsets_.push_back(0);
+    }
+
+    const string_type& name() const
+    {
+        return name_;
+    }
+
+    // The type of the column's values, fixed by its first value that is not
+    // null. A column of nulls is a string column.
+    csv_column_type type() const
+    {
+        return type_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool is_null(size_t i) const
+    {
+        return !validity_[i];
+    }
+
+    const std::vector<bool,bool_allocator_type>& validity() const
+    {
+        return validity_;
+    }
+
+    const std::vector<int64_t,int64_allocator_type>& int64_values() const
+    {
+        return int64_values_;
+    }
+
+    const std::vector<double,double_allocator_type>& double_values() const
+    {
+        return double_values_;
+    }
+
+    const std::vector<bool,bool_allocator_type>& bool_values() const
+    {
+        return bool_values_;
+    }
+
+    string_view_type string_value(size_t i) const
+    {
+        return string_view_type(chars_.data() + offsets_[i], offsets_[i+1] - offsets_[i]);
+    }
+
+    // The characters of all the strings, the i-th string starting at
+    // string_offsets()[i] and ending at string_offsets()[i+1]
+    const string_type& string_data() const
+    {
+        return chars_;
+    }
+
+    const std::vector<size_t,size_allocator_type>& string_offsets() const
+    {
+        return offsets_;
+    }
+
+    void push_back_null()
+    {
+        push_back_default();
+        validity_.push_back(false);
+        ++size_;
+    }
+
+    void push_back(int64_t value)
+    {
+        fix_type(csv_column_type::integer_t);
+        switch (type_)
+        {
+        case csv_column_type::integer_t:
+            int64_values_.push_back(value);
+            break;
+        case csv_column_type::float_t:
+            double_values_.push_back(static_cast<double>(value));
+            break;
+        default:
+            push_back_null();
+            return;
+        }
+        validity_.push_back(true);
+        ++size_;
+    }
+
+    void push_back(uint64_t value)
+    {
+        if (value <= static_cast<uint64_t>((std::numeric_limits<int64_t>::max)()))
+        {
+            push_back(static_cast<int64_t>(value));
+        }
+        else
+        {
+            push_back(static_cast<double>(value));
+        }
+    }
+
+    void push_back(double value)
+    {
+        fix_type(csv_column_type::float_t);
+        if (type_ != csv_column_type::float_t)
+        {
+            push_back_null();
+            return;
+        }
+        double_values_.push_back(value);
+        validity_.push_back(true);
+        ++size_;
+    }
+
+    void push_back(bool value)
+    {
+        fix_type(csv_column_type::boolean_t);
+        if (type_ != csv_column_type::boolean_t)
+        {
+            push_back_null();
+            return;
+        }
+        bool_values_.push_back(value);
+        validity_.push_back(true);
+        ++size_;
+    }
+
+    void push_back(const string_view_type& value)
+    {
+        fix_type(csv_column_type::string_t);
+        if (type_ != csv_column_type::string_t)
+        {
+            push_back_null();
+            return;
+        }
+        chars_.append(value.data(), value.length());
+        offsets_.push_back(chars_.size());
+        validity_.push_back(true);
+        ++size_;
+    }
+private:
+    // The first value that is not null fixes the type, and the nulls before
+    // it, stored until then as empty strings, are given storage of that type
+    void fix_type(csv_column_type type)
+    {
+        if (!has_type_)
+        {
+            has_type_ = true;
+            if (type != type_)
+            {
+                type_ = type;
+                offsets_.clear();
+                for (size_t i = 0; i < size_; ++i)
+                {
+                    push_back_default();
+                }
+            }
+        }
+    }
+
+    void push_back_default()
+    {
+        switch (type_)
+        {
+        case csv_column_type::integer_t:
+            int64_values_.push_back(0);
+            break;
+        case csv_column_type::float_t:
+            double_values_.push_back(0.0);
+            break;
+        case csv_column_type::boolean_t:
+            bool_values_.push_back(false);
+            break;
+        default:
+            offsets_.push_back(chars_.size());
+            break;
+        }
+    }
+};
+
+// basic_csv_table is a set of named columns of equal length
+
+template <class CharT,class Allocator=std::allocator<char>>
+class basic_csv_table
+{
+public:
+    typedef CharT char_type;
+    typedef Allocator allocator_type;
+    typedef basic_csv_column<CharT,Allocator> column_type;
+    typedef typename column_type::string_view_type string_view_type;
+    typedef typename std::allocator_traits<allocator_type>:: template rebind_alloc<column_type> column_allocator_type;
+private:
+    std::vector<column_type,column_allocator_type> columns_;
+    size_t rows_;
+public:
+    basic_csv_table()
+        : rows_(0)
+    {
+    }
+
+    size_t rows() const
+    {
+        return rows_;
+    }
+
+    const std::vector<column_type,column_allocator_type>& columns() const
+    {
+        return columns_;
+    }
+
+    const column_type& operator[](size_t i) const
+    {
+        return columns_[i];
+    }
+
+    const column_type& at(const string_view_type& name) const
+    {
+        for (const auto& column : columns_)
+        {
+            if (name == string_view_type(column.name().data(), column.name().length()))
+            {
+                return column;
+            }
+        }
+        JSONCONS_THROW(json_exception_impl<std::out_of_range>("Column not found"));
+    }
+
+    bool contains(const string_view_type& name) const
+    {
+        for (const auto& column : columns_)
+        {
+            if (name == string_view_type(column.name().data(), column.name().length()))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void add_column(const string_view_type& name)
+    {
+        columns_.emplace_back(name);
+        for (size_t i = 0; i < rows_; ++i)
+        {
+            columns_.back().push_back_null();
+        }
+    }
+
+    column_type& column(size_t i)
+    {
+        return columns_[i];
+    }
+
+    // Ends a row, giving nulls to the columns that have no value in it
+    void end_row()
+    {
+        ++rows_;
+        for (auto& column : columns_)
+        {
+            while (column.size() < rows_)
+            {
+                column.push_back_null();
+            }
+        }
+    }
+};
+
+// basic_csv_table_decoder builds a basic_csv_table from the events of
+// mapping_type::n_rows, a row at a time, without creating a basic_json value
+// for each field. When the options assume a header, the first row gives the
+// column names; otherwise the column names in the options do. Fields beyond
+// the named columns are dropped, as they are for mapping_type::m_columns.
+// Without any names, a column without a name is added for each field.
+
+template <class CharT,class Allocator=std::allocator<char>>
+class basic_csv_table_decoder final : public basic_json_content_handler<CharT>
+{
+public:
+    typedef CharT char_type;
+    using typename basic_json_content_handler<CharT>::string_view_type;
+    typedef basic_csv_table<CharT,Allocator> table_type;
+private:
+    table_type result_;
+    bool header_pending_;
+    bool has_names_;
+    int level_;
+    size_t column_index_;
+public:
+    basic_csv_table_decoder()
+        : basic_csv_table_decoder(basic_csv_serializing_options<CharT>())
+    {
+    }
+
+    template <class OptionsAllocator>
+    basic_csv_table_decoder(const basic_csv_serializing_options<CharT,OptionsAllocator>& options)
+        : header_pending_(options.assume_header()),
+          has_names_(false),
+          level_(0),
+          column_index_(0)
+    {
+        if (!header_pending_)
+        {
+            auto names = options.column_names();
+            auto selected = options.selected_columns();
+            std::vector<bool> column_selected = detail::resolve_selected_columns(selected, names);
+            for (size_t i = 0; i < names.size(); ++i)
+            {
+                if (selected.empty() || (i < column_selected.size() && column_selected[i]))
+                {
+                    result_.add_column(string_view_type(names[i].data(), names[i].size()));
+                }
+            }
+            has_names_ = !names.empty();
+        }
+    }
+
+    table_type get_result()
+    {
+        return std::move(result_);
+    }
+private:
+    typename table_type::column_type* current_column()
+    {
+        if (column_index_ >= result_.columns().size())
+        {
+            if (has_names_)
+            {
+                ++column_index_;
+                return nullptr;
+            }
+            result_.add_column(string_view_type());
+        }
+        return &result_.column(column_index_++);
+    }
+
+    void do_flush() override
+    {
+    }
+
+    bool do_begin_object(const serializing_context&) override
+    {
+        JSONCONS_THROW(json_exception_impl<std::runtime_error>("A CSV table is read with mapping_type::n_rows"));
+    }
+
+    bool do_end_object(const serializing_context&) override
+    {
+        JSONCONS_THROW(json_exception_impl<std::runtime_error>("A CSV table is read with mapping_type::n_rows"));
+    }
+
+    bool do_begin_array(const serializing_context&) override
+    {
+        if (level_ >= 2)
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("A CSV table cannot have multi-valued fields"));
+        }
+        ++level_;
+        column_index_ = 0;
+        return true;
+    }
+
+    bool do_end_array(const serializing_context&) override
+    {
+        if (level_ == 2)
+        {
+            if (header_pending_)
+            {
+                header_pending_ = false;
+                has_names_ = true;
+            }
+            else
+            {
+                result_.end_row();
+            }
+        }
+        --level_;
+        return true;
+    }
+
+    bool do_name(const string_view_type&, const serializing_context&) override
+    {
+        return true;
+    }
+
+    bool do_string_value(const string_view_type& value, semantic_tag_type, const serializing_context&) override
+    {
+        if (level_ == 2)
+        {
+            if (header_pending_)
+            {
+                result_.add_column(value);
+            }
+            else if (auto column = current_column())
+            {
+                column->push_back(value);
+            }
+        }
+        return true;
+    }
+
+    bool do_byte_string_value(const uint8_t*, size_t, semantic_tag_type, const serializing_context&) override
+    {
+        return do_null_value(null_serializing_context());
+    }
+
+    bool do_int64_value(int64_t value, semantic_tag_type, const serializing_context&) override
+    {
+        if (level_ == 2 && !header_pending_)
+        {
+            if (auto column = current_column())
+            {
+                column->push_back(value);
+            }
+        }
+        return true;
+    }
+
+    bool do_uint64_value(uint64_t value, semantic_tag_type, const serializing_context&) override
+    {
+        if (level_ == 2 && !header_pending_)
+        {
+            if (auto column = current_column())
+            {
+                column->push_back(value);
+            }
+        }
+        return true;
+    }
+
+    bool do_double_value(double value, const floating_point_options&, semantic_tag_type, const serializing_context&) override
+    {
+        if (level_ == 2 && !header_pending_)
+        {
+            if (auto column = current_column())
+            {
+                column->push_back(value);
+            }
+        }
+        return true;
+    }
+
+    bool do_bool(bool value, const serializing_context&) override
+    {
+        if (level_ == 2 && !header_pending_)
+        {
+            if (auto column = current_column())
+            {
+                column->push_back(value);
+            }
+        }
+        return true;
+    }
+
+    bool do_null_value(const serializing_context&) override
+    {
+        if (level_ == 2 && !header_pending_)
+        {
+            if (auto column = current_column())
+            {
+                column->push_back_null();
+            }
+        }
+        return true;
+    }
+};
+
+// Reads CSV text into a basic_csv_table. Columns with a type in column_types
+// hold values of that type; the other columns hold strings.
+
+template <class Table,class Allocator>
+Table decode_csv_table(std::basic_istream<typename Table::char_type>& is,
+                       const basic_csv_serializing_options<typename Table::char_type,Allocator>& options)
+{
+    basic_csv_serializing_options<typename Table::char_type,Allocator> table_options(options);
+    table_options.mapping(mapping_type::n_rows)
+                 .infer_types(false);
+
+    basic_csv_table_decoder<typename Table::char_type,typename Table::allocator_type> decoder(table_options);
+    basic_csv_reader<typename Table::char_type,Allocator> reader(is, decoder, table_options);
+    reader.read();
+    return decoder.get_result();
+}
+
+template <class Table,class Allocator>
+Table decode_csv_table(typename Table::string_view_type s,
+                       const basic_csv_serializing_options<typename Table::char_type,Allocator>& options)
+{
+    basic_csv_serializing_options<typename Table::char_type,Allocator> table_options(options);
+    table_options.mapping(mapping_type::n_rows)
+                 .infer_types(false);
+
+    basic_csv_table_decoder<typename Table::char_type,typename Table::allocator_type> decoder(table_options);
+    basic_csv_parser<typename Table::char_type,Allocator> parser(decoder, table_options);
+    parser.reset();
+    parser.update(s.data(), s.size());
+    parser.parse_some();
+    parser.end_parse();
+    return decoder.get_result();
+}
+
+typedef basic_csv_column<char> csv_column;
+typedef basic_csv_table<char> csv_table;
+typedef basic_csv_table_decoder<char> csv_table_decoder;
+
+}}
+
+#endif
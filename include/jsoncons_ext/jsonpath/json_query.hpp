@@ -13,6 +13,10 @@
 #include <istream>
 #include <cstdlib>
 #include <memory>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <exception>
 #include <jsoncons/json.hpp>
 #include "jsonpath_filter.hpp"
 #include "jsonpath_error_category.hpp"
@@ -21,30 +25,11 @@ namespace jsoncons { namespace jsonpath {
 
 enum class result_type {value,path};
 
-template<class Json>
-Json json_query(const Json& root, const typename Json::string_view_type& path, result_type result_t = result_type::value)
-{
-    if (result_t == result_type::value)
-    {
-        detail::jsonpath_evaluator<Json,const Json&,detail::VoidPathConstructor<Json>> evaluator;
-        evaluator.evaluate(root,path.data(),path.length());
-        return evaluator.get_values();
-    }
-    else
-    {
-        detail::jsonpath_evaluator<Json,const Json&,detail::PathConstructor<Json>> evaluator;
-        evaluator.evaluate(root,path.data(),path.length());
-        return evaluator.get_normalized_paths();
-    }
-}
+template <class Json>
+class jsonpath_multi_query;
 
-template<class Json, class T>
-void json_replace(Json& root, const typename Json::string_view_type& path, T&& new_value)
-{
-    detail::jsonpath_evaluator<Json,Json&,detail::VoidPathConstructor<Json>> evaluator;
-    evaluator.evaluate(root,path.data(),path.length());
-    evaluator.replace(std::forward<T>(new_value));
-}
+template <class Json,class JsonReference>
+class jsonpath_parallel_evaluator;
 
 namespace detail {
 
@@ -105,6 +90,9 @@ bool try_string_to_index(const CharT *s, size_t length, size_t* value, bool* pos
     }
 }
 
+template <class Json>
+class stream_path;
+
 enum class path_state 
 {
     start,
@@ -125,377 +113,683 @@ enum class path_state
     dot
 };
 
-template<class Json,
-         class JsonReference=const Json&,
-         class PathCons=PathConstructor<Json>>
-class jsonpath_evaluator : private serializing_context
+template <class Json,class JsonReference>
+struct path_node
 {
-private:
     typedef typename Json::char_type char_type;
     typedef typename Json::char_traits_type char_traits_type;
     typedef std::basic_string<char_type,char_traits_type> string_type;
-    typedef typename Json::string_view_type string_view_type;
-    typedef JsonReference reference;
     using pointer = typename std::conditional<std::is_const<typename std::remove_reference<JsonReference>::type>::value,typename Json::const_pointer,typename Json::pointer>::type;
-    struct node_type
+
+    path_node() = default;
+    path_node(size_t link, pointer valp)
+        : skip_contained_object(false),link(link),val_ptr(valp)
     {
-        node_type() = default;
-        node_type(const string_type& p, const pointer& valp)
-            : skip_contained_object(false),path(p),val_ptr(valp)
-        {
-        }
-        node_type(string_type&& p, pointer&& valp)
-            : skip_contained_object(false),path(std::move(p)),val_ptr(valp)
+    }
+    path_node(const path_node&) = default;
+    path_node(path_node&&) = default;
+
+    bool skip_contained_object;
+    // The last link of the trail from the root to the node
+    size_t link;
+    pointer val_ptr;
+};
+
+// One link of the trail from the root to a node: the node, the link of its
+// parent, and the index or name that selects it from the parent. A name is
+// a key in the document, or length.
+
+template <class Json,class JsonReference>
+struct path_link
+{
+    typedef typename Json::string_view_type string_view_type;
+    typedef typename path_node<Json,JsonReference>::pointer pointer;
+
+    path_link(size_t parent, size_t index, pointer valp)
+        : parent(parent), is_index(true), index(index), val_ptr(valp)
+    {
+    }
+    path_link(size_t parent, const string_view_type& name, pointer valp)
+        : parent(parent), is_index(false), index(0), name(name), val_ptr(valp)
+    {
+    }
+
+    size_t parent;
+    bool is_index;
+    size_t index;
+    string_view_type name;
+    pointer val_ptr;
+};
+
+// Runs the chunks of a loop over many nodes or elements, which may be run at
+// once on other threads
+class chunk_runner
+{
+public:
+    virtual ~chunk_runner() = default;
+
+    // The number of chunks to split a loop over size items into, 1 to run
+    // it as it is
+    virtual size_t chunk_count(size_t size) const = 0;
+
+    // Calls task with each index in [0,count), and returns when all calls
+    // have returned
+    virtual void run(size_t count, const std::function<void(size_t)>& task) const = 0;
+};
+
+// The state of one evaluation of a compiled path: the root, the trails from
+// the root to the nodes, if they are wanted, and the values made along the 
+// way, such as the length of an array. Link 0 is the root.
+//
+// A loop may be split into chunks, each evaluated with a selection of its
+// own on another thread. The links of a chunk are numbered from the number
+// of links when the loop began, and renumbered when its nodes are appended,
+// in order, to those of the loop.
+
+template <class Json,class JsonReference>
+class path_selection
+{
+public:
+    typedef typename Json::string_view_type string_view_type;
+    typedef typename path_node<Json,JsonReference>::string_type string_type;
+    typedef typename path_node<Json,JsonReference>::pointer pointer;
+    typedef path_link<Json,JsonReference> link_type;
+private:
+    typedef std::vector<path_node<Json,JsonReference>> node_set;
+
+    const Json* root_;
+    bool with_paths_;
+    const chunk_runner* runner_;
+    size_t base_;
+    std::vector<link_type> links_;
+    std::vector<std::shared_ptr<Json>> temp_json_values_;
+
+    struct chunk_type {};
+
+    path_selection(const path_selection& parent, chunk_type)
+        : root_(parent.root_), with_paths_(parent.with_paths_), runner_(nullptr),
+          base_(parent.base_ + parent.links_.size())
+    {
+    }
+public:
+    path_selection(JsonReference root, bool with_paths, const chunk_runner* runner = nullptr)
+        : root_(std::addressof(root)), with_paths_(with_paths), runner_(runner), base_(0)
+    {
+        if (with_paths_)
         {
+            links_.emplace_back(0, 0, std::addressof(root));
         }
-        node_type(const node_type&) = default;
-        node_type(node_type&&) = default;
+    }
 
-        bool skip_contained_object;
-        string_type path;
-        pointer val_ptr;
-    };
-    typedef std::vector<node_type> node_set;
+    path_selection(path_selection&&) = default;
+    path_selection& operator=(path_selection&&) = default;
 
-    static string_view_type length_literal() 
+    const Json& root() const
     {
-        static const char_type data[] = {'l','e','n','g','t','h'};
-        return string_view_type{data,sizeof(data)/sizeof(char_type)};
+        return *root_;
     }
 
-    class selector
+    // Sets the runner that loops are split into chunks with, null to run
+    // them as they are
+    void runner(const chunk_runner* value)
     {
-    public:
-        virtual ~selector()
+        runner_ = value;
+    }
+
+    size_t path(size_t parent, size_t index, pointer valp)
+    {
+        if (!with_paths_)
         {
+            return 0;
         }
-        virtual void select(node_type& node, const string_type& path, reference val,
-                            node_set& nodes, std::vector<std::shared_ptr<Json>>& temp_json_values) = 0;
-    };
+        links_.emplace_back(parent, index, valp);
+        return base_ + links_.size() - 1;
+    }
 
-    class expr_selector final : public selector
+    size_t path(size_t parent, const string_view_type& name, pointer valp)
     {
-    private:
-         jsonpath_filter_expr<Json> result_;
-    public:
-        expr_selector(const jsonpath_filter_expr<Json>& result)
-            : result_(result)
+        if (!with_paths_)
         {
+            return 0;
         }
+        links_.emplace_back(parent, name, valp);
+        return base_ + links_.size() - 1;
+    }
+
+    const link_type& link(size_t i) const
+    {
+        return links_[i];
+    }
 
-        void select(node_type& node, const string_type& path, reference val, 
-                    node_set& nodes, std::vector<std::shared_ptr<Json>>& temp_json_values) override
+    // True if the node is in the document, and not a value made from it,
+    // such as a length or a character of a string
+    bool in_document(size_t i) const
+    {
+        if (i == 0)
         {
-            auto index = result_.eval(val);
-            if (index.template is<size_t>())
-            {
-                size_t start = index.template as<size_t>();
-                if (val.is_array() && start < val.size())
-                {
-                    nodes.emplace_back(PathCons()(path,start),std::addressof(val[start]));
-                }
-            }
-            else if (index.is_string())
-            {
-                name_selector selector(index.as_string_view(),true);
-                selector.select(node, path, val, nodes, temp_json_values);
-            }
+            return true;
         }
-    };
+        const link_type& parent = links_[links_[i].parent];
+        return links_[i].is_index ? parent.val_ptr->is_array() : parent.val_ptr->is_object();
+    }
 
-    class filter_selector final : public selector
+    string_type normalized_path(size_t i) const
     {
-    private:
-         jsonpath_filter_expr<Json> result_;
-    public:
-        filter_selector(const jsonpath_filter_expr<Json>& result)
-            : result_(result)
+        string_type s;
+        append_path(i, s);
+        return s;
+    }
+
+    // Calls f(selection, first, last, nodes) to select the nodes of the
+    // items in [first,last) of a loop over size items, and appends them to
+    // nodes. The loop may be split into chunks, run at once.
+    template <class F>
+    void for_each_chunk(size_t size, node_set& nodes, F f)
+    {
+        size_t count = runner_ != nullptr ? runner_->chunk_count(size) : 1;
+        if (count <= 1)
         {
+            f(*this, 0, size, nodes);
+            return;
         }
 
-        void select(node_type& node, const string_type& path, reference val, 
-                    node_set& nodes, std::vector<std::shared_ptr<Json>>&) override
+        std::vector<std::unique_ptr<path_selection>> selections(count);
+        std::vector<node_set> chunk_nodes(count);
+        std::vector<std::exception_ptr> exceptions(count);
+        runner_->run(count, [&](size_t i)
         {
-            if (val.is_array())
+            try
             {
-                node.skip_contained_object =true;
-                for (size_t i = 0; i < val.size(); ++i)
-                {
-                    if (result_.exists(val[i]))
-                    {
-                        nodes.emplace_back(PathCons()(path,i),std::addressof(val[i]));
-                    }
-                }
+                selections[i].reset(new path_selection(*this, chunk_type()));
+                f(*selections[i], i*size/count, (i+1)*size/count, chunk_nodes[i]);
             }
-            else if (val.is_object())
+            catch (...)
             {
-                if (!node.skip_contained_object)
-                {
-                    if (result_.exists(val))
-                    {
-                        nodes.emplace_back(path, std::addressof(val));
-                    }
-                }
-                else
-                {
-                    node.skip_contained_object = false;
-                }
+                exceptions[i] = std::current_exception();
+            }
+        });
+        for (auto& e : exceptions)
+        {
+            if (e)
+            {
+                std::rethrow_exception(e);
             }
         }
-    };
-
-    class name_selector final : public selector
-    {
-    private:
-        string_type name_;
-        bool positive_start_;
-    public:
-        name_selector(const string_view_type& name, bool positive_start)
-            : name_(name), positive_start_(positive_start)
+        for (size_t i = 0; i < count; ++i)
         {
+            append(*selections[i], chunk_nodes[i], nodes);
         }
+    }
 
-        void select(node_type&, const string_type& path, reference val,
-                    node_set& nodes,
-                    std::vector<std::shared_ptr<Json>>& temp_json_values) override
+    // Gives the values made along the way to temps
+    void move_temps(std::vector<std::shared_ptr<Json>>& temps)
+    {
+        temps.swap(temp_json_values_);
+        temp_json_values_.clear();
+    }
+
+    template <class... Args>
+    pointer make_temp(Args&& ... args)
+    {
+        auto temp = std::make_shared<Json>(std::forward<Args>(args)...);
+        temp_json_values_.push_back(temp);
+        return temp.get();
+    }
+private:
+    void append(path_selection& chunk, node_set& chunk_nodes, node_set& nodes)
+    {
+        const size_t shift = base_ + links_.size() - chunk.base_;
+        for (auto& link : chunk.links_)
         {
-            if (val.is_object() && val.contains(name_))
-            {
-                nodes.emplace_back(PathCons()(path,name_),std::addressof(val.at(name_)));
-            }
-            else if (val.is_array())
+            if (link.parent >= chunk.base_)
             {
-                size_t pos = 0;
-                if (try_string_to_index(name_.data(), name_.size(), &pos, &positive_start_))
-                {
-                    size_t index = positive_start_ ? pos : val.size() - pos;
-                    if (index < val.size())
-                    {
-                        nodes.emplace_back(PathCons()(path,index),std::addressof(val[index]));
-                    }
-                }
-                else if (name_ == length_literal() && val.size() > 0)
-                {
-                    auto temp = std::make_shared<Json>(val.size());
-                    temp_json_values.push_back(temp);
-                    nodes.emplace_back(PathCons()(path,name_),temp.get());
-                }
+                link.parent += shift;
             }
-            else if (val.is_string())
+            links_.push_back(link);
+        }
+        for (auto& node : chunk_nodes)
+        {
+            if (node.link >= chunk.base_)
             {
-                size_t pos = 0;
-                string_view_type sv = val.as_string_view();
-                if (try_string_to_index(name_.data(), name_.size(), &pos, &positive_start_))
-                {
-                    size_t index = positive_start_ ? pos : sv.size() - pos;
-                    auto sequence = unicons::sequence_at(sv.data(), sv.data() + sv.size(), index);
-                    if (sequence.length() > 0)
-                    {
-                        auto temp = std::make_shared<Json>(sequence.begin(),sequence.length());
-                        temp_json_values.push_back(temp);
-                        nodes.emplace_back(PathCons()(path,index),temp.get());
-                    }
-                }
-                else if (name_ == length_literal() && sv.size() > 0)
-                {
-                    size_t count = unicons::u32_length(sv.begin(),sv.end());
-                    auto temp = std::make_shared<Json>(count);
-                    temp_json_values.push_back(temp);
-                    nodes.emplace_back(PathCons()(path,name_),temp.get());
-                }
+                node.link += shift;
             }
+            nodes.push_back(std::move(node));
         }
-    };
+        for (auto& temp : chunk.temp_json_values_)
+        {
+            temp_json_values_.push_back(std::move(temp));
+        }
+    }
 
-    class array_slice_selector final : public selector
+    void append_path(size_t i, string_type& s) const
     {
-    private:
-        size_t start_;
-        bool positive_start_;
-        size_t end_;
-        bool positive_end_;
-        bool undefined_end_;
-        size_t step_;
-        bool positive_step_;
-    public:
-        array_slice_selector(size_t start, bool positive_start, 
-                             size_t end, bool positive_end,
-                             size_t step, bool positive_step,
-                             bool undefined_end)
-            : start_(start), positive_start_(positive_start),
-              end_(end), positive_end_(positive_end),undefined_end_(undefined_end),
-              step_(step), positive_step_(positive_step) 
+        if (i == 0)
         {
+            s.push_back('$');
+            return;
         }
-
-        void select(node_type&, const string_type& path, reference val,
-                    node_set& nodes,
-                    std::vector<std::shared_ptr<Json>>&) override
+        const link_type& link = links_[i];
+        append_path(link.parent, s);
+        s.push_back('[');
+        if (link.is_index)
         {
-            if (positive_step_)
+            size_t length = s.length();
+            size_t index = link.index;
+            do
             {
-                end_array_slice1(path, val, nodes);
-            }
-            else
+                s.push_back(static_cast<typename string_type::value_type>('0' + index % 10));
+            } while (index /= 10);
+            std::reverse(s.begin() + length, s.end());
+        }
+        else
+        {
+            s.push_back('\'');
+            s.append(link.name.data(),link.name.length());
+            s.push_back('\'');
+        }
+        s.push_back(']');
+    }
+};
+
+template <class Json>
+typename Json::string_view_type length_literal()
+{
+    static const typename Json::char_type data[] = {'l','e','n','g','t','h'};
+    return typename Json::string_view_type{data,sizeof(data)/sizeof(typename Json::char_type)};
+}
+
+template <class Json,class JsonReference>
+class selector
+{
+public:
+    typedef JsonReference reference;
+    typedef path_node<Json,JsonReference> node_type;
+    typedef std::vector<node_type> node_set;
+    typedef typename node_type::string_type string_type;
+    typedef typename node_type::pointer pointer;
+
+    virtual ~selector()
+    {
+    }
+    virtual void select(path_selection<Json,JsonReference>& selection, node_type& node,
+                        size_t path, reference val, node_set& nodes) const = 0;
+
+    virtual bool uses_root() const
+    {
+        return false;
+    }
+
+    virtual bool is_filter() const
+    {
+        return false;
+    }
+};
+
+template <class Json,class JsonReference>
+class name_selector final : public selector<Json,JsonReference>
+{
+    typedef selector<Json,JsonReference> base_type;
+    typedef typename base_type::reference reference;
+    typedef typename base_type::node_type node_type;
+    typedef typename base_type::node_set node_set;
+    typedef typename base_type::string_type string_type;
+    typedef typename base_type::pointer pointer;
+    typedef typename Json::string_view_type string_view_type;
+
+    string_type name_;
+public:
+    name_selector(const string_view_type& name)
+        : name_(name)
+    {
+    }
+
+    void select(path_selection<Json,JsonReference>& selection, node_type&,
+                size_t path, reference val, node_set& nodes) const override
+    {
+        bool positive_start = true;
+        if (val.is_object())
+        {
+            auto it = val.find(name_);
+            if (it != val.object_range().end())
             {
-                end_array_slice2(path, val, nodes);
+                pointer p = std::addressof(it->value());
+                nodes.emplace_back(selection.path(path,it->key(),p),p);
             }
         }
-
-        void end_array_slice1(const string_type& path, reference val, node_set& nodes)
+        else if (val.is_array())
         {
-            if (val.is_array())
+            size_t pos = 0;
+            if (try_string_to_index(name_.data(), name_.size(), &pos, &positive_start))
             {
-                size_t start = positive_start_ ? start_ : val.size() - start_;
-                size_t end;
-                if (!undefined_end_)
-                {
-                    end = positive_end_ ? end_ : val.size() - end_;
-                }
-                else
-                {
-                    end = val.size();
-                }
-                for (size_t j = start; j < end; j += step_)
+                size_t index = positive_start ? pos : val.size() - pos;
+                if (index < val.size())
                 {
-                    if (j < val.size())
-                    {
-                        nodes.emplace_back(PathCons()(path,j),std::addressof(val[j]));
-                    }
+                    pointer p = std::addressof(val[index]);
+                    nodes.emplace_back(selection.path(path,index,p),p);
                 }
             }
+            else if (name_ == length_literal<Json>() && val.size() > 0)
+            {
+                pointer p = selection.make_temp(val.size());
+                nodes.emplace_back(selection.path(path,length_literal<Json>(),p),p);
+            }
         }
-
-        void end_array_slice2(const string_type& path, reference val, node_set& nodes)
+        else if (val.is_string())
         {
-            if (val.is_array())
+            size_t pos = 0;
+            string_view_type sv = val.as_string_view();
+            if (try_string_to_index(name_.data(), name_.size(), &pos, &positive_start))
             {
-                size_t start = positive_start_ ? start_ : val.size() - start_;
-                size_t end;
-                if (!undefined_end_)
-                {
-                    end = positive_end_ ? end_ : val.size() - end_;
-                }
-                else
-                {
-                    end = val.size();
-                }
-
-                size_t j = end + step_ - 1;
-                while (j > (start+step_-1))
+                size_t index = positive_start ? pos : sv.size() - pos;
+                auto sequence = unicons::sequence_at(sv.data(), sv.data() + sv.size(), index);
+                if (sequence.length() > 0)
                 {
-                    j -= step_;
-                    if (j < val.size())
-                    {
-                        nodes.emplace_back(PathCons()(path,j),std::addressof(val[j]));
-                    }
+                    pointer p = selection.make_temp(sequence.begin(),sequence.length());
+                    nodes.emplace_back(selection.path(path,index,p),p);
                 }
             }
+            else if (name_ == length_literal<Json>() && sv.size() > 0)
+            {
+                size_t count = unicons::u32_length(sv.begin(),sv.end());
+                pointer p = selection.make_temp(count);
+                nodes.emplace_back(selection.path(path,length_literal<Json>(),p),p);
+            }
         }
-    };
+    }
+};
 
-    default_parse_error_handler default_err_handler_;
-    parse_error_handler *err_handler_;
-    path_state state_;
-    string_type buffer_;
-    size_t start_;
-    bool positive_start_;
-    size_t end_;
-    bool positive_end_;
-    bool undefined_end_;
-    size_t step_;
-    bool positive_step_;
-    bool recursive_descent_;
-    node_set nodes_;
-    std::vector<node_set> stack_;
-    std::vector<std::shared_ptr<Json>> temp_json_values_;
-    size_t line_;
-    size_t column_;
-    const char_type* begin_input_;
-    const char_type* end_input_;
-    const char_type* p_;
-    std::vector<std::shared_ptr<selector>> selectors_;
+template <class Json,class JsonReference>
+class expr_selector final : public selector<Json,JsonReference>
+{
+    typedef selector<Json,JsonReference> base_type;
+    typedef typename base_type::reference reference;
+    typedef typename base_type::node_type node_type;
+    typedef typename base_type::node_set node_set;
+    typedef typename base_type::string_type string_type;
+    typedef typename base_type::pointer pointer;
 
+    jsonpath_filter_expr<Json> result_;
 public:
-    jsonpath_evaluator()
-        : err_handler_(&default_err_handler_),
-          state_(path_state::start),
-          start_(0), positive_start_(true), 
-          end_(0), positive_end_(true), undefined_end_(false),
-          step_(0), positive_step_(true),
-          recursive_descent_(false),
-          line_(0), column_(0),
-          begin_input_(nullptr), end_input_(nullptr),
-          p_(nullptr)
+    expr_selector(const jsonpath_filter_expr<Json>& result)
+        : result_(result)
     {
     }
 
-    Json get_values() const
+    bool uses_root() const override
     {
-        Json result = typename Json::array();
-
-        if (stack_.size() > 0)
-        {
-            result.reserve(stack_.back().size());
-            for (const auto& p : stack_.back())
-            {
-                result.push_back(*(p.val_ptr));
-            }
-        }
-        return result;
+        return result_.uses_root();
     }
 
-    Json get_normalized_paths() const
+    void select(path_selection<Json,JsonReference>& selection, node_type& node,
+                size_t path, reference val, node_set& nodes) const override
     {
-        Json result = typename Json::array();
-        if (stack_.size() > 0)
+        auto index = result_.eval(val, selection.root());
+        if (index.template is<size_t>())
         {
-            result.reserve(stack_.back().size());
-            for (const auto& p : stack_.back())
+            size_t start = index.template as<size_t>();
+            if (val.is_array() && start < val.size())
             {
-                result.push_back(p.path);
+                pointer p = std::addressof(val[start]);
+                nodes.emplace_back(selection.path(path,start,p),p);
             }
         }
-        return result;
+        else if (index.is_string())
+        {
+            name_selector<Json,JsonReference> selector(index.as_string_view());
+            selector.select(selection, node, path, val, nodes);
+        }
     }
+};
 
-    template <class T>
-    void replace(T&& new_value)
+template <class Json,class JsonReference>
+class filter_selector final : public selector<Json,JsonReference>
+{
+    typedef selector<Json,JsonReference> base_type;
+    typedef typename base_type::reference reference;
+    typedef typename base_type::node_type node_type;
+    typedef typename base_type::node_set node_set;
+    typedef typename base_type::string_type string_type;
+    typedef typename base_type::pointer pointer;
+
+    jsonpath_filter_expr<Json> result_;
+public:
+    filter_selector(const jsonpath_filter_expr<Json>& result)
+        : result_(result)
     {
-        if (stack_.size() > 0)
-        {
-            for (size_t i = 0; i < stack_.back().size(); ++i)
-            {
-                *(stack_.back()[i].val_ptr) = new_value;
-            }
-        }
     }
 
-    void evaluate(reference root, const string_view_type& path)
+    bool uses_root() const override
     {
-        evaluate(root,path.data(),path.length());
+        return result_.uses_root();
     }
-    void evaluate(reference root, const char_type* path)
+
+    bool is_filter() const override
     {
-        evaluate(root,path,char_traits_type::length(path));
+        return true;
     }
 
-    void evaluate(reference root, 
-                  const char_type* path, 
-                  size_t length)
+    void select(path_selection<Json,JsonReference>& selection, node_type& node,
+                size_t path, reference val, node_set& nodes) const override
     {
-        std::error_code ec;
-        evaluate(root, path, length, ec);
-        if (ec)
+        if (val.is_array())
         {
-            throw parse_error(ec,line_,column_);
+            node.skip_contained_object =true;
+            if (val.size() == 0)
+            {
+                return;
+            }
+            filter_stack<Json> stack;
+            result_.prepare(selection.root(), stack);
+            selection.for_each_chunk(val.size(), nodes,
+                [&](path_selection<Json,JsonReference>& chunk, size_t first, size_t last, node_set& chunk_nodes)
+            {
+                filter_stack<Json> chunk_stack(stack);
+                for (size_t i = first; i < last; ++i)
+                {
+                    if (result_.exists(val[i], chunk.root(), chunk_stack))
+                    {
+                        pointer p = std::addressof(val[i]);
+                        chunk_nodes.emplace_back(chunk.path(path,i,p),p);
+                    }
+                }
+            });
+        }
+        else if (val.is_object())
+        {
+            if (!node.skip_contained_object)
+            {
+                if (result_.exists(val, selection.root()))
+                {
+                    nodes.emplace_back(path, std::addressof(val));
+                }
+            }
+            else
+            {
+                node.skip_contained_object = false;
+            }
         }
     }
+};
+
+template <class Json,class JsonReference>
+class array_slice_selector final : public selector<Json,JsonReference>
+{
+    typedef selector<Json,JsonReference> base_type;
+    typedef typename base_type::reference reference;
+    typedef typename base_type::node_type node_type;
+    typedef typename base_type::node_set node_set;
+    typedef typename base_type::string_type string_type;
+    typedef typename base_type::pointer pointer;
 
-    void evaluate(reference root, 
-                  const char_type* path, 
-                  size_t length,
-                  std::error_code& ec)
+    size_t start_;
+    bool positive_start_;
+    size_t end_;
+    bool positive_end_;
+    bool undefined_end_;
+    size_t step_;
+    bool positive_step_;
+public:
+    array_slice_selector(size_t start, bool positive_start,
+                         size_t end, bool positive_end,
+                         size_t step, bool positive_step,
+                         bool undefined_end)
+        : start_(start), positive_start_(positive_start),
+          end_(end), positive_end_(positive_end),undefined_end_(undefined_end),
+          step_(step), positive_step_(positive_step)
+    {
+    }
+
+    void select(path_selection<Json,JsonReference>& selection, node_type&,
+                size_t path, reference val, node_set& nodes) const override
+    {
+        if (positive_step_)
+        {
+            end_array_slice1(selection, path, val, nodes);
+        }
+        else
+        {
+            end_array_slice2(selection, path, val, nodes);
+        }
+    }
+
+    void end_array_slice1(path_selection<Json,JsonReference>& selection, size_t path, reference val, node_set& nodes) const
+    {
+        if (val.is_array())
+        {
+            size_t start = positive_start_ ? start_ : val.size() - start_;
+            size_t end;
+            if (!undefined_end_)
+            {
+                end = positive_end_ ? end_ : val.size() - end_;
+            }
+            else
+            {
+                end = val.size();
+            }
+            for (size_t j = start; j < end; j += step_)
+            {
+                if (j < val.size())
+                {
+                    pointer p = std::addressof(val[j]);
+                    nodes.emplace_back(selection.path(path,j,p),p);
+                }
+            }
+        }
+    }
+
+    void end_array_slice2(path_selection<Json,JsonReference>& selection, size_t path, reference val, node_set& nodes) const
+    {
+        if (val.is_array())
+        {
+            size_t start = positive_start_ ? start_ : val.size() - start_;
+            size_t end;
+            if (!undefined_end_)
+            {
+                end = positive_end_ ? end_ : val.size() - end_;
+            }
+            else
+            {
+                end = val.size();
+            }
+
+            size_t j = end + step_ - 1;
+            while (j > (start+step_-1))
+            {
+                j -= step_;
+                if (j < val.size())
+                {
+                    pointer p = std::addressof(val[j]);
+                    nodes.emplace_back(selection.path(path,j,p),p);
+                }
+            }
+        }
+    }
+};
+
+enum class path_step_kind {name,selectors};
+
+// One step of a compiled path. A name step selects a member, index or
+// length by an unquoted name. A selectors step selects all members or
+// elements once for each wildcard, then applies each selector in turn.
+
+template <class Json,class JsonReference>
+struct path_step
+{
+    typedef typename path_node<Json,JsonReference>::string_type string_type;
+
+    path_step(path_step_kind kind, bool recursive_descent)
+        : kind(kind), recursive_descent(recursive_descent), wildcards(0)
+    {
+    }
+
+    path_step_kind kind;
+    bool recursive_descent;
+    string_type name;
+    size_t wildcards;
+    std::vector<std::shared_ptr<selector<Json,JsonReference>>> selectors;
+};
+
+template<class Json,class JsonReference>
+class jsonpath_compiler : private serializing_context
+{
+private:
+    typedef typename Json::char_type char_type;
+    typedef typename Json::char_traits_type char_traits_type;
+    typedef std::basic_string<char_type,char_traits_type> string_type;
+    typedef typename Json::string_view_type string_view_type;
+    typedef path_step<Json,JsonReference> step_type;
+
+    default_parse_error_handler default_err_handler_;
+    parse_error_handler *err_handler_;
+    path_state state_;
+    string_type buffer_;
+    size_t start_;
+    bool positive_start_;
+    size_t end_;
+    bool positive_end_;
+    bool undefined_end_;
+    size_t step_;
+    bool positive_step_;
+    bool recursive_descent_;
+    size_t wildcards_;
+    bool has_root_;
+    std::vector<step_type> steps_;
+    size_t line_;
+    size_t column_;
+    const char_type* begin_input_;
+    const char_type* end_input_;
+    const char_type* p_;
+    std::vector<std::shared_ptr<selector<Json,JsonReference>>> selectors_;
+
+public:
+    jsonpath_compiler()
+        : err_handler_(&default_err_handler_),
+          state_(path_state::start),
+          start_(0), positive_start_(true),
+          end_(0), positive_end_(true), undefined_end_(false),
+          step_(0), positive_step_(true),
+          recursive_descent_(false),
+          wildcards_(0),
+          has_root_(false),
+          line_(0), column_(0),
+          begin_input_(nullptr), end_input_(nullptr),
+          p_(nullptr)
+    {
+    }
+
+    bool has_root() const
+    {
+        return has_root_;
+    }
+
+    std::vector<step_type>& steps()
+    {
+        return steps_;
+    }
+
+    void compile(const char_type* path,
+                 size_t length,
+                 std::error_code& ec)
     {
         path_state pre_line_break_state = path_state::start;
 
@@ -508,6 +802,10 @@ public:
         state_ = path_state::start;
 
         recursive_descent_ = false;
+        wildcards_ = 0;
+        has_root_ = false;
+        steps_.clear();
+        selectors_.clear();
 
         clear_index();
 
@@ -535,22 +833,15 @@ public:
                 column_ = 1;
                 state_ = pre_line_break_state;
                 break;
-            case path_state::start: 
+            case path_state::start:
                 switch (*p_)
                 {
                 case ' ':case '\t':
                     break;
                 case '$':
                 case '@':
-                    {
-                        string_type s;
-                        s.push_back('$');
-                        node_set v;
-                        v.emplace_back(std::move(s),std::addressof(root));
-                        stack_.push_back(v);
-
-                        state_ = path_state::expect_dot_or_left_bracket;
-                    }
+                    has_root_ = true;
+                    state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 default:
                     err_handler_->fatal_error(jsonpath_parser_errc::expected_root, *this);
@@ -583,7 +874,7 @@ public:
                     return;
                 case '*':
                     end_all();
-                    transfer_nodes();
+                    add_selectors_step();
                     state_ = path_state::expect_dot_or_left_bracket;
                     ++p_;
                     ++column_;
@@ -599,7 +890,7 @@ public:
                     break;
                 }
                 break;
-            case path_state::expect_dot_or_left_bracket: 
+            case path_state::expect_dot_or_left_bracket:
                 switch (*p_)
                 {
                 case ' ':case '\t':
@@ -625,7 +916,7 @@ public:
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    apply_selectors();
+                    add_selectors_step();
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 case ' ':case '\t':
@@ -648,23 +939,23 @@ public:
                 case '(':
                     {
                         jsonpath_filter_parser<Json> parser(line_,column_);
-                        auto result = parser.parse(root, p_,end_input_,&p_);
+                        auto result = parser.parse(p_,end_input_,&p_);
                         line_ = parser.line();
                         column_ = parser.column();
-                        selectors_.push_back(std::make_shared<expr_selector>(result));
+                        selectors_.push_back(std::make_shared<expr_selector<Json,JsonReference>>(result));
                         state_ = path_state::expect_comma_or_right_bracket;
                     }
                     break;
                 case '?':
                     {
                         jsonpath_filter_parser<Json> parser(line_,column_);
-                        auto result = parser.parse(root,p_,end_input_,&p_);
+                        auto result = parser.parse(p_,end_input_,&p_);
                         line_ = parser.line();
                         column_ = parser.column();
-                        selectors_.push_back(std::make_shared<filter_selector>(result));
+                        selectors_.push_back(std::make_shared<filter_selector<Json,JsonReference>>(result));
                         state_ = path_state::expect_comma_or_right_bracket;
                     }
-                    break;                   
+                    break;
                 case ':':
                     clear_index();
                     state_ = path_state::left_bracket_end;
@@ -709,14 +1000,14 @@ public:
                     state_ = path_state::left_bracket_end;
                     break;
                 case ',':
-                    selectors_.push_back(std::make_shared<name_selector>(buffer_,positive_start_));
+                    selectors_.push_back(std::make_shared<name_selector<Json,JsonReference>>(buffer_));
                     buffer_.clear();
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    selectors_.push_back(std::make_shared<name_selector>(buffer_,positive_start_));
+                    selectors_.push_back(std::make_shared<name_selector<Json,JsonReference>>(buffer_));
                     buffer_.clear();
-                    apply_selectors();
+                    add_selectors_step();
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 default:
@@ -743,12 +1034,12 @@ public:
                     state_ = path_state::left_bracket_end2;
                     break;
                 case ',':
-                    selectors_.push_back(std::make_shared<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
+                    add_array_slice_selector();
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    selectors_.push_back(std::make_shared<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
-                    apply_selectors();
+                    add_array_slice_selector();
+                    add_selectors_step();
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 }
@@ -767,12 +1058,12 @@ public:
                     end_ = end_*10 + static_cast<size_t>(*p_-'0');
                     break;
                 case ',':
-                    selectors_.push_back(std::make_shared<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
+                    add_array_slice_selector();
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    selectors_.push_back(std::make_shared<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
-                    apply_selectors();
+                    add_array_slice_selector();
+                    add_selectors_step();
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 }
@@ -791,12 +1082,12 @@ public:
                     state_ = path_state::left_bracket_step2;
                     break;
                 case ',':
-                    selectors_.push_back(std::make_shared<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
+                    add_array_slice_selector();
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    selectors_.push_back(std::make_shared<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
-                    apply_selectors();
+                    add_array_slice_selector();
+                    add_selectors_step();
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 }
@@ -810,46 +1101,41 @@ public:
                     step_ = step_*10 + static_cast<size_t>(*p_-'0');
                     break;
                 case ',':
-                    selectors_.push_back(std::make_shared<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
+                    add_array_slice_selector();
                     state_ = path_state::left_bracket;
                     break;
                 case ']':
-                    selectors_.push_back(std::make_shared<array_slice_selector>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
-                    apply_selectors();
+                    add_array_slice_selector();
+                    add_selectors_step();
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 }
                 ++p_;
                 ++column_;
                 break;
-            case path_state::unquoted_name: 
+            case path_state::unquoted_name:
                 switch (*p_)
                 {
                 case '[':
-                    apply_unquoted_string(buffer_);
-                    transfer_nodes();
+                    add_name_step();
                     start_ = 0;
                     state_ = path_state::left_bracket;
                     break;
                 case '.':
-                    apply_unquoted_string(buffer_);
-                    transfer_nodes();
+                    add_name_step();
                     state_ = path_state::dot;
                     break;
                 case ' ':case '\t':
-                    apply_unquoted_string(buffer_);
-                    transfer_nodes();
+                    add_name_step();
                     state_ = path_state::expect_dot_or_left_bracket;
                     break;
                 case '\r':
-                    apply_unquoted_string(buffer_);
-                    transfer_nodes();
+                    add_name_step();
                     pre_line_break_state = path_state::expect_dot_or_left_bracket;
                     state_= path_state::cr;
                     break;
                 case '\n':
-                    apply_unquoted_string(buffer_);
-                    transfer_nodes();
+                    add_name_step();
                     pre_line_break_state = path_state::expect_dot_or_left_bracket;
                     state_= path_state::lf;
                     break;
@@ -860,11 +1146,11 @@ public:
                 ++p_;
                 ++column_;
                 break;
-            case path_state::left_bracket_single_quoted_string: 
+            case path_state::left_bracket_single_quoted_string:
                 switch (*p_)
                 {
                 case '\'':
-                    selectors_.push_back(std::make_shared<name_selector>(buffer_,positive_start_));
+                    selectors_.push_back(std::make_shared<name_selector<Json,JsonReference>>(buffer_));
                     buffer_.clear();
                     state_ = path_state::expect_comma_or_right_bracket;
                     break;
@@ -884,11 +1170,11 @@ public:
                 ++p_;
                 ++column_;
                 break;
-            case path_state::left_bracket_double_quoted_string: 
+            case path_state::left_bracket_double_quoted_string:
                 switch (*p_)
                 {
                 case '\"':
-                    selectors_.push_back(std::make_shared<name_selector>(buffer_,positive_start_));
+                    selectors_.push_back(std::make_shared<name_selector<Json,JsonReference>>(buffer_));
                     buffer_.clear();
                     state_ = path_state::expect_comma_or_right_bracket;
                     break;
@@ -916,11 +1202,8 @@ public:
         }
         switch (state_)
         {
-        case path_state::unquoted_name: 
-            {
-                apply_unquoted_string(buffer_);
-                transfer_nodes();
-            }
+        case path_state::unquoted_name:
+            add_name_step();
             break;
         default:
             break;
@@ -941,57 +1224,663 @@ public:
 
     void end_all()
     {
-        for (size_t i = 0; i < stack_.back().size(); ++i)
+        ++wildcards_;
+        start_ = 0;
+    }
+
+    void add_array_slice_selector()
+    {
+        selectors_.push_back(std::make_shared<array_slice_selector<Json,JsonReference>>(start_,positive_start_,end_,positive_end_,step_,positive_step_,undefined_end_));
+    }
+
+    void add_name_step()
+    {
+        steps_.emplace_back(path_step_kind::name, recursive_descent_);
+        steps_.back().name = buffer_;
+        buffer_.clear();
+        recursive_descent_ = false;
+    }
+
+    void add_selectors_step()
+    {
+        steps_.emplace_back(path_step_kind::selectors, recursive_descent_);
+        steps_.back().wildcards = wildcards_;
+        steps_.back().selectors.swap(selectors_);
+        wildcards_ = 0;
+        recursive_descent_ = false;
+    }
+
+    size_t line_number() const override
+    {
+        return line_;
+    }
+
+    size_t column_number() const override
+    {
+        return column_;
+    }
+};
+
+}
+
+// jsonpath_result_set holds the nodes that a JSONPath expression selects
+// from a value, as pointers into the value, and the trail of links from
+// the root to each of them. The normalized path of a node is made from its
+// trail when it is asked for. The nodes are valid as long as the value is,
+// and is not changed other than through the result set.
+
+template <class Json,class JsonReference=const Json&>
+class jsonpath_result_set
+{
+public:
+    typedef JsonReference reference;
+    typedef typename detail::path_node<Json,JsonReference>::pointer pointer;
+    typedef typename detail::path_node<Json,JsonReference>::string_type string_type;
+private:
+    typedef detail::path_selection<Json,JsonReference> selection_type;
+    typedef detail::path_node<Json,JsonReference> node_type;
+    typedef std::vector<node_type> node_set;
+
+    template <class J,class R>
+    friend class jsonpath_expression;
+    template <class J,class R>
+    friend class jsonpath_parallel_evaluator;
+
+    selection_type selection_;
+    node_set nodes_;
+
+    jsonpath_result_set(selection_type&& selection, node_set&& nodes)
+        : selection_(std::move(selection)), nodes_(std::move(nodes))
+    {
+    }
+
+    // One index or name of the trail from the root to a node
+    struct path_component
+    {
+        bool is_index;
+        size_t index;
+        string_type name;
+
+        friend bool operator<(const path_component& lhs, const path_component& rhs)
         {
-            const auto& path = stack_.back()[i].path;
-            pointer p = stack_.back()[i].val_ptr;
+            if (lhs.is_index != rhs.is_index)
+            {
+                return lhs.is_index;
+            }
+            return lhs.is_index ? lhs.index < rhs.index : lhs.name < rhs.name;
+        }
 
-            if (p->is_array())
+        friend bool operator==(const path_component& lhs, const path_component& rhs)
+        {
+            return lhs.is_index == rhs.is_index && lhs.index == rhs.index && lhs.name == rhs.name;
+        }
+    };
+public:
+    class iterator
+    {
+        typename node_set::const_iterator it_;
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef typename std::remove_reference<JsonReference>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename jsonpath_result_set::pointer pointer;
+        typedef JsonReference reference;
+
+        iterator() = default;
+
+        explicit iterator(typename node_set::const_iterator it)
+            : it_(it)
+        {
+        }
+
+        reference operator*() const
+        {
+            return *(it_->val_ptr);
+        }
+
+        pointer operator->() const
+        {
+            return it_->val_ptr;
+        }
+
+        reference operator[](difference_type n) const
+        {
+            return *(it_[n].val_ptr);
+        }
+
+        iterator& operator++()
+        {
+            ++it_;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator temp(*this);
+            ++it_;
+            return temp;
+        }
+
+        iterator& operator--()
+        {
+            --it_;
+            return *this;
+        }
+
+        iterator operator--(int)
+        {
+            iterator temp(*this);
+            --it_;
+            return temp;
+        }
+
+        iterator& operator+=(difference_type n)
+        {
+            it_ += n;
+            return *this;
+        }
+
+        iterator& operator-=(difference_type n)
+        {
+            it_ -= n;
+            return *this;
+        }
+
+        friend iterator operator+(iterator it, difference_type n)
+        {
+            return it += n;
+        }
+
+        friend iterator operator-(iterator it, difference_type n)
+        {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs.it_ - rhs.it_;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs.it_ == rhs.it_;
+        }
+
+        friend bool operator!=(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs.it_ != rhs.it_;
+        }
+
+        friend bool operator<(const iterator& lhs, const iterator& rhs)
+        {
+            return lhs.it_ < rhs.it_;
+        }
+    };
+
+    jsonpath_result_set(jsonpath_result_set&&) = default;
+    jsonpath_result_set& operator=(jsonpath_result_set&&) = default;
+
+    size_t size() const
+    {
+        return nodes_.size();
+    }
+
+    bool empty() const
+    {
+        return nodes_.empty();
+    }
+
+    reference operator[](size_t i) const
+    {
+        return *(nodes_[i].val_ptr);
+    }
+
+    iterator begin() const
+    {
+        return iterator(nodes_.begin());
+    }
+
+    iterator end() const
+    {
+        return iterator(nodes_.end());
+    }
+
+    string_type normalized_path(size_t i) const
+    {
+        return selection_.normalized_path(nodes_[i].link);
+    }
+
+    // Returns an array of copies of the values, as json_query does
+    Json values() const
+    {
+        Json result = typename Json::array();
+        result.reserve(nodes_.size());
+        for (const auto& node : nodes_)
+        {
+            result.push_back(*(node.val_ptr));
+        }
+        return result;
+    }
+
+    Json normalized_paths() const
+    {
+        Json result = typename Json::array();
+        result.reserve(nodes_.size());
+        for (const auto& node : nodes_)
+        {
+            result.push_back(selection_.normalized_path(node.link));
+        }
+        return result;
+    }
+
+    // Replaces the values in the document with new_value. Values made 
+    // from the document, such as a length, are left alone. A node is
+    // replaced before any that contains it.
+    template <class T>
+    void replace(T&& new_value)
+    {
+        for (auto it = nodes_.rbegin(); it != nodes_.rend(); ++it)
+        {
+            if (selection_.in_document(it->link))
             {
-                for (auto it = p->array_range().begin(); it != p->array_range().end(); ++it)
+                *(it->val_ptr) = new_value;
+            }
+        }
+        nodes_.clear();
+    }
+
+    // Removes the values from the objects and arrays that contain them. The
+    // root, and values made from the document, are left alone. 
+    void remove()
+    {
+        std::vector<std::vector<path_component>> paths;
+        paths.reserve(nodes_.size());
+        for (const auto& node : nodes_)
+        {
+            if (node.link != 0 && selection_.in_document(node.link))
+            {
+                paths.push_back(trail(node.link));
+            }
+        }
+        nodes_.clear();
+
+        // The elements of an array are removed from the last, and the
+        // members of a value before the value
+        std::sort(paths.begin(), paths.end(), 
+                  [](const std::vector<path_component>& a, const std::vector<path_component>& b){return b < a;});
+        paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+        for (const auto& path : paths)
+        {
+            pointer p = selection_.link(0).val_ptr;
+            for (size_t i = 0; p != nullptr && i + 1 < path.size(); ++i)
+            {
+                p = child(p, path[i]);
+            }
+            if (p == nullptr)
+            {
+                continue;
+            }
+            const path_component& last = path.back();
+            if (last.is_index)
+            {
+                if (p->is_array() && last.index < p->size())
                 {
-                    nodes_.emplace_back(PathCons()(path,it - p->array_range().begin()),std::addressof(*it));
+                    p->erase(p->array_range().begin() + last.index);
                 }
             }
             else if (p->is_object())
             {
-                for (auto it = p->object_range().begin(); it != p->object_range().end(); ++it)
+                p->erase(last.name);
+            }
+        }
+    }
+private:
+    std::vector<path_component> trail(size_t i) const
+    {
+        std::vector<path_component> components;
+        for (; i != 0; i = selection_.link(i).parent)
+        {
+            const auto& link = selection_.link(i);
+            path_component component;
+            component.is_index = link.is_index;
+            component.index = link.index;
+            if (!link.is_index)
+            {
+                component.name.assign(link.name.data(), link.name.length());
+            }
+            components.push_back(std::move(component));
+        }
+        std::reverse(components.begin(), components.end());
+        return components;
+    }
+
+    static pointer child(pointer p, const path_component& component)
+    {
+        if (component.is_index)
+        {
+            return p->is_array() && component.index < p->size() ? std::addressof((*p)[component.index]) : nullptr;
+        }
+        if (!p->is_object())
+        {
+            return nullptr;
+        }
+        auto it = p->find(component.name);
+        return it != p->object_range().end() ? std::addressof(it->value()) : nullptr;
+    }
+};
+
+// jsonpath_expression is a JSONPath expression compiled once, for evaluating
+// against many JSON values. Evaluation does not change the expression, so
+// one expression may be evaluated on several threads at once.
+
+template <class Json,class JsonReference=const Json&>
+class jsonpath_expression
+{
+public:
+    typedef typename Json::char_type char_type;
+    typedef typename Json::string_view_type string_view_type;
+    typedef JsonReference reference;
+private:
+    typedef detail::path_step<Json,JsonReference> step_type;
+    typedef detail::path_selection<Json,JsonReference> selection_type;
+    typedef detail::path_node<Json,JsonReference> node_type;
+    typedef std::vector<node_type> node_set;
+    typedef typename node_type::string_type string_type;
+    typedef typename node_type::pointer pointer;
+
+    template <class J>
+    friend class detail::filter_path;
+    template <class J>
+    friend class detail::stream_path;
+    template <class J>
+    friend class jsonpath_multi_query;
+    template <class J,class R>
+    friend class jsonpath_parallel_evaluator;
+
+    bool has_root_;
+    // True if the path is a sequence of names, such as $.store.bicycle
+    bool names_only_;
+    std::vector<step_type> steps_;
+public:
+    jsonpath_expression()
+        : has_root_(false), names_only_(false)
+    {
+    }
+
+    static jsonpath_expression compile(const string_view_type& path)
+    {
+        detail::jsonpath_compiler<Json,JsonReference> compiler;
+        std::error_code ec;
+        compiler.compile(path.data(), path.length(), ec);
+        if (ec)
+        {
+            throw parse_error(ec,compiler.line_number(),compiler.column_number());
+        }
+        return jsonpath_expression(compiler);
+    }
+
+    static jsonpath_expression compile(const string_view_type& path, std::error_code& ec)
+    {
+        detail::jsonpath_compiler<Json,JsonReference> compiler;
+        compiler.compile(path.data(), path.length(), ec);
+        if (ec)
+        {
+            return jsonpath_expression();
+        }
+        return jsonpath_expression(compiler);
+    }
+
+    Json evaluate(reference root, result_type result_t = result_type::value) const
+    {
+        selection_type selection(root, result_t == result_type::path);
+        return evaluate(selection, root, result_t);
+    }
+
+    // Returns the nodes that the expression selects from root, without
+    // copying them or making their normalized paths
+    jsonpath_result_set<Json,JsonReference> select(reference root) const
+    {
+        selection_type selection(root, true);
+        node_set nodes = select(selection, root);
+        return jsonpath_result_set<Json,JsonReference>(std::move(selection), std::move(nodes));
+    }
+
+    template <class T>
+    void replace(reference root, T&& new_value) const
+    {
+        selection_type selection(root, false);
+        node_set nodes = select(selection, root);
+        for (auto& node : nodes)
+        {
+            *(node.val_ptr) = new_value;
+        }
+    }
+private:
+    explicit jsonpath_expression(detail::jsonpath_compiler<Json,JsonReference>& compiler)
+        : has_root_(compiler.has_root()), names_only_(compiler.has_root())
+    {
+        steps_.swap(compiler.steps());
+        for (const auto& step : steps_)
+        {
+            if (step.kind != detail::path_step_kind::name || step.recursive_descent || step.name.length() == 0)
+            {
+                names_only_ = false;
+            }
+        }
+    }
+
+    Json evaluate(selection_type& selection, reference root, result_type result_t) const
+    {
+        node_set nodes = select(selection, root);
+
+        Json result = typename Json::array();
+        result.reserve(nodes.size());
+        if (result_t == result_type::value)
+        {
+            for (const auto& node : nodes)
+            {
+                result.push_back(*(node.val_ptr));
+            }
+        }
+        else
+        {
+            for (const auto& node : nodes)
+            {
+                result.push_back(selection.normalized_path(node.link));
+            }
+        }
+        return result;
+    }
+
+    // True if a filter or expression in the path reads the root
+    bool uses_root() const
+    {
+        for (const auto& step : steps_)
+        {
+            for (const auto& selector : step.selectors)
+            {
+                if (selector->uses_root())
                 {
-                    nodes_.emplace_back(PathCons()(path,it->key()),std::addressof(it->value()));
+                    return true;
                 }
             }
+        }
+        return false;
+    }
 
+    // Selects the nodes from root without copying them. The values made 
+    // along the way, such as a length, are moved to temps.
+    void select_pointers(reference root, std::vector<pointer>& result, std::vector<std::shared_ptr<Json>>& temps) const
+    {
+        selection_type selection(root, false);
+        node_set nodes = select(selection, root);
+        result.reserve(nodes.size());
+        for (const auto& node : nodes)
+        {
+            result.push_back(node.val_ptr);
         }
-        start_ = 0;
+        selection.move_temps(temps);
     }
 
-    void apply_unquoted_string(const string_view_type& name)
+    // Selects the node at a path of names without making a node set. Returns
+    // false if the path is not a sequence of names, or reaches a string, and
+    // must be selected in full. A length is put in temp.
+    bool select_names(reference root, pointer& result, Json& temp) const
     {
-        if (name.length() > 0)
+        if (!names_only_)
+        {
+            return false;
+        }
+        pointer p = std::addressof(root);
+        for (const auto& step : steps_)
         {
-            for (size_t i = 0; i < stack_.back().size(); ++i)
+            const string_type& name = step.name;
+            if (p->is_object())
+            {
+                auto it = p->find(name);
+                if (it == p->object_range().end())
+                {
+                    p = nullptr;
+                }
+                else
+                {
+                    p = std::addressof(it->value());
+                }
+            }
+            else if (p->is_array())
+            {
+                size_t pos = 0;
+                bool positive_start = true;
+                if (detail::try_string_to_index(name.data(),name.size(),&pos, &positive_start))
+                {
+                    size_t index = positive_start ? pos : p->size() - pos;
+                    p = index < p->size() ? std::addressof((*p)[index]) : nullptr;
+                }
+                else if (name == detail::length_literal<Json>() && p->size() > 0)
+                {
+                    temp = Json(p->size());
+                    p = std::addressof(temp);
+                }
+                else
+                {
+                    p = nullptr;
+                }
+            }
+            else if (p->is_string())
             {
-                apply_unquoted_string(stack_.back()[i].path, *(stack_.back()[i].val_ptr), name);
+                return false;
+            }
+            else
+            {
+                p = nullptr;
+            }
+            if (p == nullptr)
+            {
+                break;
+            }
+        }
+        result = p;
+        return true;
+    }
+
+    node_set select(selection_type& selection, reference root) const
+    {
+        node_set nodes;
+        if (has_root_)
+        {
+            nodes.emplace_back(0,std::addressof(root));
+
+            node_set next;
+            for (const auto& step : steps_)
+            {
+                switch (step.kind)
+                {
+                case detail::path_step_kind::name:
+                    if (step.name.length() > 0)
+                    {
+                        selection.for_each_chunk(nodes.size(), next,
+                            [&](selection_type& chunk, size_t first, size_t last, node_set& chunk_next)
+                        {
+                            for (size_t i = first; i < last; ++i)
+                            {
+                                apply_unquoted_string(chunk, nodes[i].link, *(nodes[i].val_ptr), step.name, step.recursive_descent, chunk_next);
+                            }
+                        });
+                    }
+                    break;
+                case detail::path_step_kind::selectors:
+                    for (size_t i = 0; i < step.wildcards; ++i)
+                    {
+                        end_all(selection, nodes, next);
+                    }
+                    if (step.selectors.size() > 0)
+                    {
+                        // Each node keeps its own state for a filter, so 
+                        // the nodes may be split into chunks
+                        selection.for_each_chunk(nodes.size(), next,
+                            [&](selection_type& chunk, size_t first, size_t last, node_set& chunk_next)
+                        {
+                            for (size_t i = first; i < last; ++i)
+                            {
+                                apply_selectors(chunk, step, nodes[i], nodes[i].link, *(nodes[i].val_ptr), chunk_next);
+                            }
+                        });
+                    }
+                    break;
+                }
+                nodes.swap(next);
+                next.clear();
+            }
+        }
+        return nodes;
+    }
+
+    static void end_all(selection_type& selection, const node_set& nodes, node_set& next)
+    {
+        for (const auto& node : nodes)
+        {
+            pointer p = node.val_ptr;
+
+            if (p->is_array())
+            {
+                for (auto it = p->array_range().begin(); it != p->array_range().end(); ++it)
+                {
+                    pointer q = std::addressof(*it);
+                    next.emplace_back(selection.path(node.link,it - p->array_range().begin(),q),q);
+                }
+            }
+            else if (p->is_object())
+            {
+                for (auto it = p->object_range().begin(); it != p->object_range().end(); ++it)
+                {
+                    pointer q = std::addressof(it->value());
+                    next.emplace_back(selection.path(node.link,it->key(),q),q);
+                }
             }
         }
-        buffer_.clear();
     }
 
-    void apply_unquoted_string(const string_type& path, reference val, const string_view_type& name)
+    static void apply_unquoted_string(selection_type& selection, size_t path, reference val,
+                                      const string_view_type& name, bool recursive_descent, node_set& next)
     {
+        bool positive_start = true;
         if (val.is_object())
         {
-            if (val.contains(name))
+            auto found = val.find(name);
+            if (found != val.object_range().end())
             {
-                nodes_.emplace_back(PathCons()(path,name),std::addressof(val.at(name)));
+                pointer p = std::addressof(found->value());
+                next.emplace_back(selection.path(path,found->key(),p),p);
             }
-            if (recursive_descent_)
+            if (recursive_descent)
             {
                 for (auto it = val.object_range().begin(); it != val.object_range().end(); ++it)
                 {
                     if (it->value().is_object() || it->value().is_array())
                     {
-                        apply_unquoted_string(path, it->value(), name);
+                        pointer p = std::addressof(it->value());
+                        apply_unquoted_string(selection, selection.path(path,it->key(),p), it->value(), name, recursive_descent, next);
                     }
                 }
             }
@@ -999,119 +1888,152 @@ public:
         else if (val.is_array())
         {
             size_t pos = 0;
-            if (try_string_to_index(name.data(),name.size(),&pos, &positive_start_))
+            if (detail::try_string_to_index(name.data(),name.size(),&pos, &positive_start))
             {
-                size_t index = positive_start_ ? pos : val.size() - pos;
+                size_t index = positive_start ? pos : val.size() - pos;
                 if (index < val.size())
                 {
-                    nodes_.emplace_back(PathCons()(path,index),std::addressof(val[index]));
+                    pointer p = std::addressof(val[index]);
+                    next.emplace_back(selection.path(path,index,p),p);
                 }
             }
-            else if (name == length_literal() && val.size() > 0)
+            else if (name == detail::length_literal<Json>() && val.size() > 0)
             {
-                auto temp = std::make_shared<Json>(val.size());
-                temp_json_values_.push_back(temp);
-                nodes_.emplace_back(PathCons()(path,name),temp.get());
+                pointer p = selection.make_temp(val.size());
+                next.emplace_back(selection.path(path,detail::length_literal<Json>(),p),p);
             }
-            if (recursive_descent_)
+            if (recursive_descent)
             {
-                for (auto it = val.array_range().begin(); it != val.array_range().end(); ++it)
+                selection.for_each_chunk(val.size(), next,
+                    [&](selection_type& chunk, size_t first, size_t last, node_set& chunk_next)
                 {
-                    if (it->is_object() || it->is_array())
+                    for (size_t i = first; i < last; ++i)
                     {
-                        apply_unquoted_string(path, *it, name);
+                        if (val[i].is_object() || val[i].is_array())
+                        {
+                            pointer p = std::addressof(val[i]);
+                            apply_unquoted_string(chunk, chunk.path(path,i,p), val[i], name, recursive_descent, chunk_next);
+                        }
                     }
-                }
+                });
             }
         }
         else if (val.is_string())
         {
             string_view_type sv = val.as_string_view();
             size_t pos = 0;
-            if (try_string_to_index(name.data(),name.size(),&pos, &positive_start_))
+            if (detail::try_string_to_index(name.data(),name.size(),&pos, &positive_start))
             {
                 auto sequence = unicons::sequence_at(sv.data(), sv.data() + sv.size(), pos);
                 if (sequence.length() > 0)
                 {
-                    auto temp = std::make_shared<Json>(sequence.begin(),sequence.length());
-                    temp_json_values_.push_back(temp);
-                    nodes_.emplace_back(PathCons()(path,pos),temp.get());
+                    pointer p = selection.make_temp(sequence.begin(),sequence.length());
+                    next.emplace_back(selection.path(path,pos,p),p);
                 }
             }
-            else if (name == length_literal() && sv.size() > 0)
+            else if (name == detail::length_literal<Json>() && sv.size() > 0)
             {
                 size_t count = unicons::u32_length(sv.begin(),sv.end());
-                auto temp = std::make_shared<Json>(count);
-                temp_json_values_.push_back(temp);
-                nodes_.emplace_back(PathCons()(path,name),temp.get());
+                pointer p = selection.make_temp(count);
+                next.emplace_back(selection.path(path,detail::length_literal<Json>(),p),p);
             }
         }
     }
 
-    void apply_selectors()
+    static bool has_filter(const step_type& step)
     {
-        if (selectors_.size() > 0)
+        for (const auto& selector : step.selectors)
         {
-            for (size_t i = 0; i < stack_.back().size(); ++i)
+            if (selector->is_filter())
             {
-                node_type& node = stack_.back()[i];
-                apply_selectors(node, node.path, *(node.val_ptr));
+                return true;
             }
-            selectors_.clear();
         }
-        transfer_nodes();
+        return false;
     }
 
-    void apply_selectors(node_type& node, const string_type& path, reference val)
+    static void apply_selectors(selection_type& selection, const step_type& step, node_type& node,
+                                size_t path, reference val, node_set& next)
     {
-        for (const auto& selector : selectors_)
+        for (const auto& selector : step.selectors)
         {
-            selector->select(node, path, val, nodes_, temp_json_values_);
+            selector->select(selection, node, path, val, next);
         }
-        if (recursive_descent_)
+        if (step.recursive_descent)
         {
             if (val.is_object())
             {
                 for (auto& nvp : val.object_range())
                 {
                     if (nvp.value().is_object() || nvp.value().is_array())
-                    {                        
-                        apply_selectors(node,PathCons()(path,nvp.key()),nvp.value());
+                    {
+                        pointer p = std::addressof(nvp.value());
+                        apply_selectors(selection, step, node, selection.path(path,nvp.key(),p), nvp.value(), next);
                     }
                 }
             }
             else if (val.is_array())
             {
-                for (auto& elem : val.array_range())
+                auto visit = [&](selection_type& chunk, size_t first, size_t last, node_set& chunk_next)
                 {
-                    if (elem.is_object() || elem.is_array())
+                    for (size_t i = first; i < last; ++i)
                     {
-                        apply_selectors(node,path, elem);
+                        if (val[i].is_object() || val[i].is_array())
+                        {
+                            pointer p = std::addressof(val[i]);
+                            apply_selectors(chunk, step, node, chunk.path(path,i,p), val[i], chunk_next);
+                        }
                     }
+                };
+                // A filter keeps state in the node from one element to 
+                // the next, so the elements are visited in turn
+                if (has_filter(step))
+                {
+                    visit(selection, 0, val.size(), next);
+                }
+                else
+                {
+                    selection.for_each_chunk(val.size(), next, visit);
                 }
             }
         }
     }
+};
 
-    void transfer_nodes()
-    {
-        stack_.push_back(nodes_);
-        nodes_.clear();
-        recursive_descent_ = false;
-    }
+template <class Json>
+jsonpath_expression<Json> make_expression(const typename Json::string_view_type& path)
+{
+    return jsonpath_expression<Json>::compile(path);
+}
 
-    size_t line_number() const override
-    {
-        return line_;
-    }
+template <class Json>
+jsonpath_expression<Json> make_expression(const typename Json::string_view_type& path, std::error_code& ec)
+{
+    return jsonpath_expression<Json>::compile(path, ec);
+}
 
-    size_t column_number() const override
-    {
-        return column_;
-    }
+template<class Json>
+Json json_query(const Json& root, const typename Json::string_view_type& path, result_type result_t = result_type::value)
+{
+    return jsonpath_expression<Json>::compile(path).evaluate(root, result_t);
+}
 
-};
+template<class Json>
+jsonpath_result_set<Json> json_select(const Json& root, const typename Json::string_view_type& path)
+{
+    return jsonpath_expression<Json>::compile(path).select(root);
+}
 
+template<class Json>
+jsonpath_result_set<Json,Json&> json_select(Json& root, const typename Json::string_view_type& path)
+{
+    return jsonpath_expression<Json,Json&>::compile(path).select(root);
+}
+
+template<class Json, class T>
+void json_replace(Json& root, const typename Json::string_view_type& path, T&& new_value)
+{
+    jsonpath_expression<Json,Json&>::compile(path).replace(root, std::forward<T>(new_value));
 }
 
 }}
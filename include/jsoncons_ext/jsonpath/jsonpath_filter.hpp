@@ -20,7 +20,12 @@
 #include <jsoncons/json.hpp>
 #include "jsonpath_error_category.hpp"
 
-namespace jsoncons { namespace jsonpath { namespace detail {
+namespace jsoncons { namespace jsonpath {
+
+template <class Json,class JsonReference>
+class jsonpath_expression;
+
+namespace detail {
 
 JSONCONS_DEFINE_LITERAL(eqtilde_literal,"=~")
 JSONCONS_DEFINE_LITERAL(star_literal,"*")
@@ -78,29 +83,6 @@ struct PathConstructor
     }
 };
 
-template<class Json>
-struct VoidPathConstructor
-{
-    typedef typename Json::char_type char_type;
-    typedef typename Json::string_view_type string_view_type;
-    typedef typename Json::string_type string_type;
-
-    string_type operator()(const string_type&, size_t) const
-    {
-        return string_type{};
-    }
-
-    string_type operator()(const string_type&, string_view_type) const
-    {
-        return string_type{};
-    }
-};
-
-template <class Json,
-          class JsonReference,
-          class PathCons>
-class jsonpath_evaluator;
-
 enum class filter_state
 {
     start,
@@ -130,151 +112,49 @@ enum class token_type
     rparen
 };
 
-template <class Json>
-class term
+// The instructions that a filter is compiled to. Operands are pushed on a
+// stack of values, operators pop their operands and push the result.
+enum class filter_opcode
 {
-public:
-    typedef typename Json::string_type string_type;
-    typedef typename Json::char_type char_type;
-
-    virtual ~term() {}
-
-    virtual void initialize(const Json&)
-    {
-    }
-    virtual bool accept_single_node() const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual Json evaluate_single_node() const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool exclaim() const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool eq_term(const term&) const 
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool eq(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool ne_term(const term&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool ne(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool regex_term(const term&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool regex2(const string_type&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool ampamp_term(const term&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool ampamp(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool pipepipe_term(const term&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool pipepipe(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool lt_term(const term&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool lt(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool gt_term(const term&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual bool gt(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-
-    virtual Json minus_term(const term&) const 
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual Json minus(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-
-    virtual Json left_minus(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-
-    virtual Json unary_minus() const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual Json plus_term(const term&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual Json plus(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual Json mult_term(const term&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual Json mult(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-
-    virtual Json div_term(const term&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
-    virtual Json div(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
+    push_value,
+    push_path,
+    push_regex,
+    exclaim,
+    unary_minus,
+    function,
+    regex,
+    mult,
+    div,
+    plus,
+    minus,
+    lt,
+    lte,
+    gt,
+    gte,
+    eq,
+    ne,
+    ampamp,
+    pipepipe
+};
 
-    virtual Json left_div(const Json&) const
-    {
-        throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
-    }
+struct filter_instruction
+{
+    filter_opcode opcode;
+    // Index of the value, path, regex or function that the instruction uses
+    size_t index;
 };
 
-template <class Json>
 struct operator_properties
 {
-    typedef std::function<Json(const term<Json>&, const term<Json>&)> operator_type;
-
     size_t precedence_level;
     bool is_right_associative;
-    operator_type op;
+    filter_opcode opcode;
 };
 
 template <class Json>
 struct function_properties
 {
-    typedef std::function<Json(const term<Json>&)> function_type;
+    typedef std::function<Json(const Json&)> function_type;
 
     size_t precedence_level;
     bool is_right_associative;
@@ -282,54 +162,109 @@ struct function_properties
     function_type op;
 };
 
+// A path in a filter, compiled with the filter. Its value is the node set
+// that it selects from the context node, or for the argument of an aggregate
+// function, the array of values that it selects from the root.
+template <class Json>
+class filter_path
+{
+    typedef typename Json::string_view_type string_view_type;
+
+    jsonpath_expression<Json,const Json&> expr_;
+    bool from_root_;
+public:
+    filter_path(const string_view_type& path, bool from_root)
+        : expr_(jsonpath_expression<Json,const Json&>::compile(path)), from_root_(from_root)
+    {
+    }
+
+    bool from_root() const
+    {
+        return from_root_;
+    }
+
+    Json evaluate(const Json& root) const
+    {
+        return expr_.evaluate(root);
+    }
+
+    // Selects the nodes from the context node. A path of names such as 
+    // @.price is looked up in place, a length is put in temp. Other paths 
+    // are selected without copying the nodes, the values made along the 
+    // way, such as a length, are kept in temps.
+    void select(const Json& context_node, std::vector<const Json*>& nodes, Json& temp,
+                std::vector<std::shared_ptr<Json>>& temps) const
+    {
+        nodes.clear();
+        const Json* p = nullptr;
+        if (expr_.select_names(context_node, p, temp))
+        {
+            if (p != nullptr)
+            {
+                nodes.push_back(p);
+            }
+        }
+        else
+        {
+            expr_.select_pointers(context_node, nodes, temps);
+        }
+    }
+};
+
 template <class Json>
 class token
 {
+public:
+    typedef typename Json::char_type char_type;
+    typedef std::basic_regex<char_type> regex_type;
+    typedef typename function_properties<Json>::function_type function_type;
+private:
     token_type type_;
     size_t precedence_level_;
     bool is_right_associative_;
     bool is_aggregate_;
-    std::shared_ptr<term<Json>> operand_ptr_;
-    std::function<Json(const term<Json>&)> unary_operator_;
-    std::function<Json(const term<Json>&, const term<Json>&)> operator_;
+    filter_opcode opcode_;
+    Json value_;
+    std::shared_ptr<const filter_path<Json>> path_;
+    std::shared_ptr<const regex_type> regex_;
+    function_type function_;
 public:
-    typedef std::function<Json(const term<Json>&)> unary_operator_type;
-    typedef std::function<Json(const term<Json>&, const term<Json>&)> operator_type;
-
-    Json operator()(const term<Json>& a)
+    token(token_type type)
+        : type_(type),precedence_level_(0),is_right_associative_(false),is_aggregate_(false),
+          opcode_(filter_opcode::push_value)
     {
-        return unary_operator_(a);
     }
-
-    Json operator()(const term<Json>& a, const term<Json>& b)
+    explicit token(const Json& value)
+        : type_(token_type::operand),precedence_level_(0),is_right_associative_(false),is_aggregate_(false),
+          opcode_(filter_opcode::push_value), value_(value)
     {
-        return operator_(a,b);
     }
-
-    token(token_type type)
-        : type_(type),precedence_level_(0),is_right_associative_(false),is_aggregate_(false)
+    explicit token(std::shared_ptr<const filter_path<Json>> path)
+        : type_(token_type::operand),precedence_level_(0),is_right_associative_(false),is_aggregate_(false),
+          opcode_(filter_opcode::push_path), path_(path)
     {
     }
-    token(token_type type, std::shared_ptr<term<Json>> term_ptr)
-        : type_(type),precedence_level_(0),is_right_associative_(false),is_aggregate_(false),operand_ptr_(term_ptr)
+    explicit token(std::shared_ptr<const regex_type> regex)
+        : type_(token_type::operand),precedence_level_(0),is_right_associative_(false),is_aggregate_(false),
+          opcode_(filter_opcode::push_regex), regex_(regex)
     {
     }
     token(size_t precedence_level, 
           bool is_right_associative,
-          std::function<Json(const term<Json>&)> unary_operator)
+          filter_opcode opcode)
         : type_(token_type::unary_operator), 
           precedence_level_(precedence_level), 
           is_right_associative_(is_right_associative),
           is_aggregate_(false), 
-          unary_operator_(unary_operator)
+          opcode_(opcode)
     {
     }
-    token(const operator_properties<Json>& properties)
+    token(const operator_properties& properties)
         : type_(token_type::binary_operator), 
           precedence_level_(properties.precedence_level), 
           is_right_associative_(properties.is_right_associative),
           is_aggregate_(false), 
-          operator_(properties.op)
+          opcode_(properties.opcode)
     {
     }
     token(const function_properties<Json>& properties)
@@ -337,7 +272,8 @@ public:
           precedence_level_(properties.precedence_level), 
           is_right_associative_(properties.is_right_associative), 
           is_aggregate_(properties.is_aggregate),
-          unary_operator_(properties.op)
+          opcode_(filter_opcode::function),
+          function_(properties.op)
     {
     }
     token(const token& t) = default;
@@ -391,18 +327,29 @@ public:
         return is_aggregate_;
     }
 
-    const term<Json>& operand()
+    filter_opcode opcode() const
     {
-        JSONCONS_ASSERT(type_ == token_type::operand && operand_ptr_ != nullptr);
-        return *operand_ptr_;
+        return opcode_;
     }
 
-    void initialize(const Json& context_node)
+    const Json& value() const
     {
-        if (operand_ptr_.get() != nullptr)
-        {
-            operand_ptr_->initialize(context_node);
-        }
+        return value_;
+    }
+
+    std::shared_ptr<const filter_path<Json>> path() const
+    {
+        return path_;
+    }
+
+    std::shared_ptr<const regex_type> regex() const
+    {
+        return regex_;
+    }
+
+    const function_type& function() const
+    {
+        return function_;
     }
 };
 
@@ -538,511 +485,550 @@ Json minus(const Json& lhs, const Json& rhs)
     return result;
 }
 
-template <class Json>
-class value_term final : public term<Json>
+enum class filter_value_kind
 {
-    Json value_;
-public:
-    template <class T>
-    value_term(const T& val)
-        : value_(val)
-    {
-    }
-
-    bool accept_single_node() const override
-    {
-        return value_.as_bool();
-    }
-
-    Json evaluate_single_node() const override
-    {
-        return value_;
-    }
-
-    bool exclaim() const override
-    {
-        return !value_.as_bool();
-    }
-
-    bool eq_term(const term<Json>& rhs) const override
-    {
-        return rhs.eq(value_);
-    }
-
-    bool eq(const Json& rhs) const override
-    {
-        return value_ == rhs;
-    }
-
-    bool ne_term(const term<Json>& rhs) const override
-    {
-        return rhs.ne(value_);
-    }
-    bool ne(const Json& rhs) const override
-    {
-        return value_ != rhs;
-    }
-    bool regex_term(const term<Json>& rhs) const override
-    {
-        return rhs.regex2(value_.as_string());
-    }
-    bool ampamp_term(const term<Json>& rhs) const override
-    {
-        return rhs.ampamp(value_);
-    }
-    bool ampamp(const Json& rhs) const override
-    {
-        return jsoncons::jsonpath::detail::ampamp(value_,rhs);
-    }
-    bool pipepipe_term(const term<Json>& rhs) const override
-    {
-        return rhs.pipepipe(value_);
-    }
-    bool pipepipe(const Json& rhs) const override
-    {
-        return jsoncons::jsonpath::detail::pipepipe(value_,rhs);
-    }
-
-    bool lt_term(const term<Json>& rhs) const override
-    {
-        return rhs.gt(value_);
-    }
-    bool lt(const Json& rhs) const override
-    {
-        return jsoncons::jsonpath::detail::lt(value_,rhs);
-    }
-
-    bool gt_term(const term<Json>& rhs) const override
-    {
-        return rhs.lt(value_);
-    }
-    bool gt(const Json& rhs) const override
-    {
-        return jsoncons::jsonpath::detail::gt(value_,rhs);
-    }
-
-    Json minus_term(const term<Json>& rhs) const override
-    {
-        return rhs.left_minus(value_);
-    }
-    Json minus(const Json& rhs) const override
-    {
-        return jsoncons::jsonpath::detail::minus(value_,rhs);
-    }
-
-    Json left_minus(const Json& lhs) const override
-    {
-        return jsoncons::jsonpath::detail::minus(lhs,value_);
-    }
-
-    Json unary_minus() const override
-    {
-        return jsoncons::jsonpath::detail::unary_minus(value_);
-    }
+    value,
+    node_set,
+    regex
+};
 
-    Json plus_term(const term<Json>& rhs) const override
-    {
-        return rhs.plus(value_);
-    }
+// A value on the stack that a filter is evaluated on. Values and nodes point
+// into the filter, the document, temp or temps, so pushing them does not copy.
+template <class Json>
+struct filter_value
+{
+    typedef std::basic_regex<typename Json::char_type> regex_type;
 
-    Json plus(const Json& rhs) const override
-    {
-        return jsoncons::jsonpath::detail::plus(value_,rhs);
-    }
-    Json mult_term(const term<Json>& rhs) const override
-    {
-        return rhs.mult(value_);
-    }
+    filter_value_kind kind;
+    const Json* value;
+    std::vector<const Json*> nodes;
+    const regex_type* regex;
+    Json temp;
+    std::vector<std::shared_ptr<Json>> temps;
 
-    Json mult(const Json& rhs) const override
+    filter_value()
+        : kind(filter_value_kind::value), value(nullptr), regex(nullptr)
     {
-        return jsoncons::jsonpath::detail::mult(value_,rhs);
     }
 
-    Json div_term(const term<Json>& rhs) const override
-    {
-        return rhs.left_div(value_);
-    }
-    Json div(const Json& rhs) const override
+    void assign(const Json* val)
     {
-        return jsoncons::jsonpath::detail::div(value_,rhs);
+        kind = filter_value_kind::value;
+        value = val;
     }
 
-    Json left_div(const Json& lhs) const override
+    void assign(Json&& val)
     {
-        return jsoncons::jsonpath::detail::div(lhs,value_);
+        temp = std::move(val);
+        kind = filter_value_kind::value;
+        value = std::addressof(temp);
     }
 };
 
 template <class Json>
-class regex_term final : public term<Json>
+class jsonpath_filter_expr;
+
+// The stack that a filter is evaluated on. Evaluating a filter against many
+// nodes with one stack reuses its storage, and evaluates the arguments of
+// aggregate functions, which depend only on the root, once.
+template <class Json>
+class filter_stack
 {
-    typedef typename Json::char_type char_type;
-    typedef typename Json::string_type string_type;
-    const std::basic_regex<char_type> pattern_;
-public:
-    regex_term(const string_type& pattern, std::regex::flag_type flags)
-        : pattern_(pattern,flags)
-    {
-    }
+    friend class jsonpath_filter_expr<Json>;
 
-    bool regex2(const string_type& subject) const override
+    std::vector<filter_value<Json>> values_;
+    const jsonpath_filter_expr<Json>* expr_;
+    const Json* root_;
+    std::vector<std::shared_ptr<const Json>> root_values_;
+public:
+    filter_stack()
+        : expr_(nullptr), root_(nullptr)
     {
-        return std::regex_match(subject, pattern_);
     }
 };
 
 template <class Json>
-class path_term final : public term<Json>
+class jsonpath_filter_expr
 {
-    typedef typename Json::string_type string_type;
-
-    string_type path_;
-    Json nodes_;
+    typedef typename Json::char_type char_type;
+    typedef std::basic_regex<char_type> regex_type;
+    typedef typename function_properties<Json>::function_type function_type;
+    typedef filter_value<Json> value_type;
+
+    std::vector<filter_instruction> code_;
+    std::vector<Json> values_;
+    std::vector<std::shared_ptr<const filter_path<Json>>> paths_;
+    std::vector<std::shared_ptr<const regex_type>> regexes_;
+    std::vector<function_type> functions_;
+    size_t stack_size_;
+    bool valid_;
+    size_t line_;
+    size_t column_;
 public:
-    path_term(const string_type& path)
-        : path_(path)
-    {
-    }
 
-    void initialize(const Json& context_node) override
+    // tokens are in reverse polish notation
+    jsonpath_filter_expr(const std::vector<token<Json>>& tokens, size_t line, size_t column)
+        : stack_size_(0), valid_(true), line_(line), column_(column)
     {
-        jsonpath_evaluator<Json,const Json&,VoidPathConstructor<Json>> evaluator;
-        evaluator.evaluate(context_node,path_);
-        nodes_ = evaluator.get_values();
-    }
+        size_t depth = 0;
+        for (const auto& t : tokens)
+        {
+            size_t index = 0;
+            switch (t.opcode())
+            {
+            case filter_opcode::push_value:
+                index = values_.size();
+                values_.push_back(t.value());
+                break;
+            case filter_opcode::push_path:
+                index = paths_.size();
+                paths_.push_back(t.path());
+                break;
+            case filter_opcode::push_regex:
+                index = regexes_.size();
+                regexes_.push_back(t.regex());
+                break;
+            case filter_opcode::function:
+                index = functions_.size();
+                functions_.push_back(t.function());
+                break;
+            default:
+                break;
+            }
+            code_.push_back(filter_instruction{t.opcode(),index});
 
-    bool accept_single_node() const override
-    {
-        return nodes_.size() != 0;
+            if (t.is_operand())
+            {
+                ++depth;
+            }
+            else if (depth < (t.is_binary_operator() ? 2 : 1))
+            {
+                valid_ = false;
+            }
+            else if (t.is_binary_operator())
+            {
+                --depth;
+            }
+            if (depth > stack_size_)
+            {
+                stack_size_ = depth;
+            }
+        }
+        if (depth != 1)
+        {
+            valid_ = false;
+        }
     }
 
-    Json evaluate_single_node() const override
+    Json eval(const Json& context_node) const
     {
-        return nodes_.size() == 1 ? nodes_[0] : nodes_;
+        return eval(context_node, context_node);
     }
 
-    bool exclaim() const override
+    Json eval(const Json& context_node, const Json& root) const
     {
-        return nodes_.size() == 0;
+        filter_stack<Json> stack;
+        return eval(context_node, root, stack);
     }
 
-    bool eq_term(const term<Json>& rhs) const override
+    Json eval(const Json& context_node, const Json& root, filter_stack<Json>& stack) const
     {
-        bool result = false;
-        if (nodes_.size() > 0)
+        try
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
-            {
-                result = rhs.eq(nodes_[i]);
-            }
+            return evaluate_single_node(execute(context_node, root, stack));
         }
-        return result;
-    }
-
-    bool eq(const Json& rhs) const override
-    {
-        bool result = false;
-        if (nodes_.size() > 0)
+        catch (const parse_error& e)
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
-            {
-                result = nodes_[i] == rhs;
-            }
+            throw parse_error(e.code(),line_,column_);
         }
-        return result;
     }
 
-    bool ne_term(const term<Json>& rhs) const override
+    // True if the filter reads the root, as the argument of an aggregate 
+    // function does
+    bool uses_root() const
     {
-        bool result = false;
-        if (nodes_.size() > 0)
+        for (const auto& path : paths_)
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
+            if (path->from_root())
             {
-                result = rhs.ne(nodes_[i]);
+                return true;
             }
         }
-        return result;
+        return false;
+    }
 
+    bool exists(const Json& context_node) const
+    {
+        return exists(context_node, context_node);
     }
-    bool ne(const Json& rhs) const override
+
+    bool exists(const Json& context_node, const Json& root) const
     {
-        bool result = false;
-        if (nodes_.size() > 0)
-        {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
-            {
-                result = nodes_[i] != rhs;
-            }
-        }
-        return result;
+        filter_stack<Json> stack;
+        return exists(context_node, root, stack);
     }
-    bool regex_term(const term<Json>& rhs) const override
+
+    bool exists(const Json& context_node, const Json& root, filter_stack<Json>& stack) const
     {
-        bool result = false;
-        if (nodes_.size() > 0)
+        try
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
-            {
-                result = rhs.regex2(nodes_[i].as_string());
-            }
+            return accept_single_node(execute(context_node, root, stack));
         }
-        return result;
-    }
-    bool ampamp_term(const term<Json>& rhs) const override
-    {
-        bool result = false;
-        if (nodes_.size() > 0)
+        catch (const parse_error& e)
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
-            {
-                result = rhs.ampamp(nodes_[i]);
-            }
+            throw parse_error(e.code(),line_,column_);
         }
-        return result;
     }
-    bool ampamp(const Json& rhs) const override
+    // Evaluates the arguments of aggregate functions for root, so that
+    // copies of the stack, used on other threads, share them
+    void prepare(const Json& root, filter_stack<Json>& stack) const
     {
-        bool result = false;
-        if (nodes_.size() > 0)
+        reset(root, stack);
+        for (size_t i = 0; i < paths_.size(); ++i)
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
+            if (paths_[i]->from_root() && !stack.root_values_[i])
             {
-                result = jsoncons::jsonpath::detail::ampamp(nodes_[i],rhs);
+                stack.root_values_[i] = std::make_shared<const Json>(paths_[i]->evaluate(root));
             }
         }
-        return result;
     }
-    bool pipepipe_term(const term<Json>& rhs) const override
+private:
+    void reset(const Json& root, filter_stack<Json>& stack) const
     {
-        bool result = false;
-        if (nodes_.size() > 0)
+        if (stack.values_.size() < stack_size_)
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
-            {
-                result = rhs.pipepipe(nodes_[i]);
-            }
+            stack.values_.resize(stack_size_);
         }
-        return result;
-    }
-    bool pipepipe(const Json& rhs) const override
-    {
-        bool result = false;
-        if (nodes_.size() > 0)
+        if (stack.expr_ != this || stack.root_ != std::addressof(root))
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
-            {
-                result = jsoncons::jsonpath::detail::pipepipe(nodes_[i],rhs);
-            }
+            stack.expr_ = this;
+            stack.root_ = std::addressof(root);
+            stack.root_values_.clear();
+            stack.root_values_.resize(paths_.size());
         }
-        return result;
     }
 
-    bool lt(const Json& rhs) const override
+    const value_type& execute(const Json& context_node, const Json& root, filter_stack<Json>& stack) const
     {
-        bool result = false;
-        if (nodes_.size() > 0)
+        if (!valid_)
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
-            {
-                result = jsoncons::jsonpath::detail::lt(nodes_[i],rhs);
-            }
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Invalid state"));
         }
-        return result;
-    }
+        reset(root, stack);
 
-    bool lt_term(const term<Json>& rhs) const override
-    {
-        bool result = false;
-        if (nodes_.size() > 0)
+        std::vector<value_type>& values = stack.values_;
+        size_t top = 0;
+        for (const auto& instruction : code_)
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
+            switch (instruction.opcode)
             {
-                result = rhs.gt(nodes_[i]);
+            case filter_opcode::push_value:
+                values[top++].assign(std::addressof(values_[instruction.index]));
+                break;
+            case filter_opcode::push_path:
+            {
+                value_type& val = values[top++];
+                const filter_path<Json>& path = *paths_[instruction.index];
+                if (path.from_root())
+                {
+                    std::shared_ptr<const Json>& root_value = stack.root_values_[instruction.index];
+                    if (!root_value)
+                    {
+                        root_value = std::make_shared<const Json>(path.evaluate(root));
+                    }
+                    val.assign(root_value.get());
+                }
+                else
+                {
+                    val.kind = filter_value_kind::node_set;
+                    path.select(context_node, val.nodes, val.temp, val.temps);
+                }
+                break;
+            }
+            case filter_opcode::push_regex:
+            {
+                value_type& val = values[top++];
+                val.kind = filter_value_kind::regex;
+                val.regex = regexes_[instruction.index].get();
+                break;
+            }
+            case filter_opcode::exclaim:
+            {
+                value_type& a = values[top-1];
+                a.assign(Json(exclaim(a)));
+                break;
+            }
+            case filter_opcode::unary_minus:
+            {
+                value_type& a = values[top-1];
+                a.assign(unary_minus(a));
+                break;
+            }
+            case filter_opcode::function:
+            {
+                value_type& a = values[top-1];
+                const function_type& f = functions_[instruction.index];
+                a.assign(a.kind == filter_value_kind::value ? f(*a.value) : f(evaluate_single_node(a)));
+                break;
+            }
+            default:
+            {
+                const value_type& b = values[--top];
+                value_type& a = values[top-1];
+                a.assign(binary_operator(instruction.opcode, a, b));
+                break;
+            }
             }
         }
-        return result;
+        return values[0];
     }
 
-    bool gt(const Json& rhs) const override
+    static Json binary_operator(filter_opcode opcode, const value_type& a, const value_type& b)
     {
-        bool result = false;
-        if (nodes_.size() > 0)
+        switch (opcode)
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
-            {
-                result = jsoncons::jsonpath::detail::gt(nodes_[i],rhs);
-            }
+        case filter_opcode::regex:
+            return Json(regex_term(a, b));
+        case filter_opcode::mult:
+            return arithmetic(a, b, jsoncons::jsonpath::detail::mult<Json>);
+        case filter_opcode::div:
+            return arithmetic(a, b, jsoncons::jsonpath::detail::div<Json>);
+        case filter_opcode::plus:
+            return arithmetic(a, b, jsoncons::jsonpath::detail::plus<Json>);
+        case filter_opcode::minus:
+            return arithmetic(a, b, jsoncons::jsonpath::detail::minus<Json>);
+        case filter_opcode::lt:
+            return Json(all_of(a, b, lt));
+        case filter_opcode::lte:
+            return Json(all_of(a, b, lt) || all_of(a, b, eq));
+        case filter_opcode::gt:
+            return Json(all_of(a, b, gt));
+        case filter_opcode::gte:
+            return Json(all_of(a, b, gt) || all_of(a, b, eq));
+        case filter_opcode::eq:
+            return Json(all_of(a, b, eq));
+        case filter_opcode::ne:
+            return Json(all_of(a, b, ne));
+        case filter_opcode::ampamp:
+            return Json(all_of(a, b, ampamp));
+        case filter_opcode::pipepipe:
+            return Json(all_of(a, b, pipepipe));
+        default:
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Invalid state"));
         }
-        return result;
     }
 
-    bool gt_term(const term<Json>& rhs) const override
+    // Two doubles, the usual case for a comparison with a number, are 
+    // compared without going through the general rules
+    static bool lt(const Json& lhs, const Json& rhs)
     {
-        bool result = false;
-        if (nodes_.size() > 0)
+        if (lhs.is_double() && rhs.is_double())
         {
-            result = true;
-            for (size_t i = 0; result && i < nodes_.size(); ++i)
-            {
-                result = rhs.lt(nodes_[i]);
-            }
+            return lhs.as_double() < rhs.as_double();
         }
-        return result;
+        return jsoncons::jsonpath::detail::lt(lhs,rhs);
     }
 
-    Json minus_term(const term<Json>& rhs) const override
+    static bool gt(const Json& lhs, const Json& rhs)
     {
-        static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? rhs.left_minus(nodes_[0]) : a_null;
-    }
-    Json minus(const Json& rhs) const override
-    {
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::minus(nodes_[0],rhs) : Json(jsoncons::null_type());
+        return lt(rhs,lhs);
     }
 
-    Json left_minus(const Json& lhs) const override
+    static bool eq(const Json& lhs, const Json& rhs)
     {
-        static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::minus(lhs,nodes_[0]) : a_null;
+        return lhs == rhs;
     }
 
-    Json unary_minus() const override
+    static bool ne(const Json& lhs, const Json& rhs)
     {
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::unary_minus(nodes_[0]) : Json::null();
+        return lhs != rhs;
     }
 
-    Json plus_term(const term<Json>& rhs) const override
-    {
-        static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? rhs.plus(nodes_[0]) : a_null;
-    }
-    Json plus(const Json& rhs) const override
+    // The right operand of && and || is tested first
+    static bool ampamp(const Json& lhs, const Json& rhs)
     {
-        static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::plus(nodes_[0],rhs) : a_null;
+        return jsoncons::jsonpath::detail::ampamp(rhs,lhs);
     }
 
-    Json mult_term(const term<Json>& rhs) const override
+    static bool pipepipe(const Json& lhs, const Json& rhs)
     {
-        static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? rhs.mult(nodes_[0]) : a_null;
-    }
-    Json mult(const Json& rhs) const override
-    {
-        static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::mult(nodes_[0],rhs) : a_null;
+        return jsoncons::jsonpath::detail::pipepipe(rhs,lhs);
     }
 
-    Json div_term(const term<Json>& rhs) const override
+    // A comparison with a node set holds if the node set is not empty and 
+    // the comparison holds for each of its nodes
+    template <class Compare>
+    static bool all_of(const value_type& a, const value_type& b, Compare compare)
     {
-        static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? rhs.left_div(nodes_[0]) : a_null;
+        switch (a.kind)
+        {
+        case filter_value_kind::value:
+            return all_of(*a.value, b, compare);
+        case filter_value_kind::node_set:
+            if (a.nodes.empty())
+            {
+                return false;
+            }
+            for (const Json* node : a.nodes)
+            {
+                if (!all_of(*node, b, compare))
+                {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
+        }
     }
-    Json div(const Json& rhs) const override
+
+    template <class Compare>
+    static bool all_of(const Json& lhs, const value_type& b, Compare compare)
     {
-        static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::div(nodes_[0],rhs) : a_null;
+        switch (b.kind)
+        {
+        case filter_value_kind::value:
+            return compare(lhs, *b.value);
+        case filter_value_kind::node_set:
+            if (b.nodes.empty())
+            {
+                return false;
+            }
+            for (const Json* node : b.nodes)
+            {
+                if (!compare(lhs, *node))
+                {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
+        }
     }
 
-    Json left_div(const Json& lhs) const override
+    static bool regex_term(const value_type& a, const value_type& b)
     {
-        static auto a_null = Json(jsoncons::null_type());
-        return nodes_.size() == 1 ? jsoncons::jsonpath::detail::div(lhs, nodes_[0]) : a_null;
+        switch (a.kind)
+        {
+        case filter_value_kind::value:
+            return regex_match(*a.value, b);
+        case filter_value_kind::node_set:
+            if (a.nodes.empty())
+            {
+                return false;
+            }
+            for (const Json* node : a.nodes)
+            {
+                if (!regex_match(*node, b))
+                {
+                    return false;
+                }
+            }
+            return true;
+        default:
+            throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
+        }
     }
-};
 
-template <class Json>
-token<Json> evaluate(const Json& context, std::vector<token<Json>>& tokens)
-{
-    for (auto it= tokens.begin(); it != tokens.end(); ++it)
+    static bool regex_match(const Json& subject, const value_type& b)
     {
-        it->initialize(context);
+        if (b.kind != filter_value_kind::regex)
+        {
+            throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
+        }
+        if (subject.is_string())
+        {
+            auto sv = subject.as_string_view();
+            return std::regex_match(sv.data(), sv.data() + sv.length(), *b.regex);
+        }
+        return std::regex_match(subject.as_string(), *b.regex);
     }
-    std::vector<token<Json>> stack;
-    for (auto t : tokens)
+
+    // Arithmetic needs a single value on each side, otherwise the result is null
+    static Json arithmetic(const value_type& a, const value_type& b, Json (*op)(const Json&, const Json&))
     {
-        if (t.is_operand())
+        const Json* lhs = single_value(a);
+        if (lhs == nullptr)
         {
-            stack.push_back(t);
+            return Json::null();
         }
-        else if (t.is_unary_operator())
+        const Json* rhs = single_value(b);
+        if (rhs == nullptr)
         {
-            auto rhs = stack.back();
-            stack.pop_back();
-            Json val = t(rhs.operand());
-            stack.push_back(token<Json>(token_type::operand,std::make_shared<value_term<Json>>(val)));
+            return Json::null();
         }
-        else if (t.is_binary_operator())
+        return op(*lhs, *rhs);
+    }
+
+    static const Json* single_value(const value_type& a)
+    {
+        switch (a.kind)
         {
-            auto rhs = stack.back();
-            stack.pop_back();
-            auto lhs = stack.back();
-            stack.pop_back();
-            Json val = t(lhs.operand(), rhs.operand());
-            stack.push_back(token<Json>(token_type::operand,std::make_shared<value_term<Json>>(val)));
+        case filter_value_kind::value:
+            return a.value;
+        case filter_value_kind::node_set:
+            return a.nodes.size() == 1 ? a.nodes[0] : nullptr;
+        default:
+            throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
         }
     }
-    if (stack.size() != 1)
+
+    static bool exclaim(const value_type& a)
     {
-        JSONCONS_THROW(json_exception_impl<std::runtime_error>("Invalid state"));
+        switch (a.kind)
+        {
+        case filter_value_kind::value:
+            return !a.value->as_bool();
+        case filter_value_kind::node_set:
+            return a.nodes.empty();
+        default:
+            throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
+        }
     }
 
-    return stack.back();
-}
-
-template <class Json>
-class jsonpath_filter_expr
-{
-public:
-    std::vector<token<Json>> tokens_;
-    size_t line_;
-    size_t column_;
-public:
-
-    jsonpath_filter_expr(const std::vector<token<Json>>& tokens, size_t line, size_t column)
-        : tokens_(tokens), line_(line), column_(column)
+    static Json unary_minus(const value_type& a)
     {
+        const Json* val = single_value(a);
+        return val != nullptr ? jsoncons::jsonpath::detail::unary_minus(*val) : Json::null();
     }
 
-    Json eval(const Json& context_node)
+    static bool accept_single_node(const value_type& a)
     {
-        try
+        switch (a.kind)
         {
-            auto t = evaluate(context_node,tokens_);
-
-            return t.operand().evaluate_single_node();
-
-        }
-        catch (const parse_error& e)
-        {
-            throw parse_error(e.code(),line_,column_);
+        case filter_value_kind::value:
+            return a.value->as_bool();
+        case filter_value_kind::node_set:
+            return !a.nodes.empty();
+        default:
+            throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
         }
     }
 
-    bool exists(const Json& context_node)
+    static Json evaluate_single_node(const value_type& a)
     {
-        try
-        {
-            auto t = evaluate(context_node,tokens_);
-            return t.operand().accept_single_node();
-        }
-        catch (const parse_error& e)
+        switch (a.kind)
         {
-            throw parse_error(e.code(),line_,column_);
+        case filter_value_kind::value:
+            return *a.value;
+        case filter_value_kind::node_set:
+            if (a.nodes.size() == 1)
+            {
+                return *a.nodes[0];
+            }
+            else
+            {
+                Json result = typename Json::array();
+                result.reserve(a.nodes.size());
+                for (const Json* node : a.nodes)
+                {
+                    result.push_back(*node);
+                }
+                return result;
+            }
+        default:
+            throw parse_error(jsonpath_parser_errc::invalid_filter_unsupported_operator,1,1);
         }
     }
 };
@@ -1061,8 +1047,6 @@ class jsonpath_filter_parser
     size_t line_;
     size_t column_;
 
-    static const operator_properties<Json> op_properties_[];
-
     class function_table
     {
         typedef std::map<string_type,function_properties<Json>> function_dictionary;
@@ -1070,10 +1054,8 @@ class jsonpath_filter_parser
         const function_dictionary functions_ =
         {
             {
-                max_literal<char_type>(),{1,true,true,[](const term<Json>& term)
+                max_literal<char_type>(),{1,true,true,[](const Json& a)
                       {
-                          Json a = term.evaluate_single_node();
-
                           double v = std::numeric_limits<double>::lowest();
                           for (const auto& elem : a.array_range())
                           {
@@ -1088,10 +1070,8 @@ class jsonpath_filter_parser
                 }
             },
             {
-                min_literal<char_type>(),{1,true,true,[](const term<Json>& term) 
+                min_literal<char_type>(),{1,true,true,[](const Json& a) 
                       {
-                          Json a = term.evaluate_single_node();
-
                           double v = (std::numeric_limits<double>::max)(); 
                           for (const auto& elem : a.array_range())
                           {
@@ -1121,23 +1101,23 @@ class jsonpath_filter_parser
 
     class binary_operator_table
     {
-        typedef std::map<string_type,operator_properties<Json>> binary_operator_map;
+        typedef std::map<string_type,operator_properties> binary_operator_map;
 
         const binary_operator_map operators =
         {
-            {eqtilde_literal<char_type>(),{2,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.regex_term(b)); }}},
-            {star_literal<char_type>(),{3,false,[](const term<Json>& a, const term<Json>& b) {return a.mult_term(b); }}},
-            {forwardslash_literal<char_type>(),{3,false,[](const term<Json>& a, const term<Json>& b) {return a.div_term(b); }}},
-            {plus_literal<char_type>(),{4,false,[](const term<Json>& a, const term<Json>& b) {return a.plus_term(b); }}},
-            {minus_literal<char_type>(),{4,false,[](const term<Json>& a, const term<Json>& b) {return a.minus_term(b); }}},
-            {lt_literal<char_type>(),{5,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.lt_term(b)); }}},
-            {lte_literal<char_type>(),{5,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.lt_term(b) || a.eq_term(b)); }}},
-            {gt_literal<char_type>(),{5,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.gt_term(b)); }}},
-            {gte_literal<char_type>(),{5,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.gt_term(b) || a.eq_term(b)); }}},
-            {eq_literal<char_type>(),{6,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.eq_term(b)); }}},
-            {ne_literal<char_type>(),{6,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.ne_term(b)); }}},
-            {ampamp_literal<char_type>(),{7,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.ampamp_term(b)); }}},
-            {pipepipe_literal<char_type>(),{8,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.pipepipe_term(b)); }}}
+            {eqtilde_literal<char_type>(),{2,false,filter_opcode::regex}},
+            {star_literal<char_type>(),{3,false,filter_opcode::mult}},
+            {forwardslash_literal<char_type>(),{3,false,filter_opcode::div}},
+            {plus_literal<char_type>(),{4,false,filter_opcode::plus}},
+            {minus_literal<char_type>(),{4,false,filter_opcode::minus}},
+            {lt_literal<char_type>(),{5,false,filter_opcode::lt}},
+            {lte_literal<char_type>(),{5,false,filter_opcode::lte}},
+            {gt_literal<char_type>(),{5,false,filter_opcode::gt}},
+            {gte_literal<char_type>(),{5,false,filter_opcode::gte}},
+            {eq_literal<char_type>(),{6,false,filter_opcode::eq}},
+            {ne_literal<char_type>(),{6,false,filter_opcode::ne}},
+            {ampamp_literal<char_type>(),{7,false,filter_opcode::ampamp}},
+            {pipepipe_literal<char_type>(),{8,false,filter_opcode::pipepipe}}
         };
 
     public:
@@ -1174,9 +1154,9 @@ public:
         return column_;
     }
 
-    jsonpath_filter_expr<Json> parse(const Json& root, const char_type* p, size_t length, const char_type** end_ptr)
+    jsonpath_filter_expr<Json> parse(const char_type* p, size_t length, const char_type** end_ptr)
     {
-        return parse(root, p,p+length, end_ptr);
+        return parse(p,p+length, end_ptr);
     }
 
     void push_state(filter_state state)
@@ -1248,7 +1228,19 @@ public:
         }
     }
 
-    jsonpath_filter_expr<Json> parse(const Json& root, const char_type* p, const char_type* end_expr, const char_type** end_ptr)
+    std::shared_ptr<const filter_path<Json>> make_path(const string_type& path, bool from_root) const
+    {
+        try
+        {
+            return std::make_shared<filter_path<Json>>(path, from_root);
+        }
+        catch (const parse_error& e)
+        {
+            throw parse_error(e.code(),line_,column_);
+        }
+    }
+
+    jsonpath_filter_expr<Json> parse(const char_type* p, const char_type* end_expr, const char_type** end_ptr)
     {
         output_stack_.clear();
         operator_stack_.clear();
@@ -1327,25 +1319,8 @@ public:
                     case ')':
                         if (buffer.length() > 0)
                         {
-                            if (operator_stack_.back().is_aggregate())
-                            {
-                                try
-                                {
-                                    // path, parse against root, get value
-                                    jsonpath_evaluator<Json,const Json&,detail::VoidPathConstructor<Json>> evaluator;
-                                    evaluator.evaluate(root,buffer.data(),buffer.length());
-                                    auto result = evaluator.get_values();
-                                    add_token(token<Json>(token_type::operand,std::make_shared<value_term<Json>>(result)));
-                                }
-                                catch (const parse_error& e)
-                                {
-                                    throw parse_error(e.code(),line_,column_);
-                                }
-                            }
-                            else
-                            {
-                                add_token(token<Json>(token_type::operand,std::make_shared<path_term<Json>>(buffer)));
-                            }
+                            // The argument of an aggregate function is evaluated against the root
+                            add_token(token<Json>(make_path(buffer,operator_stack_.back().is_aggregate())));
                             buffer.clear();
                             state = filter_state::expect_oper_or_right_round_bracket;
                         }
@@ -1417,7 +1392,7 @@ public:
                             try
                             {
                                 auto val = Json::parse(buffer);
-                                add_token(token<Json>(token_type::operand,std::make_shared<value_term<Json>>(val)));
+                                add_token(token<Json>(val));
                             }
                             catch (const parse_error& e)
                             {
@@ -1458,7 +1433,7 @@ public:
                                 try
                                 {
                                     auto val = Json::parse(buffer);
-                                    add_token(token<Json>(token_type::operand,std::make_shared<value_term<Json>>(val)));
+                                    add_token(token<Json>(val));
                                 }
                                 catch (const parse_error& e)
                                 {
@@ -1478,7 +1453,7 @@ public:
                             try
                             {
                                 auto val = Json::parse(buffer);
-                                add_token(token<Json>(token_type::operand,std::make_shared<value_term<Json>>(val)));
+                                add_token(token<Json>(val));
                             }
                             catch (const parse_error& e)
                             {
@@ -1526,7 +1501,7 @@ public:
                             try
                             {
                                 auto val = Json::parse(buffer);
-                                add_token(token<Json>(token_type::operand,std::make_shared<value_term<Json>>(val)));
+                                add_token(token<Json>(val));
                             }
                             catch (const parse_error& e)
                             {
@@ -1565,7 +1540,7 @@ public:
                             try
                             {
                                 auto val = Json::parse(buffer);
-                                add_token(token<Json>(token_type::operand,std::make_shared<value_term<Json>>(val)));
+                                add_token(token<Json>(val));
                             }
                             catch (const parse_error& e)
                             {
@@ -1603,16 +1578,14 @@ public:
                     break;
                 case '!':
                 {
-                    std::function<Json(const term<Json>&)> f = [](const term<Json>& b) {return Json(b.exclaim());};
-                    add_token(token<Json>(1, true, f));
+                    add_token(token<Json>(1, true, filter_opcode::exclaim));
                     ++p;
                     ++column_;
                     break;
                 }
                 case '-':
                 {
-                    std::function<Json(const term<Json>&)> f = [](const term<Json>& b) {return b.unary_minus();};
-                    add_token(token<Json>(1, true, f));
+                    add_token(token<Json>(1, true, filter_opcode::unary_minus));
                     ++p;
                     ++column_;
                     break;
@@ -1750,7 +1723,7 @@ public:
                     {
                         if (buffer.length() > 0)
                         {
-                            add_token(token<Json>(token_type::operand,std::make_shared<path_term<Json>>(buffer)));
+                            add_token(token<Json>(make_path(buffer,false)));
                             buffer.clear();
                         }
                         buffer.push_back(*p);
@@ -1762,7 +1735,7 @@ public:
                 case ')':
                     if (buffer.length() > 0)
                     {
-                        add_token(token<Json>(token_type::operand,std::make_shared<path_term<Json>>(buffer)));
+                        add_token(token<Json>(make_path(buffer,false)));
                         add_token(token<Json>(token_type::rparen));
                         buffer.clear();
                     }
@@ -1821,7 +1794,7 @@ public:
                                 ++column_;
                                 flags |= std::regex_constants::icase;
                             }
-                            add_token(token<Json>(token_type::operand,std::make_shared<regex_term<Json>>(buffer,flags)));
+                            add_token(token<Json>(std::make_shared<const std::basic_regex<char_type>>(buffer,flags)));
                             buffer.clear();
                         }
                         state = filter_state::expect_path_or_value_or_unary_op;
@@ -1851,24 +1824,6 @@ public:
     }
 };
 
-template <class Json>
-const operator_properties<Json> jsonpath_filter_parser<Json>::op_properties_[] =
-{
-    {2,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.regex_term(b));}},
-    {3,false,[](const term<Json>& a, const term<Json>& b) {return a.mult_term(b);}},
-    {3,false,[](const term<Json>& a, const term<Json>& b) {return a.div_term(b);}},
-    {4,false,[](const term<Json>& a, const term<Json>& b) {return a.plus_term(b);}},
-    {4,false,[](const term<Json>& a, const term<Json>& b) {return a.minus_term(b);}},
-    {5,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.lt_term(b));}},
-    {5,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.lt_term(b) || a.eq_term(b));}},
-    {5,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.gt_term(b));}},
-    {5,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.gt_term(b) || a.eq_term(b));}},
-    {6,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.eq_term(b)); }},
-    {6,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.ne_term(b)); }},
-    {7,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.ampamp_term(b));}},
-    {8,false,[](const term<Json>& a, const term<Json>& b) {return Json(a.pipepipe_term(b));}}
-};
-
 }}}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,396 @@
+// Copyright 2013 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_JSONPATH_JSONPATH_MULTI_QUERY_HPP
+#define JSONCONS_JSONPATH_JSONPATH_MULTI_QUERY_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <jsoncons/json.hpp>
+#include "json_query.hpp"
+#include "jsonpath_stream_selector.hpp"
+
+namespace jsoncons { namespace jsonpath {
+
+// jsonpath_multi_query evaluates a set of JSONPath expressions in one pass
+// over a value. The steps of the expressions that select by name, index,
+// wildcard, slice or recursive descent are merged into a tree, so that
+// expressions that begin with the same steps share them. The pass keeps,
+// at each node, the steps of the tree that have been matched there and the
+// recursive steps still to be matched below it, and does not go into nodes
+// that no step can select. The rest of an expression, from a filter or
+// another step that needs the node itself, is evaluated on each node that
+// the steps before it select.
+
+template <class Json>
+class jsonpath_multi_query
+{
+public:
+    typedef typename Json::char_type char_type;
+    typedef typename Json::string_view_type string_view_type;
+    typedef std::function<void(size_t,const Json&)> value_function;
+private:
+    typedef detail::stream_step<Json> step_type;
+    typedef detail::stream_path<Json> path_type;
+
+    // A step of the tree, and the expressions that end at it
+    struct tree_node
+    {
+        tree_node()
+            : step(0)
+        {
+        }
+
+        explicit tree_node(const step_type& step)
+            : step(step)
+        {
+        }
+
+        step_type step;
+        std::vector<size_t> children;
+        std::vector<size_t> queries;
+        // For a step that selects characters from a string, the
+        // expressions that go through it, and the paths from it on
+        std::vector<std::pair<size_t,const jsonpath_expression<Json>*>> string_queries;
+    };
+
+    std::vector<std::unique_ptr<path_type>> paths_;
+    std::vector<tree_node> nodes_;
+public:
+    jsonpath_multi_query()
+        : nodes_(1)
+    {
+    }
+
+    jsonpath_multi_query(const jsonpath_multi_query&) = delete;
+    jsonpath_multi_query(jsonpath_multi_query&&) = default;
+    jsonpath_multi_query& operator=(const jsonpath_multi_query&) = delete;
+    jsonpath_multi_query& operator=(jsonpath_multi_query&&) = default;
+
+    // Compiles path and adds it to the set. Returns the id that its values
+    // are reported with, the number of paths added before it. Throws a
+    // parse_error if path is not a valid JSONPath expression.
+    size_t add(const string_view_type& path)
+    {
+        std::unique_ptr<path_type> compiled(new path_type(path_type::compile(path)));
+        size_t id = paths_.size();
+
+        size_t current = 0;
+        for (const auto& step : compiled->steps)
+        {
+            size_t next = 0;
+            for (size_t child : nodes_[current].children)
+            {
+                if (same_step(nodes_[child].step, step))
+                {
+                    next = child;
+                    break;
+                }
+            }
+            if (next == 0)
+            {
+                next = nodes_.size();
+                nodes_.emplace_back(step);
+                nodes_[current].children.push_back(next);
+            }
+            if (step.selects_from_strings)
+            {
+                size_t k = static_cast<size_t>(&step - compiled->steps.data());
+                nodes_[next].string_queries.emplace_back(id, std::addressof(compiled->from_step[k]));
+            }
+            current = next;
+        }
+        nodes_[current].queries.push_back(id);
+        paths_.push_back(std::move(compiled));
+        return id;
+    }
+
+    size_t size() const
+    {
+        return paths_.size();
+    }
+
+    // Passes each value that a path selects from root to f, with the id of
+    // the path. The values of a path are passed in the order that they are
+    // found in root, and each one once.
+    void evaluate(const Json& root, value_function f) const
+    {
+        std::vector<size_t> matched(1, 0);
+        std::vector<size_t> carried;
+        visit(root, root, matched, carried, f);
+    }
+
+    // Returns an array of the values that each path selects from root
+    std::vector<Json> evaluate(const Json& root) const
+    {
+        std::vector<Json> results(paths_.size(), Json(typename Json::array()));
+        evaluate(root, [&results](size_t id, const Json& val){results[id].push_back(val);});
+        return results;
+    }
+private:
+    static bool same_selector(const detail::stream_selector<Json>& a, const detail::stream_selector<Json>& b)
+    {
+        return a.kind == b.kind && a.name == b.name && a.has_index == b.has_index && a.start == b.start
+            && a.end == b.end && a.undefined_end == b.undefined_end && a.step == b.step;
+    }
+
+    static bool same_step(const step_type& a, const step_type& b)
+    {
+        if (a.recursive_descent != b.recursive_descent || a.selectors.size() != b.selectors.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.selectors.size(); ++i)
+        {
+            if (!same_selector(a.selectors[i], b.selectors[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void add_node(std::vector<size_t>& nodes, size_t node)
+    {
+        if (std::find(nodes.begin(), nodes.end(), node) == nodes.end())
+        {
+            nodes.push_back(node);
+        }
+    }
+
+    // True if the step selects by name or index only, so the children
+    // it selects can be looked up
+    static bool is_lookup(const step_type& step)
+    {
+        if (step.recursive_descent)
+        {
+            return false;
+        }
+        for (const auto& selector : step.selectors)
+        {
+            if (selector.kind != detail::stream_selector_kind::name)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // matched holds the steps of the tree that select val, carried the
+    // recursive steps to be matched against val and its descendants
+    void visit(const Json& root, const Json& val,
+               const std::vector<size_t>& matched, const std::vector<size_t>& carried,
+               value_function& f) const
+    {
+        for (size_t node : matched)
+        {
+            for (size_t id : nodes_[node].queries)
+            {
+                report(root, val, id, f);
+            }
+        }
+
+        if (val.is_string())
+        {
+            std::vector<const Json*> values;
+            std::vector<std::shared_ptr<Json>> temps;
+            for (size_t node : matched)
+            {
+                for (size_t child : nodes_[node].children)
+                {
+                    for (const auto& query : nodes_[child].string_queries)
+                    {
+                        values.clear();
+                        query.second->select_pointers(val, values, temps);
+                        for (auto p : values)
+                        {
+                            f(query.first, *p);
+                        }
+                    }
+                }
+            }
+            return;
+        }
+        if (!val.is_object() && !val.is_array())
+        {
+            return;
+        }
+
+        std::vector<size_t> pending(carried);
+        bool lookup = carried.empty();
+        for (size_t node : matched)
+        {
+            for (size_t child : nodes_[node].children)
+            {
+                add_node(pending, child);
+                if (!is_lookup(nodes_[child].step))
+                {
+                    lookup = false;
+                }
+            }
+        }
+        if (pending.empty())
+        {
+            return;
+        }
+
+        if (lookup)
+        {
+            visit_selected(root, val, pending, f);
+        }
+        else if (val.is_object())
+        {
+            std::vector<size_t> next_matched;
+            std::vector<size_t> next_carried;
+            for (const auto& member : val.object_range())
+            {
+                next_matched.clear();
+                next_carried.clear();
+                string_view_type key(member.key().data(), member.key().length());
+                for (size_t node : pending)
+                {
+                    const step_type& step = nodes_[node].step;
+                    if (step.recursive_descent)
+                    {
+                        next_carried.push_back(node);
+                    }
+                    if (step.select_member(key))
+                    {
+                        next_matched.push_back(node);
+                    }
+                }
+                if (!next_matched.empty() || !next_carried.empty())
+                {
+                    visit(root, member.value(), next_matched, next_carried, f);
+                }
+            }
+        }
+        else
+        {
+            std::vector<size_t> next_matched;
+            std::vector<size_t> next_carried;
+            for (size_t i = 0; i < val.size(); ++i)
+            {
+                next_matched.clear();
+                next_carried.clear();
+                for (size_t node : pending)
+                {
+                    const step_type& step = nodes_[node].step;
+                    if (step.recursive_descent)
+                    {
+                        next_carried.push_back(node);
+                    }
+                    if (step.select_element(i))
+                    {
+                        next_matched.push_back(node);
+                    }
+                }
+                if (!next_matched.empty() || !next_carried.empty())
+                {
+                    visit(root, val[i], next_matched, next_carried, f);
+                }
+            }
+        }
+    }
+
+    // Visits the children that the pending steps select by name or index,
+    // in the order that they are in val
+    void visit_selected(const Json& root, const Json& val, const std::vector<size_t>& pending,
+                        value_function& f) const
+    {
+        std::vector<std::pair<const Json*,size_t>> selected;
+        for (size_t node : pending)
+        {
+            for (const auto& selector : nodes_[node].step.selectors)
+            {
+                const Json* child = nullptr;
+                if (val.is_object())
+                {
+                    auto it = val.find(selector.name);
+                    if (it != val.object_range().end())
+                    {
+                        child = std::addressof(it->value());
+                    }
+                }
+                else if (selector.has_index && selector.start < val.size())
+                {
+                    child = std::addressof(val[selector.start]);
+                }
+                if (child != nullptr)
+                {
+                    selected.emplace_back(child, node);
+                }
+            }
+        }
+        std::stable_sort(selected.begin(), selected.end(),
+                         [](const std::pair<const Json*,size_t>& a, const std::pair<const Json*,size_t>& b){return a.first < b.first;});
+
+        std::vector<size_t> next_matched;
+        const std::vector<size_t> next_carried;
+        for (size_t i = 0; i < selected.size(); )
+        {
+            const Json* child = selected[i].first;
+            next_matched.clear();
+            for (; i < selected.size() && selected[i].first == child; ++i)
+            {
+                add_node(next_matched, selected[i].second);
+            }
+            visit(root, *child, next_matched, next_carried, f);
+        }
+    }
+
+    void report(const Json& root, const Json& val, size_t id, value_function& f) const
+    {
+        const path_type& path = *paths_[id];
+        if (!path.has_rest)
+        {
+            f(id, val);
+            return;
+        }
+
+        std::vector<const Json*> values;
+        std::vector<std::shared_ptr<Json>> temps;
+        if (path.filter && val.is_array())
+        {
+            detail::filter_stack<Json> stack;
+            for (const auto& elem : val.array_range())
+            {
+                if (path.filter->exists(elem, root, stack))
+                {
+                    if (path.has_after_filter)
+                    {
+                        values.clear();
+                        path.after_filter.select_pointers(elem, values, temps);
+                        for (auto p : values)
+                        {
+                            f(id, *p);
+                        }
+                    }
+                    else
+                    {
+                        f(id, elem);
+                    }
+                }
+            }
+        }
+        else
+        {
+            path.rest.select_pointers(val, values, temps);
+            for (auto p : values)
+            {
+                f(id, *p);
+            }
+        }
+    }
+};
+
+}}
+
+#endif
@@ -0,0 +1,162 @@
+// Copyright 2013 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_JSONPATH_JSONPATH_PARALLEL_EVALUATOR_HPP
+#define JSONCONS_JSONPATH_JSONPATH_PARALLEL_EVALUATOR_HPP
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <jsoncons/json.hpp>
+#include "json_query.hpp"
+
+namespace jsoncons { namespace jsonpath {
+
+namespace detail {
+
+// Runs the chunks of a loop on up to num_threads threads, the calling thread
+// among them. Each thread takes the next chunk not yet taken when it is done
+// with one, so that a thread given chunks that select little goes on to
+// others.
+class thread_chunk_runner : public chunk_runner
+{
+    size_t num_threads_;
+    size_t min_size_;
+public:
+    // A loop is split into this many chunks for each thread
+    static const size_t chunks_per_thread = 4;
+
+    thread_chunk_runner(size_t num_threads, size_t min_size)
+        : num_threads_(num_threads), min_size_(min_size)
+    {
+        if (num_threads_ == 0)
+        {
+            num_threads_ = (std::max)(std::thread::hardware_concurrency(), 1u);
+        }
+    }
+
+    size_t chunk_count(size_t size) const override
+    {
+        if (num_threads_ <= 1 || size < (std::max)(min_size_, size_t(2)))
+        {
+            return 1;
+        }
+        return (std::min)(size, num_threads_*chunks_per_thread);
+    }
+
+    void run(size_t count, const std::function<void(size_t)>& task) const override
+    {
+        std::atomic<size_t> next(0);
+        auto work = [&next,count,&task]()
+        {
+            for (size_t i = next++; i < count; i = next++)
+            {
+                task(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        size_t num_threads = (std::min)(num_threads_, count);
+        for (size_t i = 1; i < num_threads; ++i)
+        {
+            threads.emplace_back(work);
+        }
+        work();
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+};
+
+}
+
+// jsonpath_parallel_evaluator evaluates a compiled JSONPath expression with
+// the loops over large arrays, and over large sets of selected nodes, split
+// into chunks that are evaluated at once on several threads. The chunks are
+// put back together in order, so the values and paths are the same, in the
+// same order, as those of jsonpath_expression.
+
+template <class Json,class JsonReference=const Json&>
+class jsonpath_parallel_evaluator
+{
+public:
+    typedef typename Json::char_type char_type;
+    typedef typename Json::string_view_type string_view_type;
+    typedef JsonReference reference;
+private:
+    typedef detail::path_selection<Json,JsonReference> selection_type;
+    typedef detail::path_node<Json,JsonReference> node_type;
+    typedef std::vector<node_type> node_set;
+
+    jsonpath_expression<Json,JsonReference> expr_;
+    size_t num_threads_;
+    size_t min_array_size_;
+public:
+    static const size_t default_min_array_size = 10000;
+
+    // Throws a parse_error if path is not a valid JSONPath expression
+    explicit jsonpath_parallel_evaluator(const string_view_type& path)
+        : expr_(jsonpath_expression<Json,JsonReference>::compile(path)),
+          num_threads_(0),
+          min_array_size_(default_min_array_size)
+    {
+    }
+
+    explicit jsonpath_parallel_evaluator(jsonpath_expression<Json,JsonReference>&& expr)
+        : expr_(std::move(expr)),
+          num_threads_(0),
+          min_array_size_(default_min_array_size)
+    {
+    }
+
+    // The number of threads to evaluate on, by default the number of hardware threads
+    size_t num_threads() const
+    {
+        return num_threads_;
+    }
+
+    void num_threads(size_t value)
+    {
+        num_threads_ = value;
+    }
+
+    // Loops over fewer items than this are not split
+    size_t min_array_size() const
+    {
+        return min_array_size_;
+    }
+
+    void min_array_size(size_t value)
+    {
+        min_array_size_ = value;
+    }
+
+    Json evaluate(reference root, result_type result_t = result_type::value) const
+    {
+        detail::thread_chunk_runner runner(num_threads_, min_array_size_);
+        selection_type selection(root, result_t == result_type::path, &runner);
+        return expr_.evaluate(selection, root, result_t);
+    }
+
+    jsonpath_result_set<Json,JsonReference> select(reference root) const
+    {
+        detail::thread_chunk_runner runner(num_threads_, min_array_size_);
+        selection_type selection(root, true, &runner);
+        node_set nodes = expr_.select(selection, root);
+        selection.runner(nullptr);
+        return jsonpath_result_set<Json,JsonReference>(std::move(selection), std::move(nodes));
+    }
+};
+
+template <class Json,class JsonReference>
+const size_t jsonpath_parallel_evaluator<Json,JsonReference>::default_min_array_size;
+
+}}
+
+#endif
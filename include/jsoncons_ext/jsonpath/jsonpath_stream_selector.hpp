@@ -0,0 +1,1032 @@
+// Copyright 2013 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_JSONPATH_JSONPATH_STREAM_SELECTOR_HPP
+#define JSONCONS_JSONPATH_JSONPATH_STREAM_SELECTOR_HPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons/json_decoder.hpp>
+#include <jsoncons/json_reader.hpp>
+#include <jsoncons/stream_reader.hpp>
+#include "json_query.hpp"
+
+namespace jsoncons { namespace jsonpath {
+
+namespace detail {
+
+enum class stream_selector_kind
+{
+    name,
+    wildcard,
+    slice
+};
+
+// A selector that can be matched against the names and indices that
+// parser events give
+template <class Json>
+struct stream_selector
+{
+    typedef typename Json::string_view_type string_view_type;
+    typedef typename Json::string_type string_type;
+
+    stream_selector(stream_selector_kind kind)
+        : kind(kind), has_index(false), start(0), end(0), undefined_end(true), step(1)
+    {
+    }
+
+    stream_selector_kind kind;
+    string_type name;
+    // A name that is an index also selects the element at that index
+    bool has_index;
+    size_t start;
+    size_t end;
+    bool undefined_end;
+    size_t step;
+
+    bool select_member(const string_view_type& key) const
+    {
+        return kind == stream_selector_kind::wildcard || (kind == stream_selector_kind::name && key == name);
+    }
+
+    bool select_element(size_t index) const
+    {
+        switch (kind)
+        {
+        case stream_selector_kind::wildcard:
+            return true;
+        case stream_selector_kind::name:
+            return has_index && index == start;
+        default:
+            return index >= start && (undefined_end || index < end) && (index - start) % step == 0;
+        }
+    }
+};
+
+template <class Json>
+struct stream_step
+{
+    typedef typename Json::string_view_type string_view_type;
+
+    stream_step(size_t offset)
+        : offset(offset), recursive_descent(false), selects_from_strings(false)
+    {
+    }
+
+    // Where the step begins in the path
+    size_t offset;
+    bool recursive_descent;
+    // True if the step selects characters from a string, as [0] does
+    bool selects_from_strings;
+    std::vector<stream_selector<Json>> selectors;
+
+    bool select_member(const string_view_type& key) const
+    {
+        for (const auto& selector : selectors)
+        {
+            if (selector.select_member(key))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool select_element(size_t index) const
+    {
+        for (const auto& selector : selectors)
+        {
+            if (selector.select_element(index))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// A JSONPath expression compiled for matching parser events. The steps up to
+// the first one that needs more than the names and indices of the nodes, such
+// as a filter, a negative index or length, are matched against the events. The
+// rest of the path is evaluated on each node that those steps select, once the
+// node has been read. A filter that is the first step of the rest is applied
+// to the elements of an array one at a time.
+
+template <class Json>
+class stream_path
+{
+public:
+    typedef typename Json::char_type char_type;
+    typedef typename Json::string_view_type string_view_type;
+    typedef typename Json::string_type string_type;
+
+    std::vector<stream_step<Json>> steps;
+    bool has_rest;
+    jsonpath_expression<Json> rest;
+    std::shared_ptr<const jsonpath_filter_expr<Json>> filter;
+    bool has_after_filter;
+    jsonpath_expression<Json> after_filter;
+    // For each step that selects from strings, the path from that step on
+    std::vector<jsonpath_expression<Json>> from_step;
+
+    stream_path()
+        : has_rest(false), has_after_filter(false)
+    {
+    }
+
+    static stream_path compile(const string_view_type& path)
+    {
+        stream_path result;
+        jsonpath_expression<Json> whole = jsonpath_expression<Json>::compile(path);
+
+        const char_type* begin = path.data();
+        const char_type* end = begin + path.length();
+        const char_type* p = begin;
+
+        size_t rest_offset = 0;
+        size_t after_offset = 0;
+        if (p < end && (*p == '$' || *p == '@'))
+        {
+            ++p;
+            rest_offset = path.length();
+            while (p < end)
+            {
+                stream_step<Json> step(static_cast<size_t>(p - begin));
+                std::shared_ptr<const jsonpath_filter_expr<Json>> filter;
+                if (!parse_step(p, end, step, filter))
+                {
+                    rest_offset = step.offset;
+                    break;
+                }
+                if (filter)
+                {
+                    rest_offset = step.offset;
+                    after_offset = static_cast<size_t>(p - begin);
+                    result.filter = filter;
+                    break;
+                }
+                result.steps.push_back(std::move(step));
+            }
+        }
+
+        std::error_code ec;
+        if (rest_offset == 0)
+        {
+            result.select_whole(whole);
+            return result;
+        }
+        if (rest_offset < path.length())
+        {
+            result.has_rest = true;
+            result.rest = jsonpath_expression<Json>::compile(rest_of(path, rest_offset), ec);
+            if (ec || result.rest.uses_root())
+            {
+                result.select_whole(whole);
+                return result;
+            }
+        }
+        if (result.filter && after_offset < path.length())
+        {
+            result.has_after_filter = true;
+            result.after_filter = jsonpath_expression<Json>::compile(rest_of(path, after_offset), ec);
+            if (ec)
+            {
+                result.select_whole(whole);
+                return result;
+            }
+        }
+        result.from_step.resize(result.steps.size());
+        for (size_t i = 0; i < result.steps.size(); ++i)
+        {
+            if (result.steps[i].selects_from_strings)
+            {
+                result.from_step[i] = jsonpath_expression<Json>::compile(rest_of(path, result.steps[i].offset), ec);
+                if (ec)
+                {
+                    result.select_whole(whole);
+                    return result;
+                }
+            }
+        }
+        return result;
+    }
+private:
+    // Evaluates the whole path on the root, once it has been read
+    void select_whole(const jsonpath_expression<Json>& whole)
+    {
+        steps.clear();
+        filter.reset();
+        has_after_filter = false;
+        from_step.clear();
+        has_rest = true;
+        rest = whole;
+    }
+
+    static string_type rest_of(const string_view_type& path, size_t offset)
+    {
+        string_type s;
+        s.push_back('$');
+        s.append(path.data() + offset, path.length() - offset);
+        return s;
+    }
+
+    static bool is_name_char(char_type c)
+    {
+        typedef typename std::make_unsigned<char_type>::type uchar_type;
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+            || c == '_' || c == '-' || static_cast<uchar_type>(c) >= 0x80;
+    }
+
+    // Returns false if the step cannot be matched against events, or is not
+    // understood here. The path has already been compiled, so the rest of it
+    // is left to the evaluator.
+    static bool parse_step(const char_type*& p, const char_type* end, stream_step<Json>& step,
+                           std::shared_ptr<const jsonpath_filter_expr<Json>>& filter)
+    {
+        if (*p == '.')
+        {
+            ++p;
+            if (p < end && *p == '.')
+            {
+                step.recursive_descent = true;
+                ++p;
+            }
+            if (p == end)
+            {
+                return false;
+            }
+            if (*p == '[')
+            {
+                return step.recursive_descent && parse_brackets(p, end, step, filter);
+            }
+            if (*p == '*')
+            {
+                ++p;
+                step.selectors.emplace_back(stream_selector_kind::wildcard);
+                // The evaluator treats ..* as .*
+                return !step.recursive_descent;
+            }
+            string_type name;
+            while (p < end && is_name_char(*p))
+            {
+                name.push_back(*p++);
+            }
+            if (name.empty() || (p < end && *p != '.' && *p != '['))
+            {
+                return false;
+            }
+            return add_name(step, name);
+        }
+        else if (*p == '[')
+        {
+            return parse_brackets(p, end, step, filter);
+        }
+        return false;
+    }
+
+    static bool parse_brackets(const char_type*& p, const char_type* end, stream_step<Json>& step,
+                               std::shared_ptr<const jsonpath_filter_expr<Json>>& filter)
+    {
+        ++p;
+        while (p < end)
+        {
+            switch (*p)
+            {
+            case '*':
+                if (step.recursive_descent)
+                {
+                    return false;
+                }
+                step.selectors.emplace_back(stream_selector_kind::wildcard);
+                ++p;
+                break;
+            case '\'':
+            case '\"':
+            {
+                char_type quote = *p++;
+                string_type name;
+                while (p < end && *p != quote)
+                {
+                    if (*p == '\\')
+                    {
+                        return false;
+                    }
+                    name.push_back(*p++);
+                }
+                if (p == end || !add_name(step, name))
+                {
+                    return false;
+                }
+                ++p;
+                break;
+            }
+            case '?':
+            {
+                if (step.recursive_descent || !step.selectors.empty())
+                {
+                    return false;
+                }
+                try
+                {
+                    jsonpath_filter_parser<Json> parser;
+                    auto expr = parser.parse(p, end, &p);
+                    if (expr.uses_root() || p == end || *p != ']')
+                    {
+                        return false;
+                    }
+                    ++p;
+                    filter = std::make_shared<jsonpath_filter_expr<Json>>(expr);
+                    return true;
+                }
+                catch (const parse_error&)
+                {
+                    return false;
+                }
+            }
+            default:
+            {
+                string_type text;
+                while (p < end && *p != ',' && *p != ']')
+                {
+                    text.push_back(*p++);
+                }
+                if (!add_index_or_slice(step, text))
+                {
+                    return false;
+                }
+                break;
+            }
+            }
+            if (p == end)
+            {
+                return false;
+            }
+            if (*p == ']')
+            {
+                ++p;
+                return true;
+            }
+            if (*p != ',')
+            {
+                return false;
+            }
+            ++p;
+        }
+        return false;
+    }
+
+    static bool add_name(stream_step<Json>& step, const string_type& name)
+    {
+        if (name.empty() || name == length_literal<Json>())
+        {
+            return false;
+        }
+        stream_selector<Json> selector(stream_selector_kind::name);
+        selector.name = name;
+        size_t index = 0;
+        bool positive = true;
+        if (try_string_to_index(name.data(), name.size(), &index, &positive))
+        {
+            if (!positive)
+            {
+                return false;
+            }
+            selector.has_index = true;
+            selector.start = index;
+            step.selects_from_strings = true;
+        }
+        step.selectors.push_back(std::move(selector));
+        return true;
+    }
+
+    static bool add_index_or_slice(stream_step<Json>& step, const string_type& text)
+    {
+        size_t colon = text.find(':');
+        if (colon == string_type::npos)
+        {
+            for (auto c : text)
+            {
+                if (!is_name_char(c))
+                {
+                    return false;
+                }
+            }
+            return add_name(step, text);
+        }
+
+        string_type parts[3];
+        size_t count = 0;
+        size_t start = 0;
+        for (size_t i = 0; i <= text.size(); ++i)
+        {
+            if (i == text.size() || text[i] == ':')
+            {
+                if (count == 3)
+                {
+                    return false;
+                }
+                parts[count++] = text.substr(start, i - start);
+                start = i + 1;
+            }
+        }
+        size_t values[3] = {0, 0, 1};
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!parts[i].empty())
+            {
+                bool positive = true;
+                if (!try_string_to_index(parts[i].data(), parts[i].size(), &values[i], &positive) || !positive)
+                {
+                    return false;
+                }
+            }
+            else if (i == 2)
+            {
+                // The evaluator reads [a:b:] as a step of 0
+                return false;
+            }
+        }
+        if (values[2] == 0)
+        {
+            return false;
+        }
+        stream_selector<Json> selector(stream_selector_kind::slice);
+        selector.start = values[0];
+        selector.undefined_end = parts[1].empty();
+        selector.end = values[1];
+        selector.step = values[2];
+        step.selectors.push_back(std::move(selector));
+        return true;
+    }
+};
+
+}
+
+// jsonpath_stream_selector is a content handler that selects the values at a
+// JSONPath from the events of a parser, without building the document. It
+// keeps the open containers and the states of the path at each of them, and
+// passes over anything that cannot be selected. Values are written to another
+// content handler as the elements of one array per document, or passed one at
+// a time to a function.
+//
+// A selected value is written to the handler as it is read, unless it comes
+// after a value that has not been completely read, such as a value inside
+// another selected value, when it is read and written later. The elements of
+// an array that a filter is applied to are read one at a time, as is each node
+// that the rest of a path beginning with a step that cannot be matched on
+// events, such as [-1], is evaluated on.
+
+template <class Json>
+class jsonpath_stream_selector : public basic_json_content_handler<typename Json::char_type>
+{
+public:
+    typedef typename Json::char_type char_type;
+    using typename basic_json_content_handler<char_type>::string_view_type;
+    typedef std::function<void(const Json&)> value_function;
+private:
+    typedef typename Json::string_type string_type;
+    typedef basic_json_content_handler<char_type> handler_type;
+
+    enum class node_kind {object, array, string, other};
+    enum class match_kind {value, rest, filter, string};
+
+    struct frame
+    {
+        frame()
+            : is_object(false), filter_elements(false), index(0)
+        {
+        }
+
+        bool is_object;
+        // True if the elements are tested by the filter
+        bool filter_elements;
+        size_t index;
+        string_type name;
+        std::vector<size_t> states;
+    };
+
+    // A node that has been selected, or is read to test it or to evaluate the
+    // rest of the path on
+    struct match
+    {
+        match(match_kind kind, size_t level, const jsonpath_expression<Json>* expr)
+            : kind(kind), level(level), live(false), done(false), expr(expr)
+        {
+        }
+
+        match_kind kind;
+        // The number of open containers when the node began
+        size_t level;
+        // True if the node is written to the handler as it is read
+        bool live;
+        bool done;
+        const jsonpath_expression<Json>* expr;
+        std::unique_ptr<json_decoder<Json>> decoder;
+        std::vector<Json> values;
+    };
+
+    detail::stream_path<Json> path_;
+    handler_type* handler_;
+    value_function function_;
+    std::vector<frame> frames_;
+    size_t level_;
+    // The depth inside a container that nothing can be selected from
+    size_t skip_;
+    std::deque<match> matches_;
+    std::vector<size_t> states_;
+    std::vector<size_t> advanced_;
+    bool begun_;
+
+    // Noncopyable and nonmoveable
+    jsonpath_stream_selector(const jsonpath_stream_selector&) = delete;
+    jsonpath_stream_selector& operator=(const jsonpath_stream_selector&) = delete;
+public:
+    jsonpath_stream_selector(const string_view_type& path, handler_type& handler)
+        : path_(detail::stream_path<Json>::compile(path)), handler_(std::addressof(handler)),
+          level_(0), skip_(0), begun_(false)
+    {
+    }
+
+    jsonpath_stream_selector(const string_view_type& path, value_function f)
+        : path_(detail::stream_path<Json>::compile(path)), handler_(nullptr), function_(f),
+          level_(0), skip_(0), begun_(false)
+    {
+    }
+
+    // Reads the events of a pull reader to its end
+    void read(basic_stream_reader<char_type>& reader)
+    {
+        for (; !reader.done(); reader.next())
+        {
+            const auto& event = reader.current();
+            const serializing_context& context = reader.context();
+            switch (event.event_type())
+            {
+            case stream_event_type::begin_array:
+                this->begin_array(context);
+                break;
+            case stream_event_type::end_array:
+                this->end_array(context);
+                break;
+            case stream_event_type::begin_object:
+                this->begin_object(context);
+                break;
+            case stream_event_type::end_object:
+                this->end_object(context);
+                break;
+            case stream_event_type::name:
+                this->name(event.template as<string_view_type>(), context);
+                break;
+            case stream_event_type::string_value:
+                this->string_value(event.template as<string_view_type>(), event.semantic_tag(), context);
+                break;
+            case stream_event_type::byte_string_value:
+            {
+                auto bytes = event.template as<byte_string>();
+                this->byte_string_value(bytes.data(), bytes.length(), event.semantic_tag(), context);
+                break;
+            }
+            case stream_event_type::null_value:
+                this->null_value(context);
+                break;
+            case stream_event_type::bool_value:
+                this->bool_value(event.template as<bool>(), context);
+                break;
+            case stream_event_type::int64_value:
+                this->int64_value(event.template as<int64_t>(), event.semantic_tag(), context);
+                break;
+            case stream_event_type::uint64_value:
+                this->uint64_value(event.template as<uint64_t>(), event.semantic_tag(), context);
+                break;
+            case stream_event_type::double_value:
+                this->double_value(event.template as<double>(), event.semantic_tag(), context);
+                break;
+            }
+        }
+        this->flush();
+    }
+private:
+    void do_flush() override
+    {
+        if (handler_ != nullptr)
+        {
+            if (!begun_)
+            {
+                handler_->begin_array();
+            }
+            handler_->end_array();
+            handler_->flush();
+        }
+        begun_ = false;
+    }
+
+    bool do_begin_object(const serializing_context& context) override
+    {
+        if (skip_ > 0)
+        {
+            ++skip_;
+        }
+        else
+        {
+            begin_node(node_kind::object);
+        }
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).begin_object(context);
+        }
+        return true;
+    }
+
+    bool do_end_object(const serializing_context& context) override
+    {
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).end_object(context);
+        }
+        end_container();
+        return true;
+    }
+
+    bool do_begin_array(const serializing_context& context) override
+    {
+        if (skip_ > 0)
+        {
+            ++skip_;
+        }
+        else
+        {
+            begin_node(node_kind::array);
+        }
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).begin_array(context);
+        }
+        return true;
+    }
+
+    bool do_end_array(const serializing_context& context) override
+    {
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).end_array(context);
+        }
+        end_container();
+        return true;
+    }
+
+    bool do_name(const string_view_type& name, const serializing_context& context) override
+    {
+        if (skip_ == 0)
+        {
+            frames_[level_-1].name.assign(name.data(), name.length());
+        }
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).name(name, context);
+        }
+        return true;
+    }
+
+    bool do_null_value(const serializing_context& context) override
+    {
+        begin_scalar(node_kind::other);
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).null_value(context);
+        }
+        end_scalar();
+        return true;
+    }
+
+    bool do_string_value(const string_view_type& value, semantic_tag_type tag, const serializing_context& context) override
+    {
+        begin_scalar(node_kind::string);
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).string_value(value, tag, context);
+        }
+        end_scalar();
+        return true;
+    }
+
+    bool do_byte_string_value(const uint8_t* data, size_t length, semantic_tag_type tag, const serializing_context& context) override
+    {
+        begin_scalar(node_kind::other);
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).byte_string_value(data, length, tag, context);
+        }
+        end_scalar();
+        return true;
+    }
+
+    bool do_double_value(double value, const floating_point_options& fmt, semantic_tag_type tag, const serializing_context& context) override
+    {
+        begin_scalar(node_kind::other);
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).double_value(value, fmt, tag, context);
+        }
+        end_scalar();
+        return true;
+    }
+
+    bool do_int64_value(int64_t value, semantic_tag_type tag, const serializing_context& context) override
+    {
+        begin_scalar(node_kind::other);
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).int64_value(value, tag, context);
+        }
+        end_scalar();
+        return true;
+    }
+
+    bool do_uint64_value(uint64_t value, semantic_tag_type tag, const serializing_context& context) override
+    {
+        begin_scalar(node_kind::other);
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).uint64_value(value, tag, context);
+        }
+        end_scalar();
+        return true;
+    }
+
+    bool do_bool(bool value, const serializing_context& context) override
+    {
+        begin_scalar(node_kind::other);
+        for (auto& m : matches_)
+        {
+            if (!m.done) handler(m).bool_value(value, context);
+        }
+        end_scalar();
+        return true;
+    }
+
+    handler_type& handler(match& m)
+    {
+        return m.live ? *handler_ : *m.decoder;
+    }
+
+    void begin_scalar(node_kind kind)
+    {
+        if (skip_ == 0)
+        {
+            begin_node(kind);
+        }
+    }
+
+    void end_scalar()
+    {
+        if (skip_ == 0)
+        {
+            end_node();
+        }
+    }
+
+    void end_container()
+    {
+        if (skip_ > 0)
+        {
+            // The matches of a container that nothing is selected from
+            // end with it
+            if (--skip_ == 0)
+            {
+                end_node();
+            }
+        }
+        else
+        {
+            --level_;
+            end_node();
+        }
+    }
+
+    // Works out the states of a node from the states of its parent, starts
+    // the matches that begin at the node, and for a container, opens it
+    void begin_node(node_kind kind)
+    {
+        const size_t n = path_.steps.size();
+        states_.clear();
+        advanced_.clear();
+        bool candidate = false;
+        if (level_ == 0)
+        {
+            if (handler_ != nullptr && !begun_)
+            {
+                handler_->begin_array();
+                begun_ = true;
+            }
+            states_.push_back(0);
+            advanced_.push_back(0);
+        }
+        else
+        {
+            frame& parent = frames_[level_-1];
+            candidate = parent.filter_elements;
+            for (size_t k : parent.states)
+            {
+                const auto& step = path_.steps[k];
+                if (step.recursive_descent)
+                {
+                    add_state(states_, k);
+                }
+                if (parent.is_object ? step.select_member(parent.name) : step.select_element(parent.index))
+                {
+                    add_state(states_, k+1);
+                    add_state(advanced_, k+1);
+                }
+            }
+            if (!parent.is_object)
+            {
+                ++parent.index;
+            }
+        }
+
+        bool filter_elements = false;
+        if (candidate)
+        {
+            start_match(match_kind::filter, nullptr);
+        }
+        for (size_t k : states_)
+        {
+            if (k == n)
+            {
+                if (!path_.has_rest)
+                {
+                    start_match(match_kind::value, nullptr);
+                }
+                else if (path_.filter && kind == node_kind::array)
+                {
+                    filter_elements = true;
+                }
+                else
+                {
+                    start_match(match_kind::rest, std::addressof(path_.rest));
+                }
+            }
+        }
+        if (kind == node_kind::string)
+        {
+            for (size_t k : advanced_)
+            {
+                if (k < n && path_.steps[k].selects_from_strings)
+                {
+                    start_match(match_kind::string, std::addressof(path_.from_step[k]));
+                }
+            }
+        }
+
+        if (kind == node_kind::object || kind == node_kind::array)
+        {
+            auto it = std::find(states_.begin(), states_.end(), n);
+            if (it != states_.end())
+            {
+                states_.erase(it);
+            }
+            if (states_.empty() && !filter_elements)
+            {
+                skip_ = 1;
+            }
+            else
+            {
+                if (frames_.size() == level_)
+                {
+                    frames_.emplace_back();
+                }
+                frame& f = frames_[level_];
+                f.is_object = kind == node_kind::object;
+                f.filter_elements = filter_elements;
+                f.index = 0;
+                f.states.swap(states_);
+                ++level_;
+            }
+        }
+    }
+
+    static void add_state(std::vector<size_t>& states, size_t state)
+    {
+        if (std::find(states.begin(), states.end(), state) == states.end())
+        {
+            states.push_back(state);
+        }
+    }
+
+    void start_match(match_kind kind, const jsonpath_expression<Json>* expr)
+    {
+        matches_.emplace_back(kind, level_, expr);
+        match& m = matches_.back();
+        if (kind == match_kind::value && handler_ != nullptr && matches_.size() == 1)
+        {
+            m.live = true;
+        }
+        else
+        {
+            m.decoder.reset(new json_decoder<Json>());
+        }
+    }
+
+    // Completes the matches of the node that has just been read, and reports
+    // the values that are ready
+    void end_node()
+    {
+        for (auto& m : matches_)
+        {
+            if (!m.done && m.level == level_)
+            {
+                complete(m);
+            }
+        }
+        while (!matches_.empty() && matches_.front().done)
+        {
+            for (const auto& val : matches_.front().values)
+            {
+                report(val);
+            }
+            matches_.pop_front();
+        }
+    }
+
+    void complete(match& m)
+    {
+        m.done = true;
+        if (m.live)
+        {
+            return;
+        }
+        Json val = m.decoder->get_result();
+        m.decoder.reset();
+        switch (m.kind)
+        {
+        case match_kind::value:
+            m.values.push_back(std::move(val));
+            break;
+        case match_kind::filter:
+            if (path_.filter->exists(val, val))
+            {
+                if (path_.has_after_filter)
+                {
+                    append(path_.after_filter.evaluate(val), m.values);
+                }
+                else
+                {
+                    m.values.push_back(std::move(val));
+                }
+            }
+            break;
+        default:
+            append(m.expr->evaluate(val), m.values);
+            break;
+        }
+    }
+
+    static void append(Json&& result, std::vector<Json>& values)
+    {
+        for (auto& val : result.array_range())
+        {
+            values.push_back(std::move(val));
+        }
+    }
+
+    void report(const Json& val)
+    {
+        if (handler_ != nullptr)
+        {
+            val.dump(*handler_);
+        }
+        else
+        {
+            function_(val);
+        }
+    }
+};
+
+// Returns an array of the values at a path in JSON text, as json_query would
+// for the parsed text, without parsing it into a Json value first
+
+template <class Json>
+Json json_stream_query(std::basic_istream<typename Json::char_type>& is,
+                       const typename Json::string_view_type& path)
+{
+    json_decoder<Json> decoder;
+    jsonpath_stream_selector<Json> selector(path, decoder);
+    basic_json_reader<typename Json::char_type> reader(is, selector);
+    reader.read();
+    return decoder.get_result();
+}
+
+}}
+
+#endif
@@ -16,54 +16,15 @@
 #include <limits>
 #include <cassert>
 #include <jsoncons/json.hpp>
+#include <jsoncons/json_filter.hpp>
 #include <jsoncons/config/binary_utilities.hpp>
+#include <jsoncons_ext/msgpack/msgpack_detail.hpp>
+#include <jsoncons_ext/msgpack/msgpack_parser.hpp>
+#include <jsoncons_ext/msgpack/msgpack_serializer.hpp>
+#include <jsoncons_ext/msgpack/msgpack_view.hpp>
 
 namespace jsoncons { namespace msgpack {
   
-class msgpack_decode_error : public std::invalid_argument, public virtual json_exception
-{
-public:
-    explicit msgpack_decode_error(size_t pos) JSONCONS_NOEXCEPT
-        : std::invalid_argument("")
-    {
-        buffer_.append("Error decoding a message pack at position ");
-        buffer_.append(std::to_string(pos));
-    }
-    ~msgpack_decode_error() JSONCONS_NOEXCEPT
-    {
-    }
-    const char* what() const JSONCONS_NOEXCEPT override
-    {
-        return buffer_.c_str();
-    }
-private:
-    std::string buffer_;
-};
-
-namespace msgpack_format
-{
-    const uint8_t nil_cd = 0xc0;
-    const uint8_t false_cd = 0xc2;
-    const uint8_t true_cd = 0xc3;
-    const uint8_t float32_cd = 0xca;
-    const uint8_t float64_cd = 0xcb;
-    const uint8_t uint8_cd = 0xcc;
-    const uint8_t uint16_cd = 0xcd;
-    const uint8_t uint32_cd = 0xce;
-    const uint8_t uint64_cd = 0xcf;
-    const uint8_t int8_cd = 0xd0;
-    const uint8_t int16_cd = 0xd1;
-    const uint8_t int32_cd = 0xd2;
-    const uint8_t int64_cd = 0xd3;
-    const uint8_t str8_cd = 0xd9;
-    const uint8_t str16_cd = 0xda;
-    const uint8_t str32_cd = 0xdb;
-    const uint8_t array16_cd = 0xdc;
-    const uint8_t array32_cd = 0xdd;
-    const uint8_t map16_cd = 0xde;
-    const uint8_t map32_cd = 0xdf;
-}
-
 struct Encode_msgpack_
 {
     template <typename T>
@@ -235,8 +196,9 @@ public:
             }
 
             case structure_tag_type::array_tag:
+            case structure_tag_type::typed_array_tag:
             {
-                const auto length = jval.array_value().size();
+                const auto length = jval.size();
                 if (length <= 15)
                 {
                     // fixarray
@@ -256,9 +218,26 @@ public:
                 }
 
                 // append each element
-                for (const auto& el : jval.array_range())
+                if (jval.template is_typed_array<double>())
+                {
+                    for (double el : jval.template typed_array_range<double>())
+                    {
+                        encode(Json(el), action, v);
+                    }
+                }
+                else if (jval.template is_typed_array<int64_t>())
+                {
+                    for (int64_t el : jval.template typed_array_range<int64_t>())
+                    {
+                        encode(Json(el), action, v);
+                    }
+                }
+                else
                 {
-                    encode(el, action, v);
+                    for (const auto& el : jval.array_range())
+                    {
+                        encode(el, action, v);
+                    }
                 }
                 break;
             }
@@ -779,6 +758,63 @@ Json decode_msgpack(const std::vector<uint8_t>& v)
     Decode_msgpack_<Json> decoder(v.data(),v.data()+v.size());
     return decoder.decode();
 }
+
+template<class Json>
+void encode_msgpack(const Json& j, std::basic_ostream<typename Json::char_type>& os)
+{
+    typedef typename Json::char_type char_type;
+    basic_msgpack_serializer<char_type> serializer(os);
+    j.dump(serializer);
+}
+
+template<class Json>
+typename std::enable_if<std::is_same<typename Json::char_type,char>::value,Json>::type 
+decode_msgpack(std::basic_istream<typename Json::char_type>& is)
+{
+    typedef typename Json::char_type char_type;
+
+    std::vector<uint8_t> v;
+    is.seekg(0, std::ios::end);   
+    v.resize((size_t)is.tellg());
+    is.seekg(0, std::ios::beg);    
+    is.read((char_type*)v.data(),v.size());
+
+    jsoncons::json_decoder<Json> decoder;
+    msgpack_parser parser(decoder);
+    parser.update(v.data(),v.size());
+    std::error_code ec;
+    parser.parse_some(ec);
+    if (ec)
+    {
+        throw parse_error(ec,parser.line_number(),parser.column_number());
+    }
+    return decoder.get_result();
+}
+
+template<class Json>
+typename std::enable_if<!std::is_same<typename Json::char_type,char>::value,Json>::type 
+decode_msgpack(std::basic_istream<typename Json::char_type>& is)
+{
+    typedef typename Json::char_type char_type;
+
+    std::vector<uint8_t> v;
+    is.seekg(0, std::ios::end);   
+    v.resize((size_t)is.tellg());
+    is.seekg(0, std::ios::beg);    
+    is.read((char_type*)v.data(),v.size());
+
+    jsoncons::json_decoder<Json> decoder;
+    basic_utf8_adaptor<char_type> adaptor(decoder);
+    msgpack_parser parser(adaptor);
+    parser.update(v.data(),v.size());
+    std::error_code ec;
+    parser.parse_some(ec);
+    if (ec)
+    {
+        throw parse_error(ec,parser.line_number(),parser.column_number());
+    }
+    return decoder.get_result();
+}
   
 #if !defined(JSONCONS_NO_DEPRECATED)
 template<class Json>
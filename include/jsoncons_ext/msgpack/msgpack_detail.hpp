@@ -0,0 +1,65 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_MSGPACK_MSGPACKDETAIL_HPP
+#define JSONCONS_MSGPACK_MSGPACKDETAIL_HPP
+
+#include <string>
+#include <stdexcept>
+#include <jsoncons/json_exception.hpp>
+
+namespace jsoncons { namespace msgpack {
+  
+class msgpack_decode_error : public std::invalid_argument, public virtual json_exception
+{
+public:
+    explicit msgpack_decode_error(size_t pos) JSONCONS_NOEXCEPT
+        : std::invalid_argument("")
+    {
+        buffer_.append("Error decoding a message pack at position ");
+        buffer_.append(std::to_string(pos));
+    }
+    ~msgpack_decode_error() JSONCONS_NOEXCEPT
+    {
+    }
+    const char* what() const JSONCONS_NOEXCEPT override
+    {
+        return buffer_.c_str();
+    }
+private:
+    std::string buffer_;
+};
+
+namespace msgpack_format
+{
+    const uint8_t nil_cd = 0xc0;
+    const uint8_t false_cd = 0xc2;
+    const uint8_t true_cd = 0xc3;
+    const uint8_t bin8_cd = 0xc4;
+    const uint8_t bin16_cd = 0xc5;
+    const uint8_t bin32_cd = 0xc6;
+    const uint8_t float32_cd = 0xca;
+    const uint8_t float64_cd = 0xcb;
+    const uint8_t uint8_cd = 0xcc;
+    const uint8_t uint16_cd = 0xcd;
+    const uint8_t uint32_cd = 0xce;
+    const uint8_t uint64_cd = 0xcf;
+    const uint8_t int8_cd = 0xd0;
+    const uint8_t int16_cd = 0xd1;
+    const uint8_t int32_cd = 0xd2;
+    const uint8_t int64_cd = 0xd3;
+    const uint8_t str8_cd = 0xd9;
+    const uint8_t str16_cd = 0xda;
+    const uint8_t str32_cd = 0xdb;
+    const uint8_t array16_cd = 0xdc;
+    const uint8_t array32_cd = 0xdd;
+    const uint8_t map16_cd = 0xde;
+    const uint8_t map32_cd = 0xdf;
+}
+
+}}
+
+#endif
@@ -0,0 +1,508 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_MSGPACK_MSGPACKPARSER_HPP
+#define JSONCONS_MSGPACK_MSGPACKPARSER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <system_error>
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons/config/binary_utilities.hpp>
+#include <jsoncons_ext/msgpack/msgpack_detail.hpp>
+#include <jsoncons_ext/msgpack/msgpack_error_category.hpp>
+
+namespace jsoncons { namespace msgpack {
+
+// msgpack_parser reports the next complete MessagePack value in its input to
+// a json_content_handler, without building a json value. Text strings are
+// passed to the handler as views into the input.
+
+class msgpack_parser : public serializing_context
+{
+    const uint8_t* begin_input_;
+    const uint8_t* end_input_;
+    const uint8_t* input_ptr_;
+    json_content_handler& handler_;
+    size_t column_;
+    size_t nesting_depth_;
+public:
+    msgpack_parser(json_content_handler& handler)
+       : begin_input_(nullptr),
+         end_input_(nullptr),
+         input_ptr_(nullptr),
+         handler_(handler),
+         column_(1),
+         nesting_depth_(0)
+    {
+    }
+
+    void update(const uint8_t* input, size_t length)
+    {
+        begin_input_ = input;
+        end_input_ = input + length;
+        input_ptr_ = begin_input_;
+    }
+
+    void reset()
+    {
+        column_ = 1;
+        nesting_depth_ = 0;
+    }
+
+    // Returns true if the input is exhausted
+    bool done() const
+    {
+        return input_ptr_ == end_input_;
+    }
+
+    void parse_some(std::error_code& ec)
+    {
+        if (input_ptr_ >= end_input_)
+        {
+            ec = msgpack_parse_errc::unexpected_eof;
+            return;
+        }
+
+        const uint8_t* pos = input_ptr_++;
+        column_ = (pos - begin_input_) + 1;
+
+        if (*pos <= 0xbf)
+        {
+            if (*pos <= 0x7f)
+            {
+                // positive fixint
+                handler_.uint64_value(*pos, semantic_tag_type::none, *this);
+            }
+            else if (*pos <= 0x8f)
+            {
+                // fixmap
+                parse_object(*pos & 0x0f, ec);
+                if (ec)
+                {
+                    return;
+                }
+            }
+            else if (*pos <= 0x9f)
+            {
+                // fixarray
+                parse_array(*pos & 0x0f, ec);
+                if (ec)
+                {
+                    return;
+                }
+            }
+            else
+            {
+                // fixstr
+                parse_string(*pos & 0x1f, false, ec);
+                if (ec)
+                {
+                    return;
+                }
+            }
+        }
+        else if (*pos >= 0xe0)
+        {
+            // negative fixint
+            handler_.int64_value(static_cast<int8_t>(*pos), semantic_tag_type::none, *this);
+        }
+        else
+        {
+            switch (*pos)
+            {
+                case msgpack_format::nil_cd:
+                {
+                    handler_.null_value(*this);
+                    break;
+                }
+                case msgpack_format::true_cd:
+                {
+                    handler_.bool_value(true, *this);
+                    break;
+                }
+                case msgpack_format::false_cd:
+                {
+                    handler_.bool_value(false, *this);
+                    break;
+                }
+                case msgpack_format::float32_cd:
+                {
+                    float val;
+                    if (!read(val, ec))
+                    {
+                        return;
+                    }
+                    handler_.double_value(val, floating_point_options(), semantic_tag_type::none, *this);
+                    break;
+                }
+                case msgpack_format::float64_cd:
+                {
+                    double val;
+                    if (!read(val, ec))
+                    {
+                        return;
+                    }
+                    handler_.double_value(val, floating_point_options(), semantic_tag_type::none, *this);
+                    break;
+                }
+                case msgpack_format::uint8_cd:
+                {
+                    uint8_t val;
+                    if (!read(val, ec))
+                    {
+                        return;
+                    }
+                    handler_.uint64_value(val, semantic_tag_type::none, *this);
+                    break;
+                }
+                case msgpack_format::uint16_cd:
+                {
+                    uint16_t val;
+                    if (!read(val, ec))
+                    {
+                        return;
+                    }
+                    handler_.uint64_value(val, semantic_tag_type::none, *this);
+                    break;
+                }
+                case msgpack_format::uint32_cd:
+                {
+                    uint32_t val;
+                    if (!read(val, ec))
+                    {
+                        return;
+                    }
+                    handler_.uint64_value(val, semantic_tag_type::none, *this);
+                    break;
+                }
+                case msgpack_format::uint64_cd:
+                {
+                    uint64_t val;
+                    if (!read(val, ec))
+                    {
+                        return;
+                    }
+                    handler_.uint64_value(val, semantic_tag_type::none, *this);
+                    break;
+                }
+                case msgpack_format::int8_cd:
+                {
+                    int8_t val;
+                    if (!read(val, ec))
+                    {
+                        return;
+                    }
+                    handler_.int64_value(val, semantic_tag_type::none, *this);
+                    break;
+                }
+                case msgpack_format::int16_cd:
+                {
+                    int16_t val;
+                    if (!read(val, ec))
+                    {
+                        return;
+                    }
+                    handler_.int64_value(val, semantic_tag_type::none, *this);
+                    break;
+                }
+                case msgpack_format::int32_cd:
+                {
+                    int32_t val;
+                    if (!read(val, ec))
+                    {
+                        return;
+                    }
+                    handler_.int64_value(val, semantic_tag_type::none, *this);
+                    break;
+                }
+                case msgpack_format::int64_cd:
+                {
+                    int64_t val;
+                    if (!read(val, ec))
+                    {
+                        return;
+                    }
+                    handler_.int64_value(val, semantic_tag_type::none, *this);
+                    break;
+                }
+                case msgpack_format::str8_cd:
+                case msgpack_format::bin8_cd:
+                {
+                    uint8_t len;
+                    if (!read(len, ec))
+                    {
+                        return;
+                    }
+                    parse_string(len, *pos == msgpack_format::bin8_cd, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    break;
+                }
+                case msgpack_format::str16_cd:
+                case msgpack_format::bin16_cd:
+                {
+                    uint16_t len;
+                    if (!read(len, ec))
+                    {
+                        return;
+                    }
+                    parse_string(len, *pos == msgpack_format::bin16_cd, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    break;
+                }
+                case msgpack_format::str32_cd:
+                case msgpack_format::bin32_cd:
+                {
+                    uint32_t len;
+                    if (!read(len, ec))
+                    {
+                        return;
+                    }
+                    parse_string(len, *pos == msgpack_format::bin32_cd, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    break;
+                }
+                case msgpack_format::array16_cd:
+                {
+                    uint16_t len;
+                    if (!read(len, ec))
+                    {
+                        return;
+                    }
+                    parse_array(len, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    break;
+                }
+                case msgpack_format::array32_cd:
+                {
+                    uint32_t len;
+                    if (!read(len, ec))
+                    {
+                        return;
+                    }
+                    parse_array(len, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    break;
+                }
+                case msgpack_format::map16_cd:
+                {
+                    uint16_t len;
+                    if (!read(len, ec))
+                    {
+                        return;
+                    }
+                    parse_object(len, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    break;
+                }
+                case msgpack_format::map32_cd:
+                {
+                    uint32_t len;
+                    if (!read(len, ec))
+                    {
+                        return;
+                    }
+                    parse_object(len, ec);
+                    if (ec)
+                    {
+                        return;
+                    }
+                    break;
+                }
+                default:
+                {
+                    // ext types are not supported
+                    ec = msgpack_parse_errc::source_error;
+                    return;
+                }
+            }
+        }
+        if (nesting_depth_ == 0)
+        {
+            handler_.flush();
+        }
+    }
+
+    size_t line_number() const override
+    {
+        return 1;
+    }
+
+    size_t column_number() const override
+    {
+        return column_;
+    }
+private:
+    template <class T>
+    bool read(T& val, std::error_code& ec)
+    {
+        const uint8_t* endp;
+        val = binary::from_big_endian<T>(input_ptr_,end_input_,&endp);
+        if (endp == input_ptr_)
+        {
+            ec = msgpack_parse_errc::unexpected_eof;
+            return false;
+        }
+        input_ptr_ = endp;
+        return true;
+    }
+
+    bool read_string(size_t len, std::error_code& ec, basic_string_view<char>* s)
+    {
+        if (len > static_cast<size_t>(end_input_ - input_ptr_))
+        {
+            ec = msgpack_parse_errc::unexpected_eof;
+            return false;
+        }
+        auto result = unicons::validate(input_ptr_, input_ptr_ + len);
+        if (result.ec != unicons::conv_errc())
+        {
+            ec = msgpack_parse_errc::invalid_utf8_text_string;
+            return false;
+        }
+        *s = basic_string_view<char>(reinterpret_cast<const char*>(input_ptr_), len);
+        input_ptr_ += len;
+        return true;
+    }
+
+    void parse_string(size_t len, bool is_binary, std::error_code& ec)
+    {
+        if (is_binary)
+        {
+            if (len > static_cast<size_t>(end_input_ - input_ptr_))
+            {
+                ec = msgpack_parse_errc::unexpected_eof;
+                return;
+            }
+            const uint8_t* data = input_ptr_;
+            input_ptr_ += len;
+            handler_.byte_string_value(data, len, semantic_tag_type::none, *this);
+        }
+        else
+        {
+            basic_string_view<char> s;
+            if (!read_string(len, ec, &s))
+            {
+                return;
+            }
+            handler_.string_value(s, semantic_tag_type::none, *this);
+        }
+    }
+
+    void parse_name(std::error_code& ec)
+    {
+        if (input_ptr_ >= end_input_)
+        {
+            ec = msgpack_parse_errc::unexpected_eof;
+            return;
+        }
+        const uint8_t* pos = input_ptr_++;
+        size_t len;
+        if (*pos >= 0xa0 && *pos <= 0xbf)
+        {
+            len = *pos & 0x1f;
+        }
+        else if (*pos == msgpack_format::str8_cd)
+        {
+            uint8_t n;
+            if (!read(n, ec))
+            {
+                return;
+            }
+            len = n;
+        }
+        else if (*pos == msgpack_format::str16_cd)
+        {
+            uint16_t n;
+            if (!read(n, ec))
+            {
+                return;
+            }
+            len = n;
+        }
+        else if (*pos == msgpack_format::str32_cd)
+        {
+            uint32_t n;
+            if (!read(n, ec))
+            {
+                return;
+            }
+            len = n;
+        }
+        else
+        {
+            ec = msgpack_parse_errc::source_error;
+            return;
+        }
+        basic_string_view<char> s;
+        if (!read_string(len, ec, &s))
+        {
+            return;
+        }
+        handler_.name(s, *this);
+    }
+
+    void parse_array(size_t len, std::error_code& ec)
+    {
+        ++nesting_depth_;
+        handler_.begin_array(len, *this);
+        for (size_t i = 0; i < len; ++i)
+        {
+            parse_some(ec);
+            if (ec)
+            {
+                return;
+            }
+        }
+        handler_.end_array(*this);
+        --nesting_depth_;
+    }
+
+    void parse_object(size_t len, std::error_code& ec)
+    {
+        ++nesting_depth_;
+        handler_.begin_object(len, *this);
+        for (size_t i = 0; i < len; ++i)
+        {
+            parse_name(ec);
+            if (ec)
+            {
+                return;
+            }
+            parse_some(ec);
+            if (ec)
+            {
+                return;
+            }
+        }
+        handler_.end_object(*this);
+        --nesting_depth_;
+    }
+};
+
+}}
+
+#endif
@@ -0,0 +1,492 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_MSGPACK_MSGPACKSERIALIZER_HPP
+#define JSONCONS_MSGPACK_MSGPACKSERIALIZER_HPP
+
+#include <string>
+#include <vector>
+#include <limits> // std::numeric_limits
+#include <memory>
+#include <jsoncons/json_exception.hpp>
+#include <jsoncons/jsoncons_utilities.hpp>
+#include <jsoncons/json_content_handler.hpp>
+#include <jsoncons/config/binary_utilities.hpp>
+#include <jsoncons/detail/writer.hpp>
+#include <jsoncons/detail/deferred_length_buffer.hpp>
+#include <jsoncons_ext/msgpack/msgpack_detail.hpp>
+
+namespace jsoncons { namespace msgpack {
+
+enum class msgpack_structure_type {object, indefinite_length_object, array, indefinite_length_array};
+
+// MessagePack has no indefinite length maps or arrays. A map or array begun
+// without a length is held in a buffer, with everything inside it, until it ends 
+// and its length is known. json_parser never reports lengths, so transcoding 
+// JSON text buffers the whole document. Sources that report lengths, such as 
+// basic_json::dump, are written straight through.
+
+template<class CharT,class Writer=jsoncons::detail::stream_byte_writer>
+class basic_msgpack_serializer final : public basic_json_content_handler<CharT>
+{
+public:
+    using typename basic_json_content_handler<CharT>::string_view_type;
+    typedef Writer writer_type;
+    typedef typename Writer::output_type output_type;
+
+private:
+    // Room for a map 32 or array 32 header
+    static const size_t max_header_length = 5;
+
+    struct stack_item
+    {
+        msgpack_structure_type type_;
+        size_t count_;
+        size_t offset_;
+
+        stack_item(msgpack_structure_type type, size_t offset)
+           : type_(type), count_(0), offset_(offset)
+        {
+        }
+
+        size_t count() const
+        {
+            return count_;
+        }
+
+        bool is_object() const
+        {
+            return type_ == msgpack_structure_type::object || type_ == msgpack_structure_type::indefinite_length_object;
+        }
+
+        bool is_indefinite_length() const
+        {
+            return type_ == msgpack_structure_type::indefinite_length_array || type_ == msgpack_structure_type::indefinite_length_object;
+        }
+    };
+    std::vector<stack_item> stack_;
+    jsoncons::detail::deferred_length_buffer deferred_;
+    Writer writer_;
+
+    // Noncopyable and nonmoveable
+    basic_msgpack_serializer(const basic_msgpack_serializer&) = delete;
+    basic_msgpack_serializer& operator=(const basic_msgpack_serializer&) = delete;
+public:
+    basic_msgpack_serializer(output_type& os)
+       : deferred_(max_header_length), writer_(os)
+    {
+    }
+
+    ~basic_msgpack_serializer()
+    {
+        try
+        {
+            writer_.flush();
+        }
+        catch (...)
+        {
+        }
+    }
+
+private:
+    // Implementing methods
+
+    void do_flush() override
+    {
+        writer_.flush();
+    }
+
+    bool do_begin_object(const serializing_context&) override
+    {
+        begin_indefinite_length(msgpack_structure_type::indefinite_length_object);
+        return true;
+    }
+
+    bool do_begin_object(size_t length, const serializing_context&) override
+    {
+        stack_.push_back(stack_item(msgpack_structure_type::object, 0));
+
+        std::vector<uint8_t> v;
+        write_map_header(length, v);
+        put(v);
+        return true;
+    }
+
+    bool do_end_object(const serializing_context&) override
+    {
+        JSONCONS_ASSERT(!stack_.empty());
+        if (stack_.back().is_indefinite_length())
+        {
+            end_indefinite_length();
+        }
+        stack_.pop_back();
+
+        end_value();
+        return true;
+    }
+
+    bool do_begin_array(const serializing_context&) override
+    {
+        begin_indefinite_length(msgpack_structure_type::indefinite_length_array);
+        return true;
+    }
+
+    bool do_begin_array(size_t length, const serializing_context&) override
+    {
+        stack_.push_back(stack_item(msgpack_structure_type::array, 0));
+
+        std::vector<uint8_t> v;
+        write_array_header(length, v);
+        put(v);
+        return true;
+    }
+
+    bool do_end_array(const serializing_context&) override
+    {
+        JSONCONS_ASSERT(!stack_.empty());
+        if (stack_.back().is_indefinite_length())
+        {
+            end_indefinite_length();
+        }
+        stack_.pop_back();
+
+        end_value();
+        return true;
+    }
+
+    bool do_name(const string_view_type& name, const serializing_context&) override
+    {
+        write_string_value(name);
+        return true;
+    }
+
+    bool do_null_value(const serializing_context&) override
+    {
+        put(msgpack_format::nil_cd);
+
+        end_value();
+        return true;
+    }
+
+    // MessagePack has no bignum, decimal or date-time types, these are written as text strings
+    bool do_string_value(const string_view_type& sv, semantic_tag_type, const serializing_context&) override
+    {
+        write_string_value(sv);
+
+        end_value();
+        return true;
+    }
+
+    bool do_byte_string_value(const uint8_t* data, size_t length, semantic_tag_type, const serializing_context&) override
+    {
+        std::vector<uint8_t> v;
+        if (length <= (std::numeric_limits<uint8_t>::max)())
+        {
+            // bin 8 stores a byte array whose length is upto (2^8)-1 bytes
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::bin8_cd), v);
+            binary::to_big_endian(static_cast<uint8_t>(length), v);
+        }
+        else if (length <= (std::numeric_limits<uint16_t>::max)())
+        {
+            // bin 16 stores a byte array whose length is upto (2^16)-1 bytes
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::bin16_cd), v);
+            binary::to_big_endian(static_cast<uint16_t>(length), v);
+        }
+        else if (length <= (std::numeric_limits<uint32_t>::max)())
+        {
+            // bin 32 stores a byte array whose length is upto (2^32)-1 bytes
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::bin32_cd), v);
+            binary::to_big_endian(static_cast<uint32_t>(length),v);
+        }
+        else
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Byte string too long for MessagePack"));
+        }
+        v.insert(v.end(), data, data + length);
+        put(v);
+
+        end_value();
+        return true;
+    }
+
+    bool do_double_value(double val,
+                         const floating_point_options&,
+                         semantic_tag_type,
+                         const serializing_context&) override
+    {
+        std::vector<uint8_t> v;
+        // float 64
+        binary::to_big_endian(static_cast<uint8_t>(msgpack_format::float64_cd), v);
+        binary::to_big_endian(val,v);
+        put(v);
+
+        end_value();
+        return true;
+    }
+
+    bool do_int64_value(int64_t val,
+                        semantic_tag_type,
+                        const serializing_context&) override
+    {
+        std::vector<uint8_t> v;
+        if (val >= 0)
+        {
+            if (val <= (std::numeric_limits<int8_t>::max)())
+            {
+                // positive fixnum stores 7-bit positive integer
+                binary::to_big_endian(static_cast<int8_t>(val),v);
+            }
+            else if (val <= (std::numeric_limits<uint8_t>::max)())
+            {
+                // uint 8 stores a 8-bit unsigned integer
+                binary::to_big_endian(static_cast<uint8_t>(msgpack_format::uint8_cd), v);
+                binary::to_big_endian(static_cast<uint8_t>(val),v);
+            }
+            else if (val <= (std::numeric_limits<uint16_t>::max)())
+            {
+                // uint 16 stores a 16-bit big-endian unsigned integer
+                binary::to_big_endian(static_cast<uint8_t>(msgpack_format::uint16_cd), v);
+                binary::to_big_endian(static_cast<uint16_t>(val),v);
+            }
+            else if (val <= (std::numeric_limits<uint32_t>::max)())
+            {
+                // uint 32 stores a 32-bit big-endian unsigned integer
+                binary::to_big_endian(static_cast<uint8_t>(msgpack_format::uint32_cd), v);
+                binary::to_big_endian(static_cast<uint32_t>(val),v);
+            }
+            else
+            {
+                // int 64 stores a 64-bit big-endian signed integer
+                binary::to_big_endian(static_cast<uint8_t>(msgpack_format::int64_cd), v);
+                binary::to_big_endian(static_cast<int64_t>(val),v);
+            }
+        }
+        else
+        {
+            if (val >= -32)
+            {
+                // negative fixnum stores 5-bit negative integer
+                binary::to_big_endian(static_cast<int8_t>(val), v);
+            }
+            else if (val >= (std::numeric_limits<int8_t>::min)())
+            {
+                // int 8 stores a 8-bit signed integer
+                binary::to_big_endian(static_cast<uint8_t>(msgpack_format::int8_cd), v);
+                binary::to_big_endian(static_cast<int8_t>(val),v);
+            }
+            else if (val >= (std::numeric_limits<int16_t>::min)())
+            {
+                // int 16 stores a 16-bit big-endian signed integer
+                binary::to_big_endian(static_cast<uint8_t>(msgpack_format::int16_cd), v);
+                binary::to_big_endian(static_cast<int16_t>(val),v);
+            }
+            else if (val >= (std::numeric_limits<int32_t>::min)())
+            {
+                // int 32 stores a 32-bit big-endian signed integer
+                binary::to_big_endian(static_cast<uint8_t>(msgpack_format::int32_cd), v);
+                binary::to_big_endian(static_cast<int32_t>(val),v);
+            }
+            else
+            {
+                // int 64 stores a 64-bit big-endian signed integer
+                binary::to_big_endian(static_cast<uint8_t>(msgpack_format::int64_cd), v);
+                binary::to_big_endian(static_cast<int64_t>(val),v);
+            }
+        }
+        put(v);
+
+        end_value();
+        return true;
+    }
+
+    bool do_uint64_value(uint64_t val,
+                         semantic_tag_type,
+                         const serializing_context&) override
+    {
+        std::vector<uint8_t> v;
+        if (val <= (std::numeric_limits<int8_t>::max)())
+        {
+            // positive fixnum stores 7-bit positive integer
+            binary::to_big_endian(static_cast<uint8_t>(val), v);
+        }
+        else if (val <= (std::numeric_limits<uint8_t>::max)())
+        {
+            // uint 8 stores a 8-bit unsigned integer
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::uint8_cd), v);
+            binary::to_big_endian(static_cast<uint8_t>(val), v);
+        }
+        else if (val <= (std::numeric_limits<uint16_t>::max)())
+        {
+            // uint 16 stores a 16-bit big-endian unsigned integer
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::uint16_cd), v);
+            binary::to_big_endian(static_cast<uint16_t>(val),v);
+        }
+        else if (val <= (std::numeric_limits<uint32_t>::max)())
+        {
+            // uint 32 stores a 32-bit big-endian unsigned integer
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::uint32_cd), v);
+            binary::to_big_endian(static_cast<uint32_t>(val),v);
+        }
+        else
+        {
+            // uint 64 stores a 64-bit big-endian unsigned integer
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::uint64_cd), v);
+            binary::to_big_endian(static_cast<uint64_t>(val),v);
+        }
+        put(v);
+
+        end_value();
+        return true;
+    }
+
+    bool do_bool(bool val, const serializing_context&) override
+    {
+        put(val ? msgpack_format::true_cd : msgpack_format::false_cd);
+
+        end_value();
+        return true;
+    }
+
+    void write_string_value(const string_view_type& sv)
+    {
+        std::vector<uint8_t> v;
+        std::basic_string<uint8_t> target;
+        auto result = unicons::convert(
+            sv.begin(), sv.end(), std::back_inserter(target),
+            unicons::conv_flags::strict);
+        if (result.ec != unicons::conv_errc())
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Illegal unicode"));
+        }
+
+        const size_t length = target.length();
+        if (length <= 31)
+        {
+            // fixstr stores a byte array whose length is upto 31 bytes
+            binary::to_big_endian(static_cast<uint8_t>(0xa0 | length), v);
+        }
+        else if (length <= (std::numeric_limits<uint8_t>::max)())
+        {
+            // str 8 stores a byte array whose length is upto (2^8)-1 bytes
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::str8_cd), v);
+            binary::to_big_endian(static_cast<uint8_t>(length), v);
+        }
+        else if (length <= (std::numeric_limits<uint16_t>::max)())
+        {
+            // str 16 stores a byte array whose length is upto (2^16)-1 bytes
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::str16_cd), v);
+            binary::to_big_endian(static_cast<uint16_t>(length), v);
+        }
+        else if (length <= (std::numeric_limits<uint32_t>::max)())
+        {
+            // str 32 stores a byte array whose length is upto (2^32)-1 bytes
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::str32_cd), v);
+            binary::to_big_endian(static_cast<uint32_t>(length),v);
+        }
+        else
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("String too long for MessagePack"));
+        }
+        v.insert(v.end(), target.begin(), target.end());
+        put(v);
+    }
+
+    static void write_map_header(size_t length, std::vector<uint8_t>& v)
+    {
+        if (length <= 15)
+        {
+            // fixmap
+            binary::to_big_endian(static_cast<uint8_t>(0x80 | length), v);
+        }
+        else if (length <= (std::numeric_limits<uint16_t>::max)())
+        {
+            // map 16
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::map16_cd), v);
+            binary::to_big_endian(static_cast<uint16_t>(length), v);
+        }
+        else if (length <= (std::numeric_limits<uint32_t>::max)())
+        {
+            // map 32
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::map32_cd), v);
+            binary::to_big_endian(static_cast<uint32_t>(length),v);
+        }
+        else
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Map too long for MessagePack"));
+        }
+    }
+
+    static void write_array_header(size_t length, std::vector<uint8_t>& v)
+    {
+        if (length <= 15)
+        {
+            // fixarray
+            binary::to_big_endian(static_cast<uint8_t>(0x90 | length), v);
+        }
+        else if (length <= (std::numeric_limits<uint16_t>::max)())
+        {
+            // array 16
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::array16_cd), v);
+            binary::to_big_endian(static_cast<uint16_t>(length),v);
+        }
+        else if (length <= (std::numeric_limits<uint32_t>::max)())
+        {
+            // array 32
+            binary::to_big_endian(static_cast<uint8_t>(msgpack_format::array32_cd), v);
+            binary::to_big_endian(static_cast<uint32_t>(length),v);
+        }
+        else
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Array too long for MessagePack"));
+        }
+    }
+
+    void begin_indefinite_length(msgpack_structure_type type)
+    {
+        stack_.push_back(stack_item(type, deferred_.begin()));
+    }
+
+    void end_indefinite_length()
+    {
+        const stack_item& item = stack_.back();
+
+        std::vector<uint8_t> v;
+        if (item.is_object())
+        {
+            write_map_header(item.count(), v);
+        }
+        else
+        {
+            write_array_header(item.count(), v);
+        }
+        deferred_.end(item.offset_, v, writer_);
+    }
+
+    void put(uint8_t c)
+    {
+        deferred_.put(c, writer_);
+    }
+
+    void put(const std::vector<uint8_t>& v)
+    {
+        deferred_.write(v, writer_);
+    }
+
+    void end_value()
+    {
+        if (!stack_.empty())
+        {
+            ++stack_.back().count_;
+        }
+    }
+};
+
+typedef basic_msgpack_serializer<char,jsoncons::detail::stream_byte_writer> msgpack_serializer;
+
+typedef basic_msgpack_serializer<char,jsoncons::detail::bytes_writer> msgpack_bytes_serializer;
+
+}}
+#endif
@@ -0,0 +1,903 @@
+// Copyright 2018 Daniel Parker
+// Distributed under the Boost license, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// See https://github.com/danielaparker/jsoncons for latest version
+
+#ifndef JSONCONS_MSGPACK_MSGPACKVIEW_HPP
+#define JSONCONS_MSGPACK_MSGPACKVIEW_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <iterator>
+#include <jsoncons/json.hpp>
+#include <jsoncons/byte_string.hpp>
+#include <jsoncons/config/binary_utilities.hpp>
+#include <jsoncons_ext/msgpack/msgpack_detail.hpp>
+#include <jsoncons_ext/msgpack/msgpack_parser.hpp>
+
+namespace jsoncons { namespace msgpack {
+
+enum class msgpack_item_type {nil, boolean, unsigned_integer, signed_integer, float32, float64, string, binary, array, map, invalid};
+
+namespace detail {
+
+struct item_header
+{
+    msgpack_item_type type;
+    // Payload bytes for scalars, strings and binaries, elements for arrays, members for maps
+    size_t length;
+    const uint8_t* payload;
+};
+
+template <class T>
+item_header make_header(msgpack_item_type type, const uint8_t* p, const uint8_t* last)
+{
+    const uint8_t* endp;
+    T len = binary::from_big_endian<T>(p, last, &endp);
+    if (endp == p)
+    {
+        return item_header{msgpack_item_type::invalid, 0, p};
+    }
+    return item_header{type, static_cast<size_t>(len), endp};
+}
+
+inline
+item_header get_item_header(const uint8_t* first, const uint8_t* last)
+{
+    if (first >= last)
+    {
+        return item_header{msgpack_item_type::invalid, 0, first};
+    }
+    const uint8_t* p = first + 1;
+    const uint8_t b = *first;
+    if (b <= 0x7f)
+    {
+        // positive fixint
+        return item_header{msgpack_item_type::unsigned_integer, 0, p};
+    }
+    if (b <= 0x8f)
+    {
+        return item_header{msgpack_item_type::map, static_cast<size_t>(b & 0x0f), p};
+    }
+    if (b <= 0x9f)
+    {
+        return item_header{msgpack_item_type::array, static_cast<size_t>(b & 0x0f), p};
+    }
+    if (b <= 0xbf)
+    {
+        return item_header{msgpack_item_type::string, static_cast<size_t>(b & 0x1f), p};
+    }
+    if (b >= 0xe0)
+    {
+        // negative fixint
+        return item_header{msgpack_item_type::signed_integer, 0, p};
+    }
+    switch (b)
+    {
+        case msgpack_format::nil_cd:
+            return item_header{msgpack_item_type::nil, 0, p};
+        case msgpack_format::false_cd:
+        case msgpack_format::true_cd:
+            return item_header{msgpack_item_type::boolean, 0, p};
+        case msgpack_format::bin8_cd:
+            return make_header<uint8_t>(msgpack_item_type::binary, p, last);
+        case msgpack_format::bin16_cd:
+            return make_header<uint16_t>(msgpack_item_type::binary, p, last);
+        case msgpack_format::bin32_cd:
+            return make_header<uint32_t>(msgpack_item_type::binary, p, last);
+        case msgpack_format::float32_cd:
+            return item_header{msgpack_item_type::float32, 4, p};
+        case msgpack_format::float64_cd:
+            return item_header{msgpack_item_type::float64, 8, p};
+        case msgpack_format::uint8_cd:
+            return item_header{msgpack_item_type::unsigned_integer, 1, p};
+        case msgpack_format::uint16_cd:
+            return item_header{msgpack_item_type::unsigned_integer, 2, p};
+        case msgpack_format::uint32_cd:
+            return item_header{msgpack_item_type::unsigned_integer, 4, p};
+        case msgpack_format::uint64_cd:
+            return item_header{msgpack_item_type::unsigned_integer, 8, p};
+        case msgpack_format::int8_cd:
+            return item_header{msgpack_item_type::signed_integer, 1, p};
+        case msgpack_format::int16_cd:
+            return item_header{msgpack_item_type::signed_integer, 2, p};
+        case msgpack_format::int32_cd:
+            return item_header{msgpack_item_type::signed_integer, 4, p};
+        case msgpack_format::int64_cd:
+            return item_header{msgpack_item_type::signed_integer, 8, p};
+        case msgpack_format::str8_cd:
+            return make_header<uint8_t>(msgpack_item_type::string, p, last);
+        case msgpack_format::str16_cd:
+            return make_header<uint16_t>(msgpack_item_type::string, p, last);
+        case msgpack_format::str32_cd:
+            return make_header<uint32_t>(msgpack_item_type::string, p, last);
+        case msgpack_format::array16_cd:
+            return make_header<uint16_t>(msgpack_item_type::array, p, last);
+        case msgpack_format::array32_cd:
+            return make_header<uint32_t>(msgpack_item_type::array, p, last);
+        case msgpack_format::map16_cd:
+            return make_header<uint16_t>(msgpack_item_type::map, p, last);
+        case msgpack_format::map32_cd:
+            return make_header<uint32_t>(msgpack_item_type::map, p, last);
+        default:
+            // ext types are not supported, as by msgpack_parser and decode_msgpack
+            return item_header{msgpack_item_type::invalid, 0, first};
+    }
+}
+
+// Sets *endp to the end of the item that begins at first, or to first if the item is malformed
+inline
+void walk(const uint8_t* first, const uint8_t* last, const uint8_t** endp)
+{
+    const uint8_t* p = first;
+    size_t pending = 1;
+    while (pending > 0)
+    {
+        item_header h = get_item_header(p, last);
+        switch (h.type)
+        {
+            case msgpack_item_type::invalid:
+                *endp = first;
+                return;
+            case msgpack_item_type::array:
+                pending += h.length;
+                p = h.payload;
+                break;
+            case msgpack_item_type::map:
+                pending += 2*h.length;
+                p = h.payload;
+                break;
+            default:
+                if (h.length > static_cast<size_t>(last - h.payload))
+                {
+                    *endp = first;
+                    return;
+                }
+                p = h.payload + h.length;
+                break;
+        }
+        --pending;
+    }
+    *endp = p;
+}
+
+template <class T>
+class const_array_iterator
+{
+    const uint8_t* p_;
+    const uint8_t* last_;
+    T current_;
+public:
+    typedef typename T::difference_type difference_type;
+    typedef typename T::value_type value_type;
+    typedef typename T::const_reference reference;
+    typedef typename T::const_pointer pointer;
+    typedef std::forward_iterator_tag iterator_catagory;
+
+    const_array_iterator()
+        : p_(nullptr), last_(nullptr)
+    {
+    }
+
+    const_array_iterator(const uint8_t* p, const uint8_t* last)
+        : p_(p), last_(last)
+    {
+    }
+
+    const_array_iterator(const const_array_iterator& other) = default;
+
+    friend bool operator==(const const_array_iterator& lhs, const const_array_iterator& rhs)
+    {
+        return lhs.p_ == rhs.p_;
+    }
+
+    friend bool operator!=(const const_array_iterator& lhs, const const_array_iterator& rhs)
+    {
+        return lhs.p_ != rhs.p_;
+    }
+
+    const_array_iterator& operator++()
+    {
+        detail::walk(p_, last_, &p_);
+        return *this;
+    }
+
+    const_array_iterator operator++(int) // postfix increment
+    {
+        const_array_iterator temp(*this);
+        detail::walk(p_, last_, &p_);
+        return temp;
+    }
+
+    reference operator*() const
+    {
+        const uint8_t* endp;
+        detail::walk(p_, last_, &endp);
+        const_cast<T*>(&current_)->first_ = p_;
+        const_cast<T*>(&current_)->last_ = endp;
+        return current_;
+    }
+
+    pointer operator->() const
+    {
+        return &(**this);
+    }
+};
+
+template <class T>
+class const_object_iterator;
+
+template <class T>
+class key_value_pair_view
+{
+    const uint8_t* key_begin_;
+    const uint8_t* key_end_;
+    const uint8_t* val_begin_;
+    const uint8_t* val_end_;
+
+public:
+    friend class const_object_iterator<T>;
+
+    key_value_pair_view()
+        : key_begin_(nullptr), key_end_(nullptr), val_begin_(nullptr), val_end_(nullptr)
+    {
+    }
+
+    key_value_pair_view(const key_value_pair_view& other) = default;
+
+    typename T::string_view_type key() const
+    {
+        return T(key_begin_, key_end_ - key_begin_).as_string_view();
+    }
+
+    T value() const
+    {
+        return T(val_begin_, val_end_ - val_begin_);
+    }
+};
+
+template <class T>
+class const_object_iterator
+{
+    const uint8_t* p_;
+    const uint8_t* last_;
+    key_value_pair_view<T> kvpair_;
+public:
+    typedef typename T::difference_type difference_type;
+    typedef key_value_pair_view<T> value_type;
+    typedef const key_value_pair_view<T>& reference;
+    typedef const key_value_pair_view<T>* pointer;
+    typedef std::forward_iterator_tag iterator_catagory;
+
+    const_object_iterator()
+        : p_(nullptr), last_(nullptr)
+    {
+    }
+
+    const_object_iterator(const uint8_t* p, const uint8_t* last)
+        : p_(p), last_(last)
+    {
+    }
+
+    const_object_iterator(const const_object_iterator& other) = default;
+
+    friend bool operator==(const const_object_iterator& lhs, const const_object_iterator& rhs)
+    {
+        return lhs.p_ == rhs.p_;
+    }
+
+    friend bool operator!=(const const_object_iterator& lhs, const const_object_iterator& rhs)
+    {
+        return lhs.p_ != rhs.p_;
+    }
+
+    const_object_iterator& operator++()
+    {
+        detail::walk(p_, last_, &p_);
+        detail::walk(p_, last_, &p_);
+        return *this;
+    }
+
+    const_object_iterator operator++(int) // postfix increment
+    {
+        const_object_iterator temp(*this);
+        ++(*this);
+        return temp;
+    }
+
+    reference operator*() const
+    {
+        key_value_pair_view<T>& kvpair = const_cast<key_value_pair_view<T>&>(kvpair_);
+        kvpair.key_begin_ = p_;
+        detail::walk(kvpair.key_begin_, last_, &kvpair.key_end_);
+        kvpair.val_begin_ = kvpair.key_end_;
+        detail::walk(kvpair.val_begin_, last_, &kvpair.val_end_);
+        return kvpair_;
+    }
+
+    pointer operator->() const
+    {
+        return &(**this);
+    }
+};
+
+} // namespace detail
+
+// msgpack_view is a non-owning reference to a packed MessagePack value. Members and
+// elements are found by skipping over their predecessors, strings and binaries are
+// returned as views into the buffer.
+
+class msgpack_view
+{
+    const uint8_t* first_;
+    const uint8_t* last_;
+public:
+    typedef msgpack_view array;
+    typedef std::allocator<char> allocator_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef msgpack_view value_type;
+    typedef msgpack_view& reference;
+    typedef const msgpack_view& const_reference;
+    typedef msgpack_view* pointer;
+    typedef const msgpack_view* const_pointer;
+    typedef std::string string_type;
+    typedef char char_type;
+    typedef std::char_traits<char_type> char_traits_type;
+    typedef basic_string_view<char_type> string_view_type;
+    typedef detail::const_object_iterator<msgpack_view> object_iterator;
+    typedef detail::const_object_iterator<msgpack_view> const_object_iterator;
+    typedef detail::const_array_iterator<msgpack_view> array_iterator;
+    typedef detail::const_array_iterator<msgpack_view> const_array_iterator;
+    typedef detail::key_value_pair_view<msgpack_view> key_value_pair_type;
+
+    friend class detail::const_array_iterator<msgpack_view>;
+    friend class detail::const_object_iterator<msgpack_view>;
+
+    msgpack_view()
+        : first_(nullptr), last_(nullptr)
+    {
+    }
+
+    msgpack_view(const uint8_t* data, size_t length)
+        : first_(data), last_(data+length)
+    {
+    }
+
+    msgpack_view(const std::vector<uint8_t>& v)
+        : first_(v.data()), last_(v.data()+v.size())
+    {
+    }
+
+    msgpack_view(const msgpack_view& other) = default;
+
+    msgpack_view& operator=(const msgpack_view&) = default;
+
+    friend bool operator==(const msgpack_view& lhs, const msgpack_view& rhs)
+    {
+        size_t n = lhs.last_ - lhs.first_;
+        size_t m = rhs.last_ - rhs.first_;
+        return (n != m) ? false : memcmp(lhs.first_,rhs.first_,n) == 0;
+    }
+
+    friend bool operator!=(const msgpack_view& lhs, const msgpack_view& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    const uint8_t* buffer() const
+    {
+        return first_;
+    }
+
+    size_t buflen() const
+    {
+        return last_ - first_;
+    }
+
+    msgpack_item_type type() const
+    {
+        JSONCONS_ASSERT(buflen() > 0);
+        return header().type;
+    }
+
+    range<const_object_iterator> object_range() const
+    {
+        detail::item_header h = header();
+        if (h.type != msgpack_item_type::map)
+        {
+            JSONCONS_THROW(json_exception_impl<std::invalid_argument>("Not an object"));
+        }
+        const uint8_t* endp = end_of_value();
+        return range<const_object_iterator>(const_object_iterator(h.payload,endp), const_object_iterator(endp, endp));
+    }
+
+    range<const_array_iterator> array_range() const
+    {
+        detail::item_header h = header();
+        if (h.type != msgpack_item_type::array)
+        {
+            JSONCONS_THROW(json_exception_impl<std::invalid_argument>("Not an array"));
+        }
+        const uint8_t* endp = end_of_value();
+        return range<const_array_iterator>(const_array_iterator(h.payload,endp), const_array_iterator(endp, endp));
+    }
+
+    bool empty() const
+    {
+        detail::item_header h = header();
+        switch (h.type)
+        {
+            case msgpack_item_type::array:
+            case msgpack_item_type::map:
+            case msgpack_item_type::string:
+            case msgpack_item_type::binary:
+                return h.length == 0;
+            default:
+                return false;
+        }
+    }
+
+    bool is_null() const
+    {
+        return type() == msgpack_item_type::nil;
+    }
+
+    bool is_bool() const
+    {
+        return type() == msgpack_item_type::boolean;
+    }
+
+    bool is_array() const
+    {
+        return type() == msgpack_item_type::array;
+    }
+
+    bool is_object() const
+    {
+        return type() == msgpack_item_type::map;
+    }
+
+    bool is_string() const
+    {
+        return type() == msgpack_item_type::string;
+    }
+
+    bool is_string_view() const
+    {
+        return is_string();
+    }
+
+    bool is_byte_string() const
+    {
+        return type() == msgpack_item_type::binary;
+    }
+
+    bool is_byte_string_view() const
+    {
+        return is_byte_string();
+    }
+
+    bool is_bignum() const
+    {
+        return false;
+    }
+
+    bool is_double() const
+    {
+        msgpack_item_type t = type();
+        return t == msgpack_item_type::float32 || t == msgpack_item_type::float64;
+    }
+
+    bool is_int64() const
+    {
+        switch (type())
+        {
+            case msgpack_item_type::signed_integer:
+                return true;
+            case msgpack_item_type::unsigned_integer:
+                return as_integer<uint64_t>() <= static_cast<uint64_t>((std::numeric_limits<int64_t>::max)());
+            default:
+                return false;
+        }
+    }
+
+    bool is_uint64() const
+    {
+        switch (type())
+        {
+            case msgpack_item_type::unsigned_integer:
+                return true;
+            case msgpack_item_type::signed_integer:
+                return as_integer<int64_t>() >= 0;
+            default:
+                return false;
+        }
+    }
+
+    size_t size() const
+    {
+        detail::item_header h = header();
+        switch (h.type)
+        {
+            case msgpack_item_type::array:
+            case msgpack_item_type::map:
+                return h.length;
+            default:
+                return 0;
+        }
+    }
+
+    msgpack_view operator[](size_t i) const
+    {
+        return at(i);
+    }
+
+    msgpack_view operator[](const string_view_type& name) const
+    {
+        return at(name);
+    }
+
+    msgpack_view at(size_t index) const
+    {
+        detail::item_header h = header();
+        JSONCONS_ASSERT(h.type == msgpack_item_type::array);
+        if (index >= h.length)
+        {
+            JSONCONS_THROW(json_exception_impl<std::out_of_range>("Invalid array subscript"));
+        }
+
+        const uint8_t* it = h.payload;
+        for (size_t i = 0; i < index; ++i)
+        {
+            it = skip(it);
+        }
+        return msgpack_view(it, skip(it)-it);
+    }
+
+    msgpack_view at(const string_view_type& key) const
+    {
+        const uint8_t* val;
+        if (!find(key, &val))
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Key not found"));
+        }
+        return msgpack_view(val, skip(val)-val);
+    }
+
+    bool contains(const string_view_type& key) const
+    {
+        if (!is_object())
+        {
+            return false;
+        }
+        const uint8_t* val;
+        return find(key, &val);
+    }
+
+    template<class T, class... Args>
+    bool is(Args&&... args) const
+    {
+        return json_type_traits<msgpack_view,T>::is(*this,std::forward<Args>(args)...);
+    }
+
+    template<class T, class... Args>
+    T as(Args&&... args) const
+    {
+        return json_type_traits<msgpack_view,T>::as(*this,std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, T>::type
+    as_integer() const
+    {
+        detail::item_header h = header();
+        switch (h.type)
+        {
+            case msgpack_item_type::unsigned_integer:
+                return static_cast<T>(read_unsigned(h));
+            case msgpack_item_type::signed_integer:
+                return static_cast<T>(read_signed(h));
+            default:
+                JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not an integer"));
+        }
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value,T>::type
+    as_integer() const
+    {
+        detail::item_header h = header();
+        switch (h.type)
+        {
+            case msgpack_item_type::unsigned_integer:
+                return static_cast<T>(read_unsigned(h));
+            case msgpack_item_type::signed_integer:
+                return static_cast<T>(read_signed(h));
+            default:
+                JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not an integer"));
+        }
+    }
+
+    bool as_bool() const
+    {
+        if (!is_bool())
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a bool"));
+        }
+        return *first_ == msgpack_format::true_cd;
+    }
+
+    double as_double() const
+    {
+        detail::item_header h = header();
+        switch (h.type)
+        {
+            case msgpack_item_type::unsigned_integer:
+                return static_cast<double>(read_unsigned(h));
+            case msgpack_item_type::signed_integer:
+                return static_cast<double>(read_signed(h));
+            case msgpack_item_type::float32:
+                return read<float>(h.payload);
+            case msgpack_item_type::float64:
+                return read<double>(h.payload);
+            default:
+                JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a double"));
+        }
+    }
+
+    // Returns a view of the UTF-8 text in the buffer
+    string_view_type as_string_view() const
+    {
+        detail::item_header h = header();
+        if (h.type != msgpack_item_type::string)
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a string"));
+        }
+        check_payload(h);
+        return string_view_type(reinterpret_cast<const char*>(h.payload), h.length);
+    }
+
+    // Returns a view of the bytes in the buffer
+    byte_string_view as_byte_string_view() const
+    {
+        detail::item_header h = header();
+        if (h.type != msgpack_item_type::binary)
+        {
+            JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a byte string"));
+        }
+        check_payload(h);
+        return byte_string_view(h.payload, h.length);
+    }
+
+    std::string as_string() const
+    {
+        switch (type())
+        {
+            case msgpack_item_type::string:
+            {
+                string_view_type sv = as_string_view();
+                return std::string(sv.data(), sv.length());
+            }
+            case msgpack_item_type::binary:
+            {
+                byte_string_view bs = as_byte_string_view();
+                std::string s;
+                encode_base64url(bs.data(),bs.length(),s);
+                return s;
+            }
+            default:
+            {
+                std::string s;
+                dump(s);
+                return s;
+            }
+        }
+    }
+
+    template <typename BAllocator=std::allocator<uint8_t>>
+    basic_byte_string<BAllocator> as_byte_string() const
+    {
+        byte_string_view bs = as_byte_string_view();
+        return basic_byte_string<BAllocator>(bs.data(),bs.length());
+    }
+
+    bignum as_bignum() const
+    {
+        switch (type())
+        {
+            case msgpack_item_type::unsigned_integer:
+                return bignum(as_integer<uint64_t>());
+            case msgpack_item_type::signed_integer:
+                return bignum(as_integer<int64_t>());
+            default:
+                JSONCONS_THROW(json_exception_impl<std::runtime_error>("Not a bignum"));
+        }
+    }
+
+    template <typename Traits,typename SAllocator>
+    void dump(std::basic_string<char,Traits,SAllocator>& s) const
+    {
+        typedef std::basic_string<char,Traits,SAllocator> string_type;
+        basic_json_serializer<char,jsoncons::detail::string_writer<string_type>> serializer(s);
+        dump(serializer);
+    }
+
+    template <typename Traits,typename SAllocator>
+    void dump(std::basic_string<char,Traits,SAllocator>& s,
+              const json_serializing_options& options) const
+    {
+        typedef std::basic_string<char,Traits,SAllocator> string_type;
+        basic_json_serializer<char,jsoncons::detail::string_writer<string_type>> serializer(s, options);
+        dump(serializer);
+    }
+
+    void dump(std::ostream& os) const
+    {
+        json_serializer serializer(os);
+        dump(serializer);
+    }
+
+    void dump(std::ostream& os, indenting line_indent) const
+    {
+        json_serializer serializer(os, line_indent);
+        dump(serializer);
+    }
+
+    void dump(std::ostream& os, const json_serializing_options& options) const
+    {
+        json_serializer serializer(os, options);
+        dump(serializer);
+    }
+
+    void dump(std::ostream& os, const json_serializing_options& options, indenting line_indent) const
+    {
+        json_serializer serializer(os, options, line_indent);
+        dump(serializer);
+    }
+
+    void dump(json_content_handler& handler) const
+    {
+        msgpack_parser parser(handler);
+        parser.update(first_, buflen());
+        std::error_code ec;
+        parser.parse_some(ec);
+        if (ec)
+        {
+            throw parse_error(ec,parser.line_number(),parser.column_number());
+        }
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const msgpack_view& v)
+    {
+        v.dump(os);
+        return os;
+    }
+private:
+    detail::item_header header() const
+    {
+        detail::item_header h = detail::get_item_header(first_, last_);
+        if (h.type == msgpack_item_type::invalid)
+        {
+            JSONCONS_THROW(msgpack_decode_error(0));
+        }
+        return h;
+    }
+
+    void check_payload(const detail::item_header& h) const
+    {
+        if (h.length > static_cast<size_t>(last_ - h.payload))
+        {
+            JSONCONS_THROW(msgpack_decode_error(last_-first_));
+        }
+    }
+
+    const uint8_t* skip(const uint8_t* p) const
+    {
+        const uint8_t* endp;
+        detail::walk(p, last_, &endp);
+        if (endp == p)
+        {
+            JSONCONS_THROW(msgpack_decode_error(p-first_));
+        }
+        return endp;
+    }
+
+    const uint8_t* end_of_value() const
+    {
+        return skip(first_);
+    }
+
+    template <class T>
+    T read(const uint8_t* p) const
+    {
+        const uint8_t* endp;
+        T val = binary::from_big_endian<T>(p, last_, &endp);
+        if (endp == p)
+        {
+            JSONCONS_THROW(msgpack_decode_error(p-first_));
+        }
+        return val;
+    }
+
+    uint64_t read_unsigned(const detail::item_header& h) const
+    {
+        switch (h.length)
+        {
+            case 0:
+                return *first_;
+            case 1:
+                return read<uint8_t>(h.payload);
+            case 2:
+                return read<uint16_t>(h.payload);
+            case 4:
+                return read<uint32_t>(h.payload);
+            default:
+                return read<uint64_t>(h.payload);
+        }
+    }
+
+    int64_t read_signed(const detail::item_header& h) const
+    {
+        switch (h.length)
+        {
+            case 0:
+                return static_cast<int8_t>(*first_);
+            case 1:
+                return read<int8_t>(h.payload);
+            case 2:
+                return read<int16_t>(h.payload);
+            case 4:
+                return read<int32_t>(h.payload);
+            default:
+                return read<int64_t>(h.payload);
+        }
+    }
+
+    // Sets *val to the start of the value of the first member with the given key
+    bool find(const string_view_type& key, const uint8_t** val) const
+    {
+        detail::item_header h = header();
+        JSONCONS_ASSERT(h.type == msgpack_item_type::map);
+
+        const uint8_t* it = h.payload;
+        for (size_t i = 0; i < h.length; ++i)
+        {
+            detail::item_header kh = detail::get_item_header(it, last_);
+            const uint8_t* next = skip(it);
+            if (kh.type == msgpack_item_type::string && kh.length == key.length() &&
+                memcmp(kh.payload, key.data(), key.length()) == 0)
+            {
+                *val = next;
+                return true;
+            }
+            it = skip(next);
+        }
+        return false;
+    }
+};
+
+template<class Json>
+typename std::enable_if<std::is_same<typename Json::char_type,char>::value,Json>::type
+decode_msgpack(const msgpack_view& v)
+{
+    jsoncons::json_decoder<Json> decoder;
+    v.dump(decoder);
+    return decoder.get_result();
+}
+
+template<class Json>
+typename std::enable_if<!std::is_same<typename Json::char_type,char>::value,Json>::type
+decode_msgpack(const msgpack_view& v)
+{
+    jsoncons::json_decoder<Json> decoder;
+    basic_utf8_adaptor<typename Json::char_type> adaptor(decoder);
+    v.dump(adaptor);
+    return decoder.get_result();
+}
+
+}}
+
+#endif
@@ -0,0 +1,139 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <sstream>
+#include <vector>
+
+using namespace jsoncons;
+using namespace jsoncons::cbor;
+
+TEST_CASE("cbor_index lookup")
+{
+    ojson j = ojson::parse(R"(
+    {
+        "application": "hiking",
+        "reputons": [
+            {"rater": "HikingAsylum.example.com", "rating": 0.90},
+            {"rater": "RockClimbing.example.com", "rating": 0.75, "tags": [1,[2,3],{"a":null}]}
+        ],
+        "empty": {},
+        "none": []
+    }
+    )");
+
+    std::vector<uint8_t> buffer;
+    encode_cbor(j, buffer);
+
+    cbor_index index(buffer);
+    cbor_view v(index);
+
+    CHECK(v.size() == 4);
+    CHECK(v.at("application").as<std::string>() == "hiking");
+    CHECK(v.contains("reputons"));
+    CHECK_FALSE(v.contains("rating"));
+    CHECK_THROWS(v.at("rating"));
+
+    cbor_view reputons = v.at("reputons");
+    CHECK(reputons.size() == 2);
+    CHECK(reputons.at(0).at("rater").as<std::string>() == "HikingAsylum.example.com");
+    CHECK(reputons[1].at("rating").as<double>() == 0.75);
+    CHECK_THROWS(reputons.at(2));
+
+    cbor_view tags = reputons[1].at("tags");
+    CHECK(tags.size() == 3);
+    CHECK(tags[1][1].as<int>() == 3);
+    CHECK(tags[2].at("a").is_null());
+
+    CHECK(v.at("empty").size() == 0);
+    CHECK_FALSE(v.at("empty").contains("a"));
+    CHECK(v.at("none").size() == 0);
+
+    CHECK(decode_cbor<ojson>(reputons) == j["reputons"]);
+}
+
+TEST_CASE("cbor_index agrees with unindexed view")
+{
+    json j;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        json item;
+        item["id"] = i;
+        item["name"] = "item" + std::to_string(i);
+        j["key" + std::to_string(i)] = std::move(item);
+    }
+
+    std::vector<uint8_t> buffer;
+    encode_cbor(j, buffer);
+
+    cbor_index index(buffer);
+    cbor_view indexed(index);
+    cbor_view walked(buffer);
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        std::string key = "key" + std::to_string(i);
+        CHECK(indexed.at(key).at("name").as<std::string>() == walked.at(key).at("name").as<std::string>());
+        CHECK(indexed.at(key).at("id").as<size_t>() == i);
+    }
+}
+
+TEST_CASE("cbor_index indefinite length and tagged items")
+{
+    // {_ "a": [_ 1, 2], "b": 0("2018-10-18T00:00:00Z")}
+    std::vector<uint8_t> buffer = {0xbf,
+                                   0x61,'a',0x9f,0x01,0x02,0xff,
+                                   0x61,'b',0xc0,0x74,'2','0','1','8','-','1','0','-','1','8','T','0','0',':','0','0',':','0','0','Z',
+                                   0xff};
+    cbor_index index(buffer);
+    cbor_view v(index);
+
+    CHECK(v.size() == 2);
+    CHECK(v.at("a").size() == 2);
+    CHECK(v.at("a")[1].as<int>() == 2);
+    CHECK(v.at("b").as<std::string>() == "2018-10-18T00:00:00Z");
+}
+
+TEST_CASE("cbor_index map with non text keys")
+{
+    // {1: "one", "b": 2}
+    std::vector<uint8_t> buffer = {0xa2,0x01,0x63,'o','n','e',0x61,'b',0x02};
+    cbor_index index(buffer);
+    cbor_view v(index);
+
+    // Maps without a key table are walked, as they are without an index
+    CHECK(v.size() == 2);
+    CHECK_THROWS(v.at("b"));
+    CHECK_THROWS(cbor_view(buffer).at("b"));
+}
+
+TEST_CASE("cbor_index malformed buffer")
+{
+    SECTION("truncated array")
+    {
+        std::vector<uint8_t> buffer = {0x82,0x01};
+        CHECK_THROWS(cbor_index(buffer));
+    }
+    SECTION("truncated map")
+    {
+        std::vector<uint8_t> buffer = {0xa1};
+        CHECK_THROWS_AS(cbor_index(buffer), cbor_decode_error);
+    }
+    SECTION("truncated key")
+    {
+        std::vector<uint8_t> buffer = {0xa1,0x63,'a','b'};
+        CHECK_THROWS_AS(cbor_index(buffer), cbor_decode_error);
+    }
+    SECTION("truncated value")
+    {
+        std::vector<uint8_t> buffer = {0xa1,0x61,'a'};
+        CHECK_THROWS_AS(cbor_index(buffer), cbor_decode_error);
+    }
+    SECTION("truncated nested value")
+    {
+        std::vector<uint8_t> buffer = {0xa1,0x61,'a',0x19,0x01};
+        CHECK_THROWS_AS(cbor_index(buffer), cbor_decode_error);
+    }
+}
@@ -0,0 +1,171 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace jsoncons;
+using namespace jsoncons::cbor;
+
+namespace {
+
+std::string to_string(const std::vector<uint8_t>& v)
+{
+    return std::string(reinterpret_cast<const char*>(v.data()), v.size());
+}
+
+}
+
+TEST_CASE("cbor_reader chunked input")
+{
+    ojson j = ojson::parse(R"(
+    {
+        "name" : "The quick brown fox jumps over the lazy dog",
+        "values" : [1, -2, 3.5, true, false, null, [], {}],
+        "nested" : {"a" : [[1,2],[3,4]], "b" : "text"}
+    }
+    )");
+    std::vector<uint8_t> v;
+    encode_cbor(j, v);
+    // Indefinite length array of a decimal fraction, a bignum and an indefinite length map
+    std::vector<uint8_t> w = {0x9f,0xc4,0x82,0x21,0x19,0x6a,0xb3,0xc2,0x49,0x01,0,0,0,0,0,0,0,0,
+                              0xbf,0x61,0x61,0x7f,0x62,0x78,0x79,0x61,0x7a,0xff,0xff,0xff};
+
+    for (size_t length = 1; length <= 17; ++length)
+    {
+        std::istringstream is(to_string(v));
+        json_decoder<ojson> decoder;
+        cbor_reader reader(is, decoder);
+        reader.buffer_length(length);
+        reader.read();
+        CHECK(decoder.get_result() == j);
+
+        std::istringstream is2(to_string(w));
+        json_decoder<json> decoder2;
+        cbor_reader reader2(is2, decoder2);
+        reader2.buffer_length(length);
+        reader2.read();
+        CHECK(decoder2.get_result() == decode_cbor<json>(w));
+    }
+}
+
+TEST_CASE("cbor_reader sequence")
+{
+    std::vector<json> items = {json(1), json("two"), json::parse("[3,[4]]"), json::parse("{\"five\":5}")};
+    std::string s;
+    for (const auto& item : items)
+    {
+        std::vector<uint8_t> v;
+        encode_cbor(item, v);
+        s.append(to_string(v));
+    }
+
+    SECTION("read_next until eof")
+    {
+        std::istringstream is(s);
+        json_decoder<json> decoder;
+        cbor_reader reader(is, decoder);
+        reader.buffer_length(3);
+
+        std::vector<json> result;
+        while (!reader.eof())
+        {
+            reader.read_next();
+            result.push_back(decoder.get_result());
+        }
+        CHECK(result == items);
+    }
+
+    SECTION("read reports the data after the first item")
+    {
+        std::istringstream is(s);
+        json_decoder<json> decoder;
+        cbor_reader reader(is, decoder);
+
+        std::error_code ec;
+        reader.read(ec);
+        CHECK(ec == cbor_parse_errc::extra_data);
+    }
+}
+
+TEST_CASE("cbor_reader large items")
+{
+    SECTION("array with a four byte length")
+    {
+        json j = json::array();
+        for (size_t i = 0; i < 70000; ++i)
+        {
+            j.push_back(i % 100);
+        }
+        std::vector<uint8_t> v;
+        encode_cbor(j, v);
+        REQUIRE(v[0] == 0x9a);
+
+        std::istringstream is(to_string(v));
+        json result = decode_cbor<json>(is);
+        CHECK(result == j);
+    }
+
+    SECTION("string longer than the buffer")
+    {
+        json j = json::array();
+        j.push_back(std::string(1000, 'a'));
+        j.push_back(std::string(5000, 'b'));
+
+        std::vector<uint8_t> v;
+        encode_cbor(j, v);
+
+        std::istringstream is(to_string(v));
+        json_decoder<json> decoder;
+        cbor_reader reader(is, decoder);
+        reader.buffer_length(16);
+        reader.read();
+        CHECK(decoder.get_result() == j);
+    }
+}
+
+TEST_CASE("cbor_reader errors")
+{
+    SECTION("empty input")
+    {
+        std::istringstream is("");
+        cbor_reader reader(is);
+        std::error_code ec;
+        reader.read_next(ec);
+        CHECK(ec == cbor_parse_errc::unexpected_eof);
+    }
+
+    SECTION("truncated input")
+    {
+        std::vector<uint8_t> v;
+        encode_cbor(json::parse("[\"abc\",[1,2,3],{\"x\":4}]"), v);
+        for (size_t n = 1; n < v.size(); ++n)
+        {
+            std::istringstream is(to_string(std::vector<uint8_t>(v.begin(), v.begin() + n)));
+            cbor_reader reader(is);
+            reader.buffer_length(2);
+            std::error_code ec;
+            reader.read_next(ec);
+            CHECK(ec == cbor_parse_errc::unexpected_eof);
+        }
+    }
+
+    SECTION("truncated input throws")
+    {
+        std::istringstream is(to_string({0x83,0x01,0x02}));
+        CHECK_THROWS_AS(decode_cbor<json>(is), parse_error);
+    }
+
+    SECTION("break inside a definite length array")
+    {
+        std::istringstream is(to_string({0x82,0x01,0xff}));
+        cbor_reader reader(is);
+        std::error_code ec;
+        reader.read_next(ec);
+        CHECK(ec == cbor_parse_errc::source_error);
+    }
+}
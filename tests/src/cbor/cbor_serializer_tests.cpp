@@ -259,3 +259,80 @@ TEST_CASE("test_serialize_decimal")
     }
 } 
 
+
+TEST_CASE("cbor_serializer use_definite_length")
+{
+    cbor_serializing_options options;
+    options.use_definite_length(true);
+
+    SECTION("round trip from json text")
+    {
+        std::string s = R"({"a":[1,2,{"b":"c","d":[]}],"e":[0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24],"f":{}})";
+        std::vector<uint8_t> v;
+        cbor_bytes_serializer serializer(v, options);
+        std::istringstream is(s);
+        json_reader reader(is, serializer);
+        reader.read();
+
+        CHECK(decode_cbor<ojson>(v) == ojson::parse(s));
+        // No indefinite length headers or break bytes
+        CHECK(v[0] == 0xa3);
+        CHECK(std::find(v.begin(), v.end(), 0xff) == v.end());
+
+        cbor_view view(v);
+        CHECK(view.size() == 3);
+        CHECK(view.at("a").size() == 3);
+        CHECK(view.at("a").at(2).at("d").size() == 0);
+        CHECK(view.at("e").size() == 25);
+        CHECK(view.at("e").at(24).as<int>() == 24);
+        CHECK(view.at("f").size() == 0);
+    }
+
+    SECTION("nested containers")
+    {
+        std::vector<uint8_t> v;
+        cbor_bytes_serializer serializer(v, options);
+        serializer.begin_array();
+        serializer.begin_array();
+        serializer.begin_object();
+        serializer.name("x");
+        serializer.begin_array(2);
+        serializer.int64_value(1);
+        serializer.begin_array();
+        serializer.end_array();
+        serializer.end_array();
+        serializer.end_object();
+        serializer.end_array();
+        serializer.string_value("y");
+        serializer.end_array();
+        serializer.flush();
+
+        std::vector<uint8_t> expected = {0x82,0x81,0xa1,0x61,'x',0x82,0x01,0x80,0x61,'y'};
+        CHECK(v == expected);
+    }
+
+    SECTION("empty containers")
+    {
+        std::vector<uint8_t> v;
+        cbor_bytes_serializer serializer(v, options);
+        serializer.begin_object();
+        serializer.end_object();
+        serializer.flush();
+        CHECK(v == std::vector<uint8_t>({0xa0}));
+
+        std::vector<uint8_t> w;
+        cbor_bytes_serializer serializer2(w, options);
+        serializer2.begin_array();
+        serializer2.end_array();
+        serializer2.flush();
+        CHECK(w == std::vector<uint8_t>({0x80}));
+    }
+
+    SECTION("encode_cbor")
+    {
+        ojson j = ojson::parse(R"({"a":[1,2,3],"b":"text"})");
+        std::vector<uint8_t> v;
+        encode_cbor(j, v, options);
+        CHECK(decode_cbor<ojson>(v) == j);
+    }
+}
@@ -0,0 +1,255 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace jsoncons;
+using namespace jsoncons::cbor;
+
+namespace {
+
+std::string to_string(const std::vector<uint8_t>& v)
+{
+    return std::string(reinterpret_cast<const char*>(v.data()), v.size());
+}
+
+std::vector<uint8_t> to_cbor(const ojson& j)
+{
+    std::vector<uint8_t> v;
+    encode_cbor(j, v);
+    return v;
+}
+
+class name_filter : public stream_filter
+{
+    std::string name_;
+    bool accept_next_;
+public:
+    name_filter(const std::string& name)
+        : name_(name), accept_next_(false)
+    {
+    }
+
+    bool accept(const stream_event& event, const serializing_context&) override
+    {
+        if (event.event_type() == stream_event_type::name)
+        {
+            accept_next_ = event.as<std::string>() == name_;
+            return false;
+        }
+        if (accept_next_)
+        {
+            accept_next_ = false;
+            return true;
+        }
+        return false;
+    }
+};
+
+}
+
+TEST_CASE("cbor_stream_reader events")
+{
+    ojson j = ojson::parse(R"(
+    {
+        "name" : "Tom",
+        "values" : [1, -2, 3.5, true, null],
+        "empty" : {}
+    }
+    )");
+    std::vector<uint8_t> v = to_cbor(j);
+
+    cbor_stream_reader reader(v);
+
+    std::vector<stream_event_type> expected = {
+        stream_event_type::begin_object,
+        stream_event_type::name, stream_event_type::string_value,
+        stream_event_type::name, stream_event_type::begin_array,
+        stream_event_type::uint64_value, stream_event_type::int64_value, stream_event_type::double_value,
+        stream_event_type::bool_value, stream_event_type::null_value,
+        stream_event_type::end_array,
+        stream_event_type::name, stream_event_type::begin_object, stream_event_type::end_object,
+        stream_event_type::end_object
+    };
+
+    std::vector<stream_event_type> events;
+    REQUIRE_FALSE(reader.done());
+    CHECK(reader.current().event_type() == stream_event_type::begin_object);
+    while (!reader.done())
+    {
+        events.push_back(reader.current().event_type());
+        if (reader.current().event_type() == stream_event_type::string_value)
+        {
+            CHECK(reader.current().as<std::string>() == std::string("Tom"));
+        }
+        if (reader.current().event_type() == stream_event_type::int64_value)
+        {
+            CHECK(reader.current().as<int>() == -2);
+        }
+        reader.next();
+    }
+    CHECK(events == expected);
+}
+
+TEST_CASE("cbor_stream_reader byte string and tagged values")
+{
+    // [h'0102', 1(1363896240), c2 bignum, 4([-2, 27315])]
+    std::vector<uint8_t> v = {0x84,0x42,0x01,0x02,0xc1,0x1a,0x51,0x4b,0x67,0xb0,
+                              0xc2,0x49,0x01,0,0,0,0,0,0,0,0,
+                              0xc4,0x82,0x21,0x19,0x6a,0xb3};
+
+    cbor_stream_reader reader(v);
+    CHECK(reader.current().event_type() == stream_event_type::begin_array);
+    reader.next();
+    CHECK(reader.current().event_type() == stream_event_type::byte_string_value);
+    CHECK(reader.current().as<byte_string>() == byte_string({0x01,0x02}));
+    CHECK(reader.current().as<std::string>() == std::string("AQI"));
+    reader.next();
+    CHECK(reader.current().event_type() == stream_event_type::uint64_value);
+    CHECK(reader.current().semantic_tag() == semantic_tag_type::epoch_time);
+    reader.next();
+    CHECK(reader.current().event_type() == stream_event_type::string_value);
+    CHECK(reader.current().semantic_tag() == semantic_tag_type::bignum);
+    CHECK(reader.current().as<std::string>() == std::string("18446744073709551616"));
+    reader.next();
+    CHECK(reader.current().event_type() == stream_event_type::string_value);
+    CHECK(reader.current().semantic_tag() == semantic_tag_type::decimal);
+    CHECK(reader.current().as<std::string>() == std::string("273.15"));
+    reader.next();
+    CHECK(reader.current().event_type() == stream_event_type::end_array);
+    reader.next();
+    CHECK(reader.done());
+}
+
+TEST_CASE("cbor_stream_reader from stream in small chunks")
+{
+    ojson j = ojson::parse(R"(
+    [
+        {"id" : 1, "text" : "The quick brown fox jumps over the lazy dog"},
+        {"id" : 2, "text" : "Jackdaws love my big sphinx of quartz"}
+    ]
+    )");
+    std::vector<uint8_t> v = to_cbor(j);
+
+    for (size_t length = 1; length <= 9; ++length)
+    {
+        std::istringstream is(to_string(v));
+        name_filter filter("text");
+        cbor_stream_reader reader(is, filter);
+        reader.buffer_length(length);
+
+        std::vector<std::string> texts;
+        while (!reader.done())
+        {
+            texts.push_back(reader.current().as<std::string>());
+            reader.next();
+        }
+        REQUIRE(texts.size() == 2);
+        CHECK(texts[0] == j[0]["text"].as<std::string>());
+        CHECK(texts[1] == j[1]["text"].as<std::string>());
+    }
+}
+
+TEST_CASE("cbor_stream_reader sequence")
+{
+    std::vector<uint8_t> v = to_cbor(ojson(1));
+    std::vector<uint8_t> v2 = to_cbor(ojson::parse("[2,3]"));
+    v.insert(v.end(), v2.begin(), v2.end());
+
+    std::istringstream is(to_string(v));
+    cbor_stream_reader reader(is);
+
+    std::vector<stream_event_type> events;
+    while (!reader.done())
+    {
+        events.push_back(reader.current().event_type());
+        reader.next();
+    }
+    std::vector<stream_event_type> expected = {
+        stream_event_type::uint64_value,
+        stream_event_type::begin_array, stream_event_type::uint64_value, stream_event_type::uint64_value, stream_event_type::end_array
+    };
+    CHECK(events == expected);
+}
+
+TEST_CASE("cbor_stream_reader skip")
+{
+    ojson j = ojson::parse(R"(
+    {
+        "skipped" : {"a" : [1, [2, 3], {"b" : "c"}], "d" : 4.5},
+        "kept" : "value"
+    }
+    )");
+    j["skipped"]["long"] = std::string(1000, 'x');
+    j["skipped"]["bytes"] = ojson(byte_string({1,2,3,4,5,6,7,8,9,10}));
+    std::vector<uint8_t> v = to_cbor(j);
+
+    SECTION("from buffer")
+    {
+        cbor_stream_reader reader(v);
+        reader.next(); // name
+        CHECK(reader.current().as<std::string>() == std::string("skipped"));
+        reader.next();
+        CHECK(reader.current().event_type() == stream_event_type::begin_object);
+        reader.skip();
+        CHECK(reader.current().event_type() == stream_event_type::name);
+        CHECK(reader.current().as<std::string>() == std::string("kept"));
+        reader.skip();
+        CHECK(reader.current().as<std::string>() == std::string("value"));
+        reader.next();
+        CHECK(reader.current().event_type() == stream_event_type::end_object);
+        reader.next();
+        CHECK(reader.done());
+    }
+
+    SECTION("from stream with a buffer shorter than the skipped string")
+    {
+        std::istringstream is(to_string(v));
+        cbor_stream_reader reader(is);
+        reader.buffer_length(7);
+        reader.next();
+        reader.next();
+        reader.skip();
+        CHECK(reader.current().as<std::string>() == std::string("kept"));
+        reader.next();
+        CHECK(reader.current().as<std::string>() == std::string("value"));
+    }
+
+    SECTION("indefinite length containers")
+    {
+        // [_ {_ "a": [_ 1, 2]}, 3]
+        std::vector<uint8_t> w = {0x9f,0xbf,0x61,0x61,0x9f,0x01,0x02,0xff,0xff,0x03,0xff};
+        cbor_stream_reader reader(w);
+        reader.next();
+        CHECK(reader.current().event_type() == stream_event_type::begin_object);
+        reader.skip();
+        CHECK(reader.current().as<int>() == 3);
+        reader.next();
+        CHECK(reader.current().event_type() == stream_event_type::end_array);
+    }
+
+    SECTION("truncated input")
+    {
+        std::vector<uint8_t> w(v.begin(), v.begin() + v.size()/2);
+        cbor_stream_reader reader(w);
+        reader.next();
+        reader.next();
+        CHECK_THROWS_AS(reader.skip(), parse_error);
+    }
+}
+
+TEST_CASE("cbor_stream_reader decode")
+{
+    std::vector<uint8_t> v = to_cbor(ojson::parse(R"({"a":[1,2,3],"b":{"c":"d"}})"));
+    cbor_stream_reader reader(v);
+    reader.next();
+    reader.next();
+    std::vector<int> a = jsoncons::detail::stream_decode_traits<std::vector<int>>::decode(reader);
+    CHECK(a == std::vector<int>({1,2,3}));
+    CHECK(reader.current().event_type() == stream_event_type::name);
+}
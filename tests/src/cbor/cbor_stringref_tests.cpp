@@ -0,0 +1,198 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace jsoncons;
+using namespace jsoncons::cbor;
+
+namespace {
+
+std::string to_string(const std::vector<uint8_t>& v)
+{
+    return std::string(reinterpret_cast<const char*>(v.data()), v.size());
+}
+
+ojson make_records(size_t count)
+{
+    ojson records = ojson::array();
+    for (size_t i = 0; i < count; ++i)
+    {
+        ojson record;
+        record["timestamp"] = i;
+        record["sensor_id"] = i % 3 == 0 ? "north" : "south";
+        record["temperature"] = 20.5;
+        record["status"] = "ok";
+        records.push_back(record);
+    }
+    return records;
+}
+
+}
+
+TEST_CASE("cbor stringref encoding")
+{
+    // Example from the stringref specification
+    json j = json::parse(R"(
+    ["1", "222", "333", "4", "555", "666", "777", "888", "999",
+     "aaa", "bbb", "ccc", "ddd", "eee", "fff", "ggg", "hhh", "iii",
+     "jjj", "kkk", "lll", "mmm", "nnn", "ooo", "ppp", "qqq", "rrr",
+     "333", "ssss", "qqq", "rrr", "ssss"]
+    )");
+
+    std::vector<uint8_t> v;
+    encode_cbor(j, v, cbor_serializing_options().pack_strings(true));
+
+    std::vector<uint8_t> expected = {0xd9,0x01,0x00,0x98,0x20,
+                                     0x61,0x31, 0x63,0x32,0x32,0x32, 0x63,0x33,0x33,0x33, 0x61,0x34};
+    const char* rest[] = {"555","666","777","888","999","aaa","bbb","ccc","ddd","eee","fff","ggg",
+                          "hhh","iii","jjj","kkk","lll","mmm","nnn","ooo","ppp","qqq","rrr"};
+    for (auto s : rest)
+    {
+        expected.push_back(0x63);
+        expected.insert(expected.end(), s, s + 3);
+    }
+    std::vector<uint8_t> tail = {0xd8,0x19,0x01,                  // "333"
+                                 0x64,0x73,0x73,0x73,0x73,        // "ssss"
+                                 0xd8,0x19,0x17,                  // "qqq"
+                                 0x63,0x72,0x72,0x72,             // "rrr", too short for a reference
+                                 0xd8,0x19,0x18,0x18};            // "ssss"
+    expected.insert(expected.end(), tail.begin(), tail.end());
+    CHECK(v == expected);
+
+    CHECK(decode_cbor<json>(v) == j);
+}
+
+TEST_CASE("cbor stringref records")
+{
+    ojson j = make_records(100);
+
+    std::vector<uint8_t> plain;
+    encode_cbor(j, plain);
+    std::vector<uint8_t> packed;
+    encode_cbor(j, packed, cbor_serializing_options().pack_strings(true));
+
+    CHECK(packed.size() * 10 < plain.size() * 7);
+
+    SECTION("decode")
+    {
+        CHECK(decode_cbor<ojson>(packed) == j);
+    }
+
+    SECTION("chunked")
+    {
+        for (size_t length = 1; length <= 17; ++length)
+        {
+            std::istringstream is(to_string(packed));
+            json_decoder<ojson> decoder;
+            cbor_reader reader(is, decoder);
+            reader.buffer_length(length);
+            reader.read();
+            CHECK(decoder.get_result() == j);
+        }
+    }
+
+    SECTION("view")
+    {
+        cbor_view view(packed);
+        REQUIRE(view.is_array());
+        CHECK(view.size() == 100);
+        CHECK(view[99]["sensor_id"].as_string() == std::string("north"));
+        CHECK(view[98]["status"].as_string() == std::string("ok"));
+        CHECK(view[98].contains("temperature"));
+
+        std::vector<std::string> keys;
+        for (const auto& member : view[50].object_range())
+        {
+            keys.push_back(member.key());
+        }
+        CHECK(keys == std::vector<std::string>({"timestamp","sensor_id","temperature","status"}));
+
+        std::string s;
+        view.dump(s);
+        CHECK(ojson::parse(s) == j);
+    }
+
+    SECTION("stream reader skips")
+    {
+        std::istringstream is(to_string(packed));
+        cbor_stream_reader reader(is);
+        reader.buffer_length(5);
+        reader.next();
+        reader.skip();
+        reader.skip();
+        CHECK(reader.current().event_type() == stream_event_type::begin_object);
+        reader.next();
+        reader.next();
+        reader.next();
+        CHECK(reader.current().as<std::string>() == std::string("sensor_id"));
+        reader.next();
+        CHECK(reader.current().as<std::string>() == std::string("south"));
+    }
+}
+
+TEST_CASE("cbor stringref byte strings and tagged values")
+{
+    ojson j = ojson::array();
+    j.push_back(ojson(byte_string({1,2,3,4})));
+    j.push_back(ojson(bignum("18446744073709551616")));
+    j.push_back(ojson(byte_string({1,2,3,4})));
+    j.push_back(ojson("2018-10-18T12:00:00Z", semantic_tag_type::date_time));
+    j.push_back(ojson("2018-10-18T12:00:00Z", semantic_tag_type::date_time));
+
+    std::vector<uint8_t> packed;
+    encode_cbor(j, packed, cbor_serializing_options().pack_strings(true));
+    CHECK(decode_cbor<ojson>(packed) == j);
+
+    cbor_view view(packed);
+    CHECK(view[2].as_byte_string() == byte_string({1,2,3,4}));
+    CHECK(view[4].as_string() == std::string("2018-10-18T12:00:00Z"));
+}
+
+TEST_CASE("cbor stringref nested namespaces")
+{
+    // 256(["aaa", 25(0), 256(["bbb", "aaa", 25(1)]), 256(["ccc", 25(0)]), 25(0)])
+    std::vector<uint8_t> v = {0xd9,0x01,0x00,0x85,0x63,0x61,0x61,0x61,0xd8,0x19,0x00,
+                              0xd9,0x01,0x00,0x83,0x63,0x62,0x62,0x62,0x63,0x61,0x61,0x61,0xd8,0x19,0x01,
+                              0xd9,0x01,0x00,0x82,0x63,0x63,0x63,0x63,0xd8,0x19,0x00,
+                              0xd8,0x19,0x00};
+    json expected = json::parse(R"(["aaa","aaa",["bbb","aaa","aaa"],["ccc","ccc"],"aaa"])");
+
+    CHECK(decode_cbor<json>(v) == expected);
+
+    cbor_view view(v);
+    CHECK(view[2][2].as_string() == std::string("aaa"));
+    CHECK(view[3][1].as_string() == std::string("ccc"));
+    CHECK(view[4].as_string() == std::string("aaa"));
+
+    cbor_stream_reader reader(v);
+    reader.next();
+    reader.next();
+    reader.next();
+    CHECK(reader.current().event_type() == stream_event_type::begin_array);
+    reader.skip();
+    reader.skip();
+    CHECK(reader.current().as<std::string>() == std::string("aaa"));
+}
+
+TEST_CASE("cbor stringref errors")
+{
+    SECTION("reference outside a namespace")
+    {
+        std::vector<uint8_t> v = {0x82,0x63,0x61,0x61,0x61,0xd8,0x19,0x00};
+        CHECK_THROWS_AS(decode_cbor<json>(v), parse_error);
+    }
+
+    SECTION("index out of range")
+    {
+        std::vector<uint8_t> v = {0xd9,0x01,0x00,0x82,0x63,0x61,0x61,0x61,0xd8,0x19,0x01};
+        CHECK_THROWS_AS(decode_cbor<json>(v), parse_error);
+        cbor_view view(v);
+        CHECK_THROWS(view[1].as_string());
+    }
+}
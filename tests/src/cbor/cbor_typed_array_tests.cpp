@@ -0,0 +1,240 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace jsoncons;
+using namespace jsoncons::cbor;
+
+namespace {
+
+std::string to_string(const std::vector<uint8_t>& v)
+{
+    return std::string(reinterpret_cast<const char*>(v.data()), v.size());
+}
+
+uint8_t native_tag(uint8_t big_endian_tag)
+{
+    return binary::is_little_endian() ? static_cast<uint8_t>(big_endian_tag + 4) : big_endian_tag;
+}
+
+std::vector<uint8_t> to_cbor(const json& j)
+{
+    std::vector<uint8_t> v;
+    encode_cbor(j, v, cbor_serializing_options().use_typed_arrays(true));
+    return v;
+}
+
+}
+
+TEST_CASE("cbor typed array encoding")
+{
+    SECTION("float64")
+    {
+        std::vector<double> values = {1.1, -2.5, 3.0e100, 0.0};
+        std::vector<uint8_t> v = to_cbor(json(values));
+        REQUIRE(v.size() == 4 + 32);
+        CHECK(v[0] == 0xd8);
+        CHECK(v[1] == native_tag(82));
+        CHECK(v[2] == 0x58);
+        CHECK(v[3] == 32);
+        CHECK(decode_cbor<json>(v) == json(values));
+    }
+
+    SECTION("float32 when lossless")
+    {
+        std::vector<double> values = {1.5, -2.25, 0.0};
+        std::vector<uint8_t> v = to_cbor(json(values));
+        CHECK(v[1] == native_tag(81));
+        CHECK(v[2] == 0x4c);
+        CHECK(decode_cbor<json>(v) == json(values));
+    }
+
+    SECTION("smallest integer element type")
+    {
+        CHECK(to_cbor(json::parse("[1,2,255]"))[1] == 64);
+        CHECK(to_cbor(json::parse("[1,2,256]"))[1] == native_tag(65));
+        CHECK(to_cbor(json::parse("[1,2,65536]"))[1] == native_tag(66));
+        CHECK(to_cbor(json::parse("[1,-2,127]"))[1] == 72);
+        CHECK(to_cbor(json::parse("[1,-2,128]"))[1] == native_tag(73));
+        CHECK(to_cbor(json::parse("[1,-2,32768]"))[1] == native_tag(74));
+        CHECK(to_cbor(json::parse("[1,-2,2147483648]"))[1] == native_tag(75));
+        CHECK(to_cbor(json::parse("[1,2,4294967296]"))[1] == native_tag(75));
+
+        std::vector<int64_t> values = {1, -2, 2147483648, -9223372036854775807};
+        CHECK(decode_cbor<json>(to_cbor(json(values))) == json(values));
+    }
+
+    SECTION("mixed arrays are written as ordinary arrays")
+    {
+        json j = json::parse(R"([[1,2.5],[1,"a",3],[],[true],[1,[2,"b"]],{"a":[null,2.5]}])");
+        std::vector<uint8_t> plain;
+        encode_cbor(j, plain);
+        std::vector<uint8_t> v = to_cbor(j);
+        CHECK(v == plain);
+        CHECK(decode_cbor<json>(v) == j);
+    }
+
+    SECTION("nested in maps and arrays")
+    {
+        ojson j = ojson::parse(R"({"x":[1.5,2.5,3.5],"y":[[1,2],[3,4]],"z":"end"})");
+        std::vector<uint8_t> v;
+        encode_cbor(j, v, cbor_serializing_options().use_typed_arrays(true).use_definite_length(true));
+        CHECK(decode_cbor<ojson>(v) == j);
+    }
+
+    SECTION("arrays begun without a length")
+    {
+        std::string s = R"({"a":[],"b":[1,2],"c":[[],[0.5]]})";
+        std::vector<uint8_t> v;
+        cbor_bytes_serializer serializer(v, cbor_serializing_options().use_typed_arrays(true));
+        std::istringstream is(s);
+        json_reader reader(is, serializer);
+        reader.read();
+        CHECK(decode_cbor<ojson>(v) == ojson::parse(s));
+    }
+
+    SECTION("with pack_strings")
+    {
+        json j = json::array();
+        j.push_back(json(std::vector<int64_t>{1,2,3}));
+        j.push_back(json(std::vector<int64_t>{1,2,3}));
+        std::vector<uint8_t> v;
+        encode_cbor(j, v, cbor_serializing_options().use_typed_arrays(true).pack_strings(true));
+        CHECK(decode_cbor<json>(v) == j);
+    }
+}
+
+TEST_CASE("cbor typed array decoding")
+{
+    SECTION("big endian int16")
+    {
+        // 73(h'0001FFFE8000')
+        std::vector<uint8_t> v = {0xd8,73,0x46,0x00,0x01,0xff,0xfe,0x80,0x00};
+        CHECK(decode_cbor<json>(v) == json::parse("[1,-2,-32768]"));
+
+        cbor_view view(v);
+        CHECK(view.is_array());
+        CHECK(view.size() == 3);
+        CHECK(view.is_typed_array<int64_t>());
+        CHECK_FALSE(view.is_typed_array<double>());
+        CHECK(view.as<std::vector<int64_t>>() == std::vector<int64_t>({1,-2,-32768}));
+        CHECK(view.as<std::vector<double>>() == std::vector<double>({1.0,-2.0,-32768.0}));
+    }
+
+    SECTION("little endian uint32")
+    {
+        // 70(h'01000000FFFFFFFF')
+        std::vector<uint8_t> v = {0xd8,70,0x48,0x01,0,0,0,0xff,0xff,0xff,0xff};
+        CHECK(decode_cbor<json>(v) == json::parse("[1,4294967295]"));
+    }
+
+    SECTION("big endian float16")
+    {
+        // 80(h'3C00C000')
+        std::vector<uint8_t> v = {0xd8,80,0x44,0x3c,0x00,0xc0,0x00};
+        CHECK(decode_cbor<json>(v) == json::parse("[1.0,-2.0]"));
+        cbor_view view(v);
+        CHECK(view.as<std::vector<double>>() == std::vector<double>({1.0,-2.0}));
+
+        std::string s;
+        view.dump(s);
+        CHECK(json::parse(s) == json::parse("[1.0,-2.0]"));
+    }
+
+    SECTION("length not a multiple of the element size")
+    {
+        std::vector<uint8_t> v = {0xd8,73,0x43,0x00,0x01,0xff};
+        CHECK_THROWS_AS(decode_cbor<json>(v), parse_error);
+    }
+}
+
+TEST_CASE("cbor typed array view")
+{
+    std::vector<double> x = {1.1, 2.2, 3.3, 4.4, 5.5, 6.6, 7.7, 8.8, 9.9};
+    std::vector<int64_t> y = {-1, 100000, 3};
+    ojson j;
+    j["x"] = ojson(x);
+    j["y"] = ojson(y);
+    std::vector<uint8_t> v;
+    encode_cbor(j, v, cbor_serializing_options().use_typed_arrays(true));
+
+    cbor_view view(v);
+    CHECK(view["x"].is_typed_array());
+    CHECK(view["x"].size() == x.size());
+    CHECK(view["x"].as<std::vector<double>>() == x);
+    CHECK(view["y"].as<std::vector<int64_t>>() == y);
+
+    auto r = view["y"].typed_array_range<int64_t>();
+    CHECK(std::vector<int64_t>(r.begin(), r.end()) == y);
+    CHECK_THROWS(view["y"].typed_array_range<double>());
+    CHECK_THROWS(view["y"].array_range());
+
+    std::string s;
+    view.dump(s);
+    CHECK(ojson::parse(s) == j);
+}
+
+TEST_CASE("cbor typed array readers")
+{
+    json j = json::array();
+    j.push_back(json(std::vector<double>{1.1, 2.2, 3.3}));
+    j.push_back(json("next"));
+    j.push_back(json(std::vector<int64_t>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+    std::vector<uint8_t> v = to_cbor(j);
+
+    SECTION("chunked")
+    {
+        for (size_t length = 1; length <= 9; ++length)
+        {
+            std::istringstream is(to_string(v));
+            json_decoder<json> decoder;
+            cbor_reader reader(is, decoder);
+            reader.buffer_length(length);
+            reader.read();
+            CHECK(decoder.get_result() == j);
+        }
+    }
+
+    SECTION("packed into a json typed array")
+    {
+        typedef basic_json<char,typed_array_policy,std::allocator<char>> tjson;
+        tjson result = decode_cbor<tjson>(v);
+        CHECK(result[2].is_typed_array<int64_t>());
+        CHECK(result[2].as<std::vector<int64_t>>() == j[2].as<std::vector<int64_t>>());
+    }
+
+    SECTION("stream reader")
+    {
+        cbor_stream_reader reader(v);
+        reader.next();
+        CHECK(reader.current().event_type() == stream_event_type::begin_array);
+        reader.next();
+        CHECK(reader.current().event_type() == stream_event_type::double_value);
+        CHECK(reader.current().as<double>() == 1.1);
+        reader.next();
+        reader.next();
+        reader.next();
+        CHECK(reader.current().event_type() == stream_event_type::end_array);
+        reader.next();
+        CHECK(reader.current().as<std::string>() == std::string("next"));
+        reader.next();
+        reader.skip();
+        CHECK(reader.current().event_type() == stream_event_type::end_array);
+        reader.next();
+        CHECK(reader.done());
+    }
+
+    SECTION("stream reader skips a typed array")
+    {
+        cbor_stream_reader reader(v);
+        reader.next();
+        reader.skip();
+        CHECK(reader.current().as<std::string>() == std::string("next"));
+    }
+}
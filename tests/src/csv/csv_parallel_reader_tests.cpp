@@ -0,0 +1,167 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons_ext/csv/csv_reader.hpp>
+#include <jsoncons_ext/csv/csv_parallel_reader.hpp>
+#include <jsoncons/json.hpp>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace jsoncons;
+using namespace jsoncons::csv;
+
+namespace {
+
+std::string make_records(size_t count)
+{
+    std::string s = "id,name,note,amount\r\n";
+    for (size_t i = 0; i < count; ++i)
+    {
+        s += std::to_string(i);
+        s += ",name";
+        s += std::to_string(i % 7);
+        switch (i % 4)
+        {
+            case 0:
+                s += ",\"quoted, with a comma\"";
+                break;
+            case 1:
+                s += ",\"spans\r\ntwo lines\"";
+                break;
+            case 2:
+                s += ",\"has \"\"quotes\"\"\"";
+                break;
+            default:
+                s += ",plain";
+                break;
+        }
+        s += ",";
+        s += std::to_string(i * 0.5);
+        s += (i % 5 == 0 || i % 11 == 0) ? "\n" : "\r\n";
+        if (i % 11 == 0)
+        {
+            s += "#comment with a \" quote\n";
+        }
+    }
+    return s;
+}
+
+ojson read_sequential(const std::string& s, const csv_serializing_options& options)
+{
+    std::istringstream is(s);
+    json_decoder<ojson> decoder;
+    csv_reader reader(is, decoder, options);
+    reader.read();
+    return decoder.get_result();
+}
+
+ojson read_parallel(const std::string& s, const csv_serializing_options& options, size_t num_threads)
+{
+    std::istringstream is(s);
+    json_decoder<ojson> decoder;
+    csv_parallel_reader reader(is, decoder, options);
+    reader.num_threads(num_threads);
+    reader.min_chunk_length(16);
+    reader.read();
+    return decoder.get_result();
+}
+
+}
+
+TEST_CASE("csv_parallel_reader matches csv_reader")
+{
+    std::string s = make_records(200);
+
+    csv_serializing_options options;
+    options.assume_header(true)
+           .comment_starter('#');
+
+    SECTION("n_objects")
+    {
+        options.mapping(mapping_type::n_objects);
+        ojson expected = read_sequential(s, options);
+        REQUIRE(expected.size() == 200);
+        for (size_t num_threads = 1; num_threads <= 9; ++num_threads)
+        {
+            CHECK(read_parallel(s, options, num_threads) == expected);
+        }
+        CHECK(decode_csv_parallel<ojson>(s, options, 4, 16) == expected);
+    }
+
+    SECTION("n_rows")
+    {
+        options.mapping(mapping_type::n_rows);
+        ojson expected = read_sequential(s, options);
+        REQUIRE(expected.size() == 201);
+        CHECK(read_parallel(s, options, 5) == expected);
+        CHECK(decode_csv_parallel<ojson>(s, options, 5, 16) == expected);
+    }
+
+    SECTION("m_columns")
+    {
+        options.mapping(mapping_type::m_columns);
+        ojson expected = read_sequential(s, options);
+        REQUIRE(expected["id"].size() == 200);
+        CHECK(read_parallel(s, options, 3) == expected);
+        CHECK(decode_csv_parallel<ojson>(s, options, 3, 16) == expected);
+    }
+
+    SECTION("selected columns")
+    {
+        options.selected_columns("note,0");
+        for (auto mapping : {mapping_type::n_rows, mapping_type::n_objects, mapping_type::m_columns})
+        {
+            options.mapping(mapping);
+            CHECK(read_parallel(s, options, 4) == read_sequential(s, options));
+        }
+    }
+}
+
+TEST_CASE("csv_parallel_reader without a header")
+{
+    std::string s = "1,a\n2,b\n3,\"c\nd\"\n4,e\n5,f";
+
+    csv_serializing_options options;
+    options.column_names("n,s");
+
+    SECTION("n_objects")
+    {
+        ojson expected = ojson::parse(R"([{"n":1,"s":"a"},{"n":2,"s":"b"},{"n":3,"s":"c\nd"},{"n":4,"s":"e"},{"n":5,"s":"f"}])");
+        CHECK(read_sequential(s, options) == expected);
+        CHECK(read_parallel(s, options, 4) == expected);
+    }
+
+    SECTION("m_columns")
+    {
+        options.mapping(mapping_type::m_columns);
+        ojson expected = ojson::parse(R"({"n":[1,2,3,4,5],"s":["a","b","c\nd","e","f"]})");
+        CHECK(read_sequential(s, options) == expected);
+        CHECK(read_parallel(s, options, 4) == expected);
+    }
+}
+
+TEST_CASE("csv_parallel_reader escape character")
+{
+    std::string s = "'a\\'b\nc',1\nd,2\n'e\\'\nf',3\ng,4\n";
+
+    csv_serializing_options options;
+    options.quote_char('\'')
+           .quote_escape_char('\\')
+           .mapping(mapping_type::n_rows);
+
+    ojson expected = read_sequential(s, options);
+    REQUIRE(expected.size() == 4);
+    CHECK(read_parallel(s, options, 4) == expected);
+}
+
+TEST_CASE("csv_parallel_reader unterminated quote")
+{
+    std::string s = "a,b\n1,2\n3,\"4\n5,6\n7,8\n9,10\n";
+
+    csv_serializing_options options;
+    options.assume_header(true);
+
+    CHECK(read_parallel(s, options, 4) == read_sequential(s, options));
+}
@@ -0,0 +1,133 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons_ext/csv/csv_reader.hpp>
+#include <jsoncons/json.hpp>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace jsoncons;
+using namespace jsoncons::csv;
+
+namespace {
+
+ojson read_in_chunks(const std::string& s, const csv_serializing_options& options, size_t length)
+{
+    std::istringstream is(s);
+    json_decoder<ojson> decoder;
+    csv_reader reader(is, decoder, options);
+    reader.buffer_length(length);
+    reader.read();
+    return decoder.get_result();
+}
+
+}
+
+TEST_CASE("csv parser long fields")
+{
+    const std::string s = "name,description,amount\n"
+                          "#comment line longer than a word\n"
+                          "  Jane Roe  ,\"A \"\"quoted\"\" description, with a comma\",12345678901\r\n"
+                          "John Doe,\"Spans\nlines\",-1.5\r\n"
+                          "a,b;c;dddddddddddd,3\n";
+
+    csv_serializing_options options;
+    options.assume_header(true)
+           .comment_starter('#')
+           .subfield_delimiter(';')
+           .trim(true);
+
+    ojson expected = ojson::parse(R"(
+    [
+        {"name":"Jane Roe","description":"A \"quoted\" description, with a comma","amount":12345678901},
+        {"name":"John Doe","description":"Spans\nlines","amount":-1.5},
+        {"name":"a","description":["b","c","dddddddddddd"],"amount":3}
+    ]
+    )");
+
+    for (size_t length = 1; length <= 19; ++length)
+    {
+        CHECK(read_in_chunks(s, options, length) == expected);
+    }
+    CHECK(read_in_chunks(s, options, 16384) == expected);
+}
+
+TEST_CASE("csv parser other delimiters")
+{
+    const std::string s = "'first\tfield'\tsecond field with spaces\tthird|value\n"
+                          "'it''s'\t\t12345678\n";
+
+    csv_serializing_options options;
+    options.field_delimiter('\t')
+           .quote_char('\'')
+           .quote_escape_char('\'')
+           .mapping(mapping_type::n_rows);
+
+    ojson expected = ojson::parse(R"(
+    [
+        ["first\tfield","second field with spaces","third|value"],
+        ["it's","",12345678]
+    ]
+    )");
+
+    for (size_t length = 1; length <= 11; ++length)
+    {
+        CHECK(read_in_chunks(s, options, length) == expected);
+    }
+}
+
+TEST_CASE("csv parser line and column numbers")
+{
+    const std::string s = "abcdefghijklmnop,qrstuvwxyz\n\"0123456789\",x";
+
+    json_decoder<ojson> decoder;
+    csv_serializing_options options;
+    options.mapping(mapping_type::n_rows);
+    csv_parser parser(decoder, options);
+    parser.reset();
+    parser.update(s.data(), s.length());
+    parser.parse_some();
+    CHECK(parser.line_number() == 2);
+    CHECK(parser.column_number() == 15);
+    parser.update(s.data(), 0);
+    parser.end_parse();
+    CHECK(decoder.get_result() == ojson::parse(R"([["abcdefghijklmnop","qrstuvwxyz"],["0123456789","x"]])"));
+}
+
+TEST_CASE("csv parser infer_types_sample_rows")
+{
+    // After two rows, "a" is locked to integers and "b" to fixed point numbers
+    const std::string s = "a,b,c\n"
+                          "1,1.5,x\n"
+                          "-20,-0.25,2\n"
+                          "0,3,y\n"
+                          "-0,0.125,3.5\n"
+                          "007,1.,null\n"
+                          "12345678901234567890123,-.5,true\n"
+                          "1.5,1e3,\n"
+                          "-,00.5,-1\n"
+                          ",12.000,z\n"
+                          "x,\"2.5\",\n";
+
+    csv_serializing_options options;
+    options.assume_header(true);
+    ojson expected = read_in_chunks(s, options, 16384);
+    CHECK(expected[0]["a"].is_uint64());
+    CHECK(expected[1]["b"].as<double>() == -0.25);
+    CHECK(expected[4]["a"].is_string());
+    CHECK(expected[8]["b"].is_double());
+
+    options.infer_types_sample_rows(2);
+    for (size_t length = 1; length <= 7; ++length)
+    {
+        ojson result = read_in_chunks(s, options, length);
+        CHECK(result == expected);
+        CHECK(result.to_string() == expected.to_string());
+    }
+
+    options.mapping(mapping_type::m_columns);
+    ojson columns = read_in_chunks(s, options, 16384);
+    CHECK(columns.to_string() == read_in_chunks(s, options.infer_types_sample_rows(0), 16384).to_string());
+}
@@ -0,0 +1,159 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons_ext/csv/csv_reader.hpp>
+#include <jsoncons/json.hpp>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace jsoncons;
+using namespace jsoncons::csv;
+
+namespace {
+
+ojson read_in_chunks(const std::string& s, const csv_serializing_options& options, size_t length)
+{
+    std::istringstream is(s);
+    json_decoder<ojson> decoder;
+    csv_reader reader(is, decoder, options);
+    reader.buffer_length(length);
+    reader.read();
+    return decoder.get_result();
+}
+
+}
+
+TEST_CASE("csv selected columns")
+{
+    const std::string s = "id,name,comment,amount,flag\n"
+                          "1,Jane Roe,\"a long, quoted \"\"comment\"\"\nover two lines\",10.5,true\n"
+                          "2,John Doe,plain,-3,false\n"
+                          "3,\"Quoted, Name\",,7,null\n";
+
+    csv_serializing_options options;
+    options.assume_header(true)
+           .selected_columns("id,amount,4");
+
+    SECTION("n_objects")
+    {
+        ojson expected = ojson::parse(R"(
+        [
+            {"id":1,"amount":10.5,"flag":true},
+            {"id":2,"amount":-3,"flag":false},
+            {"id":3,"amount":7,"flag":null}
+        ]
+        )");
+        for (size_t length = 1; length <= 9; ++length)
+        {
+            CHECK(read_in_chunks(s, options, length) == expected);
+        }
+        CHECK(read_in_chunks(s, options, 16384) == expected);
+    }
+
+    SECTION("n_rows")
+    {
+        options.mapping(mapping_type::n_rows);
+        ojson expected = ojson::parse(R"(
+        [
+            ["id","amount","flag"],
+            [1,10.5,true],
+            [2,-3,false],
+            [3,7,null]
+        ]
+        )");
+        for (size_t length = 1; length <= 9; ++length)
+        {
+            CHECK(read_in_chunks(s, options, length) == expected);
+        }
+    }
+
+    SECTION("m_columns")
+    {
+        options.mapping(mapping_type::m_columns);
+        ojson expected = ojson::parse(R"(
+        {
+            "id":[1,2,3],
+            "amount":[10.5,-3,7],
+            "flag":[true,false,null]
+        }
+        )");
+        for (size_t length = 1; length <= 9; ++length)
+        {
+            CHECK(read_in_chunks(s, options, length) == expected);
+        }
+    }
+
+    SECTION("quoted and multi-line values")
+    {
+        options.selected_columns("name,comment");
+        ojson expected = ojson::parse(R"(
+        [
+            {"name":"Jane Roe","comment":"a long, quoted \"comment\"\nover two lines"},
+            {"name":"John Doe","comment":"plain"},
+            {"name":"Quoted, Name","comment":""}
+        ]
+        )");
+        CHECK(read_in_chunks(s, options, 16384) == expected);
+    }
+
+    SECTION("names that do not match a column")
+    {
+        options.selected_columns("amount,missing,99");
+        ojson expected = ojson::parse(R"([{"amount":10.5},{"amount":-3},{"amount":7}])");
+        CHECK(read_in_chunks(s, options, 16384) == expected);
+    }
+}
+
+TEST_CASE("csv selected columns without a header")
+{
+    const std::string s = "skip me,1,\"also, skipped\",a\n"
+                          "x,2,y,b\n";
+
+    SECTION("by index")
+    {
+        csv_serializing_options options;
+        options.selected_columns("1,3");
+        CHECK(read_in_chunks(s, options, 16384) == ojson::parse(R"([[1,"a"],[2,"b"]])"));
+    }
+
+    SECTION("by column name")
+    {
+        csv_serializing_options options;
+        options.column_names("c0,c1,c2,c3")
+               .selected_columns("c3");
+        CHECK(read_in_chunks(s, options, 16384) == ojson::parse(R"([{"c3":"a"},{"c3":"b"}])"));
+
+        options.mapping(mapping_type::m_columns);
+        CHECK(read_in_chunks(s, options, 16384) == ojson::parse(R"({"c3":["a","b"]})"));
+    }
+}
+
+TEST_CASE("csv selected columns and empty lines")
+{
+    // A line whose only value is in a column that is not selected is not empty
+    const std::string s = "a,b\nskipped\n\n  \nc,d\n";
+
+    csv_serializing_options options;
+    options.selected_columns("1")
+           .mapping(mapping_type::n_rows);
+    CHECK(read_in_chunks(s, options, 16384) == ojson::parse(R"([["b"],[],[],["d"]])"));
+
+    options.trim(true);
+    CHECK(read_in_chunks(s, options, 16384) == ojson::parse(R"([["b"],[],["d"]])"));
+}
+
+TEST_CASE("csv selected columns with subfields")
+{
+    const std::string s = "a,b,c\n1;2,x,3;4\n";
+
+    csv_serializing_options options;
+    options.assume_header(true)
+           .subfield_delimiter(';')
+           .selected_columns("c");
+    CHECK(read_in_chunks(s, options, 16384) == ojson::parse(R"([{"c":[3,4]}])"));
+
+    options.mapping(mapping_type::m_columns);
+    CHECK(read_in_chunks(s, options, 16384) == ojson::parse(R"({"c":[[3,4]]})"));
+}
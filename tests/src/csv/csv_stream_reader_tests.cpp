@@ -0,0 +1,216 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons_ext/csv/csv_reader.hpp>
+#include <jsoncons_ext/csv/csv_stream_reader.hpp>
+#include <jsoncons/json.hpp>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace jsoncons;
+using namespace jsoncons::csv;
+
+namespace {
+
+ojson read_with_csv_reader(const std::string& s, const csv_serializing_options& options)
+{
+    std::istringstream is(s);
+    json_decoder<ojson> decoder;
+    csv_reader reader(is, decoder, options);
+    reader.read();
+    return decoder.get_result();
+}
+
+void replay(const stream_event& event, json_content_handler& handler)
+{
+    switch (event.event_type())
+    {
+        case stream_event_type::begin_array:
+            handler.begin_array();
+            break;
+        case stream_event_type::end_array:
+            handler.end_array();
+            break;
+        case stream_event_type::begin_object:
+            handler.begin_object();
+            break;
+        case stream_event_type::end_object:
+            handler.end_object();
+            break;
+        case stream_event_type::name:
+            handler.name(event.as<string_view>());
+            break;
+        case stream_event_type::string_value:
+            handler.string_value(event.as<string_view>(), event.semantic_tag());
+            break;
+        case stream_event_type::null_value:
+            handler.null_value();
+            break;
+        case stream_event_type::bool_value:
+            handler.bool_value(event.as<bool>());
+            break;
+        case stream_event_type::int64_value:
+            handler.int64_value(event.as<int64_t>(), event.semantic_tag());
+            break;
+        case stream_event_type::uint64_value:
+            handler.uint64_value(event.as<uint64_t>(), event.semantic_tag());
+            break;
+        case stream_event_type::double_value:
+            handler.double_value(event.as<double>(), event.semantic_tag());
+            break;
+        default:
+            break;
+    }
+}
+
+ojson read_with_stream_reader(const std::string& s, const csv_serializing_options& options, size_t length)
+{
+    std::istringstream is(s);
+    csv_stream_reader reader(is, options);
+    reader.buffer_length(length);
+    json_decoder<ojson> decoder;
+    for (; !reader.done(); reader.next())
+    {
+        replay(reader.current(), decoder);
+    }
+    decoder.flush();
+    return decoder.get_result();
+}
+
+}
+
+TEST_CASE("csv_stream_reader matches csv_reader")
+{
+    const std::string s = "id,name,comment,amount\n"
+                          "1,Jane Roe,\"a long, quoted \"\"comment\"\"\r\nover two lines\",10.5\r\n"
+                          "2,John Doe,plain,-3\n"
+                          "3,\"Quoted, Name\",,7";
+
+    csv_serializing_options options;
+    options.assume_header(true);
+
+    for (auto mapping : {mapping_type::n_rows, mapping_type::n_objects, mapping_type::m_columns})
+    {
+        options.mapping(mapping);
+        ojson expected = read_with_csv_reader(s, options);
+        for (size_t length = 1; length <= 9; ++length)
+        {
+            CHECK(read_with_stream_reader(s, options, length) == expected);
+        }
+        CHECK(read_with_stream_reader(s, options, 16384) == expected);
+    }
+}
+
+TEST_CASE("csv_stream_reader reads a record at a time")
+{
+    const std::string s = "a,b\n1,x\n2,y\n3,z\n";
+
+    csv_serializing_options options;
+    options.assume_header(true);
+
+    std::istringstream is(s);
+    csv_stream_reader reader(is, options);
+    reader.buffer_length(1);
+
+    REQUIRE_FALSE(reader.done());
+    CHECK(reader.current().event_type() == stream_event_type::begin_array);
+    reader.next();
+    CHECK(reader.current().event_type() == stream_event_type::begin_object);
+    reader.next();
+    CHECK(reader.current().event_type() == stream_event_type::name);
+    CHECK(reader.current().as<std::string>() == std::string("a"));
+    reader.next();
+    CHECK(reader.current().as<int>() == 1);
+    reader.next();
+    reader.next();
+    CHECK(reader.current().as<std::string>() == std::string("x"));
+    reader.next();
+    CHECK(reader.current().event_type() == stream_event_type::end_object);
+
+    // Only the first record has been parsed
+    CHECK(reader.line_number() == 3);
+    CHECK_FALSE(reader.eof());
+}
+
+TEST_CASE("csv_stream_reader stop early")
+{
+    std::string s = "n\n";
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        s += std::to_string(i);
+        s += "\n";
+    }
+
+    csv_serializing_options options;
+    options.assume_header(true)
+           .mapping(mapping_type::n_rows);
+
+    std::istringstream is(s);
+    csv_stream_reader reader(is, options);
+    reader.buffer_length(16);
+
+    int64_t sum = 0;
+    for (; !reader.done(); reader.next())
+    {
+        const auto& event = reader.current();
+        if (event.event_type() == stream_event_type::uint64_value)
+        {
+            if (event.as<int64_t>() == 10)
+            {
+                break;
+            }
+            sum += event.as<int64_t>();
+        }
+    }
+    CHECK(sum == 45);
+    CHECK_FALSE(reader.done());
+    CHECK(is.tellg() < static_cast<std::streamoff>(s.size()));
+}
+
+namespace {
+
+class name_filter : public stream_filter
+{
+    std::string name_;
+    bool accept_next_;
+public:
+    name_filter(const std::string& name)
+        : name_(name), accept_next_(false)
+    {
+    }
+
+    bool accept(const stream_event& event, const serializing_context&) override
+    {
+        if (event.event_type() == stream_event_type::name)
+        {
+            accept_next_ = event.as<std::string>() == name_;
+            return false;
+        }
+        bool accept = accept_next_;
+        accept_next_ = false;
+        return accept;
+    }
+};
+
+}
+
+TEST_CASE("csv_stream_reader with a filter")
+{
+    const std::string s = "id,name\n1,Jane Roe\n2,\"Doe,\nJohn\"\n3,Jill\n";
+
+    csv_serializing_options options;
+    options.assume_header(true);
+
+    std::istringstream is(s);
+    name_filter filter("name");
+    csv_stream_reader reader(is, filter, options);
+
+    std::vector<std::string> names;
+    for (; !reader.done(); reader.next())
+    {
+        names.push_back(reader.current().as<std::string>());
+    }
+    CHECK(names == std::vector<std::string>({"Jane Roe","Doe,\nJohn","Jill"}));
+}
@@ -0,0 +1,124 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons_ext/csv/csv_table.hpp>
+#include <jsoncons/json.hpp>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace jsoncons;
+using namespace jsoncons::csv;
+
+TEST_CASE("csv table with column types")
+{
+    const std::string s = "id,price,active,name\n"
+                          "1,10.5,true,\"Roe, Jane\"\n"
+                          "2,n/a,0,John Doe\n"
+                          "3,-7,x,\n"
+                          "4\n";
+
+    csv_serializing_options options;
+    options.assume_header(true)
+           .column_types("integer,float,boolean,string");
+
+    std::istringstream is(s);
+    csv_table table = decode_csv_table<csv_table>(is, options);
+
+    REQUIRE(table.rows() == 4);
+    REQUIRE(table.columns().size() == 4);
+
+    const csv_column& id = table.at("id");
+    CHECK(id.type() == csv_column_type::integer_t);
+    CHECK(id.int64_values() == std::vector<int64_t>({1,2,3,4}));
+    CHECK(id.validity() == std::vector<bool>({true,true,true,true}));
+
+    const csv_column& price = table.at("price");
+    CHECK(price.type() == csv_column_type::float_t);
+    REQUIRE(price.double_values().size() == 4);
+    CHECK(price.double_values()[0] == 10.5);
+    CHECK(price.is_null(1));
+    CHECK(price.double_values()[2] == -7.0);
+    CHECK(price.is_null(3));
+
+    const csv_column& active = table.at("active");
+    CHECK(active.type() == csv_column_type::boolean_t);
+    CHECK(active.bool_values() == std::vector<bool>({true,false,false,false}));
+    CHECK(active.validity() == std::vector<bool>({true,true,false,false}));
+
+    const csv_column& name = table[3];
+    CHECK(name.type() == csv_column_type::string_t);
+    CHECK(name.string_value(0) == string_view("Roe, Jane"));
+    CHECK(name.string_value(1) == string_view("John Doe"));
+    CHECK(name.string_value(2) == string_view(""));
+    CHECK(name.is_null(3));
+    CHECK(name.string_data() == std::string("Roe, JaneJohn Doe"));
+    CHECK(name.string_offsets() == std::vector<size_t>({0,9,17,17,17}));
+
+    CHECK_FALSE(table.contains("missing"));
+    CHECK_THROWS_AS(table.at("missing"), std::out_of_range);
+}
+
+TEST_CASE("csv table without column types")
+{
+    const std::string s = "a,b\n1,2.5\n,x\n";
+
+    csv_serializing_options options;
+    options.assume_header(true);
+
+    csv_table table = decode_csv_table<csv_table>(s, options);
+    REQUIRE(table.rows() == 2);
+    CHECK(table.at("a").type() == csv_column_type::string_t);
+    CHECK(table.at("a").string_value(0) == string_view("1"));
+    CHECK(table.at("a").string_value(1) == string_view(""));
+    CHECK(table.at("b").string_value(1) == string_view("x"));
+}
+
+TEST_CASE("csv table nulls before the first value")
+{
+    const std::string s = "x,1\ny,\nz,3\n";
+
+    csv_serializing_options options;
+    options.column_names("name,n")
+           .column_types("string,integer");
+
+    csv_table table = decode_csv_table<csv_table>(s, options);
+    REQUIRE(table.rows() == 3);
+    const csv_column& n = table.at("n");
+    CHECK(n.type() == csv_column_type::integer_t);
+    CHECK(n.int64_values() == std::vector<int64_t>({1,0,3}));
+    CHECK(n.validity() == std::vector<bool>({true,false,true}));
+}
+
+TEST_CASE("csv table with selected columns")
+{
+    const std::string s = "1,skip,2.5,skip\n3,skip,4.5,skip\n";
+
+    csv_serializing_options options;
+    options.column_names("a,b,c,d")
+           .column_types("integer,string,float,string")
+           .selected_columns("c,a");
+
+    csv_table table = decode_csv_table<csv_table>(s, options);
+    REQUIRE(table.columns().size() == 2);
+    CHECK(table[0].name() == std::string("a"));
+    CHECK(table[0].int64_values() == std::vector<int64_t>({1,3}));
+    CHECK(table[1].name() == std::string("c"));
+    CHECK(table[1].double_values() == std::vector<double>({2.5,4.5}));
+}
+
+TEST_CASE("csv table without column names")
+{
+    const std::string s = "1,2\n3\n4,5,6\n";
+
+    csv_serializing_options options;
+    options.column_types("integer,integer,integer");
+
+    csv_table table = decode_csv_table<csv_table>(s, options);
+    REQUIRE(table.rows() == 3);
+    REQUIRE(table.columns().size() == 3);
+    CHECK(table[1].validity() == std::vector<bool>({true,false,true}));
+    CHECK(table[2].int64_values() == std::vector<int64_t>({0,0,6}));
+    CHECK(table[2].validity() == std::vector<bool>({false,false,true}));
+}
@@ -53,6 +53,20 @@ TEST_CASE("convert_map_test")
     CHECK(m["b"] == result["b"]);
 }
 
+TEST_CASE("convert_nested_containers_test")
+{
+    typedef std::vector<std::map<std::string,std::vector<int>>> value_type;
+    value_type v = {{{"a",{1,2}},{"b",{}}},{},{{"c",{3}}}};
+
+    std::string s;
+    jsoncons::encode_json(v,s);
+    CHECK(jsoncons::decode_json<value_type>(s) == v);
+
+    CHECK(jsoncons::decode_json<std::vector<std::string>>(std::string(R"(["x","y"])")) == std::vector<std::string>({"x","y"}));
+    CHECK_THROWS(jsoncons::decode_json<std::vector<int>>(std::string(R"({"a":1})")));
+    CHECK_THROWS(jsoncons::decode_json<std::map<std::string,int>>(std::string("[1]")));
+}
+
 TEST_CASE("convert_array_test")
 {
     std::array<double,4> v{1,2,3,4};
@@ -0,0 +1,132 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <sstream>
+#include <vector>
+#include <thread>
+
+using namespace jsoncons;
+
+typedef basic_json<char,copy_on_write_policy,std::allocator<char>> cjson;
+
+TEST_CASE("copy on write copies share storage")
+{
+    const cjson a = cjson::parse(R"({"a":{"b":[1,2,3]},"c":"A string too long for short string storage"})");
+    const cjson b = a;
+
+    CHECK(a == b);
+    CHECK(&a.at("a") == &b.at("a"));
+    CHECK(&a.at("a").at("b")[0] == &b.at("a").at("b")[0]);
+    CHECK(a.at("c").as_cstring() == b.at("c").as_cstring());
+}
+
+TEST_CASE("copy on write mutation clones path")
+{
+    cjson a = cjson::parse(R"({"a":{"b":[1,2,3]},"c":{"d":true}})");
+    cjson b = a;
+
+    b["a"]["b"][1] = 20;
+
+    CHECK(a["a"]["b"][1].as<int>() == 2);
+    CHECK(b["a"]["b"][1].as<int>() == 20);
+
+    const cjson& ca = a;
+    const cjson& cb = b;
+    CHECK(&ca.at("a").at("b")[0] != &cb.at("a").at("b")[0]);
+    CHECK(&ca.at("c").at("d") == &cb.at("c").at("d"));
+
+    b["c"]["e"] = false;
+    CHECK_FALSE(a["c"].contains("e"));
+    CHECK(b["c"]["e"].as<bool>() == false);
+}
+
+TEST_CASE("copy on write destroying original")
+{
+    cjson b;
+    {
+        cjson a = cjson::parse(R"({"a":["A string too long for short string storage",{"b":1}]})");
+        b = a;
+        a["a"].add(3);
+        CHECK(a["a"].size() == 3);
+    }
+    CHECK(b["a"].size() == 2);
+    CHECK(b["a"][0].as<std::string>() == "A string too long for short string storage");
+    CHECK(b["a"][1]["b"].as<int>() == 1);
+}
+
+TEST_CASE("copy on write snapshots across threads")
+{
+    cjson doc = cjson::parse(R"({"counters":[0,0,0,0],"name":"snapshot"})");
+
+    std::vector<cjson> snapshots(4, doc);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < snapshots.size(); ++i)
+    {
+        threads.emplace_back([&snapshots,i]()
+        {
+            for (int k = 0; k < 100; ++k)
+            {
+                cjson copy = snapshots[i];
+                copy["counters"][i] = k;
+                snapshots[i] = copy;
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    for (size_t i = 0; i < snapshots.size(); ++i)
+    {
+        CHECK(snapshots[i]["counters"][i].as<int>() == 99);
+        CHECK(doc["counters"][i].as<int>() == 0);
+    }
+}
+
+TEST_CASE("copy on write after mutable reference escapes")
+{
+    SECTION("reference to member")
+    {
+        cjson doc = cjson::parse(R"({"a":{"b":1}})");
+        auto& a = doc.at("a");
+        cjson snap = doc;
+        a["x"] = 42;
+
+        CHECK_FALSE(snap["a"].contains("x"));
+        CHECK(doc["a"]["x"].as<int>() == 42);
+    }
+
+    SECTION("reference to nested element")
+    {
+        cjson doc = cjson::parse(R"({"a":{"b":[1,2,3]}})");
+        auto& b1 = doc["a"]["b"][1];
+        cjson snap = doc;
+        b1 = 20;
+
+        CHECK(snap["a"]["b"][1].as<int>() == 2);
+        CHECK(doc["a"]["b"][1].as<int>() == 20);
+    }
+
+    SECTION("iterator")
+    {
+        cjson doc = cjson::parse(R"([1,2,3])");
+        auto it = doc.array_range().begin();
+        cjson snap = doc;
+        *it = 10;
+
+        CHECK(snap[0].as<int>() == 1);
+        CHECK(doc[0].as<int>() == 10);
+    }
+
+    SECTION("copies of a copy share storage again")
+    {
+        cjson doc = cjson::parse(R"({"a":{"b":1}})");
+        doc.at("a");
+        const cjson snap = doc;
+        const cjson snap2 = snap;
+        CHECK(&snap.at("a") == &snap2.at("a"));
+    }
+}
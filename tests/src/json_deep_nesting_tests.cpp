@@ -0,0 +1,121 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_reclaimer.hpp>
+#include <sstream>
+#include <string>
+
+using namespace jsoncons;
+
+namespace {
+
+const size_t depth = 200000;
+
+template <class Json>
+Json make_nested_arrays(size_t n)
+{
+    Json root = typename Json::array();
+    for (size_t i = 0; i < n; ++i)
+    {
+        Json parent = typename Json::array();
+        parent.push_back(std::move(root));
+        root = std::move(parent);
+    }
+    return root;
+}
+
+template <class Json>
+Json make_nested_objects(size_t n)
+{
+    Json root;
+    root["value"] = 1;
+    for (size_t i = 0; i < n; ++i)
+    {
+        Json parent;
+        parent.insert_or_assign("index", i);
+        parent.insert_or_assign("child", std::move(root));
+        root = std::move(parent);
+    }
+    return root;
+}
+
+}
+
+TEST_CASE("deeply nested arrays")
+{
+    json j = make_nested_arrays<json>(depth);
+
+    json copy = j;
+    CHECK(copy == j);
+
+    std::string s;
+    copy.dump(s);
+    CHECK(s.size() == 2*(depth+1));
+    CHECK(s.substr(0,3) == std::string("[[["));
+
+    json other = make_nested_arrays<json>(depth);
+    CHECK(other == j);
+    other = make_nested_arrays<json>(depth-1);
+    CHECK(other != j);
+}
+
+TEST_CASE("deeply nested objects")
+{
+    ojson j = make_nested_objects<ojson>(depth);
+
+    ojson copy = j;
+    CHECK(copy == j);
+
+    ojson other(j, std::allocator<char>());
+    CHECK(other == j);
+
+    std::ostringstream os;
+    copy.dump(os);
+    CHECK(os.str().substr(0,19) == std::string("{\"index\":199999,\"ch"));
+}
+
+TEST_CASE("copy preserves member order and values")
+{
+    ojson j = ojson::parse(R"({"z":[1,{"b":2,"a":[3,4]}],"y":"A string too long for short string storage","x":{}})");
+    ojson copy = j;
+
+    CHECK(copy.to_string() == j.to_string());
+    CHECK(copy.to_string() == std::string(R"({"z":[1,{"b":2,"a":[3,4]}],"y":"A string too long for short string storage","x":{}})"));
+
+    json k = json::parse(R"({"z":[1,{"b":2,"a":[3,4]}],"y":[],"x":{"c":null}})");
+    json kcopy = k;
+    CHECK(kcopy == k);
+    CHECK(kcopy["z"][1]["a"][1].as<int>() == 4);
+}
+
+TEST_CASE("json_reclaimer")
+{
+    json_reclaimer reclaimer;
+
+    json j = make_nested_arrays<json>(depth);
+    reclaimer.reclaim(std::move(j));
+    CHECK(j.is_null());
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        ojson k = make_nested_objects<ojson>(1000);
+        reclaimer.reclaim(std::move(k));
+    }
+    reclaimer.wait();
+    CHECK(reclaimer.pending() == 0);
+}
+
+TEST_CASE("deeply nested copy on write copy with allocator")
+{
+    typedef basic_json<char,copy_on_write_policy,std::allocator<char>> cjson;
+
+    cjson j = make_nested_arrays<cjson>(depth);
+    cjson other(j, std::allocator<char>());
+    CHECK(other == j);
+
+    cjson o = make_nested_objects<cjson>(depth);
+    cjson other_o(o, std::allocator<char>());
+    CHECK(other_o == o);
+}
@@ -0,0 +1,85 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <sstream>
+#include <vector>
+
+using namespace jsoncons;
+
+TEST_CASE("memory_usage of scalars")
+{
+    json j(10);
+    json_memory_usage usage = j.memory_usage();
+    CHECK(usage.nodes == sizeof(json));
+    CHECK(usage.total() == sizeof(json));
+
+    json s("A string too long for short string storage");
+    CHECK(s.memory_usage().strings > std::string("A string too long for short string storage").length());
+    CHECK(s.memory_usage().total() == sizeof(json) + s.memory_usage().strings);
+
+    std::vector<uint8_t> bytes(100, 'a');
+    json b(byte_string_view(bytes.data(), bytes.size()));
+    CHECK(b.memory_usage().byte_strings >= bytes.size());
+
+    json n(bignum("-18446744073709551617"));
+    CHECK(n.memory_usage().bignums > 0);
+    CHECK(n.memory_usage().strings == 0);
+}
+
+TEST_CASE("memory_usage of arrays and objects")
+{
+    json j = json::parse(R"(
+    {
+        "a key too long for short string storage" : [1,2,3,"A string too long for short string storage"],
+        "b" : {"c" : true}
+    }
+    )");
+
+    json_memory_usage usage = j.memory_usage();
+    CHECK(usage.nodes == 8*sizeof(json));
+    CHECK(usage.keys > 0);
+    CHECK(usage.strings > 0);
+    CHECK(usage.containers > 0);
+    CHECK(usage.total() == usage.nodes + usage.containers + usage.keys + usage.strings + usage.byte_strings + usage.bignums);
+
+    CHECK(j["b"].memory_usage().nodes == 2*sizeof(json));
+}
+
+TEST_CASE("memory_usage slack")
+{
+    json j = json::array();
+    j.reserve(100);
+    j.push_back(1);
+
+    json_memory_usage before = j.memory_usage();
+    CHECK(before.slack == 99*sizeof(json));
+
+    j.shrink_to_fit();
+    json_memory_usage after = j.memory_usage();
+    CHECK(after.slack == 0);
+    CHECK(before.total() - after.total() == 99*sizeof(json));
+}
+
+TEST_CASE("memory_usage of typed arrays")
+{
+    std::vector<double> v(100, 1.0);
+    const json j = json::make_typed_array(v.data(), v.size());
+
+    json_memory_usage before = j.memory_usage();
+    CHECK(before.nodes == sizeof(json));
+    CHECK(before.containers >= 100*sizeof(double));
+    CHECK(before.containers < 100*sizeof(json));
+
+    // Reading a packed array does not build or retain json elements
+    CHECK(j.as<std::vector<double>>() == v);
+    CHECK(j.typed_array_range<double>().begin()[99] == 1.0);
+    CHECK(j == json::make_typed_array(v.data(), v.size()));
+    CHECK_FALSE(j.to_string().empty());
+    CHECK_THROWS(j.at(0));
+
+    json_memory_usage after = j.memory_usage();
+    CHECK(after.total() == before.total());
+    CHECK(after.containers == before.containers);
+}
@@ -0,0 +1,145 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <string>
+
+namespace ns {
+
+struct book
+{
+    std::string author;
+    std::string title;
+    double price;
+};
+
+struct bookstore
+{
+    std::string name;
+    std::vector<book> books;
+    std::map<std::string,int64_t> stock;
+    bool open;
+};
+
+struct counter
+{
+    std::string name;
+    int count;
+    double rate;
+};
+
+}
+
+JSONCONS_MEMBER_TRAITS_DECL(ns::book,author,title,price)
+JSONCONS_MEMBER_TRAITS_DECL(ns::bookstore,name,books,stock,open)
+JSONCONS_MEMBER_TRAITS_DECL(ns::counter,name,count,rate)
+
+using namespace jsoncons;
+
+TEST_CASE("JSONCONS_MEMBER_TRAITS_DECL json_type_traits")
+{
+    ns::book book1{"Haruki Murakami", "Kafka on the Shore", 25.17};
+
+    json j = book1;
+    CHECK(j.is<ns::book>());
+    CHECK(j["author"].as<std::string>() == std::string("Haruki Murakami"));
+    CHECK(j["title"].as<std::string>() == std::string("Kafka on the Shore"));
+    CHECK(j["price"].as<double>() == Approx(25.17).epsilon(0.00001));
+
+    ns::book book2 = j.as<ns::book>();
+    CHECK(book2.author == book1.author);
+    CHECK(book2.title == book1.title);
+    CHECK(book2.price == Approx(book1.price).epsilon(0.00001));
+
+    json k = json::parse(R"({"author":"Haruki Murakami"})");
+    CHECK_FALSE(k.is<ns::book>());
+}
+
+TEST_CASE("JSONCONS_MEMBER_TRAITS_DECL encode_json")
+{
+    ns::book book1{"Haruki Murakami", "Kafka on the Shore", 25.17};
+
+    std::string s;
+    encode_json(book1, s);
+
+    json j = json::parse(s);
+    CHECK(j.size() == 3);
+    CHECK(j["author"].as<std::string>() == std::string("Haruki Murakami"));
+    CHECK(j["title"].as<std::string>() == std::string("Kafka on the Shore"));
+    CHECK(j["price"].as<double>() == Approx(25.17).epsilon(0.00001));
+}
+
+TEST_CASE("JSONCONS_MEMBER_TRAITS_DECL decode_json")
+{
+    std::string s = R"(
+    {
+        "name" : "Kinokuniya",
+        "open" : true,
+        "unknown" : {"a" : [1,2,{"b":null}]},
+        "books" : [
+            {"title" : "Kafka on the Shore", "author" : "Haruki Murakami", "price" : 25.17, "isbn" : "1400079276"},
+            {"author" : "Charles Bukowski", "title" : "Women: A Novel", "price" : 12}
+        ],
+        "stock" : {"Kafka on the Shore" : 3, "Women: A Novel" : 0}
+    }
+    )";
+
+    ns::bookstore store = decode_json<ns::bookstore>(s);
+
+    CHECK(store.name == std::string("Kinokuniya"));
+    CHECK(store.open);
+    REQUIRE(store.books.size() == 2);
+    CHECK(store.books[0].author == std::string("Haruki Murakami"));
+    CHECK(store.books[0].title == std::string("Kafka on the Shore"));
+    CHECK(store.books[0].price == Approx(25.17).epsilon(0.00001));
+    CHECK(store.books[1].author == std::string("Charles Bukowski"));
+    CHECK(store.books[1].price == Approx(12.0).epsilon(0.00001));
+    REQUIRE(store.stock.size() == 2);
+    CHECK(store.stock["Kafka on the Shore"] == 3);
+    CHECK(store.stock["Women: A Novel"] == 0);
+}
+
+TEST_CASE("JSONCONS_MEMBER_TRAITS_DECL round trip")
+{
+    ns::bookstore store;
+    store.name = "Kinokuniya";
+    store.open = false;
+    store.books.push_back(ns::book{"Haruki Murakami", "Kafka on the Shore", 25.17});
+    store.stock["Kafka on the Shore"] = 3;
+
+    std::string s;
+    encode_json(store, s);
+    auto result = decode_json<ns::bookstore>(s);
+
+    CHECK(result.name == store.name);
+    CHECK(result.open == store.open);
+    REQUIRE(result.books.size() == 1);
+    CHECK(result.books[0].title == store.books[0].title);
+    CHECK(result.stock == store.stock);
+}
+
+TEST_CASE("JSONCONS_MEMBER_TRAITS_DECL member name hash")
+{
+    std::string author = "author";
+    CHECK(detail::member_name_hash(author.data(), author.length()) == detail::member_name_hash("author"));
+    std::wstring wauthor = L"author";
+    CHECK(detail::member_name_hash(wauthor.data(), wauthor.length()) == detail::member_name_hash("author"));
+}
+
+TEST_CASE("JSONCONS_MEMBER_TRAITS_DECL absent members are value-initialized")
+{
+    std::string s = R"({"name":"hits"})";
+
+    ns::counter c1 = decode_json<ns::counter>(s);
+    CHECK(c1.name == "hits");
+    CHECK(c1.count == 0);
+    CHECK(c1.rate == 0.0);
+
+    ns::counter c2 = json::parse(s).as<ns::counter>();
+    CHECK(c2.count == 0);
+    CHECK(c2.rate == 0.0);
+}
@@ -0,0 +1,153 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <sstream>
+#include <vector>
+#include <thread>
+
+using namespace jsoncons;
+
+typedef basic_json<char,typed_array_policy,std::allocator<char>> tjson;
+
+template <class Json, class T, class Enable=void>
+struct has_is_typed_array : std::false_type {};
+
+template <class Json, class T>
+struct has_is_typed_array<Json, T, decltype(void(std::declval<const Json&>().template is_typed_array<T>()))> : std::true_type {};
+
+TEST_CASE("typed array make_typed_array")
+{
+    std::vector<double> v = {1.5, 2.5, 3.5};
+    json j = json::make_typed_array(v.data(), v.size());
+
+    CHECK(j.is_array());
+    CHECK(j.is_typed_array());
+    CHECK(j.is_typed_array<double>());
+    CHECK_FALSE(j.is_typed_array<int64_t>());
+    CHECK(j.size() == 3);
+    CHECK(j[1].as<double>() == 2.5);
+    CHECK(j.as<std::vector<double>>() == v);
+    CHECK(j.is<std::vector<double>>());
+    CHECK(j.to_string() == std::string("[1.5,2.5,3.5]"));
+
+    json k = json::parse("[1.5,2.5,3.5]");
+    CHECK(j == k);
+    CHECK(k == j);
+}
+
+TEST_CASE("typed array decode")
+{
+    tjson j = tjson::parse(R"({"a":[1,2,3,4,5,6,7,8,9],"b":[1.0,2.0,3.0,4.0,5.0,6.0,7.0,8.0],"c":[1,2,3],"d":[1,2,3,4,5,6,7,"8"]})");
+
+    CHECK(j["a"].is_typed_array<int64_t>());
+    CHECK(j["b"].is_typed_array<double>());
+    CHECK_FALSE(j["c"].is_typed_array());
+    CHECK_FALSE(j["d"].is_typed_array());
+
+    std::vector<int64_t> expected = {1,2,3,4,5,6,7,8,9};
+    auto r = j["a"].typed_array_range<int64_t>();
+    CHECK(std::vector<int64_t>(r.begin(), r.end()) == expected);
+    CHECK(j["a"].as<std::vector<int64_t>>() == expected);
+    CHECK(j["a"].as<std::vector<double>>().size() == 9);
+
+    std::vector<double> d = j["b"].as<std::vector<double>>();
+    CHECK(d.size() == 8);
+    CHECK(d[7] == 8.0);
+}
+
+TEST_CASE("typed array homogeneous and heterogeneous insert")
+{
+    std::vector<int64_t> v = {1, 2, 3};
+    json j = json::make_typed_array(v.data(), v.size());
+
+    j.push_back(4);
+    CHECK(j.is_typed_array<int64_t>());
+    CHECK(j.size() == 4);
+
+    j.push_back("five");
+    CHECK_FALSE(j.is_typed_array());
+    CHECK(j.size() == 5);
+    CHECK(j[3].as<int64_t>() == 4);
+    CHECK(j[4].as<std::string>() == std::string("five"));
+}
+
+TEST_CASE("typed array element modification")
+{
+    std::vector<double> v = {1.0, 2.0, 3.0};
+    json j = json::make_typed_array(v.data(), v.size());
+
+    json copy = j;
+    j[0] = "one";
+    CHECK_FALSE(j.is_typed_array());
+    CHECK(j[0].as<std::string>() == std::string("one"));
+    CHECK(copy.is_typed_array());
+    CHECK(copy[0].as<double>() == 1.0);
+}
+
+TEST_CASE("typed array const access from multiple threads")
+{
+    std::vector<double> v(1000);
+    for (size_t i = 0; i < v.size(); ++i)
+    {
+        v[i] = static_cast<double>(i);
+    }
+    const json j = json::make_typed_array(v.data(), v.size());
+
+    std::vector<double> sums(4, 0.0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < sums.size(); ++t)
+    {
+        threads.emplace_back([&j,&sums,t]()
+        {
+            for (double e : j.typed_array_range<double>())
+            {
+                sums[t] += e;
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    for (double sum : sums)
+    {
+        CHECK(sum == 499500.0);
+    }
+    CHECK(j.is_typed_array());
+}
+
+TEST_CASE("typed array const access")
+{
+    std::vector<int64_t> v = {1, 2, 3};
+    const json j = json::make_typed_array(v.data(), v.size());
+
+    // A packed array has no elements to return by reference
+    CHECK_THROWS(j.at(0));
+    CHECK_THROWS(j.array_range());
+
+    // Conversion, comparison, serialization and size read the packed values
+    CHECK(j.as<std::vector<std::string>>() == std::vector<std::string>({"1","2","3"}));
+    CHECK(j == json::parse("[1,2,3]"));
+    CHECK(j != json::parse("[1,2,4]"));
+    CHECK(j == json::make_typed_array(std::vector<double>({1.0,2.0,3.0}).data(), 3));
+    CHECK(j.to_string() == std::string("[1,2,3]"));
+    CHECK(j.size() == 3);
+    CHECK(j.is_typed_array<int64_t>());
+
+    // Non-const access unpacks
+    json k = j;
+    CHECK(k.at(0).as<int>() == 1);
+    CHECK_FALSE(k.is_typed_array());
+    CHECK(k == j);
+}
+
+TEST_CASE("typed array element types")
+{
+    CHECK(has_is_typed_array<json,int64_t>::value);
+    CHECK(has_is_typed_array<json,double>::value);
+    CHECK_FALSE(has_is_typed_array<json,float>::value);
+    CHECK_FALSE(has_is_typed_array<json,int>::value);
+    CHECK_FALSE(has_is_typed_array<json,uint64_t>::value);
+}
@@ -0,0 +1,131 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/jsonpath/json_query.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jsoncons;
+using namespace jsoncons::jsonpath;
+
+namespace {
+
+const char* store_text()
+{
+    static const char* text = R"(
+    {
+        "store": {
+            "book": [
+                {"category": "reference", "author": "Nigel Rees", "title": "Sayings of the Century", "price": 8.95},
+                {"category": "fiction", "author": "Evelyn Waugh", "title": "Sword of Honour", "price": 12.99},
+                {"category": "fiction", "author": "Herman Melville", "title": "Moby Dick", "isbn": "0-553-21311-3", "price": 8.99},
+                {"category": "fiction", "author": "J. R. R. Tolkien", "title": "The Lord of the Rings", "isbn": "0-395-19395-8", "price": 22.99}
+            ],
+            "bicycle": {"color": "red", "price": 19.95}
+        }
+    }
+    )";
+    return text;
+}
+
+}
+
+TEST_CASE("jsonpath_expression matches json_query")
+{
+    json root = json::parse(store_text());
+
+    std::vector<std::string> paths = {
+        "$.store.book[0].title",
+        "$..author",
+        "$.store.*",
+        "$.store..price",
+        "$..book[2]",
+        "$..book[-1:]",
+        "$..book[0,1]",
+        "$..book[:2]",
+        "$..book[::-1].title",
+        "$..book[?(@.isbn)].title",
+        "$..book[?(@.price<10)].title",
+        "$..book[(@.length-1)].title",
+        "$.store.book.length",
+        "$..book[?(@.author =~ /Evelyn.*?/)].title",
+        "$.store.book[?(@.price < max($.store.book[*].price))].title",
+        "$..*",
+        "$['store']['bicycle']['color']"
+    };
+
+    for (const auto& path : paths)
+    {
+        auto expr = jsonpath_expression<json>::compile(path);
+        CHECK(expr.evaluate(root) == json_query(root, path));
+        CHECK(expr.evaluate(root, result_type::path) == json_query(root, path, result_type::path));
+    }
+}
+
+TEST_CASE("jsonpath_expression evaluated against several values")
+{
+    auto expr = make_expression<json>("$.items[?(@.price > min($.items[*].price))].name");
+
+    json first = json::parse(R"({"items":[{"name":"a","price":1},{"name":"b","price":2}]})");
+    json second = json::parse(R"({"items":[{"name":"c","price":5},{"name":"d","price":3},{"name":"e","price":4}]})");
+
+    CHECK(expr.evaluate(first) == json::parse(R"(["b"])"));
+    CHECK(expr.evaluate(second) == json::parse(R"(["c","e"])"));
+    CHECK(expr.evaluate(first) == json::parse(R"(["b"])"));
+}
+
+TEST_CASE("jsonpath_expression on several threads")
+{
+    json root = json::parse(store_text());
+    auto expr = make_expression<json>("$..book[?(@.category == 'fiction' && @.price > 10)].title");
+    json expected = json::parse(R"(["Sword of Honour","The Lord of the Rings"])");
+
+    std::vector<int> matches(4, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < matches.size(); ++i)
+    {
+        threads.emplace_back([&expr,&root,&expected,&matches,i]()
+        {
+            for (int j = 0; j < 50; ++j)
+            {
+                if (expr.evaluate(root) == expected)
+                {
+                    ++matches[i];
+                }
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    for (auto count : matches)
+    {
+        CHECK(count == 50);
+    }
+}
+
+TEST_CASE("jsonpath_expression replace")
+{
+    json root = json::parse(store_text());
+
+    auto expr = jsonpath_expression<json,json&>::compile("$..book[?(@.price > 10)].price");
+    expr.replace(root, 10.0);
+
+    CHECK(json_query(root, "$..book[*].price") == json::parse("[8.95,10.0,8.99,10.0]"));
+}
+
+TEST_CASE("jsonpath_expression compile errors")
+{
+    CHECK_THROWS_AS(jsonpath_expression<json>::compile("$.store...price"), parse_error);
+
+    std::error_code ec;
+    auto expr = make_expression<json>("$['store']['book'[*]", ec);
+    CHECK(ec == jsonpath_parser_errc::expected_right_bracket);
+    CHECK(expr.evaluate(json::parse(store_text())) == json::array());
+
+    CHECK_THROWS_AS(jsonpath_expression<json>::compile("$..book[?(@.price<10]"), parse_error);
+}
@@ -51,27 +51,27 @@ TEST_CASE("test_div")
     context.push_back(3);
 
     std::string s1 = "(3/1)";
-    auto expr1 = parser.parse(context,s1.c_str(), s1.c_str()+ s1.length(), &pend);
+    auto expr1 = parser.parse(s1.c_str(), s1.c_str()+ s1.length(), &pend);
     auto result1 = expr1.eval(context);
     CHECK(json(3) == result1);
 
     std::string s2 = "(3/@.length)";
-    auto expr2 = parser.parse(context,s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
     auto result2 = expr2.eval(context);
     CHECK(json(3) == result2);
 
     std::string s3 = "(5/2)";
-    auto expr3 = parser.parse(context,s3.c_str(), s3.c_str()+ s3.length(), &pend);
+    auto expr3 = parser.parse(s3.c_str(), s3.c_str()+ s3.length(), &pend);
     auto result3 = expr3.eval(context);
     CHECK(json(2.5) == result3);
 
     std::string s4 = "(@.length/3)";
-    auto expr4 = parser.parse(context,s4.c_str(), s4.c_str()+ s4.length(), &pend);
+    auto expr4 = parser.parse(s4.c_str(), s4.c_str()+ s4.length(), &pend);
     auto result4 = expr4.eval(context);
     CHECK(0.333333 == Approx(result4.as<double>()).epsilon(0.001));
 
     std::string s5 = "(@.0/@.length)";
-    auto expr5 = parser.parse(context,s5.c_str(), s5.c_str()+ s5.length(), &pend);
+    auto expr5 = parser.parse(s5.c_str(), s5.c_str()+ s5.length(), &pend);
     auto result5 = expr5.eval(context);
     CHECK(json(3) == result5);
 }
@@ -86,27 +86,27 @@ TEST_CASE("test_mult")
     context.push_back(2);
 
     std::string s1 = "(3*1)";
-    auto expr1 = parser.parse(context, s1.c_str(), s1.c_str()+ s1.length(), &pend);
+    auto expr1 = parser.parse(s1.c_str(), s1.c_str()+ s1.length(), &pend);
     auto result1 = expr1.eval(context);
     CHECK(json(3) == result1);
 
     std::string s2 = "(3*@.length)";
-    auto expr2 = parser.parse(context, s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
     auto result2 = expr2.eval(context);
     CHECK(json(6) == result2);
 
     std::string s3 = "(5*2)";
-    auto expr3 = parser.parse(context, s3.c_str(), s3.c_str()+ s3.length(), &pend);
+    auto expr3 = parser.parse(s3.c_str(), s3.c_str()+ s3.length(), &pend);
     auto result3 = expr3.eval(context);
     CHECK(json(10) == result3);
 
     std::string s4 = "(@.length*3)";
-    auto expr4 = parser.parse(context, s4.c_str(), s4.c_str()+ s4.length(), &pend);
+    auto expr4 = parser.parse(s4.c_str(), s4.c_str()+ s4.length(), &pend);
     auto result4 = expr4.eval(context);
     CHECK(json(6) == result4);
 
     std::string s5 = "(@.length*@.1)";
-    auto expr5 = parser.parse(context, s5.c_str(), s5.c_str()+ s5.length(), &pend);
+    auto expr5 = parser.parse(s5.c_str(), s5.c_str()+ s5.length(), &pend);
     auto result5 = expr5.eval(context);
     CHECK(json(4) == result5);
 }
@@ -120,27 +120,27 @@ TEST_CASE("test_minus")
     context.push_back(10.0);
 
     std::string s1 = "(3-1)";
-    auto expr1 = parser.parse(context, s1.c_str(), s1.c_str()+ s1.length(), &pend);
+    auto expr1 = parser.parse(s1.c_str(), s1.c_str()+ s1.length(), &pend);
     auto result1 = expr1.eval(context);
     CHECK(json(2) == result1);
 
     std::string s2 = "(3-@.length)";
-    auto expr2 = parser.parse(context, s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
     auto result2 = expr2.eval(context);
     CHECK(json(2) == result2);
 
     std::string s3 = "(3.5-1.0)";
-    auto expr3 = parser.parse(context, s3.c_str(), s3.c_str()+ s3.length(), &pend);
+    auto expr3 = parser.parse(s3.c_str(), s3.c_str()+ s3.length(), &pend);
     auto result3 = expr3.eval(context);
     CHECK(json(2.5) == result3);
 
     std::string s4 = "(@.length-3)";
-    auto expr4 = parser.parse(context, s4.c_str(), s4.c_str()+ s4.length(), &pend);
+    auto expr4 = parser.parse(s4.c_str(), s4.c_str()+ s4.length(), &pend);
     auto result4 = expr4.eval(context);
     CHECK(json(-2) ==result4);
 
     std::string s5 = "(@.length-@.0)";
-    auto expr5 = parser.parse(context, s5.c_str(), s5.c_str()+ s5.length(), &pend);
+    auto expr5 = parser.parse(s5.c_str(), s5.c_str()+ s5.length(), &pend);
     auto result5 = expr5.eval(context);
     CHECK(json(-9) ==result5);
 }
@@ -155,32 +155,32 @@ TEST_CASE("test_lt")
     context.push_back(1);
 
     std::string s1 = "(3 < 1)";
-    auto expr1 = parser.parse(context, s1.c_str(), s1.c_str()+ s1.length(), &pend);
+    auto expr1 = parser.parse(s1.c_str(), s1.c_str()+ s1.length(), &pend);
     auto result1 = expr1.eval(context);
     CHECK(json(false) == result1);
 
     std::string s2 = "(3 < @.length)";
-    auto expr2 = parser.parse(context, s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
     auto result2 = expr2.eval(context);
     CHECK(json(false) == result2);
 
     std::string s3 = "(@.length < 3)";
-    auto expr3 = parser.parse(context, s3.c_str(), s3.c_str()+ s3.length(), &pend);
+    auto expr3 = parser.parse(s3.c_str(), s3.c_str()+ s3.length(), &pend);
     auto result3 = expr3.eval(context);
     CHECK(json(true) == result3);
 
     std::string s4 = "(@.length < @.length)";
-    auto expr4 = parser.parse(context, s4.c_str(), s4.c_str()+ s4.length(), &pend);
+    auto expr4 = parser.parse(s4.c_str(), s4.c_str()+ s4.length(), &pend);
     auto result4 = expr4.eval(context);
     CHECK(json(false) == result4);
 
     std::string s5 = "(@.length < @.0)";
-    auto expr5 = parser.parse(context, s5.c_str(), s5.c_str()+ s5.length(), &pend);
+    auto expr5 = parser.parse(s5.c_str(), s5.c_str()+ s5.length(), &pend);
     auto result5 = expr5.eval(context);
     CHECK(json(true) == result5);
 
     std::string s6 = "(@.length < @.1)";
-    auto expr6 = parser.parse(context, s6.c_str(), s6.c_str()+ s6.length(), &pend);
+    auto expr6 = parser.parse(s6.c_str(), s6.c_str()+ s6.length(), &pend);
     auto result6 = expr6.eval(context);
     CHECK(json(false) == result6);
 }
@@ -194,12 +194,12 @@ TEST_CASE("test_lte")
     context.push_back(1);
 
     std::string s1 = "(3 <= 1)";
-    auto expr1 = parser.parse(context, s1.c_str(), s1.c_str()+ s1.length(), &pend);
+    auto expr1 = parser.parse(s1.c_str(), s1.c_str()+ s1.length(), &pend);
     auto result1 = expr1.eval(context);
     CHECK(json(false) == result1);
 
     std::string s2 = "(3 <= @.length)";
-    auto expr2 = parser.parse(context, s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
     auto result2 = expr2.eval(context);
     CHECK(json(false) == result2);
 }
@@ -213,12 +213,12 @@ TEST_CASE("test_gt")
     context.push_back(1);
 
     std::string s1 = "(3 > 1)";
-    auto expr1 = parser.parse(context, s1.c_str(), s1.c_str()+ s1.length(), &pend);
+    auto expr1 = parser.parse(s1.c_str(), s1.c_str()+ s1.length(), &pend);
     auto result1 = expr1.eval(context);
     CHECK(json(true) == result1);
 
     std::string s2 = "(3 > @.length)";
-    auto expr2 = parser.parse(context, s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
     auto result2 = expr2.eval(context);
     CHECK(json(true) == result2);
 }
@@ -232,12 +232,12 @@ TEST_CASE("test_gte")
     context.push_back(1);
 
     std::string s1 = "(3 >= 1)";
-    auto expr1 = parser.parse(context, s1.c_str(), s1.c_str()+ s1.length(), &pend);
+    auto expr1 = parser.parse(s1.c_str(), s1.c_str()+ s1.length(), &pend);
     auto result1 = expr1.eval(context);
     CHECK(json(true) == result1);
 
     std::string s2 = "(3 >= @.length)";
-    auto expr2 = parser.parse(context, s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
     auto result2 = expr2.eval(context);
     CHECK(json(true) == result2);
 }
@@ -251,22 +251,22 @@ TEST_CASE("test_eq")
     context.push_back(1);
 
     std::string s1 = "(3 == 1)";
-    auto expr1 = parser.parse(context, s1.c_str(), s1.c_str()+ s1.length(), &pend);
+    auto expr1 = parser.parse(s1.c_str(), s1.c_str()+ s1.length(), &pend);
     auto result1 = expr1.eval(context);
     CHECK(json(false) == result1);
 
     std::string s2 = "(3 == @.length)";
-    auto expr2 = parser.parse(context, s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
     auto result2 = expr2.eval(context);
     CHECK(json(false) == result2);
 
     std::string s3 = "(1 == 1)";
-    auto expr3 = parser.parse(context, s3.c_str(), s3.c_str()+ s3.length(), &pend);
+    auto expr3 = parser.parse(s3.c_str(), s3.c_str()+ s3.length(), &pend);
     auto result3 = expr3.eval(context);
     CHECK(json(true) == result3);
 
     std::string s4 = "(1 == @.length)";
-    auto expr4 = parser.parse(context, s4.c_str(), s4.c_str()+ s4.length(), &pend);
+    auto expr4 = parser.parse(s4.c_str(), s4.c_str()+ s4.length(), &pend);
     auto result4 = expr4.eval(context);
     CHECK(json(true) == result4);
 }
@@ -281,22 +281,22 @@ TEST_CASE("test_precedence")
     context.push_back(2);
 
     std::string s1 = "(@.0 == 1 && @.1 == 2)";
-    auto expr1 = parser.parse(context, s1.c_str(), s1.c_str()+ s1.length(), &pend);
+    auto expr1 = parser.parse(s1.c_str(), s1.c_str()+ s1.length(), &pend);
     auto result1 = expr1.eval(context);
     CHECK(json(true) == result1);
 
     std::string s2 = "((@.0 == 1) && (@.1 == 2))";
-    auto expr2 = parser.parse(context, s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
     auto result2 = expr2.eval(context);
     CHECK(json(true) == result2);
 
     std::string s3 = "(@.0 == 2 && @.1 == 2)";
-    auto expr3 = parser.parse(context, s3.c_str(), s3.c_str()+ s3.length(), &pend);
+    auto expr3 = parser.parse(s3.c_str(), s3.c_str()+ s3.length(), &pend);
     auto result3 = expr3.eval(context);
     CHECK(json(false) == result3);
 
     std::string s4 = "((@.0 == 1) && (@.1 == 1))";
-    auto expr4 = parser.parse(context, s4.c_str(), s4.c_str()+ s4.length(), &pend);
+    auto expr4 = parser.parse(s4.c_str(), s4.c_str()+ s4.length(), &pend);
     auto result4 = expr4.eval(context);
     CHECK(json(false) == result4);
 }
@@ -310,22 +310,22 @@ TEST_CASE("test_ne")
     context.push_back(1);
 
     std::string s1 = "(3 != 1)";
-    auto expr1 = parser.parse(context, s1.c_str(), s1.c_str()+ s1.length(), &pend);
+    auto expr1 = parser.parse(s1.c_str(), s1.c_str()+ s1.length(), &pend);
     auto result1 = expr1.eval(context);
     CHECK(json(true) == result1);
 
     std::string s2 = "(3 != @.length)";
-    auto expr2 = parser.parse(context, s2.c_str(), s2.c_str()+ s2.length(), &pend);
+    auto expr2 = parser.parse(s2.c_str(), s2.c_str()+ s2.length(), &pend);
     auto result2 = expr2.eval(context);
     CHECK(json(true) == result2);
 
     std::string s3 = "(1 != 1)";
-    auto expr3 = parser.parse(context, s3.c_str(), s3.c_str()+ s3.length(), &pend);
+    auto expr3 = parser.parse(s3.c_str(), s3.c_str()+ s3.length(), &pend);
     auto result3 = expr3.eval(context);
     CHECK(json(false) == result3);
 
     std::string s4 = "(1 != @.length)";
-    auto expr4 = parser.parse(context, s4.c_str(), s4.c_str()+ s4.length(), &pend);
+    auto expr4 = parser.parse(s4.c_str(), s4.c_str()+ s4.length(), &pend);
     auto result4 = expr4.eval(context);
     CHECK(json(false) == result4);
 }
@@ -339,17 +339,17 @@ TEST_CASE("test_jsonpath_filter")
     parent.push_back(2);
 
     std::string expr1 = "(1 + 1)";
-    auto res1 = parser.parse(parent, expr1.c_str(), expr1.c_str()+ expr1.length(), &pend);
+    auto res1 = parser.parse(expr1.c_str(), expr1.c_str()+ expr1.length(), &pend);
     auto result1 = res1.eval(parent);
     CHECK(json(2) == result1);
 
     std::string expr2 = "(1 - 1)";
-    auto res2 = parser.parse(parent, expr2.c_str(), expr2.c_str()+ expr2.length(), &pend);
+    auto res2 = parser.parse(expr2.c_str(), expr2.c_str()+ expr2.length(), &pend);
     auto result2 = res2.eval(parent);
     CHECK(json(0) == result2);
 
     std::string expr3 = "(@.length - 1)";
-    auto res3 = parser.parse(parent, expr3.c_str(), expr3.c_str()+ expr3.length(), &pend);
+    auto res3 = parser.parse(expr3.c_str(), expr3.c_str()+ expr3.length(), &pend);
     auto result3 = res3.eval(parent);
     CHECK(json(1) == result3);
 
@@ -364,12 +364,12 @@ TEST_CASE("test_jsonpath_filter_exclaim")
     parent.push_back(2);
 
     std::string expr1 = "(!(1 + 1))";
-    auto res1 = parser.parse(parent, expr1.c_str(), expr1.c_str()+ expr1.length(), &pend);
+    auto res1 = parser.parse(expr1.c_str(), expr1.c_str()+ expr1.length(), &pend);
     auto result1 = res1.eval(parent);
     CHECK(json(false) == result1);
 
     std::string expr2 = "(!0)";
-    auto res2 = parser.parse(parent, expr2.c_str(), expr2.c_str()+ expr2.length(), &pend);
+    auto res2 = parser.parse(expr2.c_str(), expr2.c_str()+ expr2.length(), &pend);
     auto result2= res2.eval(parent);
     CHECK(json(true) == result2);
 }
@@ -398,42 +398,42 @@ TEST_CASE("test_jsonpath_filter_negative_numbers")
     parent.push_back(2);
 
     std::string expr1 = "(-1 + 1)";
-    auto res1 = parser.parse(parent, expr1.c_str(), expr1.c_str()+ expr1.length(), &pend);
+    auto res1 = parser.parse(expr1.c_str(), expr1.c_str()+ expr1.length(), &pend);
     auto result1 = res1.eval(parent);
     CHECK(json(0) == result1);
 
     std::string expr2 = "(1 + -1)";
-    auto res2 = parser.parse(parent, expr2.c_str(), expr2.c_str()+ expr2.length(), &pend);
+    auto res2 = parser.parse(expr2.c_str(), expr2.c_str()+ expr2.length(), &pend);
     auto result2 = res2.eval(parent);
     CHECK(json(0) == result2);
 
     std::string expr3 = "(-1 - -1)";
-    auto res3 = parser.parse(parent, expr3.c_str(), expr3.c_str()+ expr3.length(), &pend);
+    auto res3 = parser.parse(expr3.c_str(), expr3.c_str()+ expr3.length(), &pend);
     auto result3 = res3.eval(parent);
     CHECK(json(0) == result3);
 
     std::string expr4 = "(-1 - -3)";
-    auto res4 = parser.parse(parent, expr4.c_str(), expr4.c_str()+ expr4.length(), &pend);
+    auto res4 = parser.parse(expr4.c_str(), expr4.c_str()+ expr4.length(), &pend);
     auto result4 = res4.eval(parent);
     CHECK(json(2) == result4);
 
     std::string expr5 = "((-2 < -1) && (-3 > -4))";
-    auto res5 = parser.parse(parent, expr5.c_str(), expr5.c_str()+ expr5.length(), &pend);
+    auto res5 = parser.parse(expr5.c_str(), expr5.c_str()+ expr5.length(), &pend);
     auto result5 = res5.eval(parent);
     CHECK(json(true) == result5);
 
     std::string expr6 = "((-2 < -1) || (-4 > -3))";
-    auto res6 = parser.parse(parent, expr6.c_str(), expr6.c_str()+ expr6.length(), &pend);
+    auto res6 = parser.parse(expr6.c_str(), expr6.c_str()+ expr6.length(), &pend);
     auto result6 = res6.eval(parent);
     CHECK(json(true) == result6);
 
     std::string expr7 = "(-2 < -1 && -3 > -4)";
-    auto res7 = parser.parse(parent, expr7.c_str(), expr7.c_str()+ expr7.length(), &pend);
+    auto res7 = parser.parse(expr7.c_str(), expr7.c_str()+ expr7.length(), &pend);
     auto result7 = res7.eval(parent);
     CHECK(json(true) == result7);
 
     std::string expr8 = "(-2 < -1 || -4 > -3)";
-    auto res8 = parser.parse(parent, expr8.c_str(), expr8.c_str()+ expr8.length(), &pend);
+    auto res8 = parser.parse(expr8.c_str(), expr8.c_str()+ expr8.length(), &pend);
     auto result8 = res8.eval(parent);
     CHECK(json(true) == result8);
 }
@@ -447,7 +447,7 @@ TEST_CASE("test_jsonpath_filter_uni")
     parent.push_back(2);
 
     std::string expr1 = "(0)";
-    auto res = parser.parse(parent, expr1.c_str(), expr1.c_str()+ expr1.length(), &pend);
+    auto res = parser.parse(expr1.c_str(), expr1.c_str()+ expr1.length(), &pend);
     auto result1 = res.eval(parent);
 
     //std::cout << (int)result1.data_type() << std::endl;
@@ -468,19 +468,80 @@ TEST_CASE("test_jsonpath_filter_regex")
     parent.push_back(2);
 
     std::string expr1 = "('today I go' =~ /today.*?/)";
-    auto res1 = parser.parse(parent, expr1.c_str(), expr1.c_str()+ expr1.length(), &pend);
+    auto res1 = parser.parse(expr1.c_str(), expr1.c_str()+ expr1.length(), &pend);
     auto result1 = res1.eval(parent);
     CHECK(json(true) == result1);
 
     std::string expr2 = "('today I go' =~ /Today.*?/)";
-    auto res2 = parser.parse(parent, expr2.c_str(), expr2.c_str()+ expr2.length(), &pend);
+    auto res2 = parser.parse(expr2.c_str(), expr2.c_str()+ expr2.length(), &pend);
     auto result2 = res2.eval(parent);
     CHECK(json(false) == result2);
 
     std::string expr3 = "('today I go' =~ /Today.*?/i)";
-    auto res3 = parser.parse(parent, expr3.c_str(), expr3.c_str()+ expr3.length(), &pend);
+    auto res3 = parser.parse(expr3.c_str(), expr3.c_str()+ expr3.length(), &pend);
     auto result3 = res3.eval(parent);
     CHECK(json(true) == result3);
 }
 #endif
 
+
+TEST_CASE("jsonpath filter node sets")
+{
+    const char* pend;
+    jsonpath_filter_parser<json> parser;
+
+    json context = json::parse(R"({"a":[1,2],"c":[],"n":2,"s":"abc","t":true,"f":false,"o":{"x":{"y":5},"z":{"y":7}},"d":2.5})");
+
+    std::vector<std::pair<std::string,json>> cases = {
+        {"(@.o..y > 4)", json(true)},
+        {"(@.o..y < 6)", json(false)},
+        {"(@.o..y <= 5)", json(false)},
+        {"(@.o..y != 3)", json(true)},
+        {"(@.o..y == @.o.x.y)", json(false)},
+        {"(@.o..y && @.t)", json(true)},
+        {"(@.f || @.o..y)", json(true)},
+        {"(@.c == @.n)", json(false)},
+        {"(!@.missing)", json(true)},
+        {"(!@.o..y)", json(false)},
+        {"(@.o..y + 1)", json::null()},
+        {"(-@.o..y)", json::null()},
+        {"(-@.o.x.y)", json(-5)},
+        {"(@.n + @.a.1)", json(4)},
+        {"(@.n - @.d)", json(-0.5)},
+        {"(@.a.length)", json(2)},
+        {"(@.s.length)", json(3)},
+        {"(@.n.length)", json::array()},
+        {"(@.o..y)", json::parse("[5,7]")},
+        {"(@.o..y =~ /5/)", json(false)},
+        {"(@.missing =~ /5/)", json(false)},
+        {"(@.s < 'abd' && @.d > 2.4)", json(true)}
+    };
+
+    for (const auto& item : cases)
+    {
+        auto expr = parser.parse(item.first.c_str(), item.first.c_str() + item.first.length(), &pend);
+        CHECK(expr.eval(context) == item.second);
+    }
+}
+
+TEST_CASE("jsonpath filter evaluated with one stack")
+{
+    const char* pend;
+    jsonpath_filter_parser<json> parser;
+
+    json root = json::parse(R"({"items":[{"price":3},{"price":1},{"price":2}]})");
+
+    std::string s = "(@.price > min($.items[*].price) && @.price < max($.items[*].price))";
+    auto expr = parser.parse(s.c_str(), s.c_str() + s.length(), &pend);
+
+    filter_stack<json> stack;
+    std::vector<bool> accepted;
+    for (const auto& item : root["items"].array_range())
+    {
+        accepted.push_back(expr.exists(item, root, stack));
+    }
+    CHECK(accepted == std::vector<bool>({false,false,true}));
+
+    json other = json::parse(R"({"items":[{"price":0},{"price":2},{"price":4}]})");
+    CHECK(expr.exists(other["items"][1], other, stack));
+}
@@ -0,0 +1,146 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/jsonpath/json_query.hpp>
+#include <jsoncons_ext/jsonpath/jsonpath_multi_query.hpp>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace jsoncons;
+using namespace jsoncons::jsonpath;
+
+namespace {
+
+const char* store_text()
+{
+    static const char* text = R"(
+    {
+        "store": {
+            "book": [
+                {"category": "reference", "author": "Nigel Rees", "title": "Sayings of the Century", "price": 8.95},
+                {"category": "fiction", "author": "Evelyn Waugh", "title": "Sword of Honour", "price": 12.99},
+                {"category": "fiction", "author": "Herman Melville", "title": "Moby Dick", "isbn": "0-553-21311-3", "price": 8.99},
+                {"category": "fiction", "author": "J. R. R. Tolkien", "title": "The Lord of the Rings", "isbn": "0-395-19395-8", "price": 22.99}
+            ],
+            "bicycle": {"color": "red", "price": 19.95}
+        }
+    }
+    )";
+    return text;
+}
+
+json sorted(json val)
+{
+    std::sort(val.array_range().begin(), val.array_range().end(),
+              [](const json& a, const json& b){return a.to_string() < b.to_string();});
+    return val;
+}
+
+}
+
+TEST_CASE("jsonpath_multi_query matches json_query")
+{
+    json root = json::parse(store_text());
+
+    std::vector<std::string> paths = {
+        "$",
+        "$.store.book[0].title",
+        "$['store']['bicycle']['color']",
+        "$.store.book[*].author",
+        "$.store.book[1:3].title",
+        "$.store.book[0,2].title",
+        "$.store.book[?(@.isbn)].title",
+        "$.store.book[?(@.price < 10)]",
+        "$.store.book[-1].title",
+        "$.store.book.length",
+        "$.store.book[(@.length-1)].title",
+        "$.store.book[?(@.price < max($.store.book[*].price))].title",
+        "$.store.book[0].title[0]",
+        "$.store.nothing",
+        "$.store.*",
+        "$..author",
+        "$..price",
+        "$..book[2].title",
+        "$..[0]",
+        "$.store..color"
+    };
+
+    jsonpath_multi_query<json> queries;
+    for (const auto& path : paths)
+    {
+        queries.add(path);
+    }
+    CHECK(queries.size() == paths.size());
+
+    std::vector<json> results = queries.evaluate(root);
+    REQUIRE(results.size() == paths.size());
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        CHECK(sorted(results[i]) == sorted(json_query(root, paths[i])));
+    }
+}
+
+TEST_CASE("jsonpath_multi_query reports values by id")
+{
+    json root = json::parse(R"({"a":{"a":{"a":1},"b":2},"c":[{"a":3}],"d":"xyz"})");
+
+    jsonpath_multi_query<json> queries;
+    size_t all_a = queries.add("$..a");
+    size_t b = queries.add("$.a.b");
+    size_t same_b = queries.add("$.a.b");
+    size_t first_char = queries.add("$.d[0]");
+
+    std::vector<std::pair<size_t,json>> values;
+    queries.evaluate(root, [&values](size_t id, const json& val){values.emplace_back(id, val);});
+
+    std::vector<json> a_values;
+    std::vector<json> b_values;
+    for (const auto& item : values)
+    {
+        if (item.first == all_a)
+        {
+            a_values.push_back(item.second);
+        }
+        else if (item.first == b || item.first == same_b)
+        {
+            b_values.push_back(item.second);
+        }
+        else
+        {
+            CHECK(item.first == first_char);
+            CHECK(item.second == json("x"));
+        }
+    }
+    // Values are reported in document order, each once
+    CHECK(a_values == std::vector<json>({json::parse(R"({"a":{"a":1},"b":2})"), json::parse(R"({"a":1})"), json(1), json(3)}));
+    CHECK(b_values == std::vector<json>({json(2), json(2)}));
+}
+
+TEST_CASE("jsonpath_multi_query evaluated against several values")
+{
+    jsonpath_multi_query<json> queries;
+    queries.add("$.items[?(@.price > 2)].name");
+    queries.add("$.items[*].price");
+
+    json first = json::parse(R"({"items":[{"name":"a","price":1},{"name":"b","price":3}]})");
+    json second = json::parse(R"({"items":[{"name":"c","price":5}]})");
+
+    std::vector<json> results = queries.evaluate(first);
+    CHECK(results[0] == json::parse(R"(["b"])"));
+    CHECK(results[1] == json::parse("[1,3]"));
+
+    results = queries.evaluate(second);
+    CHECK(results[0] == json::parse(R"(["c"])"));
+    CHECK(results[1] == json::parse("[5]"));
+}
+
+TEST_CASE("jsonpath_multi_query compile errors")
+{
+    jsonpath_multi_query<json> queries;
+    queries.add("$.a");
+    CHECK_THROWS_AS(queries.add("$.store...price"), parse_error);
+    CHECK(queries.size() == 1);
+}
@@ -141,3 +141,23 @@ const json expected = json::parse(R"(
 
 
 
+
+TEST_CASE("test_recursive_descent_paths")
+{
+
+const json expected = json::parse(R"(
+[
+    "$['store']['bicycle']['price']",
+    "$['store']['book'][0]['price']",
+    "$['store']['book'][1]['price']",
+    "$['store']['book'][2]['price']",
+    "$['store']['book'][3]['price']"
+]
+)");
+
+    json result = json_query(store,"$..price",result_type::path);
+    CHECK(expected == result);
+
+    json result2 = json_query(store,"$..['price']",result_type::path);
+    CHECK(expected == result2);
+}
@@ -0,0 +1,116 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/jsonpath/json_query.hpp>
+#include <jsoncons_ext/jsonpath/jsonpath_parallel_evaluator.hpp>
+#include <string>
+#include <vector>
+
+using namespace jsoncons;
+using namespace jsoncons::jsonpath;
+
+namespace {
+
+json make_items(size_t count)
+{
+    json items = json::array();
+    for (size_t i = 0; i < count; ++i)
+    {
+        json item;
+        item["id"] = i;
+        item["price"] = static_cast<double>((i * 7) % 23);
+        item["tags"] = json::array{"t" + std::to_string(i % 3), "t" + std::to_string(i % 5)};
+        if (i % 4 == 0)
+        {
+            item["parts"] = json::array{json::object{{"id", i * 10}}, json::object{{"id", i * 10 + 1}}};
+        }
+        items.push_back(std::move(item));
+    }
+    json root;
+    root["items"] = std::move(items);
+    return root;
+}
+
+}
+
+TEST_CASE("jsonpath_parallel_evaluator matches json_query")
+{
+    json root = make_items(500);
+
+    std::vector<std::string> paths = {
+        "$.items[*].id",
+        "$.items[*].tags[1]",
+        "$.items[?(@.price > 10)].id",
+        "$.items[?(@.price > min($.items[*].price) + 10)].id",
+        "$.items[?(@.price == max($.items[*].price))]",
+        "$.items[10:490:3].price",
+        "$.items[-3:].id",
+        "$..id",
+        "$..parts[?(@.id > 100)].id",
+        "$..tags[0]",
+        "$.items.length",
+        "$..*"
+    };
+
+    for (size_t num_threads : {1, 2, 3, 8})
+    {
+        for (const auto& path : paths)
+        {
+            jsonpath_parallel_evaluator<json> evaluator(path);
+            evaluator.num_threads(num_threads);
+            evaluator.min_array_size(16);
+
+            CHECK(evaluator.evaluate(root) == json_query(root, path));
+            CHECK(evaluator.evaluate(root, result_type::path) == json_query(root, path, result_type::path));
+        }
+    }
+}
+
+TEST_CASE("jsonpath_parallel_evaluator small arrays are not split")
+{
+    json root = make_items(20);
+
+    jsonpath_parallel_evaluator<json> evaluator(make_expression<json>("$..parts[*].id"));
+    evaluator.num_threads(4);
+    CHECK(evaluator.min_array_size() == jsonpath_parallel_evaluator<json>::default_min_array_size);
+
+    CHECK(evaluator.evaluate(root) == json::parse("[0,1,40,41,80,81,120,121,160,161]"));
+}
+
+TEST_CASE("jsonpath_parallel_evaluator select")
+{
+    json root = make_items(200);
+
+    jsonpath_parallel_evaluator<json,json&> evaluator("$.items[?(@.price > 20)].price");
+    evaluator.num_threads(4);
+    evaluator.min_array_size(8);
+
+    auto results = evaluator.select(root);
+    auto expected = json_select(root, "$.items[?(@.price > 20)].price");
+    REQUIRE(results.size() == expected.size());
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        CHECK(&results[i] == &expected[i]);
+        CHECK(results.normalized_path(i) == expected.normalized_path(i));
+    }
+
+    results.replace(json(20.0));
+    CHECK(json_query(root, "$.items[?(@.price > 20)]").size() == 0);
+}
+
+TEST_CASE("jsonpath_parallel_evaluator exceptions")
+{
+    json root = make_items(100);
+    root["items"][57]["price"] = "free";
+
+    // The filter of each tags array is evaluated in a chunk of the items
+    std::string path = "$.items[*].tags[?(@ != max($.items[*].price))]";
+    jsonpath_parallel_evaluator<json> evaluator(path);
+    evaluator.num_threads(4);
+    evaluator.min_array_size(8);
+
+    CHECK_THROWS(json_query(root, path));
+    CHECK_THROWS(evaluator.evaluate(root));
+}
@@ -0,0 +1,128 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/jsonpath/json_query.hpp>
+#include <string>
+#include <vector>
+
+using namespace jsoncons;
+using namespace jsoncons::jsonpath;
+
+namespace {
+
+const char* store_text()
+{
+    static const char* text = R"(
+    {
+        "store": {
+            "book": [
+                {"category": "reference", "author": "Nigel Rees", "title": "Sayings of the Century", "price": 8.95},
+                {"category": "fiction", "author": "Evelyn Waugh", "title": "Sword of Honour", "price": 12.99},
+                {"category": "fiction", "author": "Herman Melville", "title": "Moby Dick", "isbn": "0-553-21311-3", "price": 8.99},
+                {"category": "fiction", "author": "J. R. R. Tolkien", "title": "The Lord of the Rings", "isbn": "0-395-19395-8", "price": 22.99}
+            ],
+            "bicycle": {"color": "red", "price": 19.95}
+        }
+    }
+    )";
+    return text;
+}
+
+}
+
+TEST_CASE("jsonpath_result_set matches json_query")
+{
+    const json root = json::parse(store_text());
+
+    std::vector<std::string> paths = {
+        "$.store.book[0].title",
+        "$..author",
+        "$.store.*",
+        "$..book[-1:]",
+        "$..book[?(@.price<10)].title",
+        "$.store.book.length",
+        "$.store.book[0].title[0,2]",
+        "$..*"
+    };
+
+    for (const auto& path : paths)
+    {
+        auto nodes = json_select(root, path);
+        CHECK(nodes.values() == json_query(root, path));
+        CHECK(nodes.normalized_paths() == json_query(root, path, result_type::path));
+    }
+}
+
+TEST_CASE("jsonpath_result_set refers to the document")
+{
+    const json root = json::parse(store_text());
+
+    auto nodes = json_select(root, "$.store.book[?(@.isbn)]");
+    REQUIRE(nodes.size() == 2);
+    CHECK(&nodes[0] == &root["store"]["book"][2]);
+    CHECK(&nodes[1] == &root["store"]["book"][3]);
+    CHECK(nodes.normalized_path(1) == "$['store']['book'][3]");
+
+    std::vector<std::string> titles;
+    for (const auto& book : nodes)
+    {
+        titles.push_back(book["title"].as<std::string>());
+    }
+    CHECK(titles == std::vector<std::string>({"Moby Dick","The Lord of the Rings"}));
+}
+
+TEST_CASE("jsonpath_result_set replace")
+{
+    json root = json::parse(store_text());
+
+    auto nodes = json_select(root, "$..book[?(@.price > 10)].price");
+    nodes[0] = 11.0;
+    CHECK(root["store"]["book"][1]["price"].as<double>() == 11.0);
+
+    nodes.replace(10.0);
+    CHECK(json_query(root, "$..book[*].price") == json::parse("[8.95,10.0,8.99,10.0]"));
+
+    // A length is not in the document
+    json_select(root, "$.store.book.length").replace(0);
+    CHECK(root["store"]["book"].size() == 4);
+
+    json nested = json::parse(R"({"a":{"a":{"a":1}}})");
+    json_select(nested, "$..a").replace(2);
+    CHECK(nested == json::parse(R"({"a":2})"));
+}
+
+TEST_CASE("jsonpath_result_set remove")
+{
+    json root = json::parse(store_text());
+
+    json_select(root, "$.store.book[?(@.price < 10)]").remove();
+    CHECK(json_query(root, "$.store.book[*].title") == json::parse(R"(["Sword of Honour","The Lord of the Rings"])"));
+
+    json_select(root, "$..price").remove();
+    CHECK(json_query(root, "$..price") == json::array());
+    CHECK(root["store"]["bicycle"] == json::parse(R"({"color":"red"})"));
+
+    json a = json::parse("[0,1,2,3,4,5]");
+    json_select(a, "$[0,2,2,4:]").remove();
+    CHECK(a == json::parse("[1,3]"));
+
+    json nested = json::parse(R"({"a":[{"a":1},{"b":2}],"b":{"a":[]}})");
+    json_select(nested, "$..a").remove();
+    CHECK(nested == json::parse(R"({"b":{}})"));
+}
+
+TEST_CASE("jsonpath_result_set from a compiled expression")
+{
+    json root = json::parse(store_text());
+
+    auto expr = jsonpath_expression<json,json&>::compile("$.store.bicycle.color");
+    auto nodes = expr.select(root);
+    REQUIRE(nodes.size() == 1);
+    nodes[0] = "blue";
+    CHECK(root["store"]["bicycle"]["color"].as<std::string>() == "blue");
+
+    json other = json::parse(R"({"store":{}})");
+    CHECK(expr.select(other).empty());
+}
@@ -0,0 +1,156 @@
+// Copyright 2013 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons/json_stream_reader.hpp>
+#include <jsoncons_ext/jsonpath/json_query.hpp>
+#include <jsoncons_ext/jsonpath/jsonpath_stream_selector.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace jsoncons;
+using namespace jsoncons::jsonpath;
+
+namespace {
+
+const char* store_text()
+{
+    static const char* text = R"(
+    {
+        "store": {
+            "book": [
+                {"category": "reference", "author": "Nigel Rees", "title": "Sayings of the Century", "price": 8.95},
+                {"category": "fiction", "author": "Evelyn Waugh", "title": "Sword of Honour", "price": 12.99},
+                {"category": "fiction", "author": "Herman Melville", "title": "Moby Dick", "isbn": "0-553-21311-3", "price": 8.99},
+                {"category": "fiction", "author": "J. R. R. Tolkien", "title": "The Lord of the Rings", "isbn": "0-395-19395-8", "price": 22.99}
+            ],
+            "bicycle": {"color": "red", "price": 19.95}
+        }
+    }
+    )";
+    return text;
+}
+
+json stream_query(const std::string& text, const std::string& path)
+{
+    std::istringstream is(text);
+    return json_stream_query<json>(is, path);
+}
+
+json sorted(json val)
+{
+    std::sort(val.array_range().begin(), val.array_range().end(),
+              [](const json& a, const json& b){return a.to_string() < b.to_string();});
+    return val;
+}
+
+}
+
+TEST_CASE("jsonpath_stream_selector matches json_query")
+{
+    json root = json::parse(store_text());
+
+    std::vector<std::string> paths = {
+        "$",
+        "$.store.book[0].title",
+        "$['store']['bicycle']['color']",
+        "$.store.book[*].author",
+        "$.store.book[1:3].title",
+        "$.store.book[::2].title",
+        "$.store.book[0,2].title",
+        "$.store.book[?(@.isbn)].title",
+        "$.store.book[?(@.price < 10)]",
+        "$.store.book[?(@.author =~ /Evelyn.*?/)].title",
+        "$.store.book[-1].title",
+        "$.store.book[-2:].title",
+        "$.store.book.length",
+        "$.store.book[(@.length-1)].title",
+        "$.store.book[?(@.price < max($.store.book[*].price))].title",
+        "$.store.book[0].title[0]",
+        "$.store.nothing",
+        "$.store.bicycle.color.length"
+    };
+
+    for (const auto& path : paths)
+    {
+        CHECK(stream_query(store_text(), path) == json_query(root, path));
+    }
+}
+
+TEST_CASE("jsonpath_stream_selector recursive descent")
+{
+    json root = json::parse(store_text());
+
+    std::vector<std::string> paths = {
+        "$..author",
+        "$..price",
+        "$..book[2].title",
+        "$..[0]",
+        "$.store..color"
+    };
+
+    // Values are reported in document order
+    for (const auto& path : paths)
+    {
+        CHECK(sorted(stream_query(store_text(), path)) == sorted(json_query(root, path)));
+    }
+    CHECK(stream_query(store_text(), "$..price") == json::parse("[8.95,12.99,8.99,22.99,19.95]"));
+}
+
+TEST_CASE("jsonpath_stream_selector nested matches")
+{
+    std::string text = R"({"a":{"a":{"a":1},"b":2},"c":[{"a":3}]})";
+
+    CHECK(stream_query(text, "$..a") == json::parse(R"([{"a":{"a":1},"b":2},{"a":1},1,3])"));
+    CHECK(stream_query(text, "$.*") == json::parse(R"([{"a":{"a":1},"b":2},[{"a":3}]])"));
+}
+
+TEST_CASE("jsonpath_stream_selector with a function")
+{
+    std::string text = R"([{"id":1,"n":"x"},{"id":2,"n":"y"},{"id":3,"n":"z"}])";
+
+    std::vector<json> values;
+    jsonpath_stream_selector<json> selector("$[?(@.id >= 2)].n",
+                                            [&values](const json& val){values.push_back(val);});
+    std::istringstream is(text);
+    json_reader reader(is, selector);
+    reader.read();
+
+    CHECK(values == std::vector<json>({json("y"), json("z")}));
+}
+
+TEST_CASE("jsonpath_stream_selector with a stream reader")
+{
+    std::istringstream is(store_text());
+    json_stream_reader reader(is);
+
+    json_decoder<json> decoder;
+    jsonpath_stream_selector<json> selector("$.store.book[?(@.category == 'fiction')].price", decoder);
+    selector.read(reader);
+
+    CHECK(decoder.get_result() == json::parse("[12.99,8.99,22.99]"));
+}
+
+TEST_CASE("jsonpath_stream_selector writes to a serializer")
+{
+    std::string text = R"({"rows":[[1,2],[3,4],[5,6]]})";
+
+    std::ostringstream os;
+    json_serializer serializer(os);
+    jsonpath_stream_selector<json> selector("$.rows[*][1]", serializer);
+    std::istringstream is(text);
+    json_reader reader(is, selector);
+    reader.read();
+
+    CHECK(os.str() == "[2,4,6]");
+}
+
+TEST_CASE("jsonpath_stream_selector compile errors")
+{
+    json_decoder<json> decoder;
+    CHECK_THROWS_AS(jsonpath_stream_selector<json>("$.store...price", decoder), parse_error);
+    CHECK_THROWS_AS(jsonpath_stream_selector<json>("$..book[?(@.price<10]", decoder), parse_error);
+}
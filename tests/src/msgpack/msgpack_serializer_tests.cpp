@@ -0,0 +1,135 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/msgpack/msgpack.hpp>
+#include <jsoncons_ext/cbor/cbor.hpp>
+#include <sstream>
+#include <vector>
+#include <limits>
+
+using namespace jsoncons;
+using namespace jsoncons::msgpack;
+
+TEST_CASE("msgpack_serializer matches encode_msgpack")
+{
+    ojson j = ojson::parse(R"(
+    {
+        "application": "hiking",
+        "reputons": [
+            {"rater": "HikingAsylum.example.com", "assertion": "is-good", "rated": "sk", "rating": 0.90}
+        ],
+        "counts": [0, 127, 128, 255, 256, 65535, 65536, -1, -32, -33, -128, -129, -32768, -32769],
+        "big": 18446744073709551615,
+        "small": -9223372036854775808,
+        "flags": [true, false, null],
+        "text": "A string too long for a fixstr, it has more than thirty one bytes"
+    }
+    )");
+
+    std::vector<uint8_t> expected;
+    encode_msgpack(j, expected);
+
+    std::vector<uint8_t> v;
+    msgpack_bytes_serializer serializer(v);
+    j.dump(serializer);
+
+    CHECK(v == expected);
+}
+
+TEST_CASE("msgpack_parser round trip")
+{
+    json j = json::parse(R"({"a":[1,-2,3.5,"four",null,true,{"b":[]}],"c":18446744073709551615})");
+
+    std::vector<uint8_t> v;
+    encode_msgpack(j, v);
+
+    json_decoder<json> decoder;
+    msgpack_parser parser(decoder);
+    parser.update(v.data(), v.size());
+    std::error_code ec;
+    parser.parse_some(ec);
+    REQUIRE_FALSE(ec);
+    CHECK(parser.done());
+    CHECK(decoder.get_result() == j);
+}
+
+TEST_CASE("msgpack transcode from json text")
+{
+    // The json parser does not report container lengths
+    std::string s = R"({"a":[1,2,{"b":"c","d":[]}],"e":[0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16],"f":{}})";
+
+    std::vector<uint8_t> v;
+    msgpack_bytes_serializer serializer(v);
+    std::istringstream is(s);
+    json_reader reader(is, serializer);
+    reader.read();
+
+    std::vector<uint8_t> expected;
+    encode_msgpack(json::parse(s), expected);
+    CHECK(v.size() == expected.size());
+    CHECK(decode_msgpack<json>(v) == json::parse(s));
+}
+
+TEST_CASE("msgpack transcode to json text and cbor")
+{
+    json j = json::parse(R"({"name":"msgpack","values":[1,2,3],"nested":{"x":1.5}})");
+    std::vector<uint8_t> v;
+    encode_msgpack(j, v);
+
+    std::ostringstream os;
+    json_serializer serializer(os);
+    msgpack_parser parser(serializer);
+    parser.update(v.data(), v.size());
+    std::error_code ec;
+    parser.parse_some(ec);
+    REQUIRE_FALSE(ec);
+    CHECK(json::parse(os.str()) == j);
+
+    std::vector<uint8_t> c;
+    cbor::cbor_bytes_serializer cbor_serializer(c);
+    msgpack_parser parser2(cbor_serializer);
+    parser2.update(v.data(), v.size());
+    parser2.parse_some(ec);
+    REQUIRE_FALSE(ec);
+    CHECK(cbor::decode_cbor<json>(c) == j);
+}
+
+TEST_CASE("msgpack byte strings")
+{
+    std::vector<uint8_t> data = {0x01,0x02,0x03};
+    std::vector<uint8_t> v;
+    msgpack_bytes_serializer serializer(v);
+    serializer.byte_string_value(data.data(), data.size());
+    serializer.flush();
+
+    CHECK(v == std::vector<uint8_t>({0xc4,0x03,0x01,0x02,0x03}));
+
+    json_decoder<json> decoder;
+    msgpack_parser parser(decoder);
+    parser.update(v.data(), v.size());
+    std::error_code ec;
+    parser.parse_some(ec);
+    REQUIRE_FALSE(ec);
+    CHECK(decoder.get_result().as_byte_string() == byte_string({0x01,0x02,0x03}));
+}
+
+TEST_CASE("msgpack_parser errors")
+{
+    json_decoder<json> decoder;
+    msgpack_parser parser(decoder);
+    std::error_code ec;
+
+    std::vector<uint8_t> truncated = {0x92,0x01};
+    parser.update(truncated.data(), truncated.size());
+    parser.parse_some(ec);
+    CHECK(ec == msgpack_parse_errc::unexpected_eof);
+
+    ec = std::error_code();
+    parser.reset();
+    std::vector<uint8_t> bad_utf8 = {0xa2,0xc3,0x28};
+    parser.update(bad_utf8.data(), bad_utf8.size());
+    parser.parse_some(ec);
+    CHECK(ec == msgpack_parse_errc::invalid_utf8_text_string);
+}
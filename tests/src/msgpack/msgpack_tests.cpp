@@ -149,3 +149,20 @@ TEST_CASE("msgpack_test2")
     CHECK(j1 == j2);
 }
 
+
+TEST_CASE("msgpack encode typed array")
+{
+    std::vector<double> d = {1.5, 2.5};
+    std::vector<int64_t> i = {1, -2, 300};
+    json j;
+    j["d"] = json::make_typed_array(d.data(), d.size());
+    j["i"] = json::make_typed_array(i.data(), i.size());
+    const json& cj = j;
+
+    std::vector<uint8_t> v;
+    encode_msgpack(cj, v);
+    CHECK(cj["i"].is_typed_array());
+
+    json j2 = decode_msgpack<json>(v);
+    CHECK(j2 == json::parse(R"({"d":[1.5,2.5],"i":[1,-2,300]})"));
+}
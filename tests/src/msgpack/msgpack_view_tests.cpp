@@ -0,0 +1,155 @@
+// Copyright 2018 Daniel Parker
+// Distributed under Boost license
+
+#include <catch/catch.hpp>
+#include <jsoncons/json.hpp>
+#include <jsoncons_ext/msgpack/msgpack.hpp>
+#include <sstream>
+#include <vector>
+#include <limits>
+
+using namespace jsoncons;
+using namespace jsoncons::msgpack;
+
+TEST_CASE("msgpack_view navigation")
+{
+    ojson j = ojson::parse(R"(
+    {
+        "application": "hiking",
+        "reputons": [
+            {"rater": "HikingAsylum.example.com", "assertion": "is-good", "rated": "sk", "rating": 0.90},
+            {"rater": "RockClimbing.example.com", "rating": 0.75}
+        ],
+        "count": 2,
+        "offset": -300,
+        "valid": true,
+        "none": null
+    }
+    )");
+
+    std::vector<uint8_t> buffer;
+    encode_msgpack(j, buffer);
+
+    msgpack_view v(buffer);
+    CHECK(v.is_object());
+    CHECK(v.size() == 6);
+    CHECK(v.contains("reputons"));
+    CHECK_FALSE(v.contains("rater"));
+    CHECK_THROWS(v.at("rater"));
+
+    CHECK(v.at("application").as_string_view() == "hiking");
+    CHECK(v.at("application").as<std::string>() == "hiking");
+    CHECK(v.at("count").as<int>() == 2);
+    CHECK(v.at("offset").as<int64_t>() == -300);
+    CHECK(v.at("valid").as<bool>());
+    CHECK(v.at("none").is_null());
+
+    msgpack_view reputons = v["reputons"];
+    CHECK(reputons.is_array());
+    CHECK(reputons.size() == 2);
+    CHECK(reputons[1]["rater"].as<std::string>() == "RockClimbing.example.com");
+    CHECK(reputons[0]["rating"].as<double>() == 0.90);
+    CHECK_THROWS(reputons.at(2));
+
+    // Strings are views into the buffer
+    const char* data = v["application"].as_string_view().data();
+    CHECK(reinterpret_cast<const uint8_t*>(data) > buffer.data());
+    CHECK(reinterpret_cast<const uint8_t*>(data) < buffer.data() + buffer.size());
+
+    CHECK(decode_msgpack<ojson>(reputons) == j["reputons"]);
+}
+
+TEST_CASE("msgpack_view ranges")
+{
+    json j = json::parse(R"({"a":[1,[2,3],{"b":4}],"c":"d"})");
+    std::vector<uint8_t> buffer;
+    encode_msgpack(j, buffer);
+    msgpack_view v(buffer);
+
+    std::vector<std::string> keys;
+    for (const auto& member : v.object_range())
+    {
+        keys.push_back(std::string(member.key()));
+    }
+    CHECK(keys.size() == 2);
+
+    size_t count = 0;
+    for (const auto& element : v["a"].array_range())
+    {
+        CHECK_FALSE(element.is_null());
+        ++count;
+    }
+    CHECK(count == 3);
+    CHECK(v["a"][2]["b"].as<int>() == 4);
+}
+
+TEST_CASE("msgpack_view numbers")
+{
+    json j = json::array();
+    j.push_back((std::numeric_limits<uint64_t>::max)());
+    j.push_back((std::numeric_limits<int64_t>::min)());
+    j.push_back(-5);
+    j.push_back(200);
+    j.push_back(1.5);
+
+    std::vector<uint8_t> buffer;
+    encode_msgpack(j, buffer);
+    msgpack_view v(buffer);
+
+    CHECK(v[0].is_uint64());
+    CHECK_FALSE(v[0].is_int64());
+    CHECK(v[0].as<uint64_t>() == (std::numeric_limits<uint64_t>::max)());
+    CHECK(v[1].as<int64_t>() == (std::numeric_limits<int64_t>::min)());
+    CHECK(v[2].as<int>() == -5);
+    CHECK(v[3].as<int>() == 200);
+    CHECK(v[4].is_double());
+    CHECK(v[4].as<double>() == 1.5);
+}
+
+TEST_CASE("msgpack_view byte strings and dump")
+{
+    std::vector<uint8_t> buffer = {0x82,0xa1,'a',0xc4,0x02,0x01,0x02,0xa1,'b',0x92,0xc3,0xc0};
+    msgpack_view v(buffer);
+
+    CHECK(v["a"].is_byte_string());
+    byte_string_view bs = v["a"].as_byte_string_view();
+    CHECK(bs.length() == 2);
+    CHECK(bs.data() == buffer.data() + 5);
+
+    std::ostringstream os;
+    v["b"].dump(os);
+    CHECK(os.str() == "[true,null]");
+}
+
+TEST_CASE("msgpack_view malformed")
+{
+    std::vector<uint8_t> buffer = {0x92,0x01};
+    msgpack_view v(buffer);
+    CHECK(v.size() == 2);
+    CHECK_THROWS(v[1]);
+}
+
+TEST_CASE("msgpack_view ext types")
+{
+    // [1, fixext 1 (type 5, data 0x2a), 2]
+    std::vector<uint8_t> buffer = {0x93,0x01,0xd4,0x05,0x2a,0x02};
+    msgpack_view v(buffer);
+
+    CHECK(v.size() == 3);
+    CHECK(v[0].as<int>() == 1);
+    CHECK_THROWS_AS(v[1].type(), msgpack_decode_error);
+    CHECK_THROWS_AS(v[2], msgpack_decode_error);
+
+    // The parser and decode_msgpack reject it too
+    json_decoder<json> decoder;
+    msgpack_parser parser(decoder);
+    parser.update(buffer.data(), buffer.size());
+    std::error_code ec;
+    parser.parse_some(ec);
+    CHECK(ec == msgpack_parse_errc::source_error);
+    CHECK_THROWS(decode_msgpack<json>(buffer));
+
+    // ext 8 with a 2 byte payload
+    std::vector<uint8_t> ext8 = {0xc7,0x02,0x01,0xaa,0xbb};
+    CHECK_THROWS_AS(msgpack_view(ext8).type(), msgpack_decode_error);
+}